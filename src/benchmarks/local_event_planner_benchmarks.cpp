@@ -0,0 +1,1316 @@
+/**
+ * @file local_event_planner_benchmarks.cpp
+ * @brief Microbenchmarks for hashing, the user table, persistence, dates and
+ * the event store's indexes.
+ *
+ * Every result is one JSON object per line (JSON Lines) on stdout or in the
+ * file given with --output; progress goes to stderr. The first line
+ * describes the run. Each benchmark is repeated and the fastest run is
+ * reported next to the median, so results can be compared across commits.
+ */
+
+#include "../local_event_planner/header/batch_driver.h"
+#include "../local_event_planner/header/brent_hashing.h"
+#include "../local_event_planner/header/concurrent_brent_hashing.h"
+#include "../local_event_planner/header/local_event_planner.h"
+#include "../local_event_planner/header/terminal.h"
+#include "../local_event_planner/header/user_store.h"
+#include "../utility/header/date_time.h"
+#include "../utility/header/file_utility.h"
+#include "../utility/header/user_index.h"
+#include "../utility/header/user_journal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+// Small blocks in use plus the ones large enough to get their own mmap().
+#define BENCH_HEAP_BYTES() ((long long)(mallinfo2().uordblks + mallinfo2().hblkhd))
+#else
+#define BENCH_HEAP_BYTES() (-1LL)  // heap figures are reported as -1
+#endif
+
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+#define BENCH_OPTIMIZED true
+#else
+#define BENCH_OPTIMIZED false
+#endif
+
+#if defined(ENABLE_HOT_PATH_STATS)
+#define BENCH_HOT_PATH_STATS true  // counters in brent_hashing.cpp/file_utility.cpp are compiled in
+#else
+#define BENCH_HOT_PATH_STATS false
+#endif
+
+namespace {
+
+struct BenchOptions {
+  int repetitions = 5;
+  uint64_t maxUsers = 1000000;   // 10^7 only on request: the file alone is ~250 MB
+  unsigned int tableCapacity = 1u << 20;
+  uint64_t maxEvents = 1000000;  // also scales the documents, intervals and attendees
+  const char *directory = ".";
+  FILE *output = stdout;
+};
+
+volatile uint64_t benchSink = 0;  // keeps results alive so the work is not optimized away
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Runs @p body (which performs @p ops operations) the configured number of
+ * times and writes one result line with the fastest and the median run.
+ * @p params is a JSON object body, e.g. "\"users\":1000".
+ */
+template <typename Body>
+void runBenchmark(const BenchOptions &options, const char *name, const std::string &params, uint64_t ops, Body body,
+                  const std::string &extra = std::string()) {
+  std::vector<double> seconds;
+  for (int r = 0; r < options.repetitions; r++) {
+    seconds.push_back(body());
+  }
+  std::sort(seconds.begin(), seconds.end());
+  double best = seconds.front(), median = seconds[seconds.size() / 2];
+
+  fprintf(options.output,
+          "{\"benchmark\":\"%s\",\"params\":{%s},\"ops\":%llu,\"repetitions\":%d,"
+          "\"ns_per_op\":%.3f,\"ns_per_op_median\":%.3f,\"ops_per_sec\":%.1f%s%s}\n",
+          name, params.c_str(), (unsigned long long)ops, options.repetitions, best * 1e9 / ops, median * 1e9 / ops,
+          ops / best, extra.empty() ? "" : ",", extra.c_str());
+  fflush(options.output);
+  fprintf(stderr, "%-28s %-36s %12.2f ns/op\n", name, params.c_str(), best * 1e9 / ops);
+}
+
+std::string format(const char *pattern, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, pattern);
+  vsnprintf(buffer, sizeof(buffer), pattern, args);
+  va_end(args);
+  return buffer;
+}
+
+/** Deterministic usernames like the ones users pick: letters and digits. */
+std::vector<std::string> makeUsernames(size_t count, size_t length, uint64_t seed) {
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+  std::vector<std::string> names(count);
+  for (size_t i = 0; i < count; i++) {
+    std::string name = format("u%zu_", i);
+    while (name.size() < length) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      name.push_back(alphabet[(seed >> 33) % (sizeof(alphabet) - 1)]);
+    }
+    names[i] = name;
+  }
+  return names;
+}
+
+/** The shift/add hash the table used before hashUsername(), kept as the distribution baseline. */
+unsigned int legacyShiftAddHash(const char *key) {
+  unsigned int hash = 0;
+  while (*key) {
+    hash = (hash << 5) + *key++;
+  }
+  return hash;
+}
+
+void benchmarkHash(const BenchOptions &options) {
+  const size_t keyCount = 4096;
+  const uint64_t ops = 4000000;
+  const size_t lengths[] = { 4, 8, 16, 32, 49 };
+  for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    std::vector<std::string> keys = makeUsernames(keyCount, lengths[l], 11);
+    for (size_t k = 0; k < keyCount; k++) {
+      keys[k].resize(lengths[l]);  // short keys need not be unique to time the hash
+    }
+    runBenchmark(options, "hashUsername", format("\"key_length\":%zu", lengths[l]), ops, [&]() {
+      uint64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < ops; i++) {
+        sum += hashUsername(keys[i & (keyCount - 1)].c_str());
+      }
+      double elapsed = secondsSince(start);
+      benchSink += sum;
+      return elapsed;
+    });
+  }
+
+  // Sequential names into 2^17 buckets: how many buckets each hash reaches and its fullest one.
+  const unsigned int buckets = 1u << 17;
+  std::vector<std::string> names(100000);
+  for (size_t i = 0; i < names.size(); i++) {
+    names[i] = format("istanbul_user_%06zu", i);
+  }
+  for (int legacy = 1; legacy >= 0; legacy--) {
+    auto bucketOf = [&](const std::string &name) {
+      return (legacy ? legacyShiftAddHash(name.c_str()) : (unsigned int)hashUsername(name.c_str())) & (buckets - 1);
+    };
+    std::vector<unsigned int> load(buckets, 0);
+    unsigned int used = 0, fullest = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+      unsigned int &bucket = load[bucketOf(names[i])];
+      used += bucket == 0;
+      fullest = std::max(fullest, ++bucket);
+    }
+    runBenchmark(options, legacy ? "legacyShiftAddHash_buckets" : "hashUsername_buckets",
+                 format("\"keys\":%zu,\"buckets\":%u", names.size(), buckets), names.size(), [&]() {
+      uint64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < names.size(); i++) {
+        sum += bucketOf(names[i]);
+      }
+      double elapsed = secondsSince(start);
+      benchSink += sum;
+      return elapsed;
+    }, format("\"buckets_used\":%u,\"max_bucket\":%u", used, fullest));
+  }
+}
+
+void benchmarkUserTable(const BenchOptions &options) {
+  const double loadFactors[] = { 0.25, 0.5, 0.75, 0.9 };
+  for (size_t f = 0; f < sizeof(loadFactors) / sizeof(loadFactors[0]); f++) {
+    unsigned int capacity = options.tableCapacity;
+    unsigned int count = (unsigned int)(capacity * loadFactors[f]);
+    std::vector<std::string> names = makeUsernames(count, 12, 21);
+    std::vector<std::string> missing = makeUsernames(count, 13, 22);
+    std::string params = format("\"capacity\":%u,\"load_factor\":%.2f", capacity, loadFactors[f]);
+
+    // The table is created at its final capacity with a maximum load of 1.0,
+    // so no resize happens and the load factor is exactly the one measured.
+    HashTable ht;
+    runBenchmark(options, "insertUserBrent", params, count, [&]() {
+      initBrentHashTableWithCapacity(&ht, capacity, 1.0f);
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < count; i++) {
+        insertUserBrent(&ht, (int)i + 1, names[i].c_str(), "password");
+      }
+      double elapsed = secondsSince(start);
+      destroyBrentHashTable(&ht);
+      return elapsed;
+    });
+
+    initBrentHashTableWithCapacity(&ht, capacity, 1.0f);
+    for (unsigned int i = 0; i < count; i++) {
+      insertUserBrent(&ht, (int)i + 1, names[i].c_str(), "password");
+    }
+    double probes = averageProbeLengthBrent(&ht);
+    runBenchmark(options, "findUserBrent_hit", params, count, [&]() {
+      uint64_t found = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < count; i++) {
+        User *user = NULL;
+        found += findUserBrent(&ht, names[(i * 2654435761u) % count].c_str(), &user);
+      }
+      double elapsed = secondsSince(start);
+      benchSink += found;
+      return elapsed;
+    }, format("\"average_probe_length\":%.3f", probes));
+    runBenchmark(options, "findUserBrent_miss", params, count, [&]() {
+      uint64_t found = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < count; i++) {
+        found += findUserBrent(&ht, missing[i].c_str(), NULL);
+      }
+      double elapsed = secondsSince(start);
+      benchSink += found;
+      return elapsed;
+    });
+    destroyBrentHashTable(&ht);
+  }
+}
+
+/**
+ * The layout the table had before the slab: one malloc per User and a
+ * 16-byte {User*, hash} slot, probed linearly and doubled at the same
+ * maximum load as the Brent table.
+ */
+struct PerUserSlot {
+  User *user;
+  uint64_t hash;
+};
+
+struct PerUserTable {
+  std::vector<PerUserSlot> slots;
+  unsigned int count;
+};
+
+void placePerUser(std::vector<PerUserSlot> *slots, const PerUserSlot &entry) {
+  size_t mask = slots->size() - 1;
+  size_t i = entry.hash & mask;
+  while ((*slots)[i].user) {
+    i = (i + 1) & mask;
+  }
+  (*slots)[i] = entry;
+}
+
+void initPerUserTable(PerUserTable *table) {
+  PerUserSlot empty = { NULL, 0 };
+  table->slots.assign(BRENT_INITIAL_CAPACITY, empty);
+  table->count = 0;
+}
+
+User *findPerUser(const PerUserTable *table, const char *username) {
+  uint64_t hash = hashUsername(username);
+  size_t mask = table->slots.size() - 1;
+  for (size_t i = hash & mask; table->slots[i].user; i = (i + 1) & mask) {
+    if (table->slots[i].hash == hash && strcmp(table->slots[i].user->username, username) == 0) {
+      return table->slots[i].user;
+    }
+  }
+  return NULL;
+}
+
+int insertPerUser(PerUserTable *table, int id, const char *username, const char *password) {
+  if (findPerUser(table, username)) {
+    return 0;
+  }
+  if (table->count + 1 > table->slots.size() * BRENT_DEFAULT_MAX_LOAD) {
+    PerUserSlot empty = { NULL, 0 };
+    std::vector<PerUserSlot> grown(table->slots.size() * 2, empty);
+    for (size_t i = 0; i < table->slots.size(); i++) {
+      if (table->slots[i].user) {
+        placePerUser(&grown, table->slots[i]);
+      }
+    }
+    table->slots.swap(grown);
+  }
+  User *user = (User *)malloc(sizeof(User));
+  if (!user) {
+    return 0;
+  }
+  memset(user, 0, sizeof(User));
+  user->id = id;
+  snprintf(user->username, sizeof(user->username), "%s", username);
+  snprintf(user->password, sizeof(user->password), "%s", password);
+  PerUserSlot entry = { user, hashUsername(username) };
+  placePerUser(&table->slots, entry);
+  table->count++;
+  return 1;
+}
+
+void destroyPerUserTable(PerUserTable *table) {
+  for (size_t i = 0; i < table->slots.size(); i++) {
+    free(table->slots[i].user);
+  }
+  std::vector<PerUserSlot>().swap(table->slots);
+  table->count = 0;
+}
+
+/**
+ * Both layouts run the same workload from an empty table: insert every
+ * user, then look each one up and look up as many missing names. Memory
+ * is what the heap grew by while the table was built, so malloc headers
+ * and rounding count against the per-user layout as they did in practice.
+ */
+void benchmarkTableLayouts(const BenchOptions &options) {
+  unsigned int users = std::max(options.tableCapacity / 4, 1u);
+  std::vector<std::string> names = makeUsernames(users, 16, 41);
+  std::vector<std::string> missing = makeUsernames(users, 17, 42);
+  std::string params = format("\"users\":%u", users);
+
+  auto slabWorkload = [&](HashTable *ht) {
+    uint64_t found = 0;
+    initBrentHashTable(ht);
+    for (unsigned int i = 0; i < users; i++) {
+      insertUserBrent(ht, (int)i + 1, names[i].c_str(), "password");
+    }
+    for (unsigned int i = 0; i < users; i++) {
+      found += findUserBrent(ht, names[(i * 2654435761u) % users].c_str(), NULL);
+      found += findUserBrent(ht, missing[i].c_str(), NULL);
+    }
+    return found;
+  };
+  auto perUserWorkload = [&](PerUserTable *table) {
+    uint64_t found = 0;
+    initPerUserTable(table);
+    for (unsigned int i = 0; i < users; i++) {
+      insertPerUser(table, (int)i + 1, names[i].c_str(), "password");
+    }
+    for (unsigned int i = 0; i < users; i++) {
+      found += findPerUser(table, names[(i * 2654435761u) % users].c_str()) != NULL;
+      found += findPerUser(table, missing[i].c_str()) != NULL;
+    }
+    return found;
+  };
+
+  HashTable ht;
+  long long heapBefore = BENCH_HEAP_BYTES();
+  benchSink += slabWorkload(&ht);
+  long long slabHeap = BENCH_HEAP_BYTES() < 0 ? -1 : BENCH_HEAP_BYTES() - heapBefore;
+  size_t slabBytes = memoryUsageBrent(&ht);
+  unsigned int allocations = ht.chunkCount + 2;  // slots, chunk directory, chunks
+  destroyBrentHashTable(&ht);
+  runBenchmark(options, "slab_insert_lookup", params, 3ull * users, [&]() {
+    auto start = std::chrono::steady_clock::now();
+    benchSink += slabWorkload(&ht);
+    double elapsed = secondsSince(start);
+    destroyBrentHashTable(&ht);
+    return elapsed;
+  }, format("\"heap_bytes\":%lld,\"table_bytes\":%zu,\"allocations\":%u", slabHeap, slabBytes, allocations));
+
+  PerUserTable table;
+  heapBefore = BENCH_HEAP_BYTES();
+  benchSink += perUserWorkload(&table);
+  long long perUserHeap = BENCH_HEAP_BYTES() < 0 ? -1 : BENCH_HEAP_BYTES() - heapBefore;
+  size_t slotBytes = table.slots.size() * sizeof(PerUserSlot);
+  destroyPerUserTable(&table);
+  runBenchmark(options, "per_user_malloc_insert_lookup", params, 3ull * users, [&]() {
+    auto start = std::chrono::steady_clock::now();
+    benchSink += perUserWorkload(&table);
+    double elapsed = secondsSince(start);
+    destroyPerUserTable(&table);
+    return elapsed;
+  }, format("\"heap_bytes\":%lld,\"slot_bytes\":%zu,\"allocations\":%u", perUserHeap, slotBytes, users + 1));
+}
+
+/**
+ * Lookups in a table whose users are deleted and replaced oldest first,
+ * measured every few rounds of churn: tombstones must not make them slower.
+ */
+void benchmarkTableChurn(const BenchOptions &options) {
+  unsigned int live = std::max(options.tableCapacity / 8, 64u);
+  unsigned int samples = std::min(live, 20000u);
+  unsigned int cyclesPerStage = 5 * live;
+  char name[50];
+  HashTable ht;
+  initBrentHashTable(&ht);
+  reserveBrentHashTable(&ht, live);
+  for (unsigned int i = 0; i < live; i++) {
+    snprintf(name, sizeof(name), "churn_%u", i);
+    insertUserBrent(&ht, (int)i + 1, name, "secret");
+  }
+  std::vector<std::string> missing(samples);
+  for (unsigned int i = 0; i < samples; i++) {
+    missing[i] = format("missing_%u", i);
+  }
+
+  // The live users are always [oldest, oldest + live).
+  unsigned int oldest = 0;
+  std::vector<std::string> present(samples);
+  for (int stage = 0; stage <= 4; stage++) {
+    for (unsigned int i = 0; i < samples; i++) {
+      present[i] = format("churn_%u", oldest + (unsigned int)((i * 7919ull) % live));
+    }
+    runBenchmark(options, "findUserBrent_after_churn",
+                 format("\"live\":%u,\"cycles\":%llu", live, (unsigned long long)stage * cyclesPerStage), 2ull * samples, [&]() {
+      uint64_t found = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < samples; i++) {
+        found += findUserBrent(&ht, present[i].c_str(), NULL);
+        found += findUserBrent(&ht, missing[i].c_str(), NULL);
+      }
+      double elapsed = secondsSince(start);
+      benchSink += found;
+      return elapsed;
+    }, format("\"average_probe_length\":%.3f,\"tombstones\":%u,\"capacity\":%u", averageProbeLengthBrent(&ht), ht.tombstones,
+              ht.capacity));
+
+    for (unsigned int i = 0; i < cyclesPerStage && stage < 4; i++) {
+      snprintf(name, sizeof(name), "churn_%u", oldest);
+      deleteUserBrent(&ht, name);
+      snprintf(name, sizeof(name), "churn_%u", oldest + live);
+      insertUserBrent(&ht, (int)(oldest + live) + 1, name, "secret");
+      oldest++;
+    }
+  }
+  destroyBrentHashTable(&ht);
+}
+
+/** Lookups from 1 to 8 threads: the sharded seqlock table against one mutex around the Brent table. */
+void benchmarkConcurrentLookups(const BenchOptions &options) {
+  unsigned int users = std::max(options.tableCapacity / 16, 64u);
+  unsigned int lookupsPerThread = users;
+  std::vector<std::string> names = makeUsernames(users, 14, 51);
+  ConcurrentHashTable ct;
+  initConcurrentHashTable(&ct, 0.9f);
+  HashTable ht;
+  initBrentHashTable(&ht);
+  std::mutex globalLock;
+  for (unsigned int i = 0; i < users; i++) {
+    insertUserConcurrent(&ct, names[i].c_str(), "secret", NULL);
+    insertUserBrent(&ht, (int)i + 1, names[i].c_str(), "secret");
+  }
+
+  for (int threadCount = 1; threadCount <= 8; threadCount *= 2) {
+    std::string params = format("\"users\":%u,\"threads\":%d", users, threadCount);
+    for (int sharded = 1; sharded >= 0; sharded--) {
+      runBenchmark(options, sharded ? "findUserConcurrent" : "findUserBrent_global_mutex", params,
+                   (uint64_t)threadCount * lookupsPerThread, [&]() {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threadCount; t++) {
+          threads.push_back(std::thread([&, t]() {
+            uint64_t found = 0;
+            for (unsigned int i = 0; i < lookupsPerThread; i++) {
+              const char *key = names[(i * 7919ull + t * 104729ull) % users].c_str();
+              if (sharded) {
+                found += findUserConcurrent(&ct, key, NULL);
+              } else {
+                std::lock_guard<std::mutex> guard(globalLock);
+                found += findUserBrent(&ht, key, NULL);
+              }
+            }
+            std::lock_guard<std::mutex> guard(globalLock);
+            benchSink += found;
+          }));
+        }
+        for (size_t t = 0; t < threads.size(); t++) {
+          threads[t].join();
+        }
+        return secondsSince(start);
+      }, format("\"cores\":%u", std::thread::hardware_concurrency()));
+    }
+  }
+  destroyBrentHashTable(&ht);
+  destroyConcurrentHashTable(&ct);
+}
+
+void removeUserFiles(const std::string &file) {
+  char journal[FILENAME_MAX];
+  buildUserJournalPath(journal, sizeof(journal), file.c_str());
+  remove(file.c_str());
+  remove((file + ".tmp").c_str());
+  remove((file + ".idx").c_str());
+  remove(journal);
+}
+
+/** Writes the table as bare fixed-width records with no header, as builds before the record header did. */
+void writeHeaderlessUsers(const HashTable *ht, const std::string &file) {
+  FILE *out = fopen(file.c_str(), "wb");
+  if (!out) {
+    return;
+  }
+  for (unsigned int i = 0; i < ht->count; i++) {
+    fwrite(getUserAtBrent(ht, i), sizeof(User), 1, out);
+  }
+  fclose(out);
+}
+
+long fileBytesOf(const std::string &file) {
+  long bytes = 0;
+  FILE *in = fopen(file.c_str(), "rb");
+  if (in) {
+    fseek(in, 0, SEEK_END);
+    bytes = ftell(in);
+    fclose(in);
+  }
+  return bytes;
+}
+
+void benchmarkPersistence(const BenchOptions &options) {
+  std::string file = std::string(options.directory) + "/bench_users.dat";
+  std::string fixedFile = std::string(options.directory) + "/bench_users_fixed.dat";
+  for (uint64_t users = 1000; users <= options.maxUsers; users *= 10) {
+    std::vector<User> records(users);
+    std::vector<std::string> names = makeUsernames(users, 12, 31);
+    for (uint64_t i = 0; i < users; i++) {
+      records[i].id = (int)i + 1;
+      snprintf(records[i].username, sizeof(records[i].username), "%s", names[i].c_str());
+      snprintf(records[i].password, sizeof(records[i].password), "pw%llu", (unsigned long long)i);
+    }
+    std::vector<std::string>().swap(names);
+
+    HashTable source;
+    initBrentHashTable(&source);
+    reserveBrentHashTable(&source, (unsigned int)users);
+    insertUsersBulkBrent(&source, records.data(), (unsigned int)users);
+    std::vector<User>().swap(records);
+
+    std::string params = format("\"users\":%llu", (unsigned long long)users);
+    removeUserFiles(file);
+    runBenchmark(options, "saveUsersToBinaryFile", params, users, [&]() {
+      auto start = std::chrono::steady_clock::now();
+      int ok = saveUsersToBinaryFile(&source, file.c_str());
+      double elapsed = secondsSince(start);
+      benchSink += ok;
+      return elapsed;
+    });
+
+    long fileBytes = fileBytesOf(file);
+    runBenchmark(options, "loadUsersFromBinaryFile", params, users, [&]() {
+      HashTable loaded;
+      initBrentHashTable(&loaded);
+      auto start = std::chrono::steady_clock::now();
+      int ok = loadUsersFromBinaryFile(&loaded, file.c_str());
+      double elapsed = secondsSince(start);
+      benchSink += ok + loaded.count;
+      destroyBrentHashTable(&loaded);
+      return elapsed;
+    }, format("\"file_bytes\":%ld", fileBytes));
+
+    const uint64_t calls = 2000;
+    runBenchmark(options, "getNextID", params, calls, [&]() {
+      uint64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < calls; i++) {
+        sum += (uint64_t)getNextID(file.c_str(), sizeof(User));
+      }
+      double elapsed = secondsSince(start);
+      benchSink += sum;
+      return elapsed;
+    });
+
+    // A login without loading the table: map the file and look up one user.
+    std::string lastName = getUserAtBrent(&source, source.count - 1)->username;
+    runBenchmark(options, "findUserInFileView_cold", params, 1, [&]() {
+      UserFileView view;
+      auto start = std::chrono::steady_clock::now();
+      int found = openUserFileView(&view, file.c_str()) && findUserInFileView(&view, lastName.c_str(), NULL);
+      closeUserFileView(&view);
+      double elapsed = secondsSince(start);
+      benchSink += found;
+      return elapsed;
+    });
+
+    writeUserIndex(file.c_str());
+    runBenchmark(options, "openUserIndex", params, 1, [&]() {
+      UserIndexView view;
+      auto start = std::chrono::steady_clock::now();
+      int opened = openUserIndex(&view, file.c_str());
+      double elapsed = secondsSince(start);
+      if (opened) {
+        closeUserIndex(&view);
+      }
+      benchSink += opened;
+      return elapsed;
+    });
+    UserIndexView index;
+    if (openUserIndex(&index, file.c_str())) {
+      uint64_t lookups = std::min<uint64_t>(users, 10000);
+      std::vector<std::string> keys(lookups);
+      for (uint64_t i = 0; i < lookups; i++) {
+        keys[i] = getUserAtBrent(&source, (unsigned int)((i * 2654435761u) % users))->username;
+      }
+      runBenchmark(options, "findUserInIndex", params, lookups, [&]() {
+        uint64_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < lookups; i++) {
+          found += findUserInIndex(&index, keys[i].c_str(), NULL);
+        }
+        double elapsed = secondsSince(start);
+        benchSink += found;
+        return elapsed;
+      });
+      closeUserIndex(&index);
+    }
+
+    // Files from before the record header: getNextID() scans them until loadUserDatabase() migrates them.
+    writeHeaderlessUsers(&source, fixedFile);
+    runBenchmark(options, "getNextID_headerless", params, 1, [&]() {
+      auto start = std::chrono::steady_clock::now();
+      int next = getNextID(fixedFile.c_str(), sizeof(User));
+      double elapsed = secondsSince(start);
+      benchSink += (uint64_t)next;
+      return elapsed;
+    });
+    migrateRecordFile(fixedFile.c_str(), sizeof(User));
+
+    // The migrated file keeps fixed-width records; the saved one is compact.
+    runBenchmark(options, "loadUsersFromBinaryFile_fixed_width", params, users, [&]() {
+      HashTable loaded;
+      initBrentHashTable(&loaded);
+      auto start = std::chrono::steady_clock::now();
+      int ok = loadUsersFromBinaryFile(&loaded, fixedFile.c_str());
+      double elapsed = secondsSince(start);
+      benchSink += ok + loaded.count;
+      destroyBrentHashTable(&loaded);
+      return elapsed;
+    }, format("\"file_bytes\":%ld", fileBytesOf(fixedFile)));
+
+    // Loading as it was before bulk loading: one fread, find and insert per record.
+    runBenchmark(options, "loadUsersPerRecord", params, users, [&]() {
+      HashTable loaded;
+      initBrentHashTable(&loaded);
+      auto start = std::chrono::steady_clock::now();
+      FILE *in = fopen(fixedFile.c_str(), "rb");
+      RecordFileHeader header;
+      User user;
+      if (in && readRecordFileHeader(in, sizeof(User), &header) == RECORD_FILE_CURRENT) {
+        while (fread(&user, sizeof(User), 1, in) == 1) {
+          if (!findUserBrent(&loaded, user.username, NULL)) {
+            insertUserBrent(&loaded, user.id, user.username, user.password);
+          }
+        }
+      }
+      if (in) {
+        fclose(in);
+      }
+      double elapsed = secondsSince(start);
+      benchSink += loaded.count;
+      destroyBrentHashTable(&loaded);
+      return elapsed;
+    });
+
+    destroyBrentHashTable(&source);
+    removeUserFiles(file);
+    removeUserFiles(fixedFile);
+  }
+}
+
+/** The allocation-per-call getFormattedDate() of earlier builds: malloc, localtime and mktime per date. */
+static char *legacyFormattedDate(int daysToAdd) {
+  const size_t size = 40;  // room for three full ints, so snprintf cannot truncate
+  char *dateStr = static_cast<char *>(malloc(size));
+  time_t now = time(NULL);
+  struct tm *ltm = localtime(&now);
+  ltm->tm_mday += daysToAdd;
+  mktime(ltm);
+  snprintf(dateStr, size, "%04d-%02d-%02d", 1900 + ltm->tm_year, 1 + ltm->tm_mon, ltm->tm_mday);
+  return dateStr;
+}
+
+void benchmarkDates(const BenchOptions &options) {
+  const uint64_t ops = 1000000;
+  runBenchmark(options, "legacyFormattedDate", "", ops, [&]() {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) {
+      char *text = legacyFormattedDate((int)(i % 730) - 365);
+      sum += (unsigned char)text[9];
+      free(text);
+    }
+    double elapsed = secondsSince(start);
+    benchSink += sum;
+    return elapsed;
+  });
+
+  runBenchmark(options, "getFormattedDate", "", ops, [&]() {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) {
+      char *text = getFormattedDate((int)(i % 730) - 365);
+      sum += text ? (unsigned char)text[9] : 0;
+      free(text);
+    }
+    double elapsed = secondsSince(start);
+    benchSink += sum;
+    return elapsed;
+  });
+
+  runBenchmark(options, "getFormattedDate_buffer", "", ops, [&]() {
+    uint64_t sum = 0;
+    char text[DATE_STRING_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) {
+      sum += getFormattedDate((int)(i % 730) - 365, text, sizeof(text)) ? (unsigned char)text[9] : 0;
+    }
+    double elapsed = secondsSince(start);
+    benchSink += sum;
+    return elapsed;
+  });
+
+  Date today = makeDate(2025, 1, 1);
+  runBenchmark(options, "formatDate", "", ops, [&]() {
+    uint64_t sum = 0;
+    char text[DATE_STRING_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) {
+      formatDate(addDays(today, (int)(i % 730) - 365), text, sizeof(text));
+      sum += (unsigned char)text[9];
+    }
+    double elapsed = secondsSince(start);
+    benchSink += sum;
+    return elapsed;
+  });
+
+  std::vector<Date> dates(4096);
+  for (size_t i = 0; i < dates.size(); i++) {
+    dates[i] = addDays(today, (int)(i / 8));  // listing views: runs of nearby dates
+  }
+  std::vector<char> table(dates.size() * DATE_STRING_SIZE);
+  const uint64_t batches = ops / dates.size();
+  runBenchmark(options, "formatDates", format("\"batch\":%zu", dates.size()), batches * dates.size(), [&]() {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t b = 0; b < batches; b++) {
+      sum += formatDates(dates.data(), dates.size(), table.data(), DATE_STRING_SIZE);
+    }
+    double elapsed = secondsSince(start);
+    benchSink += sum;
+    return elapsed;
+  });
+}
+
+uint64_t nextRandom(uint64_t *seed) {
+  *seed = *seed * 6364136223846793005ull + 1442695040888963407ull;
+  return *seed;
+}
+
+/**
+ * One store of events spread over a year and clustered around 50 cities,
+ * queried by time window and by distance, each against a linear scan.
+ */
+void benchmarkEventQueries(const BenchOptions &options) {
+  const int events = (int)std::max<uint64_t>(options.maxEvents, 1000), cityCount = 50, queries = 2000, scans = 10;
+  const int64_t day = 86400, year = 365 * day;
+  EventStore store;
+  initEventStore(&store);
+  store.events.reserve(events);
+
+  // Larger cities (lower index) draw more events.
+  double cityLatitude[cityCount], cityLongitude[cityCount];
+  uint64_t seed = 4242;
+  for (int c = 0; c < cityCount; c++) {
+    nextRandom(&seed);
+    cityLatitude[c] = (double)((seed >> 20) % 12000) / 100.0 - 60.0;
+    cityLongitude[c] = (double)((seed >> 40) % 36000) / 100.0 - 180.0;
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < events; i++) {
+    nextRandom(&seed);
+    int c = (int)((seed >> 33) % cityCount * ((seed >> 50) % cityCount) / cityCount);
+    // Sum of two uniforms: a peaked spread of about +-0.3 degrees.
+    double dLat = ((double)((seed >> 8) & 0xFFF) + (double)((seed >> 20) & 0xFFF)) / 8192.0 * 0.6 - 0.3;
+    double dLon = ((double)((seed >> 32) & 0xFFF) + (double)((seed >> 44) & 0xFFF)) / 8192.0 * 0.6 - 0.3;
+    int64_t begin = (int64_t)((seed >> 16) % (uint64_t)year);
+    Event *created = NULL;
+    if (addEvent(&store, i % 1000, begin, begin + 7200, "event", "city", &created)) {
+      setEventPosition(&store, created->id, cityLatitude[c] + dLat, cityLongitude[c] + dLon);
+    }
+  }
+  double insertNs = secondsSince(start) * 1e9 / events;
+  std::string params = format("\"events\":%d", events);
+
+  std::vector<const Event *> found;
+  auto rangeQueries = [&](int count) {
+    size_t total = 0;
+    for (int q = 0; q < count; q++) {
+      int64_t from = (int64_t)q * (year / queries);
+      found.clear();
+      total += findEventsInRange(&store, from, from + day, &found);
+    }
+    return total;
+  };
+  auto rangeScans = [&](int count) {
+    size_t total = 0;
+    for (int q = 0; q < count; q++) {
+      int64_t from = (int64_t)q * (year / queries);
+      for (unsigned int i = 0; i < store.events.size(); i++) {
+        const Event *event = store.events.at(i);
+        total += event->startTime >= from && event->startTime < from + day;
+      }
+    }
+    return total;
+  };
+  auto nearQueries = [&](int count) {
+    size_t total = 0;
+    for (int q = 0; q < count; q++) {
+      int64_t from = (int64_t)q * (year / queries);
+      found.clear();
+      total += findEventsNear(&store, cityLatitude[q % cityCount], cityLongitude[q % cityCount], 5.0, from, from + 7 * day, &found);
+    }
+    return total;
+  };
+  auto nearScans = [&](int count) {
+    size_t total = 0;
+    for (int q = 0; q < count; q++) {
+      int64_t from = (int64_t)q * (year / queries);
+      int32_t latitudeE6 = degreesToE6(cityLatitude[q % cityCount]), longitudeE6 = degreesToE6(cityLongitude[q % cityCount]);
+      for (unsigned int i = 0; i < store.events.size(); i++) {
+        const Event *event = store.events.at(i);
+        total += event->startTime >= from && event->startTime < from + 7 * day
+                 && distanceKm(latitudeE6, longitudeE6, event->latitudeE6, event->longitudeE6) <= 5.0;
+      }
+    }
+    return total;
+  };
+
+  const char *rangeParams = ",\"window\":\"1 day\"", *nearParams = ",\"window\":\"5 km, 1 week\"";
+  double hits = (double)rangeQueries(queries) / queries;
+  runBenchmark(options, "findEventsInRange", params + rangeParams, queries, [&]() {
+    auto begin = std::chrono::steady_clock::now();
+    benchSink += rangeQueries(queries);
+    return secondsSince(begin);
+  }, format("\"average_hits\":%.1f,\"insert_ns_per_event\":%.0f", hits, insertNs));
+  runBenchmark(options, "scanEventsInRange", params + rangeParams, scans, [&]() {
+    auto begin = std::chrono::steady_clock::now();
+    benchSink += rangeScans(scans);
+    return secondsSince(begin);
+  });
+  hits = (double)nearQueries(queries) / queries;
+  runBenchmark(options, "findEventsNear", params + nearParams, queries, [&]() {
+    auto begin = std::chrono::steady_clock::now();
+    benchSink += nearQueries(queries);
+    return secondsSince(begin);
+  }, format("\"average_hits\":%.1f,\"grid_cells\":%zu", hits, (size_t)store.places.cells.size()));
+  runBenchmark(options, "scanEventsNear", params + nearParams, scans, [&]() {
+    auto begin = std::chrono::steady_clock::now();
+    benchSink += nearScans(scans);
+    return secondsSince(begin);
+  });
+  destroyEventStore(&store);
+}
+
+/**
+ * Week-long occurrence listings over one-off and weekly/monthly series:
+ * expanded lazily by findOccurrencesInRange() against slicing a sorted
+ * list of every occurrence of the next four years.
+ */
+void benchmarkRecurrence(const BenchOptions &options) {
+  const int oneOff = (int)std::max<uint64_t>(options.maxEvents / 5, 100), recurring = std::max(oneOff / 10, 10), queries = 200;
+  const int64_t day = 86400, year = 365 * day;
+  EventStore store;
+  initEventStore(&store);
+  uint64_t seed = 99;
+  for (int i = 0; i < oneOff + recurring; i++) {
+    nextRandom(&seed);
+    int64_t begin = (int64_t)((seed >> 20) % (uint64_t)year);
+    Event *created = NULL;
+    if (addEvent(&store, i % 1000, begin, begin + 7200, "event", "city", &created) && i >= oneOff) {
+      RecurrenceRule rule = { (seed >> 50) % 3 ? RECURRENCE_WEEKLY : RECURRENCE_MONTHLY, 1, 0, RECURRENCE_NO_END };
+      setEventRecurrence(&store, created->id, &rule);
+    }
+  }
+  std::string params = format("\"one_off\":%d,\"recurring\":%d", oneOff, recurring);
+
+  std::vector<EventTimeEntry> materialized;
+  auto materialize = [&]() {
+    materialized.clear();
+    for (unsigned int i = 0; i < store.events.size(); i++) {
+      const Event *event = store.events.at(i);
+      const EventRecurrence *recurrence = findEventRecurrence(&store, event->id);
+      for (int64_t n = 0; recurrence || n == 0; n++) {
+        int64_t begin = recurrence ? occurrenceStart(&recurrence->rule, event->startTime, n) : event->startTime;
+        if (begin >= 4 * year) {
+          break;
+        }
+        EventTimeEntry entry = { begin, event->id };
+        materialized.push_back(entry);
+      }
+    }
+    std::sort(materialized.begin(), materialized.end(), [](const EventTimeEntry &a, const EventTimeEntry &b) {
+      return a.startTime < b.startTime || (a.startTime == b.startTime && a.id < b.id);
+    });
+  };
+  materialize();
+  runBenchmark(options, "materializeOccurrences", params, materialized.size(), [&]() {
+    auto start = std::chrono::steady_clock::now();
+    materialize();
+    return secondsSince(start);
+  }, format("\"occurrences\":%zu,\"bytes\":%zu", materialized.size(), materialized.size() * sizeof(EventTimeEntry)));
+
+  std::vector<EventOccurrence> found;
+  auto sliceQueries = [&]() {
+    size_t total = 0;
+    for (int q = 0; q < queries; q++) {
+      int64_t from = year + (int64_t)q * (2 * year / queries);
+      found.clear();
+      auto it = std::lower_bound(materialized.begin(), materialized.end(), from,
+                                 [](const EventTimeEntry &entry, int64_t time) { return entry.startTime < time; });
+      for (; it != materialized.end() && it->startTime < from + 7 * day; ++it) {
+        const Event *event = store.events.find(it->id);
+        EventOccurrence occurrence = { event, it->startTime, it->startTime + (event->endTime - event->startTime) };
+        found.push_back(occurrence);
+      }
+      total += found.size();
+    }
+    return total;
+  };
+  auto lazyQueries = [&]() {
+    size_t total = 0;
+    for (int q = 0; q < queries; q++) {
+      int64_t from = year + (int64_t)q * (2 * year / queries);
+      found.clear();
+      total += findOccurrencesInRange(&store, from, from + 7 * day, &found);
+    }
+    return total;
+  };
+  size_t sliced = sliceQueries(), lazy = lazyQueries();
+  if (sliced != lazy) {
+    fprintf(stderr, "findOccurrencesInRange found %zu occurrences, the materialized list %zu\n", lazy, sliced);
+  }
+  runBenchmark(options, "sliceMaterializedOccurrences", params, queries, [&]() {
+    auto start = std::chrono::steady_clock::now();
+    benchSink += sliceQueries();
+    return secondsSince(start);
+  }, format("\"average_occurrences\":%.1f", (double)sliced / queries));
+  runBenchmark(options, "findOccurrencesInRange", params, queries, [&]() {
+    auto start = std::chrono::steady_clock::now();
+    benchSink += lazyQueries();
+    return secondsSince(start);
+  }, format("\"average_occurrences\":%.1f", (double)lazy / queries));
+  destroyEventStore(&store);
+}
+
+/** Two-term AND and OR keyword queries over short documents with Zipf-distributed words. */
+void benchmarkTextIndex(const BenchOptions &options) {
+  const int documents = (int)std::max<uint64_t>(options.maxEvents, 1000), vocabulary = 5000, queries = 200;
+  std::vector<std::string> words;
+  for (int i = 0; i < vocabulary; i++) {
+    words.push_back(format("w%d", i));
+  }
+  // Word rank r is drawn with probability ~ 1/r.
+  uint64_t seed = 7;
+  auto nextWord = [&]() {
+    double u = (double)(nextRandom(&seed) >> 11) / 9007199254740992.0;
+    int rank = (int)std::pow((double)vocabulary, u) - 1;
+    return rank < 0 ? 0 : rank;
+  };
+
+  TextIndex index;
+  initTextIndex(&index);
+  auto start = std::chrono::steady_clock::now();
+  std::string text;
+  for (int id = 1; id <= documents; id++) {
+    text.clear();
+    for (int w = 0; w < 5; w++) {
+      text += words[nextWord()];
+      text += ' ';
+    }
+    addDocumentToTextIndex(&index, (uint32_t)id, text.c_str());
+  }
+  double buildSeconds = secondsSince(start);
+  std::vector<std::string> queryTexts;
+  for (int q = 0; q < queries; q++) {
+    queryTexts.push_back(words[nextWord()] + " " + words[nextWord()]);
+  }
+
+  std::string params = format("\"documents\":%d,\"vocabulary\":%d", documents, vocabulary);
+  std::vector<uint32_t> results;
+  for (int mode = TEXT_QUERY_ALL; mode <= TEXT_QUERY_ANY; mode++) {
+    auto search = [&]() {
+      size_t total = 0;
+      for (int q = 0; q < queries; q++) {
+        total += searchTextIndex(&index, queryTexts[q].c_str(), mode, &results);
+      }
+      return total;
+    };
+    double hits = (double)search() / queries;
+    runBenchmark(options, mode == TEXT_QUERY_ALL ? "searchTextIndex_all" : "searchTextIndex_any", params, queries, [&]() {
+      auto begin = std::chrono::steady_clock::now();
+      benchSink += search();
+      return secondsSince(begin);
+    }, format("\"average_hits\":%.1f,\"build_seconds\":%.3f,\"index_bytes\":%zu,\"postings\":%zu", hits, buildSeconds,
+              memoryUsageTextIndex(&index), (size_t)index.postingCount));
+  }
+  destroyTextIndex(&index);
+}
+
+/** Attendee list intersections and unions: IdSet against sorted vectors and std::set. */
+void benchmarkAttendeeSets(const BenchOptions &options) {
+  const int attendees = (int)std::max<uint64_t>(options.maxEvents / 20, 100);
+  struct Shape {
+    const char *name;
+    uint32_t users;  // ids are drawn from 1..users
+  } shapes[] = { { "sparse", (uint32_t)attendees * 20 }, { "dense", (uint32_t)attendees * 2 } };
+
+  for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+    IdSet leftSet, rightSet, unionSet;
+    std::set<int> leftTree, rightTree;
+    uint64_t seed = 31 + s;
+    while (leftTree.size() < (size_t)attendees || rightTree.size() < (size_t)attendees) {
+      nextRandom(&seed);
+      int id = 1 + (int)((seed >> 20) % shapes[s].users);
+      if (leftTree.size() < (size_t)attendees && leftTree.insert(id).second) {
+        idSetAdd(&leftSet, (uint32_t)id);
+      }
+      id = 1 + (int)((seed >> 40) % shapes[s].users);
+      if (rightTree.size() < (size_t)attendees && rightTree.insert(id).second) {
+        idSetAdd(&rightSet, (uint32_t)id);
+      }
+    }
+    std::vector<int> leftVector(leftTree.begin(), leftTree.end()), rightVector(rightTree.begin(), rightTree.end());
+    std::vector<int> common;
+    std::string params = format("\"attendees\":%d,\"users\":%u,\"shape\":\"%s\"", attendees, shapes[s].users, shapes[s].name);
+
+    runBenchmark(options, "idSetIntersectionCardinality", params, 1, [&]() {
+      auto start = std::chrono::steady_clock::now();
+      benchSink += idSetIntersectionCardinality(&leftSet, &rightSet);
+      return secondsSince(start);
+    }, format("\"bytes\":%zu", idSetMemoryUsage(&leftSet)));
+    runBenchmark(options, "set_intersection_sorted_vector", params, 1, [&]() {
+      common.clear();
+      auto start = std::chrono::steady_clock::now();
+      std::set_intersection(leftVector.begin(), leftVector.end(), rightVector.begin(), rightVector.end(), std::back_inserter(common));
+      double elapsed = secondsSince(start);
+      benchSink += common.size();
+      return elapsed;
+    }, format("\"bytes\":%zu", leftVector.size() * sizeof(int)));
+    runBenchmark(options, "set_intersection_std_set", params, 1, [&]() {
+      common.clear();
+      auto start = std::chrono::steady_clock::now();
+      std::set_intersection(leftTree.begin(), leftTree.end(), rightTree.begin(), rightTree.end(), std::back_inserter(common));
+      double elapsed = secondsSince(start);
+      benchSink += common.size();
+      return elapsed;
+    }, format("\"bytes\":%zu", leftTree.size() * (sizeof(int) + 4 * sizeof(void *))));  // node estimate
+    runBenchmark(options, "idSetUnion", params, 1, [&]() {
+      auto start = std::chrono::steady_clock::now();
+      idSetUnion(&leftSet, &rightSet, &unionSet);
+      double elapsed = secondsSince(start);
+      benchSink += idSetCardinality(&unionSet);
+      return elapsed;
+    });
+  }
+}
+
+/**
+ * Schedule conflicts: all pairs by brute force against the sweep over the
+ * same small calendar, the sweep over the full one, and single-slot
+ * checks against the interval tree and a linear scan.
+ */
+void benchmarkScheduleConflicts(const BenchOptions &options) {
+  const int sweepCount = (int)std::max<uint64_t>(options.maxEvents, 1000), bruteCount = std::max(sweepCount / 100, 10);
+  const int checks = 100000, scans = 1000;
+  const uint64_t span = (uint64_t)sweepCount * 3600;  // one booking start per hour on average
+  uint64_t seed = 5;
+  std::vector<ScheduleInterval> intervals;
+  for (int i = 1; i <= sweepCount; i++) {
+    nextRandom(&seed);
+    // Bookings of 30 minutes to 3 hours.
+    ScheduleInterval interval;
+    interval.startTime = (int64_t)((seed >> 20) % span);
+    interval.endTime = interval.startTime + 1800 + (int64_t)((seed >> 44) % 9000);
+    interval.id = i;
+    intervals.push_back(interval);
+  }
+  // The small calendar has the same density as the full one.
+  std::vector<ScheduleInterval> small(intervals.begin(), intervals.begin() + bruteCount);
+  for (size_t i = 0; i < small.size(); i++) {
+    small[i].startTime /= sweepCount / bruteCount;
+    small[i].endTime = small[i].startTime + (intervals[i].endTime - intervals[i].startTime);
+  }
+
+  std::string smallParams = format("\"intervals\":%d", bruteCount), params = format("\"intervals\":%d", sweepCount);
+  runBenchmark(options, "allPairsBruteForce", smallParams, (uint64_t)bruteCount * (bruteCount - 1) / 2, [&]() {
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < small.size(); i++) {
+      for (size_t j = i + 1; j < small.size(); j++) {
+        found += small[i].startTime < small[j].endTime && small[j].startTime < small[i].endTime;
+      }
+    }
+    double elapsed = secondsSince(start);
+    benchSink += found;
+    return elapsed;
+  });
+  std::vector<ScheduleConflict> conflicts;
+  const std::vector<ScheduleInterval> *sets[2] = { &small, &intervals };
+  for (int f = 0; f < 2; f++) {
+    std::vector<ScheduleInterval> unsorted;
+    runBenchmark(options, "sweepScheduleConflicts", f ? params : smallParams, sets[f]->size(), [&]() {
+      unsorted = *sets[f];
+      conflicts.clear();
+      auto start = std::chrono::steady_clock::now();
+      benchSink += sweepScheduleConflicts(&unsorted, false, &conflicts);
+      return secondsSince(start);
+    });
+  }
+
+  ScheduleTree tree;
+  initScheduleTree(&tree);
+  for (size_t i = 0; i < intervals.size(); i += 10) {
+    addScheduleInterval(&tree, &intervals[i]);
+  }
+  std::vector<ScheduleInterval> calendar;
+  scheduleIntervals(&tree, &calendar);
+  std::string treeParams = format("\"commitments\":%zu", calendar.size());
+  runBenchmark(options, "hasScheduleOverlap", treeParams, checks, [&]() {
+    size_t busy = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int q = 0; q < checks; q++) {
+      int64_t from = (int64_t)(((uint64_t)q * 2654435761u * 1000) % span);
+      busy += hasScheduleOverlap(&tree, from, from + 3600);
+    }
+    double elapsed = secondsSince(start);
+    benchSink += busy;
+    return elapsed;
+  });
+  runBenchmark(options, "scanScheduleOverlap", treeParams, scans, [&]() {
+    size_t busy = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int q = 0; q < scans; q++) {
+      int64_t from = (int64_t)(((uint64_t)q * 2654435761u * 1000) % span);
+      for (size_t i = 0; i < calendar.size(); i++) {
+        if (calendar[i].startTime < from + 3600 && from < calendar[i].endTime) {
+          busy++;
+          break;
+        }
+      }
+    }
+    double elapsed = secondsSince(start);
+    benchSink += busy;
+    return elapsed;
+  });
+}
+
+/** A scripted session of registrations, logins, event creation, RSVPs and queries through the batch driver. */
+void benchmarkBatchDriver(const BenchOptions &options) {
+  const int userCount = (int)std::max<uint64_t>(options.maxEvents / 500, 4), eventsPerUser = 10;
+  std::string usersFile = std::string(options.directory) + "/bench_batch_users.dat";
+  FILE *script = tmpfile();
+  if (!script) {
+    return;
+  }
+  for (int u = 0; u < userCount; u++) {
+    fprintf(script, "register user%d pass%d\nlogin user%d pass%d\n", u, u, u, u);
+    for (int e = 0; e < eventsPerUser; e++) {
+      int64_t start = 1735689600 + (int64_t)(u * eventsPerUser + e) * 1800;
+      fprintf(script, "create-event %lld %lld \"meetup %d\" \"hall %d\"\n", (long long)start, (long long)(start + 3600), e, u % 50);
+    }
+    fprintf(script, "rsvp %d\nquery %lld %lld\nlogout\n", 1 + u * eventsPerUser, (long long)1735689600 + u * 3600,
+            (long long)1735689600 + u * 3600 + 86400);
+  }
+
+  uint64_t commands = (uint64_t)userCount * (5 + eventsPerUser);
+  runBenchmark(options, "runBatchScript", format("\"users\":%d,\"events_per_user\":%d", userCount, eventsPerUser), commands, [&]() {
+    removeUserFiles(usersFile);
+    UserStore users;
+    BatchSession session;
+    double elapsed = 0;
+    if (openUserStore(&users, usersFile.c_str())) {
+      if (openBatchSession(&session, &users, NULL)) {
+        rewind(script);
+        auto start = std::chrono::steady_clock::now();
+        benchSink += runBatchScript(&session, script);
+        elapsed = secondsSince(start);
+        closeBatchSession(&session);
+      }
+      closeUserStore(&users);
+    }
+    removeUserFiles(usersFile);
+    return elapsed;
+  });
+  fclose(script);
+}
+
+/** Key presses in a long menu: incremental frames against clearing and redrawing every time. */
+void benchmarkMenuRenderer(const BenchOptions &options) {
+  const int itemCount = 1000, rows = 40, columns = 120;
+  const uint64_t keys = std::max<uint64_t>(options.maxEvents / 5, 1000);
+  static char items[itemCount][30];
+  for (int i = 0; i < itemCount; i++) {
+    snprintf(items[i], sizeof(items[i]), "Event number %d", i);
+  }
+
+  std::string frame;
+  std::string params = format("\"items\":%d,\"rows\":%d,\"columns\":%d", itemCount, rows, columns);
+  for (int incremental = 1; incremental >= 0; incremental--) {
+    auto press = [&]() {
+      MenuView view;
+      initMenuView(&view);
+      uint64_t bytes = 0;
+      int selected = 0;
+      for (uint64_t k = 0; k < keys; k++) {
+        selected = k % 997 == 0 ? (selected + 40) % itemCount : (selected + 1) % itemCount;  // arrows, some page jumps
+        if (!incremental) {
+          initMenuView(&view);  // what the old printMenu did: clear and draw everything
+        }
+        renderMenuFrame(items, itemCount, selected, rows, columns, &view, &frame);
+        bytes += frame.size();
+      }
+      return bytes;
+    };
+    double bytesPerKey = (double)press() / keys;
+    runBenchmark(options, incremental ? "renderMenuFrame_incremental" : "renderMenuFrame_full", params, keys, [&]() {
+      auto start = std::chrono::steady_clock::now();
+      benchSink += press();
+      return secondsSince(start);
+    }, format("\"bytes_per_key\":%.1f", bytesPerKey));
+  }
+}
+
+int usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [--quick] [--filter name] [--repetitions n] [--max-users n] [--capacity n]\n"
+          "          [--max-events n] [--dir path] [--output file]\n"
+          "Groups: hash, table, table_layout, table_churn, table_concurrent, persistence, dates,\n"
+          "        events, recurrence, text, attendees, schedule, batch, menu. Results are JSON Lines.\n",
+          program);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  BenchOptions options;
+  const char *filter = NULL;
+  const char *outputFile = NULL;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--quick") == 0) {
+      options.repetitions = 1;
+      options.maxUsers = 1000;
+      options.tableCapacity = 1u << 12;
+      options.maxEvents = 2000;
+    } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+      options.repetitions = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--max-users") == 0 && hasValue) {
+      options.maxUsers = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--capacity") == 0 && hasValue) {
+      options.tableCapacity = (unsigned int)strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--max-events") == 0 && hasValue) {
+      options.maxEvents = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--dir") == 0 && hasValue) {
+      options.directory = argv[++i];
+    } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+      outputFile = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (outputFile && !(options.output = fopen(outputFile, "w"))) {
+    fprintf(stderr, "Cannot open %s\n", outputFile);
+    return 1;
+  }
+
+  fprintf(options.output,
+          "{\"suite\":\"local_event_planner_benchmarks\",\"format_version\":1,\"timestamp\":%lld,"
+          "\"optimized\":%s,\"hot_path_stats\":%s,\"compiler\":\"%s\",\"repetitions\":%d}\n",
+          (long long)time(NULL), BENCH_OPTIMIZED ? "true" : "false", BENCH_HOT_PATH_STATS ? "true" : "false",
+#if defined(__clang__)
+          "clang " __clang_version__,
+#elif defined(__GNUC__)
+          "gcc " __VERSION__,
+#elif defined(_MSC_VER)
+          "msvc",
+#else
+          "unknown",
+#endif
+          options.repetitions);
+
+  struct Group {
+    const char *name;
+    void (*run)(const BenchOptions &);
+  } groups[] = { { "hash", benchmarkHash },
+                 { "table", benchmarkUserTable },
+                 { "table_layout", benchmarkTableLayouts },
+                 { "table_churn", benchmarkTableChurn },
+                 { "table_concurrent", benchmarkConcurrentLookups },
+                 { "persistence", benchmarkPersistence },
+                 { "dates", benchmarkDates },
+                 { "events", benchmarkEventQueries },
+                 { "recurrence", benchmarkRecurrence },
+                 { "text", benchmarkTextIndex },
+                 { "attendees", benchmarkAttendeeSets },
+                 { "schedule", benchmarkScheduleConflicts },
+                 { "batch", benchmarkBatchDriver },
+                 { "menu", benchmarkMenuRenderer } };
+  for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+    if (!filter || strstr(groups[g].name, filter)) {
+      groups[g].run(options);
+    }
+  }
+
+  if (options.output != stdout) {
+    fclose(options.output);
+  }
+  return 0;
+}
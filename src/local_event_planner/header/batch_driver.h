@@ -0,0 +1,50 @@
+#ifndef BATCH_DRIVER_H
+#define BATCH_DRIVER_H
+
+#define BATCH_MAX_LINE 512
+#define BATCH_MAX_TOKENS 8
+#define BATCH_DETAIL_SIZE 64
+#include <stdio.h>
+#include "local_event_planner.h"
+#include "user_store.h"
+
+enum BatchCommand {
+	BATCH_REGISTER = 0,      // register <username> <password>
+	BATCH_LOGIN = 1,         // login <username> <password>
+	BATCH_LOGOUT = 2,        // logout
+	BATCH_CREATE_EVENT = 3,  // create-event <start> <end> <title> [location]
+	BATCH_RSVP = 4,          // rsvp <event id>
+	BATCH_QUERY = 5,         // query <from> <to>
+	BATCH_SEARCH = 6,        // search <words...>
+	BATCH_NEAR = 7,          // near <latitude> <longitude> <km>
+	BATCH_SAVE = 8,          // save <events file>
+	BATCH_LOAD = 9,          // load <events file>
+	BATCH_COMMAND_COUNT = 10
+};
+
+typedef struct BatchCommandStats {
+	uint64_t count;
+	uint64_t failures;
+	double totalMicros;
+	double maxMicros;
+} BatchCommandStats;
+
+typedef struct BatchSession {
+	UserStore* users;            // opened by the caller
+	EventStore events;
+	int userID;                  // logged-in user, 0 if none
+	FILE* trace;                 // one line per command, or NULL
+	BatchCommandStats stats[BATCH_COMMAND_COUNT];
+	uint64_t unknownCommands;
+	uint64_t lineNumber;
+	double elapsedMicros;        // wall time of runBatchScript(), parsing included
+} BatchSession;
+
+int openBatchSession(BatchSession* session, UserStore* users, FILE* trace);
+void closeBatchSession(BatchSession* session);
+const char* batchCommandName(int command);
+int runBatchCommand(BatchSession* session, const char* line);
+uint64_t runBatchScript(BatchSession* session, FILE* input);
+void printBatchReport(const BatchSession* session, FILE* output);
+
+#endif // BATCH_DRIVER_H
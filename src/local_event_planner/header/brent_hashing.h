@@ -1,15 +1,17 @@
-
+﻿
 
 #ifndef BRENT_HASHING_H
 #define BRENT_HASHING_H
 
-#define TABLE_SIZE 100
-#include <string.h>
+#define BRENT_USERS_PER_CHUNK_SHIFT BRENT_RECORDS_PER_CHUNK_SHIFT
+#define BRENT_USERS_PER_CHUNK BRENT_RECORDS_PER_CHUNK
+#include <atomic>
 #include "commonTypes.h"
+#include "brent_table.h"
 
 
-extern int currentID;
-extern bool forceFailure;
+extern std::atomic<int> currentID;
+extern std::atomic<bool> forceFailure;
 
 typedef struct User {
 	int id;
@@ -17,13 +19,40 @@ typedef struct User {
 	char password[50];
 } User;
 
-typedef struct HashTable {
-	User* table[TABLE_SIZE];
-} HashTable;
-
-static unsigned int hash(const char* key);
+/**
+ *  @name   BrentKeyOf<BrentKeyView, User>
+ *
+ *  @brief  A User is keyed by its null-terminated username field.
+ */
+template <>
+struct BrentKeyOf<BrentKeyView, User> {
+	static BrentKeyView get(const User& user)
+	{
+		return BrentKeyView(user.username);
+	}
+};
+
+typedef BrentTable<BrentKeyView, User> UserBrentTable;
+typedef BrentTableData<User> HashTable;
+
+int allocateUserID();
+void advanceUserID(int usedID);
+uint64_t hashUsernameSeeded(const char* key, uint64_t seed);
+uint64_t hashUsername(const char* key);
+int placeRecordBrent(BrentSlot* table, unsigned int capacity, uint32_t record, uint64_t hashValue);
 int initBrentHashTable(HashTable* ht);
+int initBrentHashTableWithCapacity(HashTable* ht, unsigned int capacity, float maxLoadFactor);
+int resizeBrentHashTable(HashTable* ht, unsigned int newCapacity);
+void clearBrentHashTable(HashTable* ht);
+void destroyBrentHashTable(HashTable* ht);
 int insertUserBrent(HashTable* ht, int id, const char* username, const char* password);
+int reserveBrentHashTable(HashTable* ht, unsigned int expectedUsers);
+unsigned int insertUsersBulkBrent(HashTable* ht, const User* users, unsigned int count, unsigned int* consumed = NULL);
 int findUserBrent(HashTable* ht, const char* username, User** result);
+int deleteUserBrent(HashTable* ht, const char* username);
+int updateUserBrent(HashTable* ht, const char* username, const char* newPassword);
+User* getUserAtBrent(const HashTable* ht, unsigned int index);
+double averageProbeLengthBrent(const HashTable* ht);
+size_t memoryUsageBrent(const HashTable* ht);
 
-#endif //BRENT_HASHING_H
\ No newline at end of file
+#endif //BRENT_HASHING_H
@@ -0,0 +1,1040 @@
+#ifndef BRENT_TABLE_H
+#define BRENT_TABLE_H
+
+#define BRENT_INITIAL_CAPACITY 128
+#define BRENT_DEFAULT_MAX_LOAD 0.9f
+#define BRENT_RECORDS_PER_CHUNK_SHIFT 10
+#define BRENT_RECORDS_PER_CHUNK (1u << BRENT_RECORDS_PER_CHUNK_SHIFT)
+#define BRENT_BULK_BATCH 256
+#define BRENT_TOMBSTONE 0xFFFFFFFFu
+#define BRENT_TOMBSTONE_CLEANUP_SHIFT 3 // rebuild once tombstones exceed capacity >> 3
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+typedef struct BrentSlot {
+	uint32_t fingerprint;
+	uint32_t record; // 1-based index into the record slab; 0 marks an empty slot, BRENT_TOMBSTONE a deleted one
+} BrentSlot;
+
+/**
+ *  @name   BrentTableData
+ *
+ *  @brief  Plain state of a Brent table: slot array plus chunked record slab.
+ *
+ *  @details
+ *  Kept as a C-compatible struct so C-style APIs (HashTable) can own the
+ *  state while BrentTable supplies the algorithms.
+ */
+template <typename Value>
+struct BrentTableData {
+	BrentSlot* table;
+	unsigned int capacity;
+	unsigned int count;
+	float maxLoadFactor;
+	Value** chunks;
+	unsigned int chunkCount;
+	unsigned int tombstones;
+};
+
+/**
+ *  @name   brentHomeIndex
+ *
+ *  @brief  Maps a key hash to its home slot.
+ *
+ *  @param  [in] hashValue [\b uint64_t]      Hash of the key.
+ *  @param  [in] mask      [\b unsigned int]  Table mask (capacity - 1).
+ *
+ *  @retval [\b unsigned int] Slot index in [0, capacity).
+ */
+static inline unsigned int brentHomeIndex(uint64_t hashValue, unsigned int mask)
+{
+	return (unsigned int)hashValue & mask;
+}
+
+/**
+ *  @name   brentFingerprint
+ *
+ *  @brief  Extracts the slot fingerprint from a key hash.
+ *
+ *  @param  [in] hashValue [\b uint64_t]  Hash of the key.
+ *
+ *  @retval [\b uint32_t] High 32 bits of @p hashValue.
+ *
+ *  @details
+ *  Uses the bits that brentHomeIndex() ignores, so keys sharing a probe
+ *  chain still differ in their fingerprints with probability 1 - 2^-32.
+ */
+static inline uint32_t brentFingerprint(uint64_t hashValue)
+{
+	return (uint32_t)(hashValue >> 32);
+}
+
+/**
+ *  @name   brentProbeStep
+ *
+ *  @brief  Derives the double-hashing step size from a slot fingerprint.
+ *
+ *  @param  [in] fingerprint [\b uint32_t]      Fingerprint of the key.
+ *  @param  [in] mask        [\b unsigned int]  Table mask (capacity - 1).
+ *
+ *  @retval [\b unsigned int] Odd step in [1, capacity).
+ *
+ *  @details
+ *  The fingerprint is independent of the home slot bits, and because it is
+ *  stored in the slot, an occupant's step is known without reading its
+ *  record. Forcing the step odd makes it coprime with the power-of-two
+ *  capacity, so every probe sequence visits all slots before repeating.
+ */
+static inline unsigned int brentProbeStep(uint32_t fingerprint, unsigned int mask)
+{
+	return (fingerprint & mask) | 1u;
+}
+
+/**
+ *  @name   brentSlotIsFree
+ *
+ *  @brief  Whether a slot can receive a new record.
+ *
+ *  @param  [in] slot [\b const BrentSlot*]  Slot to test.
+ *
+ *  @retval [\b bool] true for empty slots and tombstones.
+ *
+ *  @details
+ *  Lookups stop only at empty slots and walk over tombstones, so a
+ *  deleted slot keeps later keys of the chain reachable until an insert
+ *  reuses it or the table is rebuilt.
+ */
+static inline bool brentSlotIsFree(const BrentSlot* slot)
+{
+	return slot->record == 0 || slot->record == BRENT_TOMBSTONE;
+}
+
+/**
+ *  @name   brentRoundUpPowerOfTwo
+ *
+ *  @brief  Rounds a requested capacity up to the next power of two.
+ *
+ *  @param  [in] value [\b unsigned int]  Requested capacity.
+ *
+ *  @retval [\b unsigned int] Smallest power of two >= @p value (minimum 1),
+ *          or 0 if the result would overflow.
+ */
+static inline unsigned int brentRoundUpPowerOfTwo(unsigned int value)
+{
+	unsigned int capacity = 1;
+	while (capacity < value)
+	{
+		if (capacity > (UINT_MAX >> 1))
+		{
+			return 0;
+		}
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+/**
+ *  @name   brentPlaceRecord
+ *
+ *  @brief  Places a record index using Brent's reorganization.
+ *
+ *  @param  [in,out] table      [\b BrentSlot*]     Slot array to place into.
+ *  @param  [in]     capacity   [\b unsigned int]   Slot count (power of two).
+ *  @param  [in]     record     [\b uint32_t]       1-based slab index of the record to place.
+ *  @param  [in]     hashValue  [\b uint64_t]       Hash of the record's key.
+ *  @param  [in,out] tombstones [\b unsigned int*]  If non-NULL, decremented when a tombstone is reused.
+ *
+ *  @retval [\b int] 1 on success; 0 if every slot is occupied.
+ *
+ *  @details
+ *  Walks the new key's double-hashing sequence until the first free slot
+ *  (empty or tombstone), which would cost @c s+1 probes to find later.
+ *  Then, in order of increasing total cost @c i+k, looks for an occupant
+ *  at position @c i of the new key's sequence that can move @c k steps
+ *  further along its own sequence into a free slot. If such a move is
+ *  cheaper than @c s, the occupant moves and the new key takes its slot;
+ *  otherwise the new key goes into the free slot. Every record stays on
+ *  its own probe sequence, so lookups need no knowledge of the relocation.
+ *  Occupant steps come from the stored fingerprints, so no record is read.
+ *
+ *  @complexity O(s^2) probes, where s is the insertion chain length.
+ */
+static inline int brentPlaceRecord(BrentSlot* table, unsigned int capacity, uint32_t record, uint64_t hashValue, unsigned int* tombstones)
+{
+	unsigned int mask = capacity - 1;
+	unsigned int index = brentHomeIndex(hashValue, mask);
+	uint32_t fingerprint = brentFingerprint(hashValue);
+	unsigned int step = brentProbeStep(fingerprint, mask);
+
+	unsigned int s = 0;
+	unsigned int emptyIndex = index;
+	while (!brentSlotIsFree(&table[emptyIndex]))
+	{
+		if (++s >= capacity)
+		{
+			return 0;
+		}
+		emptyIndex = (emptyIndex + step) & mask;
+	}
+
+	for (unsigned int total = 1; total < s; total++)
+	{
+		unsigned int chainIndex = index;
+		for (unsigned int i = 0; i < total; i++)
+		{
+			unsigned int occupantStep = brentProbeStep(table[chainIndex].fingerprint, mask);
+			unsigned int target = (chainIndex + (total - i) * occupantStep) & mask;
+
+			if (brentSlotIsFree(&table[target]))
+			{
+				if (tombstones && table[target].record == BRENT_TOMBSTONE)
+				{
+					(*tombstones)--;
+				}
+				table[target] = table[chainIndex];
+				table[chainIndex].record = record;
+				table[chainIndex].fingerprint = fingerprint;
+				return 1;
+			}
+			chainIndex = (chainIndex + step) & mask;
+		}
+	}
+
+	if (tombstones && table[emptyIndex].record == BRENT_TOMBSTONE)
+	{
+		(*tombstones)--;
+	}
+	table[emptyIndex].record = record;
+	table[emptyIndex].fingerprint = fingerprint;
+	return 1;
+}
+
+/**
+ *  @name   brentProbeLength
+ *
+ *  @brief  Counts the probes a successful lookup of a record needs.
+ *
+ *  @param  [in] table     [\b const BrentSlot*]  Slot array to inspect.
+ *  @param  [in] capacity  [\b unsigned int]      Slot count (power of two).
+ *  @param  [in] record    [\b uint32_t]          1-based slab index stored in @p table.
+ *  @param  [in] hashValue [\b uint64_t]          Hash of the record's key.
+ *
+ *  @retval [\b unsigned int] Number of slots visited, or 0 if not reachable.
+ */
+static inline unsigned int brentProbeLength(const BrentSlot* table, unsigned int capacity, uint32_t record, uint64_t hashValue)
+{
+	unsigned int mask = capacity - 1;
+	unsigned int index = brentHomeIndex(hashValue, mask);
+	unsigned int step = brentProbeStep(brentFingerprint(hashValue), mask);
+
+	for (unsigned int probes = 1; probes <= capacity; probes++)
+	{
+		if (table[index].record == record)
+		{
+			return probes;
+		}
+		if (table[index].record == 0)
+		{
+			return 0;
+		}
+		index = (index + step) & mask;
+	}
+	return 0;
+}
+
+/**
+ *  @name   brentMix64
+ *
+ *  @brief  MurmurHash3 fmix64 finalizer.
+ *
+ *  @param  [in] hash [\b uint64_t]  Value to avalanche.
+ *
+ *  @retval [\b uint64_t] Bijective mix of @p hash.
+ */
+static inline uint64_t brentMix64(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/**
+ *  @name   brentHashBytes
+ *
+ *  @brief  Seeded 64-bit FNV-1a over a byte range, finished with brentMix64().
+ *
+ *  @param  [in] data [\b const void*]  Bytes to hash.
+ *  @param  [in] size [\b size_t]       Number of bytes.
+ *  @param  [in] seed [\b uint64_t]     Value folded into the FNV offset basis.
+ *
+ *  @retval [\b uint64_t] Unreduced hash; equals brentHashCString() for the same characters.
+ */
+static inline uint64_t brentHashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = 0xcbf29ce484222325ull ^ seed;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return brentMix64(hash);
+}
+
+/**
+ *  @name   brentHashCString
+ *
+ *  @brief  brentHashBytes() over a null-terminated string in a single pass.
+ *
+ *  @param  [in] key  [\b const char*]  Null-terminated key.
+ *  @param  [in] seed [\b uint64_t]     Value folded into the FNV offset basis.
+ *
+ *  @retval [\b uint64_t] Unreduced hash.
+ */
+static inline uint64_t brentHashCString(const char* key, uint64_t seed)
+{
+	uint64_t hash = 0xcbf29ce484222325ull ^ seed;
+	while (*key)
+	{
+		hash ^= (unsigned char)*key++;
+		hash *= 0x100000001b3ull;
+	}
+	return brentMix64(hash);
+}
+
+/**
+ *  @name   BrentKeyView
+ *
+ *  @brief  Non-owning (pointer, length) string key.
+ *
+ *  @details
+ *  The project builds as C++11, so this stands in for std::string_view:
+ *  C strings, std::string and (under C++17) std::string_view convert to it
+ *  implicitly without allocating.
+ */
+struct BrentKeyView {
+	const char* data;
+	size_t size;
+
+	BrentKeyView() : data(""), size(0) {}
+	BrentKeyView(const char* text) : data(text), size(strlen(text)) {}
+	BrentKeyView(const char* text, size_t length) : data(text), size(length) {}
+	BrentKeyView(const std::string& text) : data(text.data()), size(text.size()) {}
+#if __cplusplus >= 201703L
+	BrentKeyView(std::string_view text) : data(text.data()), size(text.size()) {}
+#endif
+};
+
+/**
+ *  @name   BrentStringHash / BrentStringEqual
+ *
+ *  @brief  Transparent hash and equality for every string-like key.
+ *
+ *  @details
+ *  Both operate on BrentKeyView, so a table keyed by std::string can be
+ *  probed with a C string or a view without building a temporary string.
+ */
+struct BrentStringHash {
+	typedef void is_transparent;
+	uint64_t operator()(BrentKeyView key) const
+	{
+		return brentHashBytes(key.data, key.size, 0);
+	}
+};
+
+struct BrentStringEqual {
+	typedef void is_transparent;
+	bool operator()(BrentKeyView left, BrentKeyView right) const
+	{
+		return left.size == right.size && memcmp(left.data, right.data, left.size) == 0;
+	}
+};
+
+/**
+ *  @name   BrentHash
+ *
+ *  @brief  Default 64-bit hash policy of BrentTable.
+ *
+ *  @details
+ *  Specialized at compile time by key shape: integral and enum keys are
+ *  mixed directly with brentMix64() (no byte loop), std::array keys of
+ *  trivially copyable elements hash a length known at compile time, and
+ *  string-like keys use the transparent BrentStringHash. Other key types
+ *  must supply their own policy.
+ */
+template <typename Key, typename Enable = void>
+struct BrentHash;
+
+template <typename Key>
+struct BrentHash<Key, typename std::enable_if<std::is_integral<Key>::value || std::is_enum<Key>::value>::type> {
+	uint64_t operator()(Key key) const
+	{
+		return brentMix64((uint64_t)key ^ 0xcbf29ce484222325ull);
+	}
+};
+
+template <typename T, size_t N>
+struct BrentHash<std::array<T, N>, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+	uint64_t operator()(const std::array<T, N>& key) const
+	{
+		return brentHashBytes(key.data(), N * sizeof(T), 0);
+	}
+};
+
+template <>
+struct BrentHash<std::string> : BrentStringHash {};
+
+template <>
+struct BrentHash<BrentKeyView> : BrentStringHash {};
+
+template <>
+struct BrentHash<const char*> : BrentStringHash {};
+
+/**
+ *  @name   BrentKeyEqual
+ *
+ *  @brief  Default key equality policy of BrentTable (operator== unless string-like).
+ */
+template <typename Key, typename Enable = void>
+struct BrentKeyEqual {
+	bool operator()(const Key& left, const Key& right) const
+	{
+		return left == right;
+	}
+};
+
+template <>
+struct BrentKeyEqual<std::string> : BrentStringEqual {};
+
+template <>
+struct BrentKeyEqual<BrentKeyView> : BrentStringEqual {};
+
+template <>
+struct BrentKeyEqual<const char*> : BrentStringEqual {};
+
+/**
+ *  @name   BrentKeyOf
+ *
+ *  @brief  Extracts the key from a stored value.
+ *
+ *  @details
+ *  The default reads @c value.first, so std::pair<Key, T> works as a map
+ *  entry. Record types that embed their key (User) specialize it.
+ */
+template <typename Key, typename Value>
+struct BrentKeyOf {
+	static const Key& get(const Value& value)
+	{
+		return value.first;
+	}
+};
+
+template <typename>
+struct BrentVoid {
+	typedef void type;
+};
+
+template <typename Policy, typename Enable = void>
+struct BrentIsTransparent : std::false_type {};
+
+template <typename Policy>
+struct BrentIsTransparent<Policy, typename BrentVoid<typename Policy::is_transparent>::type> : std::true_type {};
+
+/**
+ *  @name   BrentTable
+ *
+ *  @brief  Open-addressing table using Brent's method with double hashing.
+ *
+ *  @tparam Key       Key type; extracted from values with BrentKeyOf<Key, Value>.
+ *  @tparam Value     Stored record type.
+ *  @tparam Hash      64-bit hash policy; low bits pick the home slot, high bits the fingerprint.
+ *  @tparam KeyEq     Key equality policy.
+ *  @tparam Allocator Allocator for records; rebound for slots and the chunk directory.
+ *
+ *  @details
+ *  Slots hold a 32-bit fingerprint and a 1-based record number; records
+ *  live in fixed chunks of BRENT_RECORDS_PER_CHUNK values that never move,
+ *  so pointers stay valid across rehashes. Lookups compare fingerprints
+ *  before calling @p KeyEq. When both policies declare @c is_transparent,
+ *  find()/erase() accept any key type they can take (e.g. a C string or
+ *  BrentKeyView on a std::string table) without converting to @p Key.
+ *
+ *  A default-constructed table owns its state and must be init()ed. A
+ *  table built over an external BrentTableData only borrows it, which is
+ *  how the C-style HashTable functions reuse this engine.
+ *
+ *  @warning Not thread-safe.
+ */
+template <typename Key, typename Value,
+	typename Hash = BrentHash<Key>,
+	typename KeyEq = BrentKeyEqual<Key>,
+	typename Allocator = std::allocator<Value> >
+class BrentTable {
+public:
+	typedef BrentTableData<Value> Data;
+
+	BrentTable() : data_(&own_), owner_(true)
+	{
+		reset();
+		data_->maxLoadFactor = BRENT_DEFAULT_MAX_LOAD;
+	}
+
+	explicit BrentTable(Data* external) : data_(external), owner_(false) {}
+
+	~BrentTable()
+	{
+		if (owner_)
+		{
+			destroy();
+		}
+	}
+
+	/**
+	 *  @brief  Allocates a zeroed slot array of at least @p capacity slots.
+	 *
+	 *  @retval [\b bool] false on an invalid load factor (state untouched) or allocation failure.
+	 */
+	bool init(unsigned int capacity = BRENT_INITIAL_CAPACITY, float maxLoadFactor = BRENT_DEFAULT_MAX_LOAD)
+	{
+		if (maxLoadFactor <= 0.0f || maxLoadFactor > 1.0f)
+		{
+			return false;
+		}
+		if (owner_ && data_->table)
+		{
+			destroy();
+		}
+
+		reset();
+		data_->maxLoadFactor = maxLoadFactor;
+
+		unsigned int roundedCapacity = brentRoundUpPowerOfTwo(capacity);
+		BrentSlot* table = roundedCapacity != 0 ? allocateSlots(roundedCapacity) : NULL;
+		if (!table)
+		{
+			return false;
+		}
+		data_->table = table;
+		data_->capacity = roundedCapacity;
+		return true;
+	}
+
+	/**
+	 *  @brief  Destroys every record and frees slots, chunks and directory.
+	 */
+	void destroy()
+	{
+		destroyRecords();
+		for (unsigned int i = 0; i < data_->chunkCount; i++)
+		{
+			valueAlloc().deallocate(data_->chunks[i], BRENT_RECORDS_PER_CHUNK);
+		}
+		if (data_->chunks)
+		{
+			chunkAlloc().deallocate(data_->chunks, data_->chunkCount);
+		}
+		if (data_->table)
+		{
+			SlotAllocator(alloc_).deallocate(data_->table, data_->capacity);
+		}
+
+		float maxLoadFactor = data_->maxLoadFactor;
+		reset();
+		data_->maxLoadFactor = maxLoadFactor;
+	}
+
+	/**
+	 *  @brief  Removes every record while keeping slots and chunks allocated.
+	 */
+	void clear()
+	{
+		if (!data_->table)
+		{
+			return;
+		}
+		destroyRecords();
+		memset(data_->table, 0, data_->capacity * sizeof(BrentSlot));
+		data_->count = 0;
+		data_->tombstones = 0;
+	}
+
+	/**
+	 *  @brief  Rebuilds the slot array at @p newCapacity (rounded up); drops tombstones.
+	 *
+	 *  @retval [\b bool] false if the records do not fit or allocation fails; the table is unchanged then.
+	 */
+	bool rehash(unsigned int newCapacity)
+	{
+		unsigned int roundedCapacity = brentRoundUpPowerOfTwo(newCapacity);
+		if (roundedCapacity == 0 || roundedCapacity < data_->count)
+		{
+			return false;
+		}
+
+		BrentSlot* newTable = allocateSlots(roundedCapacity);
+		if (!newTable)
+		{
+			return false;
+		}
+
+		for (uint32_t record = 1; record <= data_->count; record++)
+		{
+			uint64_t hashValue = hasher_(BrentKeyOf<Key, Value>::get(*recordAt(record)));
+			if (!brentPlaceRecord(newTable, roundedCapacity, record, hashValue, NULL))
+			{
+				SlotAllocator(alloc_).deallocate(newTable, roundedCapacity);
+				return false;
+			}
+		}
+
+		if (data_->table)
+		{
+			SlotAllocator(alloc_).deallocate(data_->table, data_->capacity);
+		}
+		data_->table = newTable;
+		data_->capacity = roundedCapacity;
+		data_->tombstones = 0;
+		return true;
+	}
+
+	/**
+	 *  @brief  Grows once so @p expected records fit under the load factor.
+	 */
+	bool reserve(unsigned int expected)
+	{
+		double needed = (double)expected / data_->maxLoadFactor + 1.0;
+		if (needed <= (double)data_->capacity)
+		{
+			return true;
+		}
+		if (needed > (double)(UINT_MAX >> 1) + 1.0)
+		{
+			return false;
+		}
+		return rehash((unsigned int)needed);
+	}
+
+	template <typename K>
+	uint64_t hashOf(const K& key) const
+	{
+		const typename LookupKey<K>::type& probe = key;
+		return hasher_(probe);
+	}
+
+	/**
+	 *  @brief  Appends @p value and places it; duplicates are not checked.
+	 *
+	 *  @retval [\b Value*] The stored record, or NULL if the table cannot grow.
+	 */
+	Value* insert(const Value& value)
+	{
+		return insertWithHash(value, hasher_(BrentKeyOf<Key, Value>::get(value)));
+	}
+
+	Value* insertWithHash(const Value& value, uint64_t hashValue)
+	{
+		if (!ensureRoomForInsert())
+		{
+			return NULL;
+		}
+
+		uint32_t record = data_->count + 1;
+		Value* slot = recordAt(record);
+		std::allocator_traits<Allocator>::construct(alloc_, slot, value);
+
+		if (!brentPlaceRecord(data_->table, data_->capacity, record, hashValue, &data_->tombstones))
+		{
+			std::allocator_traits<Allocator>::destroy(alloc_, slot);
+			return NULL;
+		}
+		data_->count++;
+		return slot;
+	}
+
+	/**
+	 *  @brief  Inserts a block of values, skipping keys already present (first one wins).
+	 *
+	 *  @param  [out] consumed [\b unsigned int*]  If non-NULL, receives how many input values
+	 *                                             were processed; less than @p count on failure.
+	 *
+	 *  @details
+	 *  Hashes BRENT_BULK_BATCH keys (prefetching their home slots) before
+	 *  placing any of them, so hashing stays in a tight loop and the slot
+	 *  cache misses overlap.
+	 */
+	unsigned int insertBulk(const Value* values, unsigned int count, unsigned int* consumed = NULL)
+	{
+		uint64_t hashes[BRENT_BULK_BATCH];
+		unsigned int inserted = 0;
+		unsigned int base = 0;
+
+		for (; base < count; base += BRENT_BULK_BATCH)
+		{
+			unsigned int batchSize = count - base < BRENT_BULK_BATCH ? count - base : BRENT_BULK_BATCH;
+			unsigned int mask = data_->capacity - 1;
+
+			for (unsigned int i = 0; i < batchSize; i++)
+			{
+				hashes[i] = hasher_(BrentKeyOf<Key, Value>::get(values[base + i]));
+#if defined(__GNUC__)
+				__builtin_prefetch(&data_->table[brentHomeIndex(hashes[i], mask)]);
+#endif
+			}
+
+			for (unsigned int i = 0; i < batchSize; i++)
+			{
+				const Value& value = values[base + i];
+				if (lookup(BrentKeyOf<Key, Value>::get(value), hashes[i]) != 0)
+				{
+					continue;
+				}
+				if (!insertWithHash(value, hashes[i]))
+				{
+					if (consumed)
+					{
+						*consumed = base + i;
+					}
+					return inserted;
+				}
+				inserted++;
+			}
+		}
+
+		if (consumed)
+		{
+			*consumed = count;
+		}
+		return inserted;
+	}
+
+	/**
+	 *  @brief  Looks up a key; heterogeneous when Hash and KeyEq are transparent.
+	 *
+	 *  @retval [\b Value*] The record, or NULL if absent.
+	 */
+	template <typename K>
+	Value* find(const K& key) const
+	{
+		const typename LookupKey<K>::type& probe = key;
+		return findWithHash(probe, hasher_(probe));
+	}
+
+	/**
+	 *  @brief  find() with a precomputed hash.
+	 *
+	 *  @param  [out] probes  If non-NULL, receives the slots visited (the
+	 *                        ending empty slot included for a miss).
+	 */
+	template <typename K>
+	Value* findWithHash(const K& key, uint64_t hashValue, unsigned int* probes = NULL) const
+	{
+		const typename LookupKey<K>::type& probe = key;
+		uint32_t record = lookup(probe, hashValue, probes);
+		return record != 0 ? recordAt(record) : NULL;
+	}
+
+	/**
+	 *  @brief  Removes a key, leaving a tombstone in its slot.
+	 *
+	 *  @details
+	 *  Backward-shift deletion only works for linear probing; with per-key
+	 *  double-hashing steps a later key's chain may pass through the slot.
+	 *  The slab stays dense: the last record moves into the freed record and
+	 *  its slot is repointed. Once tombstones exceed
+	 *  capacity >> BRENT_TOMBSTONE_CLEANUP_SHIFT the slot array is rebuilt.
+	 *
+	 *  @warning Invalidates pointers to the erased and to the last record.
+	 */
+	template <typename K>
+	bool erase(const K& key)
+	{
+		if (!data_->table)
+		{
+			return false;
+		}
+
+		const typename LookupKey<K>::type& probe = key;
+		unsigned int slot = slotOf(probe, hasher_(probe));
+		if (slot >= data_->capacity)
+		{
+			return false;
+		}
+
+		uint32_t record = data_->table[slot].record;
+		data_->table[slot].record = BRENT_TOMBSTONE;
+		data_->table[slot].fingerprint = 0;
+		data_->tombstones++;
+
+		uint32_t last = data_->count;
+		Value* lastValue = recordAt(last);
+		if (record != last)
+		{
+			// Find the last record's slot by record number, which is exact even if another record has the same key
+			uint64_t movedHash = hasher_(BrentKeyOf<Key, Value>::get(*lastValue));
+			unsigned int mask = data_->capacity - 1;
+			unsigned int movedSlot = brentHomeIndex(movedHash, mask);
+			unsigned int step = brentProbeStep(brentFingerprint(movedHash), mask);
+			while (data_->table[movedSlot].record != last)
+			{
+				movedSlot = (movedSlot + step) & mask;
+			}
+			*recordAt(record) = std::move(*lastValue);
+			data_->table[movedSlot].record = record;
+		}
+		std::allocator_traits<Allocator>::destroy(alloc_, lastValue);
+		data_->count--;
+
+		if (data_->tombstones > (data_->capacity >> BRENT_TOMBSTONE_CLEANUP_SHIFT))
+		{
+			rehash(data_->capacity);
+		}
+		return true;
+	}
+
+	/**
+	 *  @brief  Record at a 0-based position in insertion order, or NULL.
+	 */
+	Value* at(unsigned int index) const
+	{
+		return index < data_->count ? recordAt(index + 1) : NULL;
+	}
+
+	unsigned int size() const
+	{
+		return data_->count;
+	}
+
+	unsigned int capacity() const
+	{
+		return data_->capacity;
+	}
+
+	Data* data() const
+	{
+		return data_;
+	}
+
+	/**
+	 *  @brief  Mean probe count of a successful lookup over all records (diagnostic).
+	 */
+	double averageProbeLength() const
+	{
+		if (!data_->table || data_->count == 0)
+		{
+			return 0.0;
+		}
+
+		unsigned long long totalProbes = 0;
+		for (uint32_t record = 1; record <= data_->count; record++)
+		{
+			uint64_t hashValue = hasher_(BrentKeyOf<Key, Value>::get(*recordAt(record)));
+			totalProbes += brentProbeLength(data_->table, data_->capacity, record, hashValue);
+		}
+		return (double)totalProbes / (double)data_->count;
+	}
+
+	/**
+	 *  @brief  Heap bytes owned: slot array + slab chunks + chunk directory.
+	 */
+	size_t memoryUsage() const
+	{
+		return (size_t)data_->capacity * sizeof(BrentSlot)
+			+ (size_t)data_->chunkCount * BRENT_RECORDS_PER_CHUNK * sizeof(Value)
+			+ (size_t)data_->chunkCount * sizeof(Value*);
+	}
+
+private:
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<BrentSlot> SlotAllocator;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Value*> ChunkAllocator;
+
+	// Transparent policies probe with K itself; otherwise K is converted to Key once per call.
+	template <typename K>
+	struct LookupKey {
+		typedef typename std::conditional<BrentIsTransparent<Hash>::value && BrentIsTransparent<KeyEq>::value,
+			typename std::decay<const K>::type, Key>::type type;
+	};
+
+	BrentTable(const BrentTable&);
+	BrentTable& operator=(const BrentTable&);
+
+	void reset()
+	{
+		data_->table = NULL;
+		data_->capacity = 0;
+		data_->count = 0;
+		data_->chunks = NULL;
+		data_->chunkCount = 0;
+		data_->tombstones = 0;
+	}
+
+	Allocator& valueAlloc()
+	{
+		return alloc_;
+	}
+
+	ChunkAllocator chunkAlloc() const
+	{
+		return ChunkAllocator(alloc_);
+	}
+
+	BrentSlot* allocateSlots(unsigned int capacity)
+	{
+		try
+		{
+			BrentSlot* table = SlotAllocator(alloc_).allocate(capacity);
+			memset(table, 0, capacity * sizeof(BrentSlot));
+			return table;
+		}
+		catch (...)
+		{
+			return NULL;
+		}
+	}
+
+	Value* recordAt(uint32_t record) const
+	{
+		uint32_t index = record - 1;
+		return &data_->chunks[index >> BRENT_RECORDS_PER_CHUNK_SHIFT][index & (BRENT_RECORDS_PER_CHUNK - 1)];
+	}
+
+	void destroyRecords()
+	{
+		for (uint32_t record = 1; record <= data_->count; record++)
+		{
+			std::allocator_traits<Allocator>::destroy(alloc_, recordAt(record));
+		}
+	}
+
+	// Makes sure the slab has room for record number count + 1; a new chunk is allocated only when the last one is full.
+	bool reserveRecord()
+	{
+		unsigned int chunkIndex = data_->count >> BRENT_RECORDS_PER_CHUNK_SHIFT;
+		if (chunkIndex < data_->chunkCount)
+		{
+			return true;
+		}
+
+		Value* chunk = NULL;
+		Value** chunks = NULL;
+		try
+		{
+			chunk = valueAlloc().allocate(BRENT_RECORDS_PER_CHUNK);
+			chunks = chunkAlloc().allocate(chunkIndex + 1);
+		}
+		catch (...)
+		{
+			if (chunk)
+			{
+				valueAlloc().deallocate(chunk, BRENT_RECORDS_PER_CHUNK);
+			}
+			return false;
+		}
+
+		for (unsigned int i = 0; i < data_->chunkCount; i++)
+		{
+			chunks[i] = data_->chunks[i];
+		}
+		if (data_->chunks)
+		{
+			chunkAlloc().deallocate(data_->chunks, data_->chunkCount);
+		}
+		chunks[chunkIndex] = chunk;
+		data_->chunks = chunks;
+		data_->chunkCount = chunkIndex + 1;
+		return true;
+	}
+
+	// Tombstones count towards the load; mostly-tombstone tables are rebuilt in place instead of doubled.
+	bool ensureRoomForInsert()
+	{
+		if ((double)(data_->count + data_->tombstones + 1) > (double)data_->capacity * data_->maxLoadFactor)
+		{
+			unsigned int newCapacity = data_->tombstones >= data_->count ? data_->capacity : data_->capacity << 1;
+			if (newCapacity == 0 || !rehash(newCapacity))
+			{
+				if (data_->count >= data_->capacity)
+				{
+					return false;
+				}
+			}
+		}
+		return reserveRecord();
+	}
+
+	// Walks the key's probe sequence to an empty slot; fingerprints filter candidates before KeyEq runs.
+	// The probe count is only stored on return, so callers passing NULL pay nothing for it.
+	template <typename K>
+	unsigned int slotOf(const K& key, uint64_t hashValue, unsigned int* probes = NULL) const
+	{
+		unsigned int mask = data_->capacity - 1;
+		uint32_t fingerprint = brentFingerprint(hashValue);
+		unsigned int probeIndex = brentHomeIndex(hashValue, mask);
+		unsigned int step = brentProbeStep(fingerprint, mask);
+
+		for (unsigned int i = 0; i < data_->capacity; i++)
+		{
+			const BrentSlot* slot = &data_->table[probeIndex];
+
+			if (slot->record == 0)
+			{
+				if (probes)
+				{
+					*probes = i + 1;
+				}
+				return data_->capacity;
+			}
+
+			if (slot->fingerprint == fingerprint && slot->record != BRENT_TOMBSTONE
+				&& equal_(key, BrentKeyOf<Key, Value>::get(*recordAt(slot->record))))
+			{
+				if (probes)
+				{
+					*probes = i + 1;
+				}
+				return probeIndex;
+			}
+			probeIndex = (probeIndex + step) & mask;
+		}
+		if (probes)
+		{
+			*probes = data_->capacity;
+		}
+		return data_->capacity;
+	}
+
+	template <typename K>
+	uint32_t lookup(const K& key, uint64_t hashValue, unsigned int* probes = NULL) const
+	{
+		if (!data_->table)
+		{
+			if (probes)
+			{
+				*probes = 0;
+			}
+			return 0;
+		}
+		unsigned int slot = slotOf(key, hashValue, probes);
+		return slot < data_->capacity ? data_->table[slot].record : 0;
+	}
+
+	Data own_;
+	Data* data_;
+	bool owner_;
+	Allocator alloc_;
+	Hash hasher_;
+	KeyEq equal_;
+};
+
+#endif // BRENT_TABLE_H
@@ -0,0 +1,44 @@
+#ifndef CONCURRENT_BRENT_HASHING_H
+#define CONCURRENT_BRENT_HASHING_H
+
+#define CONCURRENT_BRENT_SHARD_BITS 4
+#define CONCURRENT_BRENT_SHARDS (1u << CONCURRENT_BRENT_SHARD_BITS)
+#define CONCURRENT_BRENT_INITIAL_CAPACITY 64
+#define CONCURRENT_BRENT_INITIAL_CHUNKS 8
+#include <atomic>
+#include <mutex>
+#include "brent_hashing.h"
+
+typedef struct ConcurrentSlotArray {
+	unsigned int capacity;
+	struct ConcurrentSlotArray* retired; // previous array, freed on destroy
+	std::atomic<uint64_t> slots[1];      // fingerprint << 32 | record, one word per slot
+} ConcurrentSlotArray;
+
+typedef struct ConcurrentChunkDirectory {
+	unsigned int capacity;
+	struct ConcurrentChunkDirectory* retired; // previous directory, freed on destroy
+	User* chunks[1];
+} ConcurrentChunkDirectory;
+
+typedef struct alignas(64) ConcurrentBrentShard {
+	std::mutex writeLock;
+	std::atomic<unsigned int> sequence; // odd while a writer moves slots
+	std::atomic<ConcurrentSlotArray*> slots;
+	std::atomic<ConcurrentChunkDirectory*> directory;
+	std::atomic<unsigned int> count;
+	unsigned int chunkCount;
+} ConcurrentBrentShard;
+
+typedef struct ConcurrentHashTable {
+	ConcurrentBrentShard shards[CONCURRENT_BRENT_SHARDS];
+	float maxLoadFactor;
+} ConcurrentHashTable;
+
+int initConcurrentHashTable(ConcurrentHashTable* ct, float maxLoadFactor);
+void destroyConcurrentHashTable(ConcurrentHashTable* ct);
+int insertUserConcurrent(ConcurrentHashTable* ct, const char* username, const char* password, int* assignedID);
+int findUserConcurrent(ConcurrentHashTable* ct, const char* username, User* result);
+unsigned int countUsersConcurrent(ConcurrentHashTable* ct);
+
+#endif // CONCURRENT_BRENT_HASHING_H
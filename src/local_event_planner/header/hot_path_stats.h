@@ -0,0 +1,129 @@
+#ifndef HOT_PATH_STATS_H
+#define HOT_PATH_STATS_H
+
+#define HOT_PATH_HISTOGRAM_BUCKETS 48   // bucket b holds values in [2^(b-1), 2^b); bucket 0 holds 0
+#include <stdio.h>
+#include <atomic>
+#include "brent_hashing.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+enum HotPathCounter {
+	HOT_PATH_LOOKUPS = 0,
+	HOT_PATH_LOOKUP_HITS,
+	HOT_PATH_LOOKUP_PROBES,        // slots visited by every lookup, hits and misses
+	HOT_PATH_INSERTS,
+	HOT_PATH_INSERT_COLLISIONS,    // inserts whose home slot was already taken
+	HOT_PATH_INSERT_FAILURES,
+	HOT_PATH_DELETES,
+	HOT_PATH_RESIZES,
+	HOT_PATH_FILE_LOADS,
+	HOT_PATH_FILE_SAVES,
+	HOT_PATH_FILE_FAILURES,
+	HOT_PATH_BYTES_READ,
+	HOT_PATH_BYTES_WRITTEN,
+	HOT_PATH_LOGINS,
+	HOT_PATH_LOGIN_FAILURES,
+	HOT_PATH_COUNTER_COUNT
+};
+
+enum HotPathHistogram {
+	HOT_PATH_PROBE_LENGTH = 0,     // probes per lookup
+	HOT_PATH_LOGIN_NANOS,          // lookup + password check, user input excluded
+	HOT_PATH_LOAD_NANOS,
+	HOT_PATH_SAVE_NANOS,
+	HOT_PATH_HISTOGRAM_COUNT
+};
+
+typedef struct HotPathThreadStats {
+	std::atomic<uint64_t> counters[HOT_PATH_COUNTER_COUNT];
+	std::atomic<uint64_t> buckets[HOT_PATH_HISTOGRAM_COUNT][HOT_PATH_HISTOGRAM_BUCKETS];
+	std::atomic<uint64_t> sums[HOT_PATH_HISTOGRAM_COUNT];
+} HotPathThreadStats;
+
+typedef struct HotPathStats {
+	bool enabled;                  // false when built without ENABLE_HOT_PATH_STATS
+	uint64_t counters[HOT_PATH_COUNTER_COUNT];
+	uint64_t buckets[HOT_PATH_HISTOGRAM_COUNT][HOT_PATH_HISTOGRAM_BUCKETS];
+	uint64_t sums[HOT_PATH_HISTOGRAM_COUNT];
+} HotPathStats;
+
+HotPathThreadStats* hotPathThreadStats();
+uint64_t hotPathNanos();
+void snapshotHotPathStats(HotPathStats* stats);
+void resetHotPathStats();
+uint64_t hotPathHistogramCount(const HotPathStats* stats, HotPathHistogram histogram);
+uint64_t hotPathHistogramPercentile(const HotPathStats* stats, HotPathHistogram histogram, double fraction);
+const char* hotPathCounterName(HotPathCounter counter);
+const char* hotPathHistogramName(HotPathHistogram histogram);
+int writeHotPathStatsJson(FILE* out, const HotPathStats* stats, const HashTable* ht);
+
+/**
+ *  @name   hotPathBucket
+ *
+ *  @brief  Log2 bucket of a histogram value.
+ *
+ *  @param  [in] value [\b uint64_t]  Value to classify.
+ *
+ *  @retval [\b unsigned int] 0 for 0, otherwise 1 + floor(log2(value)),
+ *          clamped to the last bucket.
+ */
+static inline unsigned int hotPathBucket(uint64_t value)
+{
+	if (value == 0)
+	{
+		return 0;
+	}
+#if defined(_MSC_VER)
+	unsigned long highest;
+	_BitScanReverse64(&highest, value);
+	unsigned int bucket = (unsigned int)highest + 1;
+#else
+	unsigned int bucket = 64 - (unsigned int)__builtin_clzll(value);
+#endif
+	return bucket < HOT_PATH_HISTOGRAM_BUCKETS ? bucket : HOT_PATH_HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ *  @name   hotPathAdd
+ *
+ *  @brief  Adds to a counter of the calling thread.
+ *
+ *  @details
+ *  Each thread only writes its own block, so a relaxed load and store is
+ *  enough; no read-modify-write or shared cache line is involved.
+ */
+static inline void hotPathAdd(HotPathCounter counter, uint64_t amount)
+{
+	std::atomic<uint64_t>& slot = hotPathThreadStats()->counters[counter];
+	slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/**
+ *  @name   hotPathRecord
+ *
+ *  @brief  Adds one value to a histogram of the calling thread.
+ */
+static inline void hotPathRecord(HotPathHistogram histogram, uint64_t value)
+{
+	HotPathThreadStats* local = hotPathThreadStats();
+	std::atomic<uint64_t>& bucket = local->buckets[histogram][hotPathBucket(value)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	local->sums[histogram].store(local->sums[histogram].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Instrumentation points compile to nothing unless ENABLE_HOT_PATH_STATS is defined.
+#if defined(ENABLE_HOT_PATH_STATS)
+#define HOT_PATH_COUNT(counter, amount) hotPathAdd((counter), (amount))
+#define HOT_PATH_RECORD(histogram, value) hotPathRecord((histogram), (value))
+#define HOT_PATH_TIMER_START(name) uint64_t name = hotPathNanos()
+#define HOT_PATH_TIMER_STOP(name, histogram) hotPathRecord((histogram), hotPathNanos() - (name))
+#else
+#define HOT_PATH_COUNT(counter, amount) ((void)0)
+#define HOT_PATH_RECORD(histogram, value) ((void)0)
+#define HOT_PATH_TIMER_START(name) ((void)0)
+#define HOT_PATH_TIMER_STOP(name, histogram) ((void)0)
+#endif
+
+#endif // HOT_PATH_STATS_H
@@ -0,0 +1,40 @@
+#ifndef ID_SET_H
+#define ID_SET_H
+
+#define ID_SET_ARRAY_MAX 4096        // larger containers switch to a bitmap
+#define ID_SET_BITMAP_WORDS 1024     // 65536 bits
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+enum IdSetContainerType {
+	ID_SET_ARRAY = 0,   // sorted low 16 bits
+	ID_SET_BITMAP = 1   // one bit per low 16-bit value
+};
+
+typedef struct IdSetContainer {
+	uint16_t key;                  // high 16 bits shared by the container's ids
+	uint32_t cardinality;
+	std::vector<uint16_t> array;   // used while cardinality <= ID_SET_ARRAY_MAX
+	std::vector<uint64_t> bitmap;  // ID_SET_BITMAP_WORDS words otherwise
+} IdSetContainer;
+
+typedef struct IdSet {
+	std::vector<IdSetContainer> containers;  // sorted by key
+} IdSet;
+
+int idSetAdd(IdSet* set, uint32_t id);
+int idSetRemove(IdSet* set, uint32_t id);
+int idSetContains(const IdSet* set, uint32_t id);
+size_t idSetCardinality(const IdSet* set);
+void idSetClear(IdSet* set);
+void idSetUnion(const IdSet* left, const IdSet* right, IdSet* result);
+void idSetUnionWith(IdSet* target, const IdSet* other);
+void idSetIntersection(const IdSet* left, const IdSet* right, IdSet* result);
+size_t idSetIntersectionCardinality(const IdSet* left, const IdSet* right);
+size_t idSetToVector(const IdSet* set, std::vector<uint32_t>* ids);
+size_t idSetMemoryUsage(const IdSet* set);
+void idSetSerialize(const IdSet* set, std::vector<uint8_t>* bytes);
+int idSetDeserialize(const uint8_t* bytes, size_t size, IdSet* set);
+
+#endif // ID_SET_H
@@ -0,0 +1,165 @@
+#ifndef LOCAL_EVENT_PLANNER_H
+#define LOCAL_EVENT_PLANNER_H
+
+#define EVENT_TITLE_SIZE 64
+#define EVENT_LOCATION_SIZE 64
+#define EVENT_INDEX_MIN_DELTA 4096     // delta run size that always triggers a merge
+#define EVENT_INDEX_DELTA_SHIFT 4      // ... or once the delta exceeds main run >> 4
+#define EVENT_INDEX_STALE_SHIFT 2      // rebuild once stale entries exceed main run >> 2
+#define EVENT_LOAD_BLOCK_RECORDS 4096
+#define EVENT_RECURRENCE_MAGIC "RRUL" // optional sections after the event records
+#define EVENT_ATTENDEE_MAGIC "ATND"
+#define EVENT_MAX_ATTENDEE_BYTES (64u << 20)
+#include <vector>
+#include "../../utility/header/file_utility.h"
+#include "text_index.h"
+#include "spatial_index.h"
+#include "recurrence.h"
+#include "id_set.h"
+#include "schedule_conflict.h"
+
+typedef struct Event {
+	int id;
+	int ownerID;
+	int64_t startTime;  // seconds since the Unix epoch
+	int64_t endTime;    // seconds since the Unix epoch, >= startTime
+	char title[EVENT_TITLE_SIZE];
+	char location[EVENT_LOCATION_SIZE];
+	int32_t latitudeE6;   // degrees * 1e6, SPATIAL_NO_POSITION if the event has no place
+	int32_t longitudeE6;  // degrees * 1e6
+} Event;
+
+/**
+ *  @name   BrentKeyOf<int, Event>
+ *
+ *  @brief  Events are keyed by their id in the event table.
+ */
+template <>
+struct BrentKeyOf<int, Event> {
+	static const int& get(const Event& event)
+	{
+		return event.id;
+	}
+};
+
+typedef BrentTable<int, Event> EventTable;
+
+typedef struct EventTimeEntry {
+	int64_t startTime;
+	int id;
+} EventTimeEntry;
+
+typedef struct EventOccurrence {
+	const Event* event;
+	int64_t startTime;  // this occurrence's start
+	int64_t endTime;    // startTime plus the event's duration
+} EventOccurrence;
+
+typedef struct EventSectionHeader {
+	char magic[4];          // EVENT_RECURRENCE_MAGIC or EVENT_ATTENDEE_MAGIC
+	uint32_t count;         // records that follow
+} EventSectionHeader;
+
+typedef struct RecurrenceFileRecord {
+	int32_t eventID;
+	int32_t frequency;
+	int32_t interval;
+	int32_t count;
+	int64_t until;
+	uint64_t exceptionCount; // int64_t start times that follow the record
+} RecurrenceFileRecord;
+
+typedef struct AttendeeFileRecord {
+	int32_t eventID;
+	uint32_t byteCount;      // idSetSerialize() bytes that follow
+} AttendeeFileRecord;
+
+typedef struct EventAttendees {
+	int eventID;
+	IdSet users;             // User::id of everyone attending
+} EventAttendees;
+
+typedef struct UserAttendance {
+	int userID;
+	IdSet events;            // ids of the events the user attends
+	ScheduleTree schedule;   // the one-off ones by time, for conflict checks
+	IdSet series;            // the recurring ones, expanded per query
+} UserAttendance;
+
+/**
+ *  @name   BrentKeyOf<int, EventAttendees>
+ *
+ *  @brief  Attendee sets are keyed by event id.
+ */
+template <>
+struct BrentKeyOf<int, EventAttendees> {
+	static const int& get(const EventAttendees& attendees)
+	{
+		return attendees.eventID;
+	}
+};
+
+/**
+ *  @name   BrentKeyOf<int, UserAttendance>
+ *
+ *  @brief  Attendance sets are keyed by user id.
+ */
+template <>
+struct BrentKeyOf<int, UserAttendance> {
+	static const int& get(const UserAttendance& attendance)
+	{
+		return attendance.userID;
+	}
+};
+
+typedef BrentTable<int, EventAttendees> AttendeeTable;
+typedef BrentTable<int, UserAttendance> AttendanceTable;
+
+typedef struct EventStore {
+	EventTable events;
+	std::vector<EventTimeEntry> mainRun;  // sorted by (startTime, id)
+	std::vector<EventTimeEntry> deltaRun; // recent additions, sorted lazily
+	bool deltaSorted;
+	size_t staleEntries;                  // entries whose event was deleted or moved
+	TextIndex text;                       // title and location keywords
+	SpatialIndex places;                  // grid over events with coordinates
+	RecurrenceTable recurrences;          // rules of recurring events, by event id
+	ScheduleTree seriesSpans;             // each series from its first to its last possible start
+	AttendeeTable attendees;              // event id -> attending users
+	AttendanceTable attendance;           // user id -> attended events
+	int nextID;
+} EventStore;
+
+int initEventStore(EventStore* store);
+void destroyEventStore(EventStore* store);
+int addEvent(EventStore* store, int ownerID, int64_t startTime, int64_t endTime, const char* title, const char* location, Event** created);
+int insertEventRecord(EventStore* store, const Event* event);
+int findEventById(EventStore* store, int id, Event** result);
+int updateEventTime(EventStore* store, int id, int64_t startTime, int64_t endTime);
+int updateEventText(EventStore* store, int id, const char* title, const char* location);
+int setEventPosition(EventStore* store, int id, double latitude, double longitude);
+int setEventRecurrence(EventStore* store, int id, const RecurrenceRule* rule);
+int addRecurrenceException(EventStore* store, int id, int64_t occurrenceStart);
+const EventRecurrence* findEventRecurrence(EventStore* store, int id);
+int addAttendee(EventStore* store, int eventID, int userID);
+int removeAttendee(EventStore* store, int eventID, int userID);
+int isAttending(EventStore* store, int eventID, int userID);
+size_t countAttendees(EventStore* store, int eventID);
+const IdSet* findEventAttendees(EventStore* store, int eventID);
+size_t findEventsAttendedBy(EventStore* store, const IdSet* users, IdSet* events);
+size_t findMutualAttendees(EventStore* store, int eventID, int otherEventID, IdSet* result);
+size_t countAttendeesAmong(EventStore* store, int eventID, const IdSet* users);
+size_t checkScheduleConflicts(EventStore* store, int userID, int64_t startTime, int64_t endTime, std::vector<ScheduleConflict>* conflicts);
+size_t findUserConflicts(EventStore* store, int userID, int64_t from, int64_t to, std::vector<ScheduleConflict>* conflicts);
+size_t findVenueConflicts(EventStore* store, int64_t from, int64_t to, std::vector<ScheduleConflict>* conflicts);
+int deleteEvent(EventStore* store, int id);
+size_t findEventsInRange(EventStore* store, int64_t from, int64_t to, std::vector<const Event*>* results);
+size_t findOccurrencesInRange(EventStore* store, int64_t from, int64_t to, std::vector<EventOccurrence>* results);
+size_t findEventsNear(EventStore* store, double latitude, double longitude, double radiusKm, int64_t from, int64_t to, std::vector<const Event*>* results);
+size_t findEventsInBox(EventStore* store, double minLatitude, double minLongitude, double maxLatitude, double maxLongitude, int64_t from, int64_t to, std::vector<const Event*>* results);
+size_t searchEvents(EventStore* store, const char* query, int mode, std::vector<const Event*>* results);
+size_t countEvents(const EventStore* store);
+int loadEventsFromBinaryFile(EventStore* store, const char* filename);
+int saveEventsToBinaryFile(const EventStore* store, const char* filename);
+
+#endif // LOCAL_EVENT_PLANNER_H
@@ -2,6 +2,10 @@
 
 #include "../../utility/header/commonTypes.h"
 
+#define EVENTS_FILE "events.dat"
+
+struct UserStore;
+
 // Test modu bayrağı (TANIMI menu.cpp içinde)
 extern bool isTestEnvironmentMenu;
 
@@ -10,12 +14,16 @@ enum Key {
 	NONE = 0,
 	UP_ARROW = 1,
 	DOWN_ARROW = 2,
-	ENTER = 3
+	ENTER = 3,
+	PAGE_UP = 4,
+	PAGE_DOWN = 5,
+	RESIZE = 6       // the terminal changed size while waiting for a key
 };
 
 // API
 int getInput();
 int printMenu(const char menuItems[][30], int menuSize, int selectedIndex);
 int runMenu(const char menuItems[][30], int menuSize);
-int firstMenu();
-int mainMenu(const int userID, const char* userName);
\ No newline at end of file
+int firstMenu(UserStore* store, const char* usersFile);
+int mainMenu(const int userID, const char* userName);
+int eventMenu(const int userID, const char* userName);
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#define RECURRENCE_NO_END INT64_MAX
+#define RECURRENCE_MAX_EXCEPTIONS 65536
+#include <vector>
+#include "brent_hashing.h"
+#include "../../utility/header/date_time.h"
+
+enum RecurrenceFrequency {
+	RECURRENCE_NONE = 0,
+	RECURRENCE_DAILY = 1,
+	RECURRENCE_WEEKLY = 2,
+	RECURRENCE_MONTHLY = 3  // same day of month, clamped to the month's last day
+};
+
+typedef struct RecurrenceRule {
+	int frequency;   // RecurrenceFrequency
+	int interval;    // every n days/weeks/months, >= 1
+	int count;       // number of occurrences including the first; 0 = unlimited
+	int64_t until;   // latest allowed occurrence start, RECURRENCE_NO_END for none
+} RecurrenceRule;
+
+typedef struct EventRecurrence {
+	int eventID;
+	int64_t firstStart;               // the event's start, kept in sync by the store
+	RecurrenceRule rule;
+	std::vector<int64_t> exceptions;  // sorted start times of cancelled occurrences
+} EventRecurrence;
+
+/**
+ *  @name   BrentKeyOf<int, EventRecurrence>
+ *
+ *  @brief  Recurrence rules are keyed by the id of their event.
+ */
+template <>
+struct BrentKeyOf<int, EventRecurrence> {
+	static const int& get(const EventRecurrence& recurrence)
+	{
+		return recurrence.eventID;
+	}
+};
+
+typedef BrentTable<int, EventRecurrence> RecurrenceTable;
+
+typedef struct OccurrenceIterator {
+	const EventRecurrence* recurrence;
+	int64_t firstStart;       // start of occurrence 0 (the event's own start)
+	int64_t index;            // current occurrence number
+	int64_t startTime;        // current occurrence start
+	int64_t to;               // exclusive end of the window
+	size_t nextException;     // first exception not before startTime
+	bool valid;
+} OccurrenceIterator;
+
+int isValidRecurrenceRule(const RecurrenceRule* rule);
+int64_t occurrenceStart(const RecurrenceRule* rule, int64_t firstStart, int64_t index);
+int beginOccurrences(OccurrenceIterator* it, const EventRecurrence* recurrence, int64_t firstStart, int64_t from, int64_t to);
+int advanceOccurrence(OccurrenceIterator* it);
+
+#endif // RECURRENCE_H
@@ -0,0 +1,46 @@
+#ifndef SCHEDULE_CONFLICT_H
+#define SCHEDULE_CONFLICT_H
+
+#define SCHEDULE_NO_NODE -1
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+typedef struct ScheduleInterval {
+	int64_t startTime;  // inclusive
+	int64_t endTime;    // exclusive: back-to-back intervals do not overlap
+	int id;
+} ScheduleInterval;
+
+typedef struct ScheduleConflict {
+	int id;                // the earlier-starting interval (0 for a prospective slot)
+	int otherID;
+	int64_t overlapStart;
+	int64_t overlapEnd;
+} ScheduleConflict;
+
+typedef struct ScheduleNode {
+	ScheduleInterval interval;
+	int64_t maxEnd;     // largest endTime in the subtree
+	uint32_t priority;  // treap heap order
+	int32_t left;
+	int32_t right;
+} ScheduleNode;
+
+typedef struct ScheduleTree {
+	std::vector<ScheduleNode> nodes;   // node pool, children are indices
+	std::vector<int32_t> freeNodes;
+	int32_t root;
+	size_t count;
+	uint32_t seed;
+} ScheduleTree;
+
+void initScheduleTree(ScheduleTree* tree);
+int addScheduleInterval(ScheduleTree* tree, const ScheduleInterval* interval);
+int removeScheduleInterval(ScheduleTree* tree, const ScheduleInterval* interval);
+int hasScheduleOverlap(const ScheduleTree* tree, int64_t startTime, int64_t endTime);
+size_t findScheduleOverlaps(const ScheduleTree* tree, const ScheduleInterval* candidate, std::vector<ScheduleConflict>* conflicts);
+size_t scheduleIntervals(const ScheduleTree* tree, std::vector<ScheduleInterval>* intervals);
+size_t sweepScheduleConflicts(std::vector<ScheduleInterval>* intervals, bool sorted, std::vector<ScheduleConflict>* conflicts);
+
+#endif // SCHEDULE_CONFLICT_H
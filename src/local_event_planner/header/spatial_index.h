@@ -0,0 +1,59 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#define SPATIAL_CELL_E6 10000                // grid cell edge: 0.01 degrees (~1.1 km of latitude)
+#define SPATIAL_NO_POSITION INT32_MIN        // latitudeE6 of an event without coordinates
+#define SPATIAL_EARTH_RADIUS_KM 6371.0088
+#include <vector>
+#include "brent_hashing.h"
+
+typedef struct SpatialEntry {
+	int64_t startTime;
+	int id;
+	int32_t latitudeE6;   // degrees * 1e6
+	int32_t longitudeE6;  // degrees * 1e6
+} SpatialEntry;
+
+typedef struct SpatialCell {
+	uint64_t key;                       // packed (latitude cell, longitude cell)
+	std::vector<SpatialEntry> entries;  // sorted by startTime when @c sorted is set
+	bool sorted;
+} SpatialCell;
+
+/**
+ *  @name   BrentKeyOf<uint64_t, SpatialCell>
+ *
+ *  @brief  Grid cells are keyed by their packed cell coordinates.
+ */
+template <>
+struct BrentKeyOf<uint64_t, SpatialCell> {
+	static const uint64_t& get(const SpatialCell& cell)
+	{
+		return cell.key;
+	}
+};
+
+typedef BrentTable<uint64_t, SpatialCell> SpatialCellTable;
+
+typedef struct SpatialIndex {
+	SpatialCellTable cells;
+	size_t pointCount;
+} SpatialIndex;
+
+typedef struct SpatialBox {
+	int32_t minLatitudeE6;
+	int32_t maxLatitudeE6;
+	int32_t minLongitudeE6;  // greater than maxLongitudeE6 when the box crosses 180 degrees
+	int32_t maxLongitudeE6;
+} SpatialBox;
+
+int initSpatialIndex(SpatialIndex* index);
+void destroySpatialIndex(SpatialIndex* index);
+int addSpatialPoint(SpatialIndex* index, const SpatialEntry* entry);
+int removeSpatialPoint(SpatialIndex* index, const SpatialEntry* entry);
+size_t querySpatialBox(SpatialIndex* index, const SpatialBox* box, int64_t from, int64_t to, std::vector<SpatialEntry>* results);
+int spatialBoxAroundPoint(double latitude, double longitude, double radiusKm, SpatialBox* box);
+double distanceKm(int32_t latitudeE6, int32_t longitudeE6, int32_t otherLatitudeE6, int32_t otherLongitudeE6);
+int32_t degreesToE6(double degrees);
+
+#endif // SPATIAL_INDEX_H
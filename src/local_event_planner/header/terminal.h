@@ -0,0 +1,45 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#define TERMINAL_DEFAULT_ROWS 24
+#define TERMINAL_DEFAULT_COLUMNS 80
+#define MENU_HEADER_ROWS 1      // "=== MENU ==="
+#define MENU_FOOTER_ROWS 2      // blank line and navigation hint
+#include <string>
+#include "../../utility/header/commonTypes.h"
+#if !defined(_WIN32)
+#include <signal.h>
+#endif
+
+typedef struct TerminalSession {
+	bool active;
+	int rows;
+	int columns;
+#if defined(_WIN32)
+	HANDLE output;
+	DWORD savedOutputMode;
+#else
+	struct termios savedMode;
+	struct sigaction savedResizeAction;
+#endif
+} TerminalSession;
+
+typedef struct MenuView {
+	int rows;          // terminal size of the last frame, 0 before the first one
+	int columns;
+	int itemCount;
+	int visibleRows;   // item rows on screen
+	int top;           // first visible item
+	int selected;      // highlighted item in the last frame
+} MenuView;
+
+int beginTerminalSession(TerminalSession* terminal);
+void endTerminalSession(TerminalSession* terminal);
+void getTerminalSize(int* rows, int* columns);
+int refreshTerminalSize(TerminalSession* terminal);
+int readTerminalKey(TerminalSession* terminal);
+int writeTerminal(const std::string& bytes);
+void initMenuView(MenuView* view);
+size_t renderMenuFrame(const char menuItems[][30], int menuSize, int selectedIndex, int rows, int columns, MenuView* view, std::string* frame);
+
+#endif // TERMINAL_H
@@ -0,0 +1,64 @@
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#define TEXT_POSTING_BLOCK 128     // ids per skip entry
+#define TEXT_MIN_TOKEN_LENGTH 2
+#define TEXT_MAX_TOKEN_LENGTH 32    // longer tokens are truncated
+#include <string>
+#include <vector>
+#include "brent_hashing.h"
+
+enum TextQueryMode {
+	TEXT_QUERY_ALL = 0, // every term must match (AND)
+	TEXT_QUERY_ANY = 1  // any term may match (OR)
+};
+
+typedef struct PostingSkip {
+	uint32_t firstID; // first id of the block, stored absolutely
+	uint32_t offset;  // byte offset of the block's remaining deltas
+} PostingSkip;
+
+typedef struct PostingList {
+	std::vector<uint8_t> bytes;     // ascending ids as varint deltas, TEXT_POSTING_BLOCK per block
+	std::vector<PostingSkip> skips;
+	uint32_t count;
+	uint32_t lastID;
+} PostingList;
+
+typedef struct TextTerm {
+	std::string term;
+	PostingList postings;
+} TextTerm;
+
+/**
+ *  @name   BrentKeyOf<std::string, TextTerm>
+ *
+ *  @brief  Terms are keyed by their text, so the dictionary can be probed
+ *          with a BrentKeyView token without building a std::string.
+ */
+template <>
+struct BrentKeyOf<std::string, TextTerm> {
+	static const std::string& get(const TextTerm& term)
+	{
+		return term.term;
+	}
+};
+
+typedef BrentTable<std::string, TextTerm> TextTermTable;
+
+typedef struct TextIndex {
+	TextTermTable terms;
+	size_t postingCount;
+} TextIndex;
+
+size_t tokenizeText(const char* text, std::vector<std::string>* tokens);
+int initTextIndex(TextIndex* index);
+void destroyTextIndex(TextIndex* index);
+int addDocumentToTextIndex(TextIndex* index, uint32_t id, const char* text);
+int removeDocumentFromTextIndex(TextIndex* index, uint32_t id, const char* text);
+int updateDocumentInTextIndex(TextIndex* index, uint32_t id, const char* oldText, const char* newText);
+size_t searchTextIndex(const TextIndex* index, const char* query, int mode, std::vector<uint32_t>* results);
+size_t decodePostingList(const PostingList* list, std::vector<uint32_t>* ids);
+size_t memoryUsageTextIndex(const TextIndex* index);
+
+#endif // TEXT_INDEX_H
@@ -2,7 +2,10 @@
 #define USER_AUTHENTICATION_H
 
 #include "../../utility/header/file_utility.h"          // HashTable, User, dosya işlemleri
+#include "../../utility/header/user_journal.h"          // Kayıt günlüğü (journal)
+#include "../../utility/header/user_index.h"            // Kalıcı kullanıcı indeksi
 #include "../../local_event_planner/header/wait.h"      // WAIT makrosu (buradan geliyor)
+#include "user_store.h"                                 // Uzun ömürlü kullanıcı deposu
 #include "menu.h"                                       // Menü çağrıları için
 
 
@@ -11,11 +14,12 @@ extern bool isTestEnvironment;
 
 // Kullanıcı giriş ve kayıt işlemleri
 int performUserLogin(HashTable* ht);
+int performUserLoginFromIndex(const UserIndexView* view, const char* journalFile);
 int performUserRegistration(HashTable* ht);
 
-// Dosya yükleme ve kaydetme ile çalışan yüksek seviye işlemler
-int initiateUserRegistration();
-int initiateUserLogin();
+// Uygulama boyunca açık kalan depo üzerinde çalışan yüksek seviye işlemler
+int initiateUserRegistration(UserStore* store);
+int initiateUserLogin(UserStore* store, const char* filename);
 
 
 #endif // USER_AUTHENTICATION_H
@@ -0,0 +1,21 @@
+#ifndef USER_STORE_H
+#define USER_STORE_H
+
+#include "../../utility/header/user_journal.h"
+
+typedef struct UserStore {
+	HashTable table;
+	char filename[FILENAME_MAX];
+	long pendingJournalRecords;
+} UserStore;
+
+int openUserStore(UserStore* store, const char* filename);
+int findUserInStore(UserStore* store, const char* username, User** result);
+int authenticateUserInStore(UserStore* store, const char* username, const char* password, User** result);
+int registerUserInStore(UserStore* store, const char* username, const char* password, User** created);
+int updateUserPasswordInStore(UserStore* store, const char* username, const char* newPassword);
+int deleteUserFromStore(UserStore* store, const char* username);
+int flushUserStore(UserStore* store);
+void closeUserStore(UserStore* store);
+
+#endif // USER_STORE_H
@@ -0,0 +1,469 @@
+#include "../header/batch_driver.h"
+#include "../../utility/header/date_time.h"
+#include <chrono>
+#include <cstdlib>
+
+static const char* const batchCommandNames[BATCH_COMMAND_COUNT] =
+{
+	"register",
+	"login",
+	"logout",
+	"create-event",
+	"rsvp",
+	"query",
+	"search",
+	"near",
+	"save",
+	"load"
+};
+
+/**
+ *  @name   splitBatchLine
+ *
+ *  @brief  Splits a script line into whitespace-separated tokens in place.
+ *
+ *  @retval [\b int] Number of tokens; a "double quoted" token may contain spaces.
+ *
+ *  @details Stops at a '#' that starts a token, so comments may follow a command.
+ */
+static int splitBatchLine(char* line, char* tokens[BATCH_MAX_TOKENS])
+{
+	int count = 0;
+	char* cursor = line;
+	while (count < BATCH_MAX_TOKENS)
+	{
+		while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')
+		{
+			cursor++;
+		}
+		if (*cursor == '\0' || *cursor == '#')
+		{
+			break;
+		}
+
+		char end = ' ';
+		if (*cursor == '"')
+		{
+			end = '"';
+			cursor++;
+		}
+		tokens[count++] = cursor;
+		while (*cursor != '\0' && (end == '"' ? *cursor != '"' : (*cursor != ' ' && *cursor != '\t' && *cursor != '\r' && *cursor != '\n')))
+		{
+			cursor++;
+		}
+		if (*cursor == '\0')
+		{
+			break;
+		}
+		*cursor++ = '\0';
+	}
+	return count;
+}
+
+/**
+ *  @name   parseBatchTime
+ *
+ *  @brief  Reads "YYYY-MM-DDTHH:MM[:SS]" or plain epoch seconds.
+ */
+static int parseBatchTime(const char* text, int64_t* result)
+{
+	DateTime dateTime;
+	if (parseDateTime(text, &dateTime))
+	{
+		*result = dateTimeToEpochSeconds(dateTime);
+		return 1;
+	}
+
+	char* end = NULL;
+	long long seconds = strtoll(text, &end, 10);
+	if (end == text || *end != '\0')
+	{
+		return 0;
+	}
+	*result = (int64_t)seconds;
+	return 1;
+}
+
+static int parseBatchNumber(const char* text, double* result)
+{
+	char* end = NULL;
+	*result = strtod(text, &end);
+	return end != text && *end == '\0';
+}
+
+static int findBatchCommand(const char* name)
+{
+	for (int i = 0; i < BATCH_COMMAND_COUNT; i++)
+	{
+		if (strcmp(name, batchCommandNames[i]) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ *  @name   executeBatchCommand
+ *
+ *  @brief  Runs one parsed command against the session.
+ *
+ *  @retval [\b int] 1 on success; 0 on failure, with the reason in @p detail.
+ */
+static int executeBatchCommand(BatchSession* session, int command, char* tokens[], int count, char* detail)
+{
+	switch (command)
+	{
+	case BATCH_REGISTER:
+	{
+		User* user = NULL;
+		if (count != 3 || strlen(tokens[1]) >= sizeof(user->username) || strlen(tokens[2]) >= sizeof(user->password))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "usage: register <username> <password>");
+			return 0;
+		}
+		if (strlen(tokens[2]) < 4)
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "password shorter than 4 characters");
+			return 0;
+		}
+		if (!registerUserInStore(session->users, tokens[1], tokens[2], &user))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "username taken or store error");
+			return 0;
+		}
+		snprintf(detail, BATCH_DETAIL_SIZE, "user %d", user->id);
+		return 1;
+	}
+	case BATCH_LOGIN:
+	{
+		User* user = NULL;
+		if (count != 3 || !authenticateUserInStore(session->users, tokens[1], tokens[2], &user))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "unknown user or wrong password");
+			return 0;
+		}
+		session->userID = user->id;
+		snprintf(detail, BATCH_DETAIL_SIZE, "user %d", user->id);
+		return 1;
+	}
+	case BATCH_LOGOUT:
+		session->userID = 0;
+		return 1;
+	case BATCH_CREATE_EVENT:
+	{
+		int64_t startTime, endTime;
+		Event* event = NULL;
+		if (count < 4 || count > 5 || !parseBatchTime(tokens[1], &startTime) || !parseBatchTime(tokens[2], &endTime))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "usage: create-event <start> <end> <title> [location]");
+			return 0;
+		}
+		if (session->userID == 0)
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "not logged in");
+			return 0;
+		}
+		if (!addEvent(&session->events, session->userID, startTime, endTime, tokens[3], count == 5 ? tokens[4] : "", &event))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "invalid event");
+			return 0;
+		}
+		snprintf(detail, BATCH_DETAIL_SIZE, "event %d", event->id);
+		return 1;
+	}
+	case BATCH_RSVP:
+	{
+		Event* event = NULL;
+		if (count != 2 || session->userID == 0 || !findEventById(&session->events, atoi(tokens[1]), &event))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "unknown event or not logged in");
+			return 0;
+		}
+		size_t conflicts = checkScheduleConflicts(&session->events, session->userID, event->startTime, event->endTime, NULL);
+		if (!addAttendee(&session->events, event->id, session->userID))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "already attending");
+			return 0;
+		}
+		snprintf(detail, BATCH_DETAIL_SIZE, conflicts ? "attending, overlaps another RSVP" : "attending");
+		return 1;
+	}
+	case BATCH_QUERY:
+	{
+		int64_t from, to;
+		if (count != 3 || !parseBatchTime(tokens[1], &from) || !parseBatchTime(tokens[2], &to))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "usage: query <from> <to>");
+			return 0;
+		}
+		std::vector<EventOccurrence> occurrences;
+		snprintf(detail, BATCH_DETAIL_SIZE, "%zu occurrences", findOccurrencesInRange(&session->events, from, to, &occurrences));
+		return 1;
+	}
+	case BATCH_SEARCH:
+	{
+		char query[BATCH_MAX_LINE] = "";
+		for (int i = 1; i < count; i++)
+		{
+			strncat(query, tokens[i], sizeof(query) - strlen(query) - 2);
+			strcat(query, " ");
+		}
+		std::vector<const Event*> events;
+		snprintf(detail, BATCH_DETAIL_SIZE, "%zu events", searchEvents(&session->events, query, TEXT_QUERY_ALL, &events));
+		return 1;
+	}
+	case BATCH_NEAR:
+	{
+		double latitude, longitude, radiusKm;
+		if (count != 4 || !parseBatchNumber(tokens[1], &latitude) || !parseBatchNumber(tokens[2], &longitude) || !parseBatchNumber(tokens[3], &radiusKm))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "usage: near <latitude> <longitude> <km>");
+			return 0;
+		}
+		std::vector<const Event*> events;
+		snprintf(detail, BATCH_DETAIL_SIZE, "%zu events", findEventsNear(&session->events, latitude, longitude, radiusKm, INT64_MIN, INT64_MAX, &events));
+		return 1;
+	}
+	case BATCH_SAVE:
+		if (count != 2 || !saveEventsToBinaryFile(&session->events, tokens[1]))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "could not save");
+			return 0;
+		}
+		snprintf(detail, BATCH_DETAIL_SIZE, "%zu events", countEvents(&session->events));
+		return 1;
+	case BATCH_LOAD:
+		if (count != 2)
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "usage: load <events file>");
+			return 0;
+		}
+		destroyEventStore(&session->events);
+		if (!initEventStore(&session->events) || !loadEventsFromBinaryFile(&session->events, tokens[1]))
+		{
+			snprintf(detail, BATCH_DETAIL_SIZE, "could not load");
+			return 0;
+		}
+		snprintf(detail, BATCH_DETAIL_SIZE, "%zu events", countEvents(&session->events));
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/**
+ *  @name   openBatchSession
+ *
+ *  @brief  Prepares a non-interactive session over an open user store.
+ *
+ *  @param  [out] session [\b BatchSession*]  Session to initialize.
+ *  @param  [in]  users   [\b UserStore*]     Store opened with openUserStore().
+ *  @param  [in]  trace   [\b FILE*]          Receives one line per command, or NULL.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments or allocation failure.
+ *
+ *  @details
+ *  The session calls the store functions directly: there is no menu, no
+ *  scanf() prompt, no WAIT() and no screen clearing, so commands run back
+ *  to back and the recorded latency is the work itself. Events live in
+ *  the session's own EventStore until a save command writes them.
+ *
+ *  @warning The session must be released with closeBatchSession().
+ */
+int openBatchSession(BatchSession* session, UserStore* users, FILE* trace)
+{
+	if (!session || !users)
+	{
+		return 0;
+	}
+
+	memset(session->stats, 0, sizeof(session->stats));
+	session->users = users;
+	session->userID = 0;
+	session->trace = trace;
+	session->unknownCommands = 0;
+	session->lineNumber = 0;
+	session->elapsedMicros = 0;
+	return initEventStore(&session->events);
+}
+
+/**
+ *  @name   closeBatchSession
+ *
+ *  @brief  Releases the session's event store; the user store stays open.
+ */
+void closeBatchSession(BatchSession* session)
+{
+	if (session)
+	{
+		destroyEventStore(&session->events);
+	}
+}
+
+/**
+ *  @name   batchCommandName
+ *
+ *  @brief  Script keyword of a BatchCommand.
+ */
+const char* batchCommandName(int command)
+{
+	return command >= 0 && command < BATCH_COMMAND_COUNT ? batchCommandNames[command] : "unknown";
+}
+
+/**
+ *  @name   runBatchCommand
+ *
+ *  @brief  Parses, runs and times one script line.
+ *
+ *  @param  [in,out] session [\b BatchSession*]  Open session.
+ *  @param  [in]     line    [\b const char*]    Command line, e.g. "login alice secret".
+ *
+ *  @retval [\b int] 1 if the command succeeded; 0 if it failed or is unknown;
+ *          -1 for a blank or comment line.
+ *
+ *  @details
+ *  Only the command itself is timed, not the parsing. The latency goes
+ *  into the command's BatchCommandStats and, when tracing, onto a line
+ *  "<line> <command> ok|FAILED <detail> (<micros> us)".
+ */
+int runBatchCommand(BatchSession* session, const char* line)
+{
+	if (!session || !line)
+	{
+		return 0;
+	}
+
+	char buffer[BATCH_MAX_LINE];
+	char* tokens[BATCH_MAX_TOKENS];
+	snprintf(buffer, sizeof(buffer), "%s", line);
+	session->lineNumber++;
+	int count = splitBatchLine(buffer, tokens);
+	if (count == 0)
+	{
+		return -1;
+	}
+
+	int command = findBatchCommand(tokens[0]);
+	if (command < 0)
+	{
+		session->unknownCommands++;
+		if (session->trace)
+		{
+			fprintf(session->trace, "%llu %s FAILED unknown command\n", (unsigned long long)session->lineNumber, tokens[0]);
+		}
+		return 0;
+	}
+
+	char detail[BATCH_DETAIL_SIZE] = "";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int ok = executeBatchCommand(session, command, tokens, count, detail);
+	double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	BatchCommandStats* stats = &session->stats[command];
+	stats->count++;
+	stats->failures += ok ? 0 : 1;
+	stats->totalMicros += micros;
+	if (micros > stats->maxMicros)
+	{
+		stats->maxMicros = micros;
+	}
+	if (session->trace)
+	{
+		fprintf(session->trace, "%llu %s %s %s (%.1f us)\n", (unsigned long long)session->lineNumber,
+			batchCommandNames[command], ok ? "ok" : "FAILED", detail, micros);
+	}
+	return ok;
+}
+
+/**
+ *  @name   runBatchScript
+ *
+ *  @brief  Runs every line of a script file or stream (e.g. stdin).
+ *
+ *  @param  [in,out] session [\b BatchSession*]  Open session.
+ *  @param  [in]     input   [\b FILE*]          Script, one command per line.
+ *
+ *  @retval [\b uint64_t] Number of commands run, failed ones included.
+ *
+ *  @details Failures do not stop the script. Lines too long for
+ *           BATCH_MAX_LINE are skipped and counted as unrecognized. The
+ *           wall time, parsing and tracing included, is added to
+ *           @c elapsedMicros for the throughput in printBatchReport().
+ */
+uint64_t runBatchScript(BatchSession* session, FILE* input)
+{
+	if (!session || !input)
+	{
+		return 0;
+	}
+
+	uint64_t commands = 0;
+	char line[BATCH_MAX_LINE];
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (fgets(line, sizeof(line), input))
+	{
+		if (!strchr(line, '\n') && !feof(input))
+		{
+			// Over-long line: skip all of it rather than run a truncated command.
+			int ch = fgetc(input);
+			while (ch != '\n' && ch != EOF)
+			{
+				ch = fgetc(input);
+			}
+			session->lineNumber++;
+			session->unknownCommands++;
+			if (session->trace)
+			{
+				fprintf(session->trace, "%llu FAILED line longer than %d characters\n", (unsigned long long)session->lineNumber, BATCH_MAX_LINE - 2);
+			}
+			commands++;
+			continue;
+		}
+		if (runBatchCommand(session, line) >= 0)
+		{
+			commands++;
+		}
+	}
+	session->elapsedMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	return commands;
+}
+
+/**
+ *  @name   printBatchReport
+ *
+ *  @brief  Prints per-command latency and the overall throughput.
+ *
+ *  @param  [in] session [\b const BatchSession*]  Session after runBatchScript().
+ *  @param  [in] output  [\b FILE*]                Destination, e.g. stdout.
+ */
+void printBatchReport(const BatchSession* session, FILE* output)
+{
+	if (!session || !output)
+	{
+		return;
+	}
+
+	uint64_t total = session->unknownCommands;
+	fprintf(output, "%-14s %10s %8s %12s %12s\n", "command", "count", "failed", "mean us", "max us");
+	for (int i = 0; i < BATCH_COMMAND_COUNT; i++)
+	{
+		const BatchCommandStats* stats = &session->stats[i];
+		if (stats->count == 0)
+		{
+			continue;
+		}
+		total += stats->count;
+		fprintf(output, "%-14s %10llu %8llu %12.2f %12.2f\n", batchCommandNames[i], (unsigned long long)stats->count,
+			(unsigned long long)stats->failures, stats->totalMicros / (double)stats->count, stats->maxMicros);
+	}
+	if (session->unknownCommands)
+	{
+		fprintf(output, "%-14s %10llu\n", "unrecognized", (unsigned long long)session->unknownCommands);
+	}
+
+	double seconds = session->elapsedMicros / 1e6;
+	fprintf(output, "%llu commands in %.3f s (%.0f commands/s)\n", (unsigned long long)total, seconds,
+		seconds > 0 ? (double)total / seconds : 0.0);
+}
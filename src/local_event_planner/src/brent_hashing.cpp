@@ -1,4 +1,5 @@
 ﻿#include "../header/brent_hashing.h"
+#include "../header/hot_path_stats.h"
 
 /**
  *  @name   currentID
@@ -7,11 +8,12 @@
  *
  *  @details
  *  Stores the next candidate user ID. Typically advanced by persistence
- *  layer after loading/saving users.
+ *  layer after loading/saving users. New IDs should be taken with
+ *  allocateUserID() so concurrent registrations never share an ID.
  *
- *  @note   Global state; not thread-safe.
+ *  @note   Atomic; safe to read and advance from several threads.
  */
-int currentID = 1;
+std::atomic<int> currentID(1);
 
 /**
  *  @name   forceFailure
@@ -22,64 +24,238 @@ int currentID = 1;
  *  When set to true, insertUserBrent(...) will return failure (0) without
  *  modifying the table. Useful for unit tests of error paths.
  *
- *  @note   Global state; not thread-safe.
+ *  @note   Atomic so the hook can be flipped while worker threads run.
  */
-bool forceFailure = false;
+std::atomic<bool> forceFailure(false);
 
 /**
- *  @name   hash
+ *  @name   allocateUserID
  *
- *  @brief  Computes a simple additive/shift hash for a C-string key.
+ *  @brief  Hands out the next user ID.
  *
- *  @param  [in] key [\b const char*]  Null-terminated username/key to hash.
+ *  @retval [\b int] A user ID no other caller has received.
+ *
+ *  @details
+ *  Single fetch-and-add on @c currentID; replaces the unsynchronized
+ *  @c currentID++ in the registration paths.
+ */
+int allocateUserID()
+{
+	return currentID.fetch_add(1);
+}
+
+/**
+ *  @name   advanceUserID
+ *
+ *  @brief  Moves @c currentID past an ID that is already in use.
+ *
+ *  @param  [in] usedID [\b int]  ID read from disk or assigned elsewhere.
+ *
+ *  @details
+ *  Compare-and-swap loop that only ever raises @c currentID, so a loader
+ *  replaying old records cannot rewind IDs handed out concurrently.
+ */
+void advanceUserID(int usedID)
+{
+	int expected = currentID.load();
+	while (usedID >= expected && !currentID.compare_exchange_weak(expected, usedID + 1))
+	{
+	}
+}
+
+/**
+ *  @name   hashUsernameSeeded
+ *
+ *  @brief  Computes a seeded 64-bit hash for a C-string key.
  *
- *  @retval [\b unsigned int] Bucket index in range [0, TABLE_SIZE).
+ *  @param  [in] key  [\b const char*]  Null-terminated username/key to hash.
+ *  @param  [in] seed [\b uint64_t]     Value folded into the FNV offset basis.
+ *
+ *  @retval [\b uint64_t] Unreduced 64-bit hash value.
  *
  *  @details
- *  Iteratively left-shifts the running value by 5 and adds the next byte,
- *  then reduces modulo TABLE_SIZE. Intended for internal use in this module.
+ *  Runs 64-bit FNV-1a over the bytes of @p key and finishes with the
+ *  MurmurHash3 fmix64 avalanche, so usernames that differ only in a numeric
+ *  suffix still spread over every output bit. The low 32 bits select the
+ *  home slot; the high 32 bits become the slot fingerprint and probe step.
+ *  The seed lets persisted indexes record which hash family built them.
  *
  *  @warning key must be non-NULL and point to a valid null-terminated string.
  */
-static unsigned int hash(const char* key)
+uint64_t hashUsernameSeeded(const char* key, uint64_t seed)
 {
-	unsigned int hash = 0;
-	while (*key) 
+	return brentHashCString(key, seed);
+}
+
+/**
+ *  @name   hashUsername
+ *
+ *  @brief  Computes the 64-bit hash used by the in-memory table.
+ *
+ *  @param  [in] key [\b const char*]  Null-terminated username/key to hash.
+ *
+ *  @retval [\b uint64_t] hashUsernameSeeded(key, 0).
+ *
+ *  @details
+ *  Matches BrentHash<BrentKeyView>, so UserBrentTable and the persisted
+ *  index agree on every slot.
+ */
+uint64_t hashUsername(const char* key)
+{
+	return hashUsernameSeeded(key, 0);
+}
+
+/**
+ *  @name   placeRecordBrent
+ *
+ *  @brief  Places a record index into an external Brent slot array.
+ *
+ *  @param  [in,out] table     [\b BrentSlot*]    Zeroed slot array (power-of-two capacity).
+ *  @param  [in]     capacity  [\b unsigned int]  Slot count.
+ *  @param  [in]     record    [\b uint32_t]      1-based record number to store (non-zero).
+ *  @param  [in]     hashValue [\b uint64_t]      Hash of the record's key.
+ *
+ *  @retval [\b int] 1 on success; 0 if the array is full or arguments are invalid.
+ *
+ *  @details
+ *  Exposes the same Brent placement the in-memory table uses, so other
+ *  modules (e.g. the persistent user index) build slot layouts that
+ *  findUserBrent()-style probing can read.
+ */
+int placeRecordBrent(BrentSlot* table, unsigned int capacity, uint32_t record, uint64_t hashValue)
+{
+	if (!table || capacity == 0 || (capacity & (capacity - 1)) != 0 || record == 0)
 	{
-		hash = (hash << 5) + *key++;
+		return 0;
 	}
-	return hash % TABLE_SIZE;
+	return brentPlaceRecord(table, capacity, record, hashValue, NULL);
 }
 
 /**
  *  @name   initBrentHashTable
  *
- *  @brief  Initializes all buckets of the Brent hash table to NULL.
+ *  @brief  Initializes the Brent hash table with the default capacity.
  *
  *  @param  [in,out] ht [\b HashTable*]  Table instance to initialize.
  *
- *  @retval [\b int] 1 on success; 0 on invalid argument.
+ *  @retval [\b int] 1 on success; 0 on invalid argument or allocation failure.
  *
  *  @details
- *  Performs a linear pass over TABLE_SIZE slots and clears them.
+ *  Equivalent to initBrentHashTableWithCapacity(ht, BRENT_INITIAL_CAPACITY,
+ *  BRENT_DEFAULT_MAX_LOAD). The table grows on demand, so the initial
+ *  capacity is not a limit on the number of users.
  *
- *  @complexity O(TABLE_SIZE)
+ *  @complexity O(BRENT_INITIAL_CAPACITY)
  *
- *  @warning ht must be a valid, allocated pointer.
+ *  @warning The table must be released with destroyBrentHashTable().
  */
 int initBrentHashTable(HashTable* ht)
 {
-	for (int i = 0; i < TABLE_SIZE; i++) 
+	return initBrentHashTableWithCapacity(ht, BRENT_INITIAL_CAPACITY, BRENT_DEFAULT_MAX_LOAD);
+}
+
+/**
+ *  @name   initBrentHashTableWithCapacity
+ *
+ *  @brief  Initializes the table with a given capacity and growth threshold.
+ *
+ *  @param  [in,out] ht            [\b HashTable*]   Table instance to initialize.
+ *  @param  [in]     capacity      [\b unsigned int] Requested slot count; rounded up to a power of two.
+ *  @param  [in]     maxLoadFactor [\b float]        Load factor in (0, 1] above which the table doubles.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid argument or allocation failure.
+ *
+ *  @details
+ *  Allocates a zeroed slot array. Keeping the capacity a power of two lets
+ *  every probe reduce the hash with a mask instead of a modulo.
+ *
+ *  @complexity O(capacity)
+ */
+int initBrentHashTableWithCapacity(HashTable* ht, unsigned int capacity, float maxLoadFactor)
+{
+	if (!ht)
 	{
-		ht->table[i] = NULL;
+		return 0;
 	}
-	return 1;
+	return UserBrentTable(ht).init(capacity, maxLoadFactor);
+}
+
+/**
+ *  @name   resizeBrentHashTable
+ *
+ *  @brief  Rehashes every stored user into a new slot array.
+ *
+ *  @param  [in,out] ht          [\b HashTable*]   Table to resize.
+ *  @param  [in]     newCapacity [\b unsigned int] Requested slot count; rounded up to a power of two.
+ *
+ *  @retval [\b int] 1 on success; 0 if the new capacity cannot hold the
+ *          current users or allocation fails. The table is unchanged on failure.
+ *
+ *  @details
+ *  Only the slot array is reallocated; User records stay in the slab, so
+ *  pointers previously returned by findUserBrent() remain valid. Tombstones
+ *  are dropped, so resizing to the current capacity is also how deleted
+ *  slots are cleaned up.
+ *
+ *  @complexity O(count + newCapacity)
+ */
+int resizeBrentHashTable(HashTable* ht, unsigned int newCapacity)
+{
+	if (!ht)
+	{
+		return 0;
+	}
+	return UserBrentTable(ht).rehash(newCapacity);
+}
+
+/**
+ *  @name   clearBrentHashTable
+ *
+ *  @brief  Removes every user while keeping the allocated storage.
+ *
+ *  @param  [in,out] ht [\b HashTable*]  Table to empty.
+ *
+ *  @details
+ *  Zeroes the slot array and rewinds the slab, so the table can be refilled
+ *  without allocating again. Pointers previously returned by
+ *  findUserBrent() must not be used afterwards.
+ *
+ *  @complexity O(capacity)
+ */
+void clearBrentHashTable(HashTable* ht)
+{
+	if (!ht)
+	{
+		return;
+	}
+	UserBrentTable(ht).clear();
+}
+
+/**
+ *  @name   destroyBrentHashTable
+ *
+ *  @brief  Frees the slot array and the user slab.
+ *
+ *  @param  [in,out] ht [\b HashTable*]  Table to release; left empty with capacity 0.
+ *
+ *  @details
+ *  Releases one block per slab chunk plus the slot array, regardless of
+ *  the number of users. Safe to call on a NULL pointer or on an already
+ *  destroyed table.
+ */
+void destroyBrentHashTable(HashTable* ht)
+{
+	if (!ht)
+	{
+		return;
+	}
+	UserBrentTable(ht).destroy();
 }
 
 /**
  *  @name   insertUserBrent
  *
- *  @brief  Inserts a new User into the table using a Brent-style probe choice.
+ *  @brief  Inserts a new User into the table using Brent's method.
  *
  *  @param  [in,out] ht        [\b HashTable*]  Target hash table.
  *  @param  [in]     id        [\b int]         User identifier to store.
@@ -89,19 +265,18 @@ int initBrentHashTable(HashTable* ht)
  *  @retval [\b int] 1 on success; 0 on failure (e.g., allocation fail, forced fail).
  *
  *  @details
- *  Computes the primary index from @p username. If the slot is occupied,
- *  linearly probes to find either the first empty slot or a position where
- *  relocating the current occupant (one step ahead) reduces probe distance
- *  (a simplified Brent heuristic). Allocates a new User and places it at
- *  the resolved index; existing occupant may be shifted.
+ *  Doubles the table first if the insertion would push the load factor past
+ *  @c maxLoadFactor, then writes the User into the next slab record and
+ *  places its index with Brent's rule (see brentPlaceRecord()).
  *
  *  @note
  *  - Respects the global @c forceFailure test flag.
  *  - Truncates @p username/@p password to fit fixed-size fields in User.
+ *  - With ENABLE_HOT_PATH_STATS, counts inserts, home-slot collisions and resizes.
  *
  *  @complexity
  *  - Average: Amortized O(1)
- *  - Worst-case: O(TABLE_SIZE)
+ *  - Worst-case: O(capacity)
  *
  *  @warning
  *  - @p ht, @p username, and @p password must be valid pointers.
@@ -114,61 +289,125 @@ int insertUserBrent(HashTable* ht, int id, const char* username, const char* pas
 	{
 		return 0;
 	}
-	unsigned int index = hash(username);
 
-	if (ht->table[index] != NULL)
-	{
-		unsigned int i = 1;
-		unsigned int bestIndex = index;
-		unsigned int bestDist = i;
+	User newUser;
+	newUser.id = id;
+	strncpy(newUser.username, username, sizeof(newUser.username) - 1);
+	newUser.username[sizeof(newUser.username) - 1] = '\0';
+	strncpy(newUser.password, password, sizeof(newUser.password) - 1);
+	newUser.password[sizeof(newUser.password) - 1] = '\0';
 
-		while (i < TABLE_SIZE)
-		{
-			unsigned int probeIndex = (index + i) % TABLE_SIZE;
-
-			if (ht->table[probeIndex] == NULL)
-			{
-				bestIndex = probeIndex;
-				bestDist = i;
-				break;
-			}
-
-			unsigned int secondaryIndex = (probeIndex + 1) % TABLE_SIZE;
-			if (ht->table[secondaryIndex] == NULL)
-			{
-				bestIndex = secondaryIndex;
-				bestDist = i;
-				break;
-			}
-			i++;
-		}
+	uint64_t hashValue = hashUsername(newUser.username);
+#if defined(ENABLE_HOT_PATH_STATS)
+	unsigned int oldCapacity = ht->capacity;
+	if (ht->table && !brentSlotIsFree(&ht->table[brentHomeIndex(hashValue, ht->capacity - 1)]))
+	{
+		hotPathAdd(HOT_PATH_INSERT_COLLISIONS, 1);
+	}
+#endif
+	int inserted = UserBrentTable(ht).insertWithHash(newUser, hashValue) != NULL;
+	HOT_PATH_COUNT(inserted ? HOT_PATH_INSERTS : HOT_PATH_INSERT_FAILURES, 1);
+	HOT_PATH_COUNT(HOT_PATH_RESIZES, ht->capacity != oldCapacity);
+	return inserted;
+}
 
-		if (bestIndex != index)
-		{
-			ht->table[bestIndex] = ht->table[index];
-		}
+/**
+ *  @name   reserveBrentHashTable
+ *
+ *  @brief  Pre-sizes the table for an expected number of users.
+ *
+ *  @param  [in,out] ht            [\b HashTable*]   Table to grow.
+ *  @param  [in]     expectedUsers [\b unsigned int] Total users the table should hold without rehashing.
+ *
+ *  @retval [\b int] 1 on success (including when already large enough); 0 on failure.
+ *
+ *  @details
+ *  Resizes once to the smallest power of two that keeps @p expectedUsers
+ *  under @c maxLoadFactor, so a bulk load never rehashes incrementally.
+ */
+int reserveBrentHashTable(HashTable* ht, unsigned int expectedUsers)
+{
+	if (!ht || !ht->table)
+	{
+		return 0;
 	}
+	return UserBrentTable(ht).reserve(expectedUsers);
+}
 
-	User* newUser = (User*)malloc(sizeof(User));
-	if (!newUser)
+/**
+ *  @name   insertUsersBulkBrent
+ *
+ *  @brief  Inserts a block of users, skipping usernames already present.
+ *
+ *  @param  [in,out] ht    [\b HashTable*]   Target hash table.
+ *  @param  [in]     users [\b const User*]  Records to insert (fields need not be terminated).
+ *  @param  [in]     count [\b unsigned int] Number of records.
+ *  @param  [out]    consumed [\b unsigned int*] If non-NULL, receives how many records were
+ *                                              placed or dropped as duplicates; less than
+ *                                              @p count only if an insert failed.
+ *
+ *  @retval [\b unsigned int] Number of users actually inserted.
+ *
+ *  @details
+ *  Terminates the fields of BRENT_BULK_BATCH records at a time and hands
+ *  each batch to BrentTable::insertBulk(), which hashes (and prefetches)
+ *  the whole batch before placing any of it. Duplicates, both within the
+ *  block and against earlier contents, are dropped in the same pass
+ *  (first occurrence wins). Since duplicates make the return value smaller
+ *  than @p count, callers that must not lose records check @p consumed.
+ *
+ *  @note Respects the global @c forceFailure test flag.
+ *
+ *  @complexity O(count) expected.
+ */
+unsigned int insertUsersBulkBrent(HashTable* ht, const User* users, unsigned int count, unsigned int* consumed)
+{
+	if (consumed)
+	{
+		*consumed = 0;
+	}
+	if (forceFailure || !ht || !ht->table || !users)
 	{
 		return 0;
 	}
 
-	newUser->id = id;
-	strncpy(newUser->username, username, sizeof(newUser->username) - 1);
-	newUser->username[sizeof(newUser->username) - 1] = '\0';
-	strncpy(newUser->password, password, sizeof(newUser->password) - 1);
-	newUser->password[sizeof(newUser->password) - 1] = '\0';
+	UserBrentTable table(ht);
+	User batch[BRENT_BULK_BATCH];
+	unsigned int inserted = 0;
+#if defined(ENABLE_HOT_PATH_STATS)
+	unsigned int oldCapacity = ht->capacity;
+#endif
 
-	ht->table[index] = newUser;
-	return 1;
+	for (unsigned int base = 0; base < count; base += BRENT_BULK_BATCH)
+	{
+		unsigned int batchSize = count - base < BRENT_BULK_BATCH ? count - base : BRENT_BULK_BATCH;
+		for (unsigned int i = 0; i < batchSize; i++)
+		{
+			batch[i] = users[base + i];
+			batch[i].username[sizeof(batch[i].username) - 1] = '\0';
+			batch[i].password[sizeof(batch[i].password) - 1] = '\0';
+		}
+
+		unsigned int batchConsumed = 0;
+		inserted += table.insertBulk(batch, batchSize, &batchConsumed);
+		if (consumed)
+		{
+			*consumed = base + batchConsumed;
+		}
+		if (batchConsumed < batchSize)
+		{
+			break;
+		}
+	}
+	HOT_PATH_COUNT(HOT_PATH_INSERTS, inserted);
+	HOT_PATH_COUNT(HOT_PATH_RESIZES, ht->capacity != oldCapacity);
+	return inserted;
 }
 
 /**
  *  @name   findUserBrent
  *
- *  @brief  Looks up a user by username using linear probing from the hash index.
+ *  @brief  Looks up a user by username along its double-hashing probe sequence.
  *
  *  @param  [in]      ht       [\b HashTable*]   Hash table to query.
  *  @param  [in]      username [\b const char*]  Null-terminated username key.
@@ -177,12 +416,13 @@ int insertUserBrent(HashTable* ht, int id, const char* username, const char* pas
  *  @retval [\b int] 1 if found; 0 if not found or on invalid args.
  *
  *  @details
- *  Starts at the primary hash index and linearly probes until it either
- *  encounters a NULL bucket (not found) or a matching username (found).
+ *  Slots with a different fingerprint are rejected without touching the
+ *  User record. With ENABLE_HOT_PATH_STATS every lookup also records the
+ *  probe count of that same walk (see hot_path_stats.h).
  *
  *  @complexity
  *  - Average: Amortized O(1)
- *  - Worst-case: O(TABLE_SIZE)
+ *  - Worst-case: O(capacity)
  *
  *  @warning
  *  - @p ht and @p username must be non-NULL.
@@ -190,39 +430,147 @@ int insertUserBrent(HashTable* ht, int id, const char* username, const char* pas
  */
 int findUserBrent(HashTable* ht, const char* username, User** result)
 {
-	if (!ht || !username)
+	User* user = NULL;
+	if (ht && username)
 	{
-		return 0; 
+#if defined(ENABLE_HOT_PATH_STATS)
+		unsigned int probes = 0;
+		user = UserBrentTable(ht).findWithHash(BrentKeyView(username), hashUsername(username), &probes);
+		hotPathAdd(HOT_PATH_LOOKUPS, 1);
+		hotPathAdd(HOT_PATH_LOOKUP_HITS, user != NULL);
+		hotPathAdd(HOT_PATH_LOOKUP_PROBES, probes);
+		hotPathRecord(HOT_PATH_PROBE_LENGTH, probes);
+#else
+		user = UserBrentTable(ht).find(BrentKeyView(username));
+#endif
 	}
 
-	unsigned int index = hash(username);
+	if (result)
+	{
+		*result = user;
+	}
+	return user != NULL;
+}
 
-	for (unsigned int i = 0; i < TABLE_SIZE; i++)
+/**
+ *  @name   deleteUserBrent
+ *
+ *  @brief  Removes a user, leaving a tombstone in its slot.
+ *
+ *  @param  [in,out] ht       [\b HashTable*]   Table to modify.
+ *  @param  [in]     username [\b const char*]  Null-terminated username key.
+ *
+ *  @retval [\b int] 1 if the user was removed; 0 if absent or on invalid args.
+ *
+ *  @details
+ *  See BrentTable::erase(). The slab stays dense, so getUserAtBrent() and
+ *  saves still see exactly @c count users in insertion order, except that
+ *  the last user takes the deleted user's position.
+ *
+ *  @complexity O(1) expected; O(capacity) when a cleanup runs.
+ *
+ *  @warning Invalidates the User pointer of the deleted user and of the
+ *           user that was last in the slab.
+ */
+int deleteUserBrent(HashTable* ht, const char* username)
+{
+	if (!ht || !username)
 	{
-		unsigned int probeIndex = (index + i) % TABLE_SIZE;
+		return 0;
+	}
+	int erased = UserBrentTable(ht).erase(BrentKeyView(username));
+	HOT_PATH_COUNT(HOT_PATH_DELETES, erased);
+	return erased;
+}
 
-		if (ht->table[probeIndex] == NULL)
-		{
-			if (result)
-			{
-				*result = NULL;
-			}
-			return 0;
-		}
+/**
+ *  @name   updateUserBrent
+ *
+ *  @brief  Changes a user's password in place.
+ *
+ *  @param  [in,out] ht          [\b HashTable*]   Table to modify.
+ *  @param  [in]     username    [\b const char*]  Null-terminated username key.
+ *  @param  [in]     newPassword [\b const char*]  New password (truncated to 49 chars).
+ *
+ *  @retval [\b int] 1 if the user was updated; 0 if absent or on invalid args.
+ *
+ *  @details
+ *  The key does not change, so no slot moves and pointers stay valid.
+ */
+int updateUserBrent(HashTable* ht, const char* username, const char* newPassword)
+{
+	User* user = NULL;
+	if (!newPassword || !findUserBrent(ht, username, &user))
+	{
+		return 0;
+	}
 
-		if (strcmp(ht->table[probeIndex]->username, username) == 0)
-		{
-			if (result)
-			{
-				*result = ht->table[probeIndex];
-			}
-			return 1;
-		}
+	strncpy(user->password, newPassword, sizeof(user->password) - 1);
+	user->password[sizeof(user->password) - 1] = '\0';
+	return 1;
+}
+
+/**
+ *  @name   getUserAtBrent
+ *
+ *  @brief  Returns the user stored at a given position of the slab.
+ *
+ *  @param  [in] ht    [\b const HashTable*]  Table to read.
+ *  @param  [in] index [\b unsigned int]      0-based position in insertion order.
+ *
+ *  @retval [\b User*] The record, or NULL if @p index >= count.
+ *
+ *  @details
+ *  Lets callers walk every user in insertion order without scanning the
+ *  (mostly empty) slot array.
+ */
+User* getUserAtBrent(const HashTable* ht, unsigned int index)
+{
+	if (!ht)
+	{
+		return NULL;
 	}
+	return UserBrentTable(const_cast<HashTable*>(ht)).at(index);
+}
 
-	if (result)
+/**
+ *  @name   averageProbeLengthBrent
+ *
+ *  @brief  Average number of probes for a successful lookup over all users.
+ *
+ *  @param  [in] ht [\b const HashTable*]  Table to inspect.
+ *
+ *  @retval [\b double] Mean probe count; 0.0 for an empty or invalid table.
+ *
+ *  @details
+ *  Diagnostic used by tests and benchmarks. Brent's method keeps this value
+ *  below about 2.5 even when the table is almost full.
+ *
+ *  @complexity O(count * average probe length)
+ */
+double averageProbeLengthBrent(const HashTable* ht)
+{
+	if (!ht)
 	{
-		*result = NULL;
+		return 0.0;
 	}
-	return 0;
-}
\ No newline at end of file
+	return UserBrentTable(const_cast<HashTable*>(ht)).averageProbeLength();
+}
+
+/**
+ *  @name   memoryUsageBrent
+ *
+ *  @brief  Bytes of heap memory owned by the table.
+ *
+ *  @param  [in] ht [\b const HashTable*]  Table to inspect.
+ *
+ *  @retval [\b size_t] Slot array + slab chunks + chunk directory, in bytes.
+ */
+size_t memoryUsageBrent(const HashTable* ht)
+{
+	if (!ht)
+	{
+		return 0;
+	}
+	return UserBrentTable(const_cast<HashTable*>(ht)).memoryUsage();
+}
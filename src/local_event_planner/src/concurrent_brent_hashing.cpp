@@ -0,0 +1,543 @@
+﻿#include "../header/concurrent_brent_hashing.h"
+#include <thread>
+
+/**
+ *  @name   concurrentShardIndex
+ *
+ *  @brief  Picks the shard that owns a hash value.
+ *
+ *  @param  [in] hashValue [\b uint64_t]  Output of hashUsername().
+ *
+ *  @retval [\b unsigned int] Shard index in [0, CONCURRENT_BRENT_SHARDS).
+ *
+ *  @details
+ *  Uses the top bits of the hash. The home slot comes from the low bits and
+ *  the probe step from the low bits of the fingerprint, so shard choice does
+ *  not bias placement inside a shard.
+ */
+static unsigned int concurrentShardIndex(uint64_t hashValue)
+{
+	return (unsigned int)(hashValue >> (64 - CONCURRENT_BRENT_SHARD_BITS));
+}
+
+/**
+ *  @name   concurrentSlotWord
+ *
+ *  @brief  Packs a slot into the word readers load in one access.
+ */
+static inline uint64_t concurrentSlotWord(uint32_t fingerprint, uint32_t record)
+{
+	return ((uint64_t)fingerprint << 32) | record;
+}
+
+static inline uint32_t concurrentSlotRecord(uint64_t word)
+{
+	return (uint32_t)word;
+}
+
+static inline uint32_t concurrentSlotFingerprint(uint64_t word)
+{
+	return (uint32_t)(word >> 32);
+}
+
+/**
+ *  @name   allocateSlotArray
+ *
+ *  @brief  Allocates a zeroed slot array carrying its own capacity.
+ *
+ *  @param  [in] capacity [\b unsigned int]  Power-of-two slot count.
+ *
+ *  @retval [\b ConcurrentSlotArray*] New array, or NULL on allocation failure.
+ *
+ *  @details
+ *  Keeping the capacity inside the allocation means a reader that loads the
+ *  array pointer always gets a matching mask, even while a writer grows it.
+ *  Zeroed memory is a valid array of empty lock-free atomic words.
+ */
+static ConcurrentSlotArray* allocateSlotArray(unsigned int capacity)
+{
+	return (ConcurrentSlotArray*)calloc(1, sizeof(ConcurrentSlotArray) + (capacity - 1) * sizeof(std::atomic<uint64_t>));
+}
+
+/**
+ *  @name   allocateChunkDirectory
+ *
+ *  @brief  Allocates a zeroed chunk directory carrying its own capacity.
+ *
+ *  @param  [in] capacity [\b unsigned int]  Number of chunk pointers.
+ *
+ *  @retval [\b ConcurrentChunkDirectory*] New directory, or NULL on allocation failure.
+ */
+static ConcurrentChunkDirectory* allocateChunkDirectory(unsigned int capacity)
+{
+	ConcurrentChunkDirectory* directory = (ConcurrentChunkDirectory*)calloc(1, sizeof(ConcurrentChunkDirectory) + (capacity - 1) * sizeof(User*));
+	if (directory)
+	{
+		directory->capacity = capacity;
+	}
+	return directory;
+}
+
+/**
+ *  @name   probeShard
+ *
+ *  @brief  Brent lookup against one published snapshot of a shard.
+ *
+ *  @param  [in]  slots     [\b const ConcurrentSlotArray*]       Slot array in use.
+ *  @param  [in]  directory [\b const ConcurrentChunkDirectory*]  Chunk directory in use.
+ *  @param  [in]  username  [\b const char*]                      Key to find.
+ *  @param  [in]  hashValue [\b uint64_t]                         hashUsername(username).
+ *  @param  [out] result    [\b User*]                            If non-NULL, receives a copy.
+ *
+ *  @retval [\b int] 1 if found, 0 if absent, -1 if the snapshot is torn
+ *          (a slot points past the directory the caller loaded).
+ *
+ *  @details
+ *  May run concurrently with a writer. Slot words are atomic, and a slot
+ *  is loaded with acquire order, so a record it names was fully written
+ *  before the reader copies it; published records never change. Every
+ *  read stays inside arrays that are never freed before
+ *  destroyConcurrentHashTable(), so a probe racing a slot move yields a
+ *  wrong answer at worst, which the caller's sequence check throws away.
+ */
+static int probeShard(const ConcurrentSlotArray* slots, const ConcurrentChunkDirectory* directory,
+	const char* username, uint64_t hashValue, User* result)
+{
+	unsigned int mask = slots->capacity - 1;
+	uint32_t fingerprint = brentFingerprint(hashValue);
+	unsigned int probeIndex = brentHomeIndex(hashValue, mask);
+	unsigned int step = brentProbeStep(fingerprint, mask);
+
+	for (unsigned int i = 0; i < slots->capacity; i++)
+	{
+		uint64_t slot = slots->slots[probeIndex].load(std::memory_order_acquire);
+
+		if (concurrentSlotRecord(slot) == 0)
+		{
+			return 0;
+		}
+
+		if (concurrentSlotFingerprint(slot) == fingerprint)
+		{
+			uint32_t index = concurrentSlotRecord(slot) - 1;
+			unsigned int chunkIndex = index >> BRENT_USERS_PER_CHUNK_SHIFT;
+			if (chunkIndex >= directory->capacity || !directory->chunks[chunkIndex])
+			{
+				return -1;
+			}
+
+			const User* user = &directory->chunks[chunkIndex][index & (BRENT_USERS_PER_CHUNK - 1)];
+			if (strncmp(user->username, username, sizeof(user->username)) == 0)
+			{
+				if (result)
+				{
+					*result = *user;
+				}
+				return 1;
+			}
+		}
+		probeIndex = (probeIndex + step) & mask;
+	}
+	return 0;
+}
+
+/**
+ *  @name   placeRecordConcurrent
+ *
+ *  @brief  Brent placement over atomic slot words.
+ *
+ *  @param  [in,out] slots     [\b ConcurrentSlotArray*]  Array owned by the caller's write lock.
+ *  @param  [in]     record    [\b uint32_t]              1-based slab index of the record to place.
+ *  @param  [in]     hashValue [\b uint64_t]              hashUsername() of the record's key.
+ *
+ *  @retval [\b int] 1 on success; 0 if every slot is occupied.
+ *
+ *  @details
+ *  The same reorganization as brentPlaceRecord(), minus tombstones, which
+ *  a table without deletes never has. Slots are read relaxed since only
+ *  the lock holder writes them, and written with release order so lock-free
+ *  readers that see a slot also see its record. A moved occupant is
+ *  stored at its new slot before its old one is overwritten.
+ */
+static int placeRecordConcurrent(ConcurrentSlotArray* slots, uint32_t record, uint64_t hashValue)
+{
+	unsigned int capacity = slots->capacity;
+	unsigned int mask = capacity - 1;
+	unsigned int index = brentHomeIndex(hashValue, mask);
+	uint32_t fingerprint = brentFingerprint(hashValue);
+	unsigned int step = brentProbeStep(fingerprint, mask);
+
+	unsigned int s = 0;
+	unsigned int emptyIndex = index;
+	while (concurrentSlotRecord(slots->slots[emptyIndex].load(std::memory_order_relaxed)) != 0)
+	{
+		if (++s >= capacity)
+		{
+			return 0;
+		}
+		emptyIndex = (emptyIndex + step) & mask;
+	}
+
+	for (unsigned int total = 1; total < s; total++)
+	{
+		unsigned int chainIndex = index;
+		for (unsigned int i = 0; i < total; i++)
+		{
+			uint64_t occupant = slots->slots[chainIndex].load(std::memory_order_relaxed);
+			unsigned int occupantStep = brentProbeStep(concurrentSlotFingerprint(occupant), mask);
+			unsigned int target = (chainIndex + (total - i) * occupantStep) & mask;
+
+			if (concurrentSlotRecord(slots->slots[target].load(std::memory_order_relaxed)) == 0)
+			{
+				slots->slots[target].store(occupant, std::memory_order_release);
+				slots->slots[chainIndex].store(concurrentSlotWord(fingerprint, record), std::memory_order_release);
+				return 1;
+			}
+			chainIndex = (chainIndex + step) & mask;
+		}
+	}
+
+	slots->slots[emptyIndex].store(concurrentSlotWord(fingerprint, record), std::memory_order_release);
+	return 1;
+}
+
+/**
+ *  @name   growShardSlots
+ *
+ *  @brief  Rebuilds a shard's slot array at twice the capacity.
+ *
+ *  @param  [in,out] shard [\b ConcurrentBrentShard*]  Shard whose write lock is held.
+ *
+ *  @retval [\b int] 1 on success; 0 on allocation failure or overflow.
+ *
+ *  @details
+ *  The new array is filled off to the side and published with one atomic
+ *  store, so readers see either the old or the new array, both complete.
+ *  The old array is chained as retired instead of being freed because a
+ *  reader may still be probing it.
+ */
+static int growShardSlots(ConcurrentBrentShard* shard)
+{
+	ConcurrentSlotArray* current = shard->slots.load(std::memory_order_relaxed);
+	ConcurrentChunkDirectory* directory = shard->directory.load(std::memory_order_relaxed);
+	if (current->capacity > (UINT_MAX >> 1))
+	{
+		return 0;
+	}
+
+	unsigned int capacity = current->capacity << 1;
+	ConcurrentSlotArray* grown = allocateSlotArray(capacity);
+	if (!grown)
+	{
+		return 0;
+	}
+	grown->capacity = capacity;
+
+	unsigned int count = shard->count.load(std::memory_order_relaxed);
+	for (uint32_t record = 1; record <= count; record++)
+	{
+		uint32_t index = record - 1;
+		const User* user = &directory->chunks[index >> BRENT_USERS_PER_CHUNK_SHIFT][index & (BRENT_USERS_PER_CHUNK - 1)];
+		placeRecordConcurrent(grown, record, hashUsername(user->username));
+	}
+
+	grown->retired = current;
+	shard->slots.store(grown, std::memory_order_release);
+	return 1;
+}
+
+/**
+ *  @name   reserveShardRecord
+ *
+ *  @brief  Makes sure the shard's slab has room for one more user.
+ *
+ *  @param  [in,out] shard [\b ConcurrentBrentShard*]  Shard whose write lock is held.
+ *
+ *  @retval [\b int] 1 on success; 0 on allocation failure.
+ *
+ *  @details
+ *  Chunks never move. When the directory itself is full it is copied into
+ *  one twice the size, published atomically, and the old one is retired.
+ */
+static int reserveShardRecord(ConcurrentBrentShard* shard)
+{
+	unsigned int chunkIndex = shard->count.load(std::memory_order_relaxed) >> BRENT_USERS_PER_CHUNK_SHIFT;
+	if (chunkIndex < shard->chunkCount)
+	{
+		return 1;
+	}
+
+	ConcurrentChunkDirectory* directory = shard->directory.load(std::memory_order_relaxed);
+	if (chunkIndex >= directory->capacity)
+	{
+		ConcurrentChunkDirectory* grown = allocateChunkDirectory(directory->capacity << 1);
+		if (!grown)
+		{
+			return 0;
+		}
+		memcpy(grown->chunks, directory->chunks, directory->capacity * sizeof(User*));
+		grown->retired = directory;
+		shard->directory.store(grown, std::memory_order_release);
+		directory = grown;
+	}
+
+	User* chunk = (User*)malloc(BRENT_USERS_PER_CHUNK * sizeof(User));
+	if (!chunk)
+	{
+		return 0;
+	}
+	directory->chunks[chunkIndex] = chunk;
+	shard->chunkCount = chunkIndex + 1;
+	return 1;
+}
+
+/**
+ *  @name   initConcurrentHashTable
+ *
+ *  @brief  Initializes a sharded Brent table for concurrent use.
+ *
+ *  @param  [out] ct            [\b ConcurrentHashTable*]  Table to initialize.
+ *  @param  [in]  maxLoadFactor [\b float]                 Per-shard growth threshold in (0, 1].
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments or allocation failure.
+ *
+ *  @details
+ *  Each of the CONCURRENT_BRENT_SHARDS shards is an independent Brent table
+ *  with its own slab, writer mutex and sequence counter. Inserts on
+ *  different shards never contend; lookups take no lock at all.
+ *
+ *  @warning Must not be called while other threads use @p ct.
+ */
+int initConcurrentHashTable(ConcurrentHashTable* ct, float maxLoadFactor)
+{
+	if (!ct || maxLoadFactor <= 0.0f || maxLoadFactor > 1.0f)
+	{
+		return 0;
+	}
+
+	ct->maxLoadFactor = maxLoadFactor;
+	for (unsigned int i = 0; i < CONCURRENT_BRENT_SHARDS; i++)
+	{
+		ConcurrentBrentShard* shard = &ct->shards[i];
+		shard->sequence.store(0);
+		shard->count.store(0);
+		shard->chunkCount = 0;
+
+		ConcurrentSlotArray* slots = allocateSlotArray(CONCURRENT_BRENT_INITIAL_CAPACITY);
+		if (slots)
+		{
+			slots->capacity = CONCURRENT_BRENT_INITIAL_CAPACITY;
+		}
+		shard->slots.store(slots);
+		shard->directory.store(allocateChunkDirectory(CONCURRENT_BRENT_INITIAL_CHUNKS));
+	}
+
+	for (unsigned int i = 0; i < CONCURRENT_BRENT_SHARDS; i++)
+	{
+		if (!ct->shards[i].slots.load() || !ct->shards[i].directory.load())
+		{
+			destroyConcurrentHashTable(ct);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   destroyConcurrentHashTable
+ *
+ *  @brief  Frees every slab chunk, slot array and directory, retired ones included.
+ *
+ *  @param  [in,out] ct [\b ConcurrentHashTable*]  Table to release.
+ *
+ *  @warning Must not be called while other threads use @p ct.
+ */
+void destroyConcurrentHashTable(ConcurrentHashTable* ct)
+{
+	if (!ct)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < CONCURRENT_BRENT_SHARDS; i++)
+	{
+		ConcurrentBrentShard* shard = &ct->shards[i];
+
+		ConcurrentChunkDirectory* directory = shard->directory.load();
+		for (unsigned int c = 0; directory && c < shard->chunkCount; c++)
+		{
+			free(directory->chunks[c]);
+		}
+		while (directory)
+		{
+			ConcurrentChunkDirectory* retired = directory->retired;
+			free(directory);
+			directory = retired;
+		}
+
+		ConcurrentSlotArray* slots = shard->slots.load();
+		while (slots)
+		{
+			ConcurrentSlotArray* retired = slots->retired;
+			free(slots);
+			slots = retired;
+		}
+
+		shard->slots.store(NULL);
+		shard->directory.store(NULL);
+		shard->count.store(0);
+		shard->chunkCount = 0;
+	}
+}
+
+/**
+ *  @name   insertUserConcurrent
+ *
+ *  @brief  Registers a user; safe to call from many threads at once.
+ *
+ *  @param  [in,out] ct         [\b ConcurrentHashTable*]  Initialized table.
+ *  @param  [in]     username   [\b const char*]           Username (truncated to 49 chars).
+ *  @param  [in]     password   [\b const char*]           Password (truncated to 49 chars).
+ *  @param  [out]    assignedID [\b int*]                  If non-NULL, receives the new ID.
+ *
+ *  @retval [\b int] 1 on success; 0 if the name exists, @c forceFailure is
+ *          set or memory runs out.
+ *
+ *  @details
+ *  Takes only the owning shard's mutex. The ID comes from allocateUserID()
+ *  after the duplicate check, so rejected names do not burn IDs. The user
+ *  is written into its slab slot before any table slot references it; only
+ *  the Brent placement, which may move one existing slot, runs inside the
+ *  odd sequence window that lookups validate against.
+ */
+int insertUserConcurrent(ConcurrentHashTable* ct, const char* username, const char* password, int* assignedID)
+{
+	if (forceFailure || !ct || !username || !password)
+	{
+		return 0;
+	}
+
+	User user;
+	strncpy(user.username, username, sizeof(user.username) - 1);
+	user.username[sizeof(user.username) - 1] = '\0';
+	strncpy(user.password, password, sizeof(user.password) - 1);
+	user.password[sizeof(user.password) - 1] = '\0';
+
+	uint64_t hashValue = hashUsername(user.username);
+	ConcurrentBrentShard* shard = &ct->shards[concurrentShardIndex(hashValue)];
+	std::lock_guard<std::mutex> guard(shard->writeLock);
+
+	if (probeShard(shard->slots.load(std::memory_order_relaxed), shard->directory.load(std::memory_order_relaxed),
+		user.username, hashValue, NULL) == 1)
+	{
+		return 0;
+	}
+
+	unsigned int count = shard->count.load(std::memory_order_relaxed);
+	ConcurrentSlotArray* slots = shard->slots.load(std::memory_order_relaxed);
+	if ((double)(count + 1) > (double)slots->capacity * ct->maxLoadFactor)
+	{
+		if (!growShardSlots(shard) && count >= slots->capacity)
+		{
+			return 0;
+		}
+		slots = shard->slots.load(std::memory_order_relaxed);
+	}
+	if (!reserveShardRecord(shard))
+	{
+		return 0;
+	}
+
+	user.id = allocateUserID();
+	uint32_t record = count + 1;
+	ConcurrentChunkDirectory* directory = shard->directory.load(std::memory_order_relaxed);
+	directory->chunks[count >> BRENT_USERS_PER_CHUNK_SHIFT][count & (BRENT_USERS_PER_CHUNK - 1)] = user;
+
+	unsigned int sequence = shard->sequence.load(std::memory_order_relaxed);
+	shard->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	int placed = placeRecordConcurrent(slots, record, hashValue);
+	shard->sequence.store(sequence + 2, std::memory_order_release);
+
+	if (!placed)
+	{
+		return 0;
+	}
+	shard->count.store(record, std::memory_order_release);
+	if (assignedID)
+	{
+		*assignedID = user.id;
+	}
+	return 1;
+}
+
+/**
+ *  @name   findUserConcurrent
+ *
+ *  @brief  Lock-free lookup validated by the shard's sequence counter.
+ *
+ *  @param  [in]  ct       [\b ConcurrentHashTable*]  Initialized table.
+ *  @param  [in]  username [\b const char*]           Key to look up.
+ *  @param  [out] result   [\b User*]                 If non-NULL, receives a copy of the record.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ *
+ *  @details
+ *  Seqlock read: load an even sequence, probe, re-check the sequence and
+ *  retry if a writer moved slots in between. The record is copied out
+ *  rather than returned by pointer so the caller never holds a reference
+ *  into memory another thread may be writing.
+ */
+int findUserConcurrent(ConcurrentHashTable* ct, const char* username, User* result)
+{
+	if (!ct || !username)
+	{
+		return 0;
+	}
+
+	uint64_t hashValue = hashUsername(username);
+	ConcurrentBrentShard* shard = &ct->shards[concurrentShardIndex(hashValue)];
+	User copy;
+
+	while (true)
+	{
+		unsigned int before = shard->sequence.load(std::memory_order_acquire);
+		if (before & 1u)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		int found = probeShard(shard->slots.load(std::memory_order_acquire), shard->directory.load(std::memory_order_acquire),
+			username, hashValue, &copy);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (found >= 0 && shard->sequence.load(std::memory_order_relaxed) == before)
+		{
+			if (found && result)
+			{
+				*result = copy;
+			}
+			return found;
+		}
+	}
+}
+
+/**
+ *  @name   countUsersConcurrent
+ *
+ *  @brief  Sums the shard counts.
+ *
+ *  @param  [in] ct [\b ConcurrentHashTable*]  Initialized table.
+ *
+ *  @retval [\b unsigned int] Number of users; a snapshot while inserts are running.
+ */
+unsigned int countUsersConcurrent(ConcurrentHashTable* ct)
+{
+	unsigned int total = 0;
+	for (unsigned int i = 0; ct && i < CONCURRENT_BRENT_SHARDS; i++)
+	{
+		total += ct->shards[i].count.load(std::memory_order_acquire);
+	}
+	return total;
+}
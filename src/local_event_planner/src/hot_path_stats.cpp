@@ -0,0 +1,313 @@
+#include "../header/hot_path_stats.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+static const char* const counterNames[HOT_PATH_COUNTER_COUNT] = {
+	"lookups",
+	"lookup_hits",
+	"lookup_probes",
+	"inserts",
+	"insert_collisions",
+	"insert_failures",
+	"deletes",
+	"resizes",
+	"file_loads",
+	"file_saves",
+	"file_failures",
+	"bytes_read",
+	"bytes_written",
+	"logins",
+	"login_failures"
+};
+
+static const char* const histogramNames[HOT_PATH_HISTOGRAM_COUNT] = {
+	"probe_length",
+	"login_ns",
+	"load_ns",
+	"save_ns"
+};
+
+/**
+ *  @name   HotPathRegistry
+ *
+ *  @brief  Every live thread's counter block plus the totals of finished threads.
+ *
+ *  @details
+ *  Only registration, thread exit, snapshots and resets take the lock;
+ *  the counters themselves are written lock-free by their owning thread.
+ */
+struct HotPathRegistry {
+	std::mutex lock;
+	std::vector<HotPathThreadStats*> threads;
+	HotPathStats retired;
+};
+
+static HotPathRegistry& hotPathRegistry()
+{
+	static HotPathRegistry* registry = new HotPathRegistry(); // never destroyed: threads may exit during static destruction
+	return *registry;
+}
+
+static void clearThreadStats(HotPathThreadStats* local)
+{
+	for (int c = 0; c < HOT_PATH_COUNTER_COUNT; c++)
+	{
+		local->counters[c].store(0, std::memory_order_relaxed);
+	}
+	for (int h = 0; h < HOT_PATH_HISTOGRAM_COUNT; h++)
+	{
+		for (int b = 0; b < HOT_PATH_HISTOGRAM_BUCKETS; b++)
+		{
+			local->buckets[h][b].store(0, std::memory_order_relaxed);
+		}
+		local->sums[h].store(0, std::memory_order_relaxed);
+	}
+}
+
+static void addThreadStats(HotPathStats* total, const HotPathThreadStats* local)
+{
+	for (int c = 0; c < HOT_PATH_COUNTER_COUNT; c++)
+	{
+		total->counters[c] += local->counters[c].load(std::memory_order_relaxed);
+	}
+	for (int h = 0; h < HOT_PATH_HISTOGRAM_COUNT; h++)
+	{
+		for (int b = 0; b < HOT_PATH_HISTOGRAM_BUCKETS; b++)
+		{
+			total->buckets[h][b] += local->buckets[h][b].load(std::memory_order_relaxed);
+		}
+		total->sums[h] += local->sums[h].load(std::memory_order_relaxed);
+	}
+}
+
+/**
+ *  @name   HotPathThreadSlot
+ *
+ *  @brief  Owns the calling thread's block and folds it into the totals at exit.
+ */
+struct HotPathThreadSlot {
+	HotPathThreadStats stats;
+
+	HotPathThreadSlot()
+	{
+		clearThreadStats(&stats);
+		HotPathRegistry& registry = hotPathRegistry();
+		std::lock_guard<std::mutex> guard(registry.lock);
+		registry.threads.push_back(&stats);
+	}
+
+	~HotPathThreadSlot()
+	{
+		HotPathRegistry& registry = hotPathRegistry();
+		std::lock_guard<std::mutex> guard(registry.lock);
+		addThreadStats(&registry.retired, &stats);
+		for (size_t i = 0; i < registry.threads.size(); i++)
+		{
+			if (registry.threads[i] == &stats)
+			{
+				registry.threads[i] = registry.threads.back();
+				registry.threads.pop_back();
+				break;
+			}
+		}
+	}
+};
+
+/**
+ *  @name   hotPathThreadStats
+ *
+ *  @brief  Counter block of the calling thread, registered on first use.
+ *
+ *  @retval [\b HotPathThreadStats*] Block only the calling thread writes.
+ */
+HotPathThreadStats* hotPathThreadStats()
+{
+	static thread_local HotPathThreadSlot slot;
+	return &slot.stats;
+}
+
+/**
+ *  @name   hotPathNanos
+ *
+ *  @brief  Monotonic clock reading for latency histograms.
+ *
+ *  @retval [\b uint64_t] Nanoseconds since an arbitrary epoch.
+ */
+uint64_t hotPathNanos()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ *  @name   snapshotHotPathStats
+ *
+ *  @brief  Sums the counters of every thread, finished threads included.
+ *
+ *  @param  [out] stats [\b HotPathStats*]  Receives the totals.
+ *
+ *  @details
+ *  Threads keep counting while the snapshot is taken, so counters read
+ *  late may include a few operations more than counters read early. When
+ *  built without ENABLE_HOT_PATH_STATS every value is 0 and
+ *  @c enabled is false.
+ *
+ *  @complexity O(threads * (counters + histogram buckets))
+ */
+void snapshotHotPathStats(HotPathStats* stats)
+{
+	if (!stats)
+	{
+		return;
+	}
+	memset(stats, 0, sizeof(*stats));
+#if defined(ENABLE_HOT_PATH_STATS)
+	HotPathRegistry& registry = hotPathRegistry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	*stats = registry.retired;
+	stats->enabled = true;
+	for (size_t i = 0; i < registry.threads.size(); i++)
+	{
+		addThreadStats(stats, registry.threads[i]);
+	}
+#endif
+}
+
+/**
+ *  @name   resetHotPathStats
+ *
+ *  @brief  Zeroes the counters of every thread.
+ *
+ *  @warning Increments racing with the reset may survive it.
+ */
+void resetHotPathStats()
+{
+	HotPathRegistry& registry = hotPathRegistry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	memset(&registry.retired, 0, sizeof(registry.retired));
+	for (size_t i = 0; i < registry.threads.size(); i++)
+	{
+		clearThreadStats(registry.threads[i]);
+	}
+}
+
+/**
+ *  @name   hotPathHistogramCount
+ *
+ *  @brief  Number of values recorded in a histogram.
+ */
+uint64_t hotPathHistogramCount(const HotPathStats* stats, HotPathHistogram histogram)
+{
+	uint64_t count = 0;
+	for (int b = 0; b < HOT_PATH_HISTOGRAM_BUCKETS; b++)
+	{
+		count += stats->buckets[histogram][b];
+	}
+	return count;
+}
+
+/**
+ *  @name   hotPathHistogramPercentile
+ *
+ *  @brief  Upper bound of the bucket holding a given fraction of the values.
+ *
+ *  @param  [in] stats     [\b const HotPathStats*]  Snapshot to read.
+ *  @param  [in] histogram [\b HotPathHistogram]     Histogram to read.
+ *  @param  [in] fraction  [\b double]               E.g. 0.5 for the median, 0.99 for p99.
+ *
+ *  @retval [\b uint64_t] Largest value bucket b can hold (2^b - 1); 0 for an empty histogram.
+ *
+ *  @details
+ *  Log buckets bound the answer within a factor of two, which is what the
+ *  counters are for: spotting a probe chain or a latency that doubled.
+ */
+uint64_t hotPathHistogramPercentile(const HotPathStats* stats, HotPathHistogram histogram, double fraction)
+{
+	uint64_t count = hotPathHistogramCount(stats, histogram);
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)(fraction * (double)count);
+	rank = rank < 1 ? 1 : (rank > count ? count : rank);
+	uint64_t seen = 0;
+	for (int b = 0; b < HOT_PATH_HISTOGRAM_BUCKETS; b++)
+	{
+		seen += stats->buckets[histogram][b];
+		if (seen >= rank)
+		{
+			return b == 0 ? 0 : (b >= 64 ? UINT64_MAX : (((uint64_t)1 << b) - 1));
+		}
+	}
+	return UINT64_MAX;
+}
+
+const char* hotPathCounterName(HotPathCounter counter)
+{
+	return (int)counter >= 0 && counter < HOT_PATH_COUNTER_COUNT ? counterNames[counter] : "unknown";
+}
+
+const char* hotPathHistogramName(HotPathHistogram histogram)
+{
+	return (int)histogram >= 0 && histogram < HOT_PATH_HISTOGRAM_COUNT ? histogramNames[histogram] : "unknown";
+}
+
+/**
+ *  @name   writeHotPathStatsJson
+ *
+ *  @brief  Dumps a snapshot and the table's gauges as one JSON object.
+ *
+ *  @param  [in] out   [\b FILE*]                 Destination stream.
+ *  @param  [in] stats [\b const HotPathStats*]   Snapshot from snapshotHotPathStats().
+ *  @param  [in] ht    [\b const HashTable*]      Table whose load factor etc. to include, or NULL.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments or a write error.
+ *
+ *  @details
+ *  Histograms list only non-empty buckets as [upper bound, count] pairs,
+ *  next to their count, sum, p50 and p99. The table gauges are read at
+ *  dump time and are available even without ENABLE_HOT_PATH_STATS.
+ */
+int writeHotPathStatsJson(FILE* out, const HotPathStats* stats, const HashTable* ht)
+{
+	if (!out || !stats)
+	{
+		return 0;
+	}
+
+	fprintf(out, "{\"enabled\":%s,\"counters\":{", stats->enabled ? "true" : "false");
+	for (int c = 0; c < HOT_PATH_COUNTER_COUNT; c++)
+	{
+		fprintf(out, "%s\"%s\":%llu", c ? "," : "", counterNames[c], (unsigned long long)stats->counters[c]);
+	}
+
+	fprintf(out, "},\"histograms\":{");
+	for (int h = 0; h < HOT_PATH_HISTOGRAM_COUNT; h++)
+	{
+		HotPathHistogram histogram = (HotPathHistogram)h;
+		fprintf(out, "%s\"%s\":{\"count\":%llu,\"sum\":%llu,\"p50\":%llu,\"p99\":%llu,\"buckets\":[", h ? "," : "", histogramNames[h],
+			(unsigned long long)hotPathHistogramCount(stats, histogram), (unsigned long long)stats->sums[h],
+			(unsigned long long)hotPathHistogramPercentile(stats, histogram, 0.5), (unsigned long long)hotPathHistogramPercentile(stats, histogram, 0.99));
+		bool first = true;
+		for (int b = 0; b < HOT_PATH_HISTOGRAM_BUCKETS; b++)
+		{
+			if (stats->buckets[h][b] != 0)
+			{
+				fprintf(out, "%s[%llu,%llu]", first ? "" : ",", b == 0 ? 0ull : (unsigned long long)(((uint64_t)1 << b) - 1), (unsigned long long)stats->buckets[h][b]);
+				first = false;
+			}
+		}
+		fprintf(out, "]}");
+	}
+	fprintf(out, "}");
+
+	if (ht && ht->table)
+	{
+		fprintf(out, ",\"table\":{\"capacity\":%u,\"count\":%u,\"tombstones\":%u,\"load_factor\":%.4f,\"max_load_factor\":%.2f,\"average_probe_length\":%.3f,\"memory_bytes\":%llu}",
+			ht->capacity, ht->count, ht->tombstones, ht->capacity ? (double)ht->count / ht->capacity : 0.0, ht->maxLoadFactor,
+			averageProbeLengthBrent(ht), (unsigned long long)memoryUsageBrent(ht));
+	}
+	fprintf(out, "}\n");
+	return !ferror(out);
+}
@@ -0,0 +1,784 @@
+#include "../header/id_set.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ *  @name   popcount64
+ *
+ *  @brief  Number of set bits in a word.
+ */
+static inline uint32_t popcount64(uint64_t word)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)__popcnt64(word);
+#else
+	return (uint32_t)__builtin_popcountll(word);
+#endif
+}
+
+/**
+ *  @name   trailingZeros64
+ *
+ *  @brief  Index of the lowest set bit of a non-zero word.
+ */
+static inline uint32_t trailingZeros64(uint64_t word)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(word);
+#endif
+}
+
+static bool containerKeyLess(const IdSetContainer& container, uint16_t key)
+{
+	return container.key < key;
+}
+
+/**
+ *  @name   findContainer
+ *
+ *  @brief  Position of the container for @p key, or where it would be inserted.
+ */
+static size_t findContainer(const IdSet* set, uint16_t key)
+{
+	return std::lower_bound(set->containers.begin(), set->containers.end(), key, containerKeyLess) - set->containers.begin();
+}
+
+static bool isBitmap(const IdSetContainer& container)
+{
+	return !container.bitmap.empty();
+}
+
+static bool bitmapTest(const std::vector<uint64_t>& bitmap, uint16_t low)
+{
+	return (bitmap[low >> 6] >> (low & 63)) & 1;
+}
+
+/**
+ *  @name   convertToBitmap
+ *
+ *  @brief  Turns an array container into a bitmap container.
+ */
+static void convertToBitmap(IdSetContainer* container)
+{
+	container->bitmap.assign(ID_SET_BITMAP_WORDS, 0);
+	for (size_t i = 0; i < container->array.size(); i++)
+	{
+		container->bitmap[container->array[i] >> 6] |= 1ull << (container->array[i] & 63);
+	}
+	std::vector<uint16_t>().swap(container->array);
+}
+
+/**
+ *  @name   convertToArray
+ *
+ *  @brief  Turns a bitmap container with at most ID_SET_ARRAY_MAX ids back into an array.
+ */
+static void convertToArray(IdSetContainer* container)
+{
+	container->array.clear();
+	container->array.reserve(container->cardinality);
+	for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+	{
+		for (uint64_t bits = container->bitmap[word]; bits; bits &= bits - 1)
+		{
+			container->array.push_back((uint16_t)(word * 64 + trailingZeros64(bits)));
+		}
+	}
+	std::vector<uint64_t>().swap(container->bitmap);
+}
+
+/**
+ *  @name   normalizeContainer
+ *
+ *  @brief  Picks the cheaper representation for the container's cardinality.
+ */
+static void normalizeContainer(IdSetContainer* container)
+{
+	if (isBitmap(*container) && container->cardinality <= ID_SET_ARRAY_MAX)
+	{
+		convertToArray(container);
+	}
+	else if (!isBitmap(*container) && container->cardinality > ID_SET_ARRAY_MAX)
+	{
+		convertToBitmap(container);
+	}
+}
+
+/**
+ *  @name   idSetAdd
+ *
+ *  @brief  Adds an id.
+ *
+ *  @param  [in,out] set [\b IdSet*]    Set to modify.
+ *  @param  [in]     id  [\b uint32_t]  Id to add.
+ *
+ *  @retval [\b int] 1 if added; 0 if already present or @p set is NULL.
+ *
+ *  @details
+ *  Ids are split into a 16-bit container key and 16 low bits, as in
+ *  Roaring bitmaps. A container holds a sorted uint16_t array until it
+ *  exceeds ID_SET_ARRAY_MAX ids (8 KB) and a 65536-bit bitmap (8 KB)
+ *  after that, so each id costs at most two bytes and dense ranges cost
+ *  one bit per possible id.
+ */
+int idSetAdd(IdSet* set, uint32_t id)
+{
+	if (!set)
+	{
+		return 0;
+	}
+
+	uint16_t key = (uint16_t)(id >> 16), low = (uint16_t)id;
+	size_t position = findContainer(set, key);
+	if (position == set->containers.size() || set->containers[position].key != key)
+	{
+		IdSetContainer created;
+		created.key = key;
+		created.cardinality = 0;
+		set->containers.insert(set->containers.begin() + position, created);
+	}
+
+	IdSetContainer& container = set->containers[position];
+	if (isBitmap(container))
+	{
+		uint64_t& word = container.bitmap[low >> 6];
+		uint64_t bit = 1ull << (low & 63);
+		if (word & bit)
+		{
+			return 0;
+		}
+		word |= bit;
+	}
+	else
+	{
+		std::vector<uint16_t>::iterator it = std::lower_bound(container.array.begin(), container.array.end(), low);
+		if (it != container.array.end() && *it == low)
+		{
+			return 0;
+		}
+		container.array.insert(it, low);
+	}
+	container.cardinality++;
+	normalizeContainer(&container);
+	return 1;
+}
+
+/**
+ *  @name   idSetRemove
+ *
+ *  @brief  Removes an id; an emptied container is dropped.
+ *
+ *  @retval [\b int] 1 if removed; 0 if absent.
+ */
+int idSetRemove(IdSet* set, uint32_t id)
+{
+	if (!set)
+	{
+		return 0;
+	}
+
+	uint16_t key = (uint16_t)(id >> 16), low = (uint16_t)id;
+	size_t position = findContainer(set, key);
+	if (position == set->containers.size() || set->containers[position].key != key)
+	{
+		return 0;
+	}
+
+	IdSetContainer& container = set->containers[position];
+	if (isBitmap(container))
+	{
+		uint64_t& word = container.bitmap[low >> 6];
+		uint64_t bit = 1ull << (low & 63);
+		if (!(word & bit))
+		{
+			return 0;
+		}
+		word &= ~bit;
+	}
+	else
+	{
+		std::vector<uint16_t>::iterator it = std::lower_bound(container.array.begin(), container.array.end(), low);
+		if (it == container.array.end() || *it != low)
+		{
+			return 0;
+		}
+		container.array.erase(it);
+	}
+
+	if (--container.cardinality == 0)
+	{
+		set->containers.erase(set->containers.begin() + position);
+	}
+	else
+	{
+		normalizeContainer(&container);
+	}
+	return 1;
+}
+
+/**
+ *  @name   idSetContains
+ *
+ *  @brief  Membership test.
+ *
+ *  @complexity O(log c + log 4096) for c containers.
+ */
+int idSetContains(const IdSet* set, uint32_t id)
+{
+	if (!set)
+	{
+		return 0;
+	}
+
+	uint16_t key = (uint16_t)(id >> 16), low = (uint16_t)id;
+	size_t position = findContainer(set, key);
+	if (position == set->containers.size() || set->containers[position].key != key)
+	{
+		return 0;
+	}
+
+	const IdSetContainer& container = set->containers[position];
+	return isBitmap(container)
+		? bitmapTest(container.bitmap, low)
+		: std::binary_search(container.array.begin(), container.array.end(), low);
+}
+
+/**
+ *  @name   idSetCardinality
+ *
+ *  @brief  Number of ids, from the per-container counts.
+ */
+size_t idSetCardinality(const IdSet* set)
+{
+	size_t total = 0;
+	for (size_t i = 0; set && i < set->containers.size(); i++)
+	{
+		total += set->containers[i].cardinality;
+	}
+	return total;
+}
+
+/**
+ *  @name   idSetClear
+ *
+ *  @brief  Removes every id and releases the containers.
+ */
+void idSetClear(IdSet* set)
+{
+	if (set)
+	{
+		std::vector<IdSetContainer>().swap(set->containers);
+	}
+}
+
+/**
+ *  @name   intersectArrays
+ *
+ *  @brief  Intersects two sorted arrays, binary-searching the larger one when sizes differ a lot.
+ *
+ *  @param  [out] out Receives the common values; may be NULL to only count them.
+ */
+static uint32_t intersectArrays(const std::vector<uint16_t>& left, const std::vector<uint16_t>& right, std::vector<uint16_t>* out)
+{
+	const std::vector<uint16_t>& small = left.size() <= right.size() ? left : right;
+	const std::vector<uint16_t>& large = left.size() <= right.size() ? right : left;
+	uint32_t count = 0;
+
+	if (small.size() * 32 < large.size())
+	{
+		std::vector<uint16_t>::const_iterator from = large.begin();
+		for (size_t i = 0; i < small.size() && from != large.end(); i++)
+		{
+			from = std::lower_bound(from, large.end(), small[i]);
+			if (from != large.end() && *from == small[i])
+			{
+				if (out)
+				{
+					out->push_back(small[i]);
+				}
+				count++;
+			}
+		}
+		return count;
+	}
+
+	size_t i = 0, j = 0;
+	while (i < small.size() && j < large.size())
+	{
+		if (small[i] < large[j])
+		{
+			i++;
+		}
+		else if (large[j] < small[i])
+		{
+			j++;
+		}
+		else
+		{
+			if (out)
+			{
+				out->push_back(small[i]);
+			}
+			count++;
+			i++;
+			j++;
+		}
+	}
+	return count;
+}
+
+/**
+ *  @name   intersectContainers
+ *
+ *  @brief  Intersects two containers with the same key.
+ *
+ *  @param  [out] out Receives the result; NULL to only count it.
+ *
+ *  @retval [\b uint32_t] Cardinality of the intersection.
+ */
+static uint32_t intersectContainers(const IdSetContainer& left, const IdSetContainer& right, IdSetContainer* out)
+{
+	if (!isBitmap(left) && !isBitmap(right))
+	{
+		return intersectArrays(left.array, right.array, out ? &out->array : NULL);
+	}
+
+	if (isBitmap(left) != isBitmap(right))
+	{
+		const IdSetContainer& array = isBitmap(left) ? right : left;
+		const IdSetContainer& bitmap = isBitmap(left) ? left : right;
+		uint32_t count = 0;
+		for (size_t i = 0; i < array.array.size(); i++)
+		{
+			if (bitmapTest(bitmap.bitmap, array.array[i]))
+			{
+				if (out)
+				{
+					out->array.push_back(array.array[i]);
+				}
+				count++;
+			}
+		}
+		return count;
+	}
+
+	uint32_t count = 0;
+	if (!out)
+	{
+		for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+		{
+			count += popcount64(left.bitmap[word] & right.bitmap[word]);
+		}
+		return count;
+	}
+
+	out->bitmap.resize(ID_SET_BITMAP_WORDS);
+	for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+	{
+		out->bitmap[word] = left.bitmap[word] & right.bitmap[word];
+		count += popcount64(out->bitmap[word]);
+	}
+	out->cardinality = count;
+	if (count > 0 && count <= ID_SET_ARRAY_MAX)
+	{
+		convertToArray(out);
+	}
+	return count;
+}
+
+/**
+ *  @name   unionContainers
+ *
+ *  @brief  Merges @p other into @p target (same key).
+ */
+static void unionContainers(IdSetContainer* target, const IdSetContainer& other)
+{
+	if (!isBitmap(*target) && !isBitmap(other))
+	{
+		std::vector<uint16_t> merged;
+		merged.reserve(target->array.size() + other.array.size());
+		std::set_union(target->array.begin(), target->array.end(), other.array.begin(), other.array.end(), std::back_inserter(merged));
+		target->array.swap(merged);
+		target->cardinality = (uint32_t)target->array.size();
+		normalizeContainer(target);
+		return;
+	}
+
+	if (!isBitmap(*target))
+	{
+		convertToBitmap(target);
+	}
+
+	uint32_t count = 0;
+	if (isBitmap(other))
+	{
+		for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+		{
+			target->bitmap[word] |= other.bitmap[word];
+			count += popcount64(target->bitmap[word]);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < other.array.size(); i++)
+		{
+			target->bitmap[other.array[i] >> 6] |= 1ull << (other.array[i] & 63);
+		}
+		for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+		{
+			count += popcount64(target->bitmap[word]);
+		}
+	}
+	target->cardinality = count;
+}
+
+/**
+ *  @name   idSetUnionWith
+ *
+ *  @brief  Adds every id of @p other to @p target.
+ *
+ *  @details Containers are merged key by key in one pass over both sorted lists.
+ */
+void idSetUnionWith(IdSet* target, const IdSet* other)
+{
+	if (!target || !other || target == other)
+	{
+		return;
+	}
+
+	std::vector<IdSetContainer> merged;
+	merged.reserve(target->containers.size() + other->containers.size());
+	size_t i = 0, j = 0;
+	while (i < target->containers.size() || j < other->containers.size())
+	{
+		if (j == other->containers.size()
+			|| (i < target->containers.size() && target->containers[i].key < other->containers[j].key))
+		{
+			merged.push_back(IdSetContainer());
+			merged.back().key = target->containers[i].key;
+			merged.back().cardinality = target->containers[i].cardinality;
+			merged.back().array.swap(target->containers[i].array);
+			merged.back().bitmap.swap(target->containers[i].bitmap);
+			i++;
+		}
+		else if (i == target->containers.size() || other->containers[j].key < target->containers[i].key)
+		{
+			merged.push_back(other->containers[j++]);
+		}
+		else
+		{
+			merged.push_back(IdSetContainer());
+			merged.back().key = target->containers[i].key;
+			merged.back().cardinality = target->containers[i].cardinality;
+			merged.back().array.swap(target->containers[i].array);
+			merged.back().bitmap.swap(target->containers[i].bitmap);
+			unionContainers(&merged.back(), other->containers[j]);
+			i++;
+			j++;
+		}
+	}
+	target->containers.swap(merged);
+}
+
+/**
+ *  @name   idSetUnion
+ *
+ *  @brief  @p result = @p left ∪ @p right.
+ */
+void idSetUnion(const IdSet* left, const IdSet* right, IdSet* result)
+{
+	if (!left || !right || !result)
+	{
+		return;
+	}
+
+	IdSet merged = *left;
+	idSetUnionWith(&merged, right);
+	result->containers.swap(merged.containers);
+}
+
+/**
+ *  @name   idSetIntersection
+ *
+ *  @brief  @p result = @p left ∩ @p right.
+ *
+ *  @details Only containers whose keys appear in both sets are visited.
+ */
+void idSetIntersection(const IdSet* left, const IdSet* right, IdSet* result)
+{
+	if (!left || !right || !result)
+	{
+		return;
+	}
+
+	std::vector<IdSetContainer> common;
+	size_t i = 0, j = 0;
+	while (i < left->containers.size() && j < right->containers.size())
+	{
+		if (left->containers[i].key < right->containers[j].key)
+		{
+			i++;
+		}
+		else if (right->containers[j].key < left->containers[i].key)
+		{
+			j++;
+		}
+		else
+		{
+			IdSetContainer out;
+			out.key = left->containers[i].key;
+			out.cardinality = intersectContainers(left->containers[i], right->containers[j], &out);
+			if (out.cardinality > 0)
+			{
+				common.push_back(IdSetContainer());
+				common.back().key = out.key;
+				common.back().cardinality = out.cardinality;
+				common.back().array.swap(out.array);
+				common.back().bitmap.swap(out.bitmap);
+			}
+			i++;
+			j++;
+		}
+	}
+	result->containers.swap(common);
+}
+
+/**
+ *  @name   idSetIntersectionCardinality
+ *
+ *  @brief  |@p left ∩ @p right| without building the intersection.
+ *
+ *  @details Bitmap pairs reduce to AND + popcount over 1024 words.
+ */
+size_t idSetIntersectionCardinality(const IdSet* left, const IdSet* right)
+{
+	if (!left || !right)
+	{
+		return 0;
+	}
+
+	size_t count = 0, i = 0, j = 0;
+	while (i < left->containers.size() && j < right->containers.size())
+	{
+		if (left->containers[i].key < right->containers[j].key)
+		{
+			i++;
+		}
+		else if (right->containers[j].key < left->containers[i].key)
+		{
+			j++;
+		}
+		else
+		{
+			count += intersectContainers(left->containers[i++], right->containers[j++], NULL);
+		}
+	}
+	return count;
+}
+
+/**
+ *  @name   idSetToVector
+ *
+ *  @brief  Appends the ids in ascending order.
+ *
+ *  @retval [\b size_t] Number of ids appended.
+ */
+size_t idSetToVector(const IdSet* set, std::vector<uint32_t>* ids)
+{
+	if (!set || !ids)
+	{
+		return 0;
+	}
+
+	size_t first = ids->size();
+	for (size_t c = 0; c < set->containers.size(); c++)
+	{
+		const IdSetContainer& container = set->containers[c];
+		uint32_t high = (uint32_t)container.key << 16;
+		if (!isBitmap(container))
+		{
+			for (size_t i = 0; i < container.array.size(); i++)
+			{
+				ids->push_back(high | container.array[i]);
+			}
+			continue;
+		}
+		for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+		{
+			for (uint64_t bits = container.bitmap[word]; bits; bits &= bits - 1)
+			{
+				ids->push_back(high | (word * 64 + trailingZeros64(bits)));
+			}
+		}
+	}
+	return ids->size() - first;
+}
+
+/**
+ *  @name   idSetMemoryUsage
+ *
+ *  @brief  Bytes held by the set, including container bookkeeping.
+ */
+size_t idSetMemoryUsage(const IdSet* set)
+{
+	if (!set)
+	{
+		return 0;
+	}
+
+	size_t bytes = sizeof(IdSet) + set->containers.capacity() * sizeof(IdSetContainer);
+	for (size_t i = 0; i < set->containers.size(); i++)
+	{
+		bytes += set->containers[i].array.capacity() * sizeof(uint16_t) + set->containers[i].bitmap.capacity() * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+/**
+ *  @name   appendBytes
+ *
+ *  @brief  Appends raw bytes to a serialization buffer.
+ */
+static void appendBytes(std::vector<uint8_t>* bytes, const void* data, size_t size)
+{
+	const uint8_t* source = static_cast<const uint8_t*>(data);
+	bytes->insert(bytes->end(), source, source + size);
+}
+
+/**
+ *  @name   idSetSerialize
+ *
+ *  @brief  Appends a byte image of the set.
+ *
+ *  @details
+ *  Layout: uint32 container count, then per container a uint16 key,
+ *  a uint16 IdSetContainerType and a uint32 cardinality followed by the
+ *  array (cardinality * uint16) or the bitmap (1024 * uint64), in host
+ *  byte order like the rest of the record files.
+ */
+void idSetSerialize(const IdSet* set, std::vector<uint8_t>* bytes)
+{
+	if (!set || !bytes)
+	{
+		return;
+	}
+
+	uint32_t count = (uint32_t)set->containers.size();
+	appendBytes(bytes, &count, sizeof(count));
+	for (size_t i = 0; i < set->containers.size(); i++)
+	{
+		const IdSetContainer& container = set->containers[i];
+		uint16_t type = isBitmap(container) ? ID_SET_BITMAP : ID_SET_ARRAY;
+		appendBytes(bytes, &container.key, sizeof(container.key));
+		appendBytes(bytes, &type, sizeof(type));
+		appendBytes(bytes, &container.cardinality, sizeof(container.cardinality));
+		if (type == ID_SET_BITMAP)
+		{
+			appendBytes(bytes, container.bitmap.data(), ID_SET_BITMAP_WORDS * sizeof(uint64_t));
+		}
+		else
+		{
+			appendBytes(bytes, container.array.data(), container.array.size() * sizeof(uint16_t));
+		}
+	}
+}
+
+/**
+ *  @name   idSetDeserialize
+ *
+ *  @brief  Rebuilds a set written by idSetSerialize().
+ *
+ *  @param  [in]  bytes [\b const uint8_t*]  Serialized image.
+ *  @param  [in]  size  [\b size_t]          Exact image size.
+ *  @param  [out] set   [\b IdSet*]          Receives the set (replaced).
+ *
+ *  @retval [\b int] 1 on success; 0 if the image is truncated, has trailing
+ *          bytes or breaks an invariant (key order, sorted arrays,
+ *          cardinalities); @p set is then left empty.
+ */
+int idSetDeserialize(const uint8_t* bytes, size_t size, IdSet* set)
+{
+	if (!set)
+	{
+		return 0;
+	}
+	idSetClear(set);
+
+	size_t offset = sizeof(uint32_t);
+	uint32_t count;
+	if (!bytes || size < offset)
+	{
+		return 0;
+	}
+	memcpy(&count, bytes, sizeof(count));
+
+	for (uint32_t c = 0; c < count; c++)
+	{
+		uint16_t key, type;
+		uint32_t cardinality;
+		if (size - offset < 8)
+		{
+			idSetClear(set);
+			return 0;
+		}
+		memcpy(&key, bytes + offset, sizeof(key));
+		memcpy(&type, bytes + offset + 2, sizeof(type));
+		memcpy(&cardinality, bytes + offset + 4, sizeof(cardinality));
+		offset += 8;
+
+		bool ordered = set->containers.empty() || set->containers.back().key < key;
+		bool valid = ordered && cardinality > 0 && ((type == ID_SET_ARRAY && cardinality <= ID_SET_ARRAY_MAX)
+			|| (type == ID_SET_BITMAP && cardinality > ID_SET_ARRAY_MAX && cardinality <= 65536));
+		size_t payload = type == ID_SET_BITMAP ? ID_SET_BITMAP_WORDS * sizeof(uint64_t) : cardinality * sizeof(uint16_t);
+		if (!valid || size - offset < payload)
+		{
+			idSetClear(set);
+			return 0;
+		}
+
+		set->containers.push_back(IdSetContainer());
+		IdSetContainer& container = set->containers.back();
+		container.key = key;
+		container.cardinality = cardinality;
+		uint32_t actual = 0;
+		if (type == ID_SET_BITMAP)
+		{
+			container.bitmap.resize(ID_SET_BITMAP_WORDS);
+			memcpy(container.bitmap.data(), bytes + offset, payload);
+			for (uint32_t word = 0; word < ID_SET_BITMAP_WORDS; word++)
+			{
+				actual += popcount64(container.bitmap[word]);
+			}
+		}
+		else
+		{
+			container.array.resize(cardinality);
+			memcpy(container.array.data(), bytes + offset, payload);
+			actual = (uint32_t)(std::adjacent_find(container.array.begin(), container.array.end(), std::greater_equal<uint16_t>())
+				== container.array.end() ? cardinality : 0);
+		}
+		offset += payload;
+
+		if (actual != cardinality)
+		{
+			idSetClear(set);
+			return 0;
+		}
+	}
+
+	if (offset != size)
+	{
+		idSetClear(set);
+		return 0;
+	}
+	return 1;
+}
@@ -0,0 +1,2083 @@
+#include "../header/local_event_planner.h"
+#include <algorithm>
+
+/**
+ *  @name   timeEntryLess
+ *
+ *  @brief  Orders index entries by start time, then by event id.
+ */
+static bool timeEntryLess(const EventTimeEntry& left, const EventTimeEntry& right)
+{
+	return left.startTime < right.startTime || (left.startTime == right.startTime && left.id < right.id);
+}
+
+/**
+ *  @name   timeEntryBefore
+ *
+ *  @brief  lower_bound() predicate: entry starts before @p startTime.
+ */
+static bool timeEntryBefore(const EventTimeEntry& entry, int64_t startTime)
+{
+	return entry.startTime < startTime;
+}
+
+/**
+ *  @name   copyEventText
+ *
+ *  @brief  Copies a string into a fixed-size Event field, truncating it.
+ */
+static void copyEventText(char* target, size_t size, const char* source)
+{
+	strncpy(target, source ? source : "", size - 1);
+	target[size - 1] = '\0';
+}
+
+/**
+ *  @name   buildEventText
+ *
+ *  @brief  Text an event is keyword-indexed under: "<title> <location>".
+ */
+static void buildEventText(const Event* event, char* buffer, size_t size)
+{
+	snprintf(buffer, size, "%s %s", event->title, event->location);
+}
+
+/**
+ *  @name   indexEventText
+ *
+ *  @brief  Adds an event's keywords to the store's text index.
+ */
+static int indexEventText(EventStore* store, const Event* event)
+{
+	char text[EVENT_TITLE_SIZE + EVENT_LOCATION_SIZE];
+	buildEventText(event, text, sizeof(text));
+	return addDocumentToTextIndex(&store->text, (uint32_t)event->id, text);
+}
+
+/**
+ *  @name   spatialEntryOf
+ *
+ *  @brief  Builds an event's grid entry.
+ *
+ *  @retval [\b int] 1 if the event has coordinates; 0 otherwise.
+ */
+static int spatialEntryOf(const Event* event, SpatialEntry* entry)
+{
+	if (event->latitudeE6 == SPATIAL_NO_POSITION)
+	{
+		return 0;
+	}
+	entry->startTime = event->startTime;
+	entry->id = event->id;
+	entry->latitudeE6 = event->latitudeE6;
+	entry->longitudeE6 = event->longitudeE6;
+	return 1;
+}
+
+/**
+ *  @name   indexEventPlace
+ *
+ *  @brief  Adds an event with coordinates to the spatial grid.
+ */
+static void indexEventPlace(EventStore* store, const Event* event)
+{
+	SpatialEntry entry;
+	if (spatialEntryOf(event, &entry))
+	{
+		addSpatialPoint(&store->places, &entry);
+	}
+}
+
+/**
+ *  @name   unindexEventPlace
+ *
+ *  @brief  Removes an event's current entry from the spatial grid.
+ */
+static void unindexEventPlace(EventStore* store, const Event* event)
+{
+	SpatialEntry entry;
+	if (spatialEntryOf(event, &entry))
+	{
+		removeSpatialPoint(&store->places, &entry);
+	}
+}
+
+/**
+ *  @name   sortDeltaRun
+ *
+ *  @brief  Sorts the delta run if additions left it out of order.
+ *
+ *  @param  [in,out] store [\b EventStore*]  Store whose delta run is sorted.
+ */
+static void sortDeltaRun(EventStore* store)
+{
+	if (!store->deltaSorted)
+	{
+		std::sort(store->deltaRun.begin(), store->deltaRun.end(), timeEntryLess);
+		store->deltaSorted = true;
+	}
+}
+
+/**
+ *  @name   mergeDeltaRun
+ *
+ *  @brief  Folds the delta run into the main run and drops holes.
+ *
+ *  @param  [in,out] store [\b EventStore*]  Store to compact.
+ *
+ *  @details
+ *  One sequential merge of two sorted runs; entries whose id was cleared
+ *  by a delete or a time change are skipped on the way.
+ *
+ *  @complexity O(main + delta log delta)
+ */
+static void mergeDeltaRun(EventStore* store)
+{
+	sortDeltaRun(store);
+
+	std::vector<EventTimeEntry> merged;
+	merged.reserve(store->mainRun.size() + store->deltaRun.size() - store->staleEntries);
+
+	std::vector<EventTimeEntry>::const_iterator left = store->mainRun.begin();
+	std::vector<EventTimeEntry>::const_iterator right = store->deltaRun.begin();
+	while (left != store->mainRun.end() || right != store->deltaRun.end())
+	{
+		const EventTimeEntry& next = right == store->deltaRun.end()
+			|| (left != store->mainRun.end() && !timeEntryLess(*right, *left)) ? *left++ : *right++;
+		if (next.id != 0)
+		{
+			merged.push_back(next);
+		}
+	}
+
+	store->mainRun.swap(merged);
+	store->deltaRun.clear();
+	store->deltaSorted = true;
+	store->staleEntries = 0;
+}
+
+/**
+ *  @name   maybeCompactTimeIndex
+ *
+ *  @brief  Merges the runs once the delta or the holes grow too large.
+ *
+ *  @details
+ *  The delta may reach main >> EVENT_INDEX_DELTA_SHIFT (at least
+ *  EVENT_INDEX_MIN_DELTA) entries, so the O(n) merge is amortized over
+ *  a constant fraction of n insertions.
+ */
+static void maybeCompactTimeIndex(EventStore* store)
+{
+	size_t deltaLimit = store->mainRun.size() >> EVENT_INDEX_DELTA_SHIFT;
+	if (deltaLimit < EVENT_INDEX_MIN_DELTA)
+	{
+		deltaLimit = EVENT_INDEX_MIN_DELTA;
+	}
+
+	if (store->deltaRun.size() >= deltaLimit
+		|| store->staleEntries > (store->mainRun.size() >> EVENT_INDEX_STALE_SHIFT))
+	{
+		mergeDeltaRun(store);
+	}
+}
+
+/**
+ *  @name   addTimeEntry
+ *
+ *  @brief  Records an event's start time in the delta run.
+ */
+static void addTimeEntry(EventStore* store, int64_t startTime, int id)
+{
+	EventTimeEntry entry = { startTime, id };
+	if (store->deltaSorted && !store->deltaRun.empty() && timeEntryLess(entry, store->deltaRun.back()))
+	{
+		store->deltaSorted = false;
+	}
+	store->deltaRun.push_back(entry);
+	maybeCompactTimeIndex(store);
+}
+
+/**
+ *  @name   clearEntryInRun
+ *
+ *  @brief  Turns the (startTime, id) entry of a run into a hole.
+ *
+ *  @retval [\b int] 1 if the entry was found.
+ *
+ *  @details
+ *  Sorted runs are searched by start time and then scanned across the
+ *  events sharing it; the unsorted delta is scanned linearly. Setting
+ *  the id to 0 keeps the start-time order intact.
+ */
+static int clearEntryInRun(std::vector<EventTimeEntry>* run, bool sorted, int64_t startTime, int id)
+{
+	std::vector<EventTimeEntry>::iterator it = sorted
+		? std::lower_bound(run->begin(), run->end(), startTime, timeEntryBefore)
+		: run->begin();
+
+	for (; it != run->end() && (!sorted || it->startTime == startTime); ++it)
+	{
+		if (it->id == id && it->startTime == startTime)
+		{
+			it->id = 0;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ *  @name   removeTimeEntry
+ *
+ *  @brief  Removes an event's entry from whichever run holds it.
+ */
+static void removeTimeEntry(EventStore* store, int64_t startTime, int id)
+{
+	if (clearEntryInRun(&store->mainRun, true, startTime, id)
+		|| clearEntryInRun(&store->deltaRun, store->deltaSorted, startTime, id))
+	{
+		store->staleEntries++;
+		maybeCompactTimeIndex(store);
+	}
+}
+
+/**
+ *  @name   rebuildTimeIndex
+ *
+ *  @brief  Rebuilds the main run from every event with a single sort.
+ *
+ *  @complexity O(n log n)
+ */
+static void rebuildTimeIndex(EventStore* store)
+{
+	store->mainRun.clear();
+	store->deltaRun.clear();
+	store->deltaSorted = true;
+	store->staleEntries = 0;
+
+	unsigned int count = store->events.size();
+	store->mainRun.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const Event* event = store->events.at(i);
+		EventTimeEntry entry = { event->startTime, event->id };
+		store->mainRun.push_back(entry);
+	}
+	std::sort(store->mainRun.begin(), store->mainRun.end(), timeEntryLess);
+}
+
+typedef struct TimeIndexCursor {
+	std::vector<EventTimeEntry>::const_iterator left, leftEnd;    // main run
+	std::vector<EventTimeEntry>::const_iterator right, rightEnd;  // delta run
+	int64_t to;
+} TimeIndexCursor;
+
+/**
+ *  @name   openTimeIndexCursor
+ *
+ *  @brief  Positions a cursor on the first index entry starting at or after @p from.
+ *
+ *  @complexity O(log n), plus the delta sort if one is pending.
+ */
+static void openTimeIndexCursor(EventStore* store, int64_t from, int64_t to, TimeIndexCursor* cursor)
+{
+	sortDeltaRun(store);
+	cursor->left = std::lower_bound(store->mainRun.begin(), store->mainRun.end(), from, timeEntryBefore);
+	cursor->leftEnd = store->mainRun.end();
+	cursor->right = std::lower_bound(store->deltaRun.begin(), store->deltaRun.end(), from, timeEntryBefore);
+	cursor->rightEnd = store->deltaRun.end();
+	cursor->to = to;
+}
+
+/**
+ *  @name   nextTimeEntry
+ *
+ *  @brief  Next live entry of the merged runs before the cursor's end.
+ *
+ *  @retval [\b const EventTimeEntry*] The entry, or NULL once the window is exhausted.
+ *
+ *  @details Holes left by deletes and time changes are skipped.
+ */
+static const EventTimeEntry* nextTimeEntry(TimeIndexCursor* cursor)
+{
+	for (;;)
+	{
+		bool leftLive = cursor->left != cursor->leftEnd && cursor->left->startTime < cursor->to;
+		bool rightLive = cursor->right != cursor->rightEnd && cursor->right->startTime < cursor->to;
+		if (!leftLive && !rightLive)
+		{
+			return NULL;
+		}
+
+		const EventTimeEntry* next = !rightLive || (leftLive && !timeEntryLess(*cursor->right, *cursor->left))
+			? &*cursor->left++
+			: &*cursor->right++;
+		if (next->id != 0)
+		{
+			return next;
+		}
+	}
+}
+
+/**
+ *  @name   idLess
+ *
+ *  @brief  Orders events by id.
+ */
+static bool idLess(const Event* left, const Event* right)
+{
+	return left->id < right->id;
+}
+
+/**
+ *  @name   rebuildTextIndex
+ *
+ *  @brief  Re-indexes every event's keywords in ascending id order.
+ *
+ *  @details
+ *  Ascending ids turn every posting into an O(1) append, whereas the
+ *  slab order after deletions would force list re-encodes.
+ */
+static int rebuildTextIndex(EventStore* store)
+{
+	destroyTextIndex(&store->text);
+	if (!initTextIndex(&store->text))
+	{
+		return 0;
+	}
+
+	std::vector<const Event*> ordered;
+	ordered.reserve(store->events.size());
+	for (unsigned int i = 0; i < store->events.size(); i++)
+	{
+		ordered.push_back(store->events.at(i));
+	}
+	std::sort(ordered.begin(), ordered.end(), idLess);
+
+	int ok = 1;
+	for (size_t i = 0; i < ordered.size(); i++)
+	{
+		ok &= indexEventText(store, ordered[i]);
+	}
+	return ok;
+}
+
+/**
+ *  @name   rebuildSpatialIndex
+ *
+ *  @brief  Re-buckets every event that has coordinates.
+ */
+static int rebuildSpatialIndex(EventStore* store)
+{
+	destroySpatialIndex(&store->places);
+	if (!initSpatialIndex(&store->places))
+	{
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < store->events.size(); i++)
+	{
+		indexEventPlace(store, store->events.at(i));
+	}
+	return 1;
+}
+
+/**
+ *  @name   placeDistanceLess
+ *
+ *  @brief  Orders (distance, event) pairs by distance, then by id.
+ */
+static bool placeDistanceLess(const std::pair<double, const Event*>& left, const std::pair<double, const Event*>& right)
+{
+	return left.first < right.first || (left.first == right.first && left.second->id < right.second->id);
+}
+
+/**
+ *  @name   startTimeLess
+ *
+ *  @brief  Orders events by start time, then by id.
+ */
+static bool startTimeLess(const Event* left, const Event* right)
+{
+	return left->startTime < right->startTime || (left->startTime == right->startTime && left->id < right->id);
+}
+
+/**
+ *  @name   scheduleIntervalOf
+ *
+ *  @brief  The slot an event occupies in its attendees' schedules.
+ */
+static ScheduleInterval scheduleIntervalOf(const Event* event)
+{
+	ScheduleInterval interval;
+	interval.startTime = event->startTime;
+	interval.endTime = event->endTime;
+	interval.id = event->id;
+	return interval;
+}
+
+/**
+ *  @name   seriesSpanOf
+ *
+ *  @brief  The span a series can have occurrences in, as a tree interval.
+ *
+ *  @details
+ *  Runs from the first start to one past the last start the count and
+ *  until limits allow; unlimited series run to INT64_MAX. Exceptions are
+ *  ignored, so the span may be wider than the occurrences, never narrower.
+ */
+static ScheduleInterval seriesSpanOf(const EventRecurrence* recurrence)
+{
+	int64_t last = recurrence->rule.until;
+	if (recurrence->rule.count > 0)
+	{
+		last = std::min(last, occurrenceStart(&recurrence->rule, recurrence->firstStart, recurrence->rule.count - 1));
+	}
+
+	ScheduleInterval span;
+	span.startTime = recurrence->firstStart;
+	span.endTime = last == INT64_MAX ? INT64_MAX : std::max(last + 1, recurrence->firstStart);
+	span.id = recurrence->eventID;
+	return span;
+}
+
+static void indexSeriesSpan(EventStore* store, const EventRecurrence* recurrence)
+{
+	ScheduleInterval span = seriesSpanOf(recurrence);
+	addScheduleInterval(&store->seriesSpans, &span);
+}
+
+static void unindexSeriesSpan(EventStore* store, const EventRecurrence* recurrence)
+{
+	ScheduleInterval span = seriesSpanOf(recurrence);
+	removeScheduleInterval(&store->seriesSpans, &span);
+}
+
+/**
+ *  @name   rescheduleAttendees
+ *
+ *  @brief  Moves an event's slot in the schedule of everyone attending it.
+ *
+ *  @details Recurring events have no slot; their occurrences follow the start.
+ */
+static void rescheduleAttendees(EventStore* store, const ScheduleInterval* before, const ScheduleInterval* after)
+{
+	EventAttendees* attendees = store->attendees.find(before->id);
+	if (!attendees)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> users;
+	idSetToVector(&attendees->users, &users);
+	for (size_t i = 0; i < users.size(); i++)
+	{
+		UserAttendance* attendance = store->attendance.find((int)users[i]);
+		if (attendance && removeScheduleInterval(&attendance->schedule, before))
+		{
+			addScheduleInterval(&attendance->schedule, after);
+		}
+	}
+}
+
+/**
+ *  @name   moveAttendeesSchedule
+ *
+ *  @brief  Moves an event between its attendees' schedule trees and series sets.
+ *
+ *  @details Called when an event starts or stops recurring: a series has no
+ *           single slot in the tree, its occurrences are expanded per query.
+ */
+static void moveAttendeesSchedule(EventStore* store, const Event* event, bool recurring)
+{
+	EventAttendees* attendees = store->attendees.find(event->id);
+	if (!attendees)
+	{
+		return;
+	}
+
+	ScheduleInterval interval = scheduleIntervalOf(event);
+	std::vector<uint32_t> users;
+	idSetToVector(&attendees->users, &users);
+	for (size_t i = 0; i < users.size(); i++)
+	{
+		UserAttendance* attendance = store->attendance.find((int)users[i]);
+		if (!attendance)
+		{
+			continue;
+		}
+		if (recurring)
+		{
+			removeScheduleInterval(&attendance->schedule, &interval);
+			idSetAdd(&attendance->series, (uint32_t)event->id);
+		}
+		else if (idSetRemove(&attendance->series, (uint32_t)event->id))
+		{
+			addScheduleInterval(&attendance->schedule, &interval);
+		}
+	}
+}
+
+/**
+ *  @name   collectSeriesOccurrences
+ *
+ *  @brief  Occurrences of a user's recurring commitments that overlap [startTime, endTime).
+ *
+ *  @param  [in,out] store       [\b EventStore*]                     Open store.
+ *  @param  [in]     attendance  [\b const UserAttendance*]           The user's commitments.
+ *  @param  [in]     startTime   [\b int64_t]                         Inclusive window start.
+ *  @param  [in]     endTime     [\b int64_t]                         Exclusive window end.
+ *  @param  [in]     stopAtFirst [\b bool]                            Stop after one occurrence.
+ *  @param  [out]    intervals   [\b std::vector<ScheduleInterval>*]  Receives one interval per occurrence (appended).
+ *
+ *  @retval [\b size_t] Number of intervals appended.
+ *
+ *  @details
+ *  An occurrence lasting d seconds overlaps the window when it starts in
+ *  (startTime - d, endTime), so beginOccurrences() jumps straight there
+ *  and each series costs O(1) plus its occurrences in the window.
+ */
+static size_t collectSeriesOccurrences(EventStore* store, const UserAttendance* attendance, int64_t startTime, int64_t endTime, bool stopAtFirst, std::vector<ScheduleInterval>* intervals)
+{
+	size_t before = intervals->size();
+	std::vector<uint32_t> ids;
+	idSetToVector(&attendance->series, &ids);
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		Event* event = NULL;
+		const EventRecurrence* recurrence = store->recurrences.find((int)ids[i]);
+		if (!recurrence || !findEventById(store, (int)ids[i], &event))
+		{
+			continue;
+		}
+
+		int64_t duration = event->endTime - event->startTime;
+		OccurrenceIterator it;
+		for (int more = beginOccurrences(&it, recurrence, event->startTime, startTime - duration + 1, endTime); more; more = advanceOccurrence(&it))
+		{
+			ScheduleInterval occurrence = { it.startTime, it.startTime + duration, event->id };
+			intervals->push_back(occurrence);
+			if (stopAtFirst)
+			{
+				return 1;
+			}
+		}
+	}
+	return intervals->size() - before;
+}
+
+/**
+ *  @name   conflictStartLess
+ *
+ *  @brief  Orders conflicts by the start of their overlap.
+ */
+static bool conflictStartLess(const ScheduleConflict& left, const ScheduleConflict& right)
+{
+	return left.overlapStart < right.overlapStart || (left.overlapStart == right.overlapStart && left.otherID < right.otherID);
+}
+
+/**
+ *  @name   locationLess
+ *
+ *  @brief  Groups events by location; stable sorting keeps each group in start order.
+ */
+static bool locationLess(const Event* left, const Event* right)
+{
+	return strcmp(left->location, right->location) < 0;
+}
+
+/**
+ *  @name   initEventStore
+ *
+ *  @brief  Prepares an empty event store.
+ *
+ *  @param  [out] store [\b EventStore*]  Store to initialize.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid argument or allocation failure.
+ *
+ *  @details
+ *  Events are owned by an EventTable (BrentTable keyed by id). Start times
+ *  live in a separate two-run index: a large sorted main run and a small
+ *  delta run that absorbs additions and is merged in periodically. Title
+ *  and location keywords go into a TextIndex, events with coordinates
+ *  into a SpatialIndex, and recurrence rules into a RecurrenceTable.
+ *  Attendance is kept both ways, event -> users and user -> events, as
+ *  compressed IdSets; each user also has an interval tree of the attended
+ *  events' slots for conflict checks.
+ *
+ *  @warning The store must be released with destroyEventStore().
+ */
+int initEventStore(EventStore* store)
+{
+	if (!store || !store->events.init())
+	{
+		return 0;
+	}
+	if (!initTextIndex(&store->text))
+	{
+		store->events.destroy();
+		return 0;
+	}
+	if (!initSpatialIndex(&store->places))
+	{
+		destroyTextIndex(&store->text);
+		store->events.destroy();
+		return 0;
+	}
+	if (!store->recurrences.init() || !store->attendees.init() || !store->attendance.init())
+	{
+		store->attendees.destroy();
+		store->recurrences.destroy();
+		destroySpatialIndex(&store->places);
+		destroyTextIndex(&store->text);
+		store->events.destroy();
+		return 0;
+	}
+
+	initScheduleTree(&store->seriesSpans);
+	store->mainRun.clear();
+	store->deltaRun.clear();
+	store->deltaSorted = true;
+	store->staleEntries = 0;
+	store->nextID = 1;
+	return 1;
+}
+
+/**
+ *  @name   destroyEventStore
+ *
+ *  @brief  Frees every event and both index runs.
+ *
+ *  @param  [in,out] store [\b EventStore*]  Store to release.
+ */
+void destroyEventStore(EventStore* store)
+{
+	if (!store)
+	{
+		return;
+	}
+
+	store->events.destroy();
+	destroyTextIndex(&store->text);
+	destroySpatialIndex(&store->places);
+	store->recurrences.destroy();
+	std::vector<ScheduleNode>().swap(store->seriesSpans.nodes);
+	std::vector<int32_t>().swap(store->seriesSpans.freeNodes);
+	initScheduleTree(&store->seriesSpans);
+	store->attendees.destroy();
+	store->attendance.destroy();
+	std::vector<EventTimeEntry>().swap(store->mainRun);
+	std::vector<EventTimeEntry>().swap(store->deltaRun);
+	store->deltaSorted = true;
+	store->staleEntries = 0;
+}
+
+/**
+ *  @name   addEvent
+ *
+ *  @brief  Creates an event with the next free id.
+ *
+ *  @param  [in,out] store     [\b EventStore*]  Open store.
+ *  @param  [in]     ownerID   [\b int]          Id of the creating user.
+ *  @param  [in]     startTime [\b int64_t]      Start, seconds since the epoch.
+ *  @param  [in]     endTime   [\b int64_t]      End, not before @p startTime.
+ *  @param  [in]     title     [\b const char*]  Title (truncated to EVENT_TITLE_SIZE - 1).
+ *  @param  [in]     location  [\b const char*]  Location (truncated to EVENT_LOCATION_SIZE - 1).
+ *  @param  [out]    created   [\b Event**]      If non-NULL, receives the stored event.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments or allocation failure.
+ *
+ *  @details
+ *  The event starts without coordinates; see setEventPosition().
+ *
+ *  @complexity Amortized O(1) plus the amortized share of a run merge.
+ */
+int addEvent(EventStore* store, int ownerID, int64_t startTime, int64_t endTime, const char* title, const char* location, Event** created)
+{
+	if (!store || !title || endTime < startTime)
+	{
+		return 0;
+	}
+
+	Event event;
+	memset(&event, 0, sizeof(event));
+	event.id = store->nextID;
+	event.ownerID = ownerID;
+	event.startTime = startTime;
+	event.endTime = endTime;
+	copyEventText(event.title, sizeof(event.title), title);
+	copyEventText(event.location, sizeof(event.location), location);
+	event.latitudeE6 = SPATIAL_NO_POSITION;
+
+	Event* stored = store->events.insert(event);
+	if (!stored)
+	{
+		return 0;
+	}
+	store->nextID++;
+	addTimeEntry(store, startTime, event.id);
+	indexEventText(store, stored);
+
+	if (created)
+	{
+		*created = stored;
+	}
+	return 1;
+}
+
+/**
+ *  @name   insertEventRecord
+ *
+ *  @brief  Adds an event that already carries its id (e.g. from a file).
+ *
+ *  @param  [in,out] store [\b EventStore*]    Open store.
+ *  @param  [in]     event [\b const Event*]   Record to copy; text fields are re-terminated.
+ *
+ *  @retval [\b int] 1 on success; 0 if the id is taken, invalid or allocation fails.
+ */
+int insertEventRecord(EventStore* store, const Event* event)
+{
+	if (!store || !event || event->id <= 0 || event->endTime < event->startTime
+		|| store->events.find(event->id))
+	{
+		return 0;
+	}
+
+	Event copy = *event;
+	copy.title[sizeof(copy.title) - 1] = '\0';
+	copy.location[sizeof(copy.location) - 1] = '\0';
+	if (!store->events.insert(copy))
+	{
+		return 0;
+	}
+	if (copy.id >= store->nextID)
+	{
+		store->nextID = copy.id + 1;
+	}
+	addTimeEntry(store, copy.startTime, copy.id);
+	indexEventText(store, &copy);
+	indexEventPlace(store, &copy);
+	return 1;
+}
+
+/**
+ *  @name   findEventById
+ *
+ *  @brief  Looks up an event by id.
+ *
+ *  @param  [in]  store  [\b EventStore*]  Open store.
+ *  @param  [in]  id     [\b int]          Event id.
+ *  @param  [out] result [\b Event**]      If non-NULL, receives the event or NULL.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ *
+ *  @warning Change times with updateEventTime(), not through @p result,
+ *           or the time index goes stale.
+ */
+int findEventById(EventStore* store, int id, Event** result)
+{
+	Event* event = store ? store->events.find(id) : NULL;
+	if (result)
+	{
+		*result = event;
+	}
+	return event != NULL;
+}
+
+/**
+ *  @name   updateEventTime
+ *
+ *  @brief  Moves an event to a new time slot.
+ *
+ *  @param  [in,out] store     [\b EventStore*]  Open store.
+ *  @param  [in]     id        [\b int]          Event id.
+ *  @param  [in]     startTime [\b int64_t]      New start.
+ *  @param  [in]     endTime   [\b int64_t]      New end, not before @p startTime.
+ *
+ *  @retval [\b int] 1 on success; 0 if absent or the times are invalid.
+ *
+ *  @details
+ *  The old index entry becomes a hole and a new one goes to the delta
+ *  run; the record itself stays where it is. A recurring event's series
+ *  moves with its first occurrence, so its exception dates are dropped.
+ *  The slot also moves in every attendee's schedule.
+ */
+int updateEventTime(EventStore* store, int id, int64_t startTime, int64_t endTime)
+{
+	Event* event = NULL;
+	if (endTime < startTime || !findEventById(store, id, &event))
+	{
+		return 0;
+	}
+
+	ScheduleInterval before = scheduleIntervalOf(event);
+	if (event->startTime != startTime)
+	{
+		removeTimeEntry(store, event->startTime, id);
+		unindexEventPlace(store, event);
+		event->startTime = startTime;
+		addTimeEntry(store, startTime, id);
+		indexEventPlace(store, event);
+
+		EventRecurrence* recurrence = store->recurrences.find(id);
+		if (recurrence)
+		{
+			unindexSeriesSpan(store, recurrence);
+			recurrence->firstStart = startTime;
+			recurrence->exceptions.clear();
+			indexSeriesSpan(store, recurrence);
+		}
+	}
+	event->endTime = endTime;
+
+	ScheduleInterval after = scheduleIntervalOf(event);
+	if (after.startTime != before.startTime || after.endTime != before.endTime)
+	{
+		rescheduleAttendees(store, &before, &after);
+	}
+	return 1;
+}
+
+/**
+ *  @name   updateEventText
+ *
+ *  @brief  Changes an event's title and location.
+ *
+ *  @param  [in,out] store    [\b EventStore*]  Open store.
+ *  @param  [in]     id       [\b int]          Event id.
+ *  @param  [in]     title    [\b const char*]  New title (truncated).
+ *  @param  [in]     location [\b const char*]  New location (truncated).
+ *
+ *  @retval [\b int] 1 on success; 0 if absent or @p title is NULL.
+ *
+ *  @details
+ *  Only keywords that appear in exactly one of the old and new texts are
+ *  updated in the text index (see updateDocumentInTextIndex()).
+ */
+int updateEventText(EventStore* store, int id, const char* title, const char* location)
+{
+	Event* event = NULL;
+	if (!title || !findEventById(store, id, &event))
+	{
+		return 0;
+	}
+
+	char oldText[EVENT_TITLE_SIZE + EVENT_LOCATION_SIZE];
+	char newText[EVENT_TITLE_SIZE + EVENT_LOCATION_SIZE];
+	buildEventText(event, oldText, sizeof(oldText));
+	copyEventText(event->title, sizeof(event->title), title);
+	copyEventText(event->location, sizeof(event->location), location);
+	buildEventText(event, newText, sizeof(newText));
+	return updateDocumentInTextIndex(&store->text, (uint32_t)id, oldText, newText);
+}
+
+/**
+ *  @name   setEventPosition
+ *
+ *  @brief  Places an event at a latitude/longitude.
+ *
+ *  @param  [in,out] store     [\b EventStore*]  Open store.
+ *  @param  [in]     id        [\b int]          Event id.
+ *  @param  [in]     latitude  [\b double]       Degrees in [-90, 90].
+ *  @param  [in]     longitude [\b double]       Degrees in [-180, 180].
+ *
+ *  @retval [\b int] 1 on success; 0 if absent or the coordinates are out of range.
+ *
+ *  @details
+ *  Coordinates are stored as micro-degrees (about 11 cm of precision),
+ *  and the event moves to its new grid cell.
+ */
+int setEventPosition(EventStore* store, int id, double latitude, double longitude)
+{
+	Event* event = NULL;
+	if (!(latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0)
+		|| !findEventById(store, id, &event))
+	{
+		return 0;
+	}
+
+	unindexEventPlace(store, event);
+	event->latitudeE6 = degreesToE6(latitude);
+	event->longitudeE6 = degreesToE6(longitude);
+	indexEventPlace(store, event);
+	return 1;
+}
+
+/**
+ *  @name   setEventRecurrence
+ *
+ *  @brief  Makes an event repeat, or one-off again.
+ *
+ *  @param  [in,out] store [\b EventStore*]            Open store.
+ *  @param  [in]     id    [\b int]                    Event id; its start is the first occurrence.
+ *  @param  [in]     rule  [\b const RecurrenceRule*]  New rule, or NULL / RECURRENCE_NONE to stop repeating.
+ *
+ *  @retval [\b int] 1 on success; 0 if absent, the rule is invalid or allocation fails.
+ *
+ *  @details
+ *  The rule is stored once, however many occurrences it describes.
+ *  Replacing a rule drops the exceptions of the old one. Attendees'
+ *  schedules trade the event's single slot for the series, or back.
+ */
+int setEventRecurrence(EventStore* store, int id, const RecurrenceRule* rule)
+{
+	Event* event = NULL;
+	if (!findEventById(store, id, &event))
+	{
+		return 0;
+	}
+	EventRecurrence* recurrence = store->recurrences.find(id);
+	if (!rule || rule->frequency == RECURRENCE_NONE)
+	{
+		if (recurrence)
+		{
+			unindexSeriesSpan(store, recurrence);
+			store->recurrences.erase(id);
+			moveAttendeesSchedule(store, event, false);
+		}
+		return 1;
+	}
+	if (!isValidRecurrenceRule(rule))
+	{
+		return 0;
+	}
+
+	if (!recurrence)
+	{
+		EventRecurrence created;
+		created.eventID = id;
+		created.firstStart = event->startTime;
+		created.rule = *rule;
+		recurrence = store->recurrences.insert(created);
+		if (!recurrence)
+		{
+			return 0;
+		}
+		indexSeriesSpan(store, recurrence);
+		moveAttendeesSchedule(store, event, true);
+		return 1;
+	}
+	unindexSeriesSpan(store, recurrence);
+	recurrence->rule = *rule;
+	recurrence->exceptions.clear();
+	indexSeriesSpan(store, recurrence);
+	return 1;
+}
+
+/**
+ *  @name   addRecurrenceException
+ *
+ *  @brief  Cancels one occurrence of a recurring event.
+ *
+ *  @param  [in,out] store           [\b EventStore*]  Open store.
+ *  @param  [in]     id              [\b int]          Recurring event id.
+ *  @param  [in]     occurrenceStart [\b int64_t]      Start time of the occurrence to skip.
+ *
+ *  @retval [\b int] 1 if cancelled (or already cancelled); 0 if the event does
+ *          not recur, has no occurrence at that time or already has
+ *          RECURRENCE_MAX_EXCEPTIONS exceptions.
+ */
+int addRecurrenceException(EventStore* store, int id, int64_t occurrenceStart)
+{
+	Event* event = NULL;
+	EventRecurrence* recurrence = findEventById(store, id, &event) ? store->recurrences.find(id) : NULL;
+	if (!recurrence)
+	{
+		return 0;
+	}
+
+	std::vector<int64_t>::iterator position = std::lower_bound(recurrence->exceptions.begin(), recurrence->exceptions.end(), occurrenceStart);
+	if (position != recurrence->exceptions.end() && *position == occurrenceStart)
+	{
+		return 1;
+	}
+
+	OccurrenceIterator it;
+	if (recurrence->exceptions.size() >= RECURRENCE_MAX_EXCEPTIONS
+		|| !beginOccurrences(&it, recurrence, event->startTime, occurrenceStart, occurrenceStart + 1))
+	{
+		return 0;
+	}
+	recurrence->exceptions.insert(position, occurrenceStart);
+	return 1;
+}
+
+/**
+ *  @name   findEventRecurrence
+ *
+ *  @brief  The recurrence of an event.
+ *
+ *  @retval [\b const EventRecurrence*] The rule and its exceptions, or NULL for a one-off event.
+ */
+const EventRecurrence* findEventRecurrence(EventStore* store, int id)
+{
+	return store ? store->recurrences.find(id) : NULL;
+}
+
+/**
+ *  @name   addAttendee
+ *
+ *  @brief  Records that a user attends an event (an RSVP).
+ *
+ *  @param  [in,out] store   [\b EventStore*]  Open store.
+ *  @param  [in]     eventID [\b int]          Event id.
+ *  @param  [in]     userID  [\b int]          User::id as assigned by insertUserBrent().
+ *
+ *  @retval [\b int] 1 if added; 0 if already attending, the event is absent,
+ *          @p userID is not positive or allocation fails.
+ *
+ *  @details Updates the event's attendee set and the user's attendance set
+ *           and schedule.
+ */
+int addAttendee(EventStore* store, int eventID, int userID)
+{
+	Event* event = NULL;
+	if (userID <= 0 || !findEventById(store, eventID, &event))
+	{
+		return 0;
+	}
+
+	EventAttendees* attendees = store->attendees.find(eventID);
+	if (!attendees)
+	{
+		EventAttendees created;
+		created.eventID = eventID;
+		attendees = store->attendees.insert(created);
+	}
+	UserAttendance* attendance = store->attendance.find(userID);
+	if (!attendance)
+	{
+		UserAttendance created;
+		created.userID = userID;
+		initScheduleTree(&created.schedule);
+		attendance = store->attendance.insert(created);
+	}
+	if (!attendees || !attendance || !idSetAdd(&attendees->users, (uint32_t)userID))
+	{
+		return 0;
+	}
+	idSetAdd(&attendance->events, (uint32_t)eventID);
+	if (store->recurrences.find(eventID))
+	{
+		idSetAdd(&attendance->series, (uint32_t)eventID);
+	}
+	else
+	{
+		ScheduleInterval interval = scheduleIntervalOf(event);
+		addScheduleInterval(&attendance->schedule, &interval);
+	}
+	return 1;
+}
+
+/**
+ *  @name   removeAttendee
+ *
+ *  @brief  Withdraws a user's RSVP.
+ *
+ *  @retval [\b int] 1 if removed; 0 if the user was not attending.
+ *
+ *  @details Sets that become empty are dropped from their tables.
+ */
+int removeAttendee(EventStore* store, int eventID, int userID)
+{
+	EventAttendees* attendees = store ? store->attendees.find(eventID) : NULL;
+	if (!attendees || !idSetRemove(&attendees->users, (uint32_t)userID))
+	{
+		return 0;
+	}
+	if (attendees->users.containers.empty())
+	{
+		store->attendees.erase(eventID);
+	}
+
+	Event* event = NULL;
+	UserAttendance* attendance = store->attendance.find(userID);
+	if (attendance && idSetRemove(&attendance->events, (uint32_t)eventID))
+	{
+		if (!idSetRemove(&attendance->series, (uint32_t)eventID) && findEventById(store, eventID, &event))
+		{
+			ScheduleInterval interval = scheduleIntervalOf(event);
+			removeScheduleInterval(&attendance->schedule, &interval);
+		}
+		if (attendance->events.containers.empty())
+		{
+			store->attendance.erase(userID);
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   removeAllAttendees
+ *
+ *  @brief  Drops every RSVP of an event that is being deleted.
+ */
+static void removeAllAttendees(EventStore* store, const Event* event)
+{
+	EventAttendees* attendees = store->attendees.find(event->id);
+	if (!attendees)
+	{
+		return;
+	}
+
+	ScheduleInterval interval = scheduleIntervalOf(event);
+	std::vector<uint32_t> users;
+	idSetToVector(&attendees->users, &users);
+	for (size_t i = 0; i < users.size(); i++)
+	{
+		UserAttendance* attendance = store->attendance.find((int)users[i]);
+		if (attendance && idSetRemove(&attendance->events, (uint32_t)event->id))
+		{
+			if (!idSetRemove(&attendance->series, (uint32_t)event->id))
+			{
+				removeScheduleInterval(&attendance->schedule, &interval);
+			}
+			if (attendance->events.containers.empty())
+			{
+				store->attendance.erase((int)users[i]);
+			}
+		}
+	}
+	store->attendees.erase(event->id);
+}
+
+/**
+ *  @name   isAttending
+ *
+ *  @brief  Whether a user attends an event.
+ */
+int isAttending(EventStore* store, int eventID, int userID)
+{
+	EventAttendees* attendees = store ? store->attendees.find(eventID) : NULL;
+	return attendees && idSetContains(&attendees->users, (uint32_t)userID);
+}
+
+/**
+ *  @name   countAttendees
+ *
+ *  @brief  Number of users attending an event.
+ */
+size_t countAttendees(EventStore* store, int eventID)
+{
+	return idSetCardinality(findEventAttendees(store, eventID));
+}
+
+/**
+ *  @name   findEventAttendees
+ *
+ *  @brief  The attendee set of an event.
+ *
+ *  @retval [\b const IdSet*] The set, or NULL if nobody attends; valid until the store changes.
+ */
+const IdSet* findEventAttendees(EventStore* store, int eventID)
+{
+	EventAttendees* attendees = store ? store->attendees.find(eventID) : NULL;
+	return attendees ? &attendees->users : NULL;
+}
+
+/**
+ *  @name   findEventsAttendedBy
+ *
+ *  @brief  Events attended by any of a group of users ("events my friends are attending").
+ *
+ *  @param  [in,out] store  [\b EventStore*]   Open store.
+ *  @param  [in]     users  [\b const IdSet*]  User ids, e.g. a friend list.
+ *  @param  [out]    events [\b IdSet*]        Receives the union of their attendance sets.
+ *
+ *  @retval [\b size_t] Number of distinct events.
+ *
+ *  @details One union per user over the user -> events index; no event's
+ *           attendee list is scanned.
+ */
+size_t findEventsAttendedBy(EventStore* store, const IdSet* users, IdSet* events)
+{
+	if (!store || !users || !events)
+	{
+		return 0;
+	}
+
+	idSetClear(events);
+	std::vector<uint32_t> ids;
+	idSetToVector(users, &ids);
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		const UserAttendance* attendance = store->attendance.find((int)ids[i]);
+		if (attendance)
+		{
+			idSetUnionWith(events, &attendance->events);
+		}
+	}
+	return idSetCardinality(events);
+}
+
+/**
+ *  @name   findMutualAttendees
+ *
+ *  @brief  Users attending both events.
+ *
+ *  @retval [\b size_t] Number of mutual attendees written to @p result.
+ */
+size_t findMutualAttendees(EventStore* store, int eventID, int otherEventID, IdSet* result)
+{
+	if (!result)
+	{
+		return 0;
+	}
+
+	const IdSet* left = findEventAttendees(store, eventID);
+	const IdSet* right = findEventAttendees(store, otherEventID);
+	if (!left || !right)
+	{
+		idSetClear(result);
+		return 0;
+	}
+	idSetIntersection(left, right, result);
+	return idSetCardinality(result);
+}
+
+/**
+ *  @name   countAttendeesAmong
+ *
+ *  @brief  How many of a group of users attend an event ("3 friends are going").
+ *
+ *  @details Counts the intersection without materializing it.
+ */
+size_t countAttendeesAmong(EventStore* store, int eventID, const IdSet* users)
+{
+	return idSetIntersectionCardinality(findEventAttendees(store, eventID), users);
+}
+
+/**
+ *  @name   checkScheduleConflicts
+ *
+ *  @brief  Checks a prospective slot against a user's commitments.
+ *
+ *  @param  [in,out] store     [\b EventStore*]                     Open store.
+ *  @param  [in]     userID    [\b int]                             User whose RSVPs are the commitments.
+ *  @param  [in]     startTime [\b int64_t]                         Start of the new event.
+ *  @param  [in]     endTime   [\b int64_t]                         End of the new event.
+ *  @param  [out]    conflicts [\b std::vector<ScheduleConflict>*]  Receives the overlapping occurrences by
+ *                                                                  overlap start (appended, id 0), or NULL to only test.
+ *
+ *  @retval [\b size_t] Number of conflicts; with @p conflicts NULL, 1 if there is any.
+ *
+ *  @details
+ *  Each user's one-off events are kept in an interval tree, so this is
+ *  meant to run before an RSVP or a new event is confirmed. Recurring
+ *  events are expanded over the slot instead, so a weekly meeting clashes
+ *  in every week it is not cancelled. Intervals are half-open: an event
+ *  ending at 10:00 does not clash with one starting then.
+ *
+ *  @complexity O(log n + s) for the test, O(log n + s + k) expected when
+ *              listing, for s recurring commitments
+ */
+size_t checkScheduleConflicts(EventStore* store, int userID, int64_t startTime, int64_t endTime, std::vector<ScheduleConflict>* conflicts)
+{
+	const UserAttendance* attendance = store ? store->attendance.find(userID) : NULL;
+	if (!attendance || endTime < startTime)
+	{
+		return 0;
+	}
+
+	std::vector<ScheduleInterval> occurrences;
+	if (!conflicts)
+	{
+		return hasScheduleOverlap(&attendance->schedule, startTime, endTime)
+			|| collectSeriesOccurrences(store, attendance, startTime, endTime, true, &occurrences) ? 1 : 0;
+	}
+
+	size_t before = conflicts->size();
+	ScheduleInterval candidate = { startTime, endTime, 0 };
+	findScheduleOverlaps(&attendance->schedule, &candidate, conflicts);
+	if (collectSeriesOccurrences(store, attendance, startTime, endTime, false, &occurrences) == 0)
+	{
+		return conflicts->size() - before;
+	}
+
+	for (size_t i = 0; i < occurrences.size(); i++)
+	{
+		ScheduleConflict conflict;
+		conflict.id = 0;
+		conflict.otherID = occurrences[i].id;
+		conflict.overlapStart = std::max(startTime, occurrences[i].startTime);
+		conflict.overlapEnd = std::min(endTime, occurrences[i].endTime);
+		conflicts->push_back(conflict);
+	}
+	std::sort(conflicts->begin() + before, conflicts->end(), conflictStartLess);
+	return conflicts->size() - before;
+}
+
+/**
+ *  @name   findUserConflicts
+ *
+ *  @brief  Reports every pair of overlapping events a user attends in a window.
+ *
+ *  @param  [in,out] store     [\b EventStore*]                     Open store.
+ *  @param  [in]     userID    [\b int]                             User whose RSVPs to check.
+ *  @param  [in]     from      [\b int64_t]                         Inclusive window start.
+ *  @param  [in]     to        [\b int64_t]                         Exclusive window end.
+ *  @param  [out]    conflicts [\b std::vector<ScheduleConflict>*]  Receives one entry per pair (appended).
+ *
+ *  @retval [\b size_t] Number of pairs appended to @p conflicts.
+ *
+ *  @details
+ *  The window bounds the expansion of recurring events, which may repeat
+ *  forever; one-off events are taken if they overlap it. A series clashing
+ *  with another event in several weeks is reported once per week. Long
+ *  occurrences of one series overlapping each other are not conflicts.
+ *
+ *  @complexity O(n + m log m + k) for n one-off events and m intervals in the window
+ */
+size_t findUserConflicts(EventStore* store, int userID, int64_t from, int64_t to, std::vector<ScheduleConflict>* conflicts)
+{
+	const UserAttendance* attendance = store ? store->attendance.find(userID) : NULL;
+	if (!attendance || !conflicts || to < from)
+	{
+		return 0;
+	}
+
+	std::vector<ScheduleInterval> all;
+	std::vector<ScheduleInterval> intervals;
+	scheduleIntervals(&attendance->schedule, &all);
+	for (size_t i = 0; i < all.size() && all[i].startTime < to; i++)
+	{
+		if (from < all[i].endTime)
+		{
+			intervals.push_back(all[i]);
+		}
+	}
+	bool sorted = collectSeriesOccurrences(store, attendance, from, to, false, &intervals) == 0;
+
+	size_t before = conflicts->size();
+	sweepScheduleConflicts(&intervals, sorted, conflicts);
+	size_t kept = before;
+	for (size_t i = before; i < conflicts->size(); i++)
+	{
+		if ((*conflicts)[i].id != (*conflicts)[i].otherID)
+		{
+			(*conflicts)[kept++] = (*conflicts)[i];
+		}
+	}
+	conflicts->resize(kept);
+	return kept - before;
+}
+
+/**
+ *  @name   findVenueConflicts
+ *
+ *  @brief  Reports double bookings: overlapping events at the same location.
+ *
+ *  @param  [in,out] store     [\b EventStore*]                     Open store.
+ *  @param  [in]     from      [\b int64_t]                         Inclusive lower bound on start times.
+ *  @param  [in]     to        [\b int64_t]                         Exclusive upper bound on start times.
+ *  @param  [out]    conflicts [\b std::vector<ScheduleConflict>*]  Receives one entry per pair (appended).
+ *
+ *  @retval [\b size_t] Number of pairs appended.
+ *
+ *  @details
+ *  Meant for checking an imported venue calendar: the events starting in
+ *  the window are grouped by their exact location text (one room each)
+ *  and every group is swept separately. Events without a location are
+ *  ignored.
+ *
+ *  @complexity O(n log n + k) for n events in the window
+ */
+size_t findVenueConflicts(EventStore* store, int64_t from, int64_t to, std::vector<ScheduleConflict>* conflicts)
+{
+	if (!conflicts)
+	{
+		return 0;
+	}
+
+	std::vector<const Event*> events;
+	findEventsInRange(store, from, to, &events);
+	std::stable_sort(events.begin(), events.end(), locationLess);
+
+	size_t before = conflicts->size();
+	std::vector<ScheduleInterval> intervals;
+	for (size_t first = 0, last = 0; first < events.size(); first = last)
+	{
+		intervals.clear();
+		for (last = first; last < events.size() && strcmp(events[last]->location, events[first]->location) == 0; last++)
+		{
+			intervals.push_back(scheduleIntervalOf(events[last]));
+		}
+		if (events[first]->location[0] != '\0')
+		{
+			sweepScheduleConflicts(&intervals, true, conflicts);
+		}
+	}
+	return conflicts->size() - before;
+}
+
+/**
+ *  @name   deleteEvent
+ *
+ *  @brief  Removes an event and its time index entry.
+ *
+ *  @param  [in,out] store [\b EventStore*]  Open store.
+ *  @param  [in]     id    [\b int]          Event id.
+ *
+ *  @retval [\b int] 1 if removed; 0 if absent.
+ *
+ *  @warning Invalidates Event pointers, as described in BrentTable::erase().
+ */
+int deleteEvent(EventStore* store, int id)
+{
+	Event* event = NULL;
+	if (!findEventById(store, id, &event))
+	{
+		return 0;
+	}
+
+	char text[EVENT_TITLE_SIZE + EVENT_LOCATION_SIZE];
+	buildEventText(event, text, sizeof(text));
+	removeDocumentFromTextIndex(&store->text, (uint32_t)id, text);
+	removeTimeEntry(store, event->startTime, id);
+	unindexEventPlace(store, event);
+	const EventRecurrence* recurrence = store->recurrences.find(id);
+	if (recurrence)
+	{
+		unindexSeriesSpan(store, recurrence);
+		store->recurrences.erase(id);
+	}
+	removeAllAttendees(store, event);
+	return store->events.erase(id);
+}
+
+/**
+ *  @name   findEventsInRange
+ *
+ *  @brief  Collects the events starting in [from, to), ordered by start time.
+ *
+ *  @param  [in,out] store   [\b EventStore*]                  Open store.
+ *  @param  [in]     from    [\b int64_t]                      Inclusive lower bound.
+ *  @param  [in]     to      [\b int64_t]                      Exclusive upper bound.
+ *  @param  [out]    results [\b std::vector<const Event*>*]   Receives the matches (appended).
+ *
+ *  @retval [\b size_t] Number of events appended.
+ *
+ *  @details
+ *  One binary search per run locates @p from, then both runs are merged
+ *  until @p to, skipping holes. The pointers stay valid until the store
+ *  is next modified.
+ *
+ *  @complexity O(log n + k)
+ */
+size_t findEventsInRange(EventStore* store, int64_t from, int64_t to, std::vector<const Event*>* results)
+{
+	if (!store || !results || to <= from)
+	{
+		return 0;
+	}
+
+	TimeIndexCursor cursor;
+	openTimeIndexCursor(store, from, to, &cursor);
+	size_t found = 0;
+	for (const EventTimeEntry* entry = nextTimeEntry(&cursor); entry; entry = nextTimeEntry(&cursor))
+	{
+		const Event* event = store->events.find(entry->id);
+		if (event)
+		{
+			results->push_back(event);
+			found++;
+		}
+	}
+	return found;
+}
+
+/**
+ *  @name   nextOneOffEntry
+ *
+ *  @brief  Next index entry that belongs to an event without a recurrence rule.
+ */
+static const EventTimeEntry* nextOneOffEntry(EventStore* store, TimeIndexCursor* cursor)
+{
+	const EventTimeEntry* entry = nextTimeEntry(cursor);
+	while (entry && store->recurrences.size() > 0 && store->recurrences.find(entry->id))
+	{
+		entry = nextTimeEntry(cursor);
+	}
+	return entry;
+}
+
+typedef struct SeriesCursor {
+	OccurrenceIterator it;
+	const Event* event;
+} SeriesCursor;
+
+typedef struct SeriesHeapEntry {
+	int64_t startTime;    // current occurrence of the cursor
+	int id;
+	unsigned int cursor;  // index into the SeriesCursor array
+} SeriesHeapEntry;
+
+/**
+ *  @name   seriesEntryAfter
+ *
+ *  @brief  Heap order: the series with the earliest (start, id) is on top.
+ */
+static bool seriesEntryAfter(const SeriesHeapEntry& left, const SeriesHeapEntry& right)
+{
+	return left.startTime > right.startTime || (left.startTime == right.startTime && left.id > right.id);
+}
+
+/**
+ *  @name   pushOccurrence
+ *
+ *  @brief  Appends one occurrence, shifting the event's duration to its start.
+ */
+static void pushOccurrence(std::vector<EventOccurrence>* results, const Event* event, int64_t startTime)
+{
+	EventOccurrence occurrence = { event, startTime, startTime + (event->endTime - event->startTime) };
+	results->push_back(occurrence);
+}
+
+/**
+ *  @name   findOccurrencesInRange
+ *
+ *  @brief  Collects every occurrence starting in [from, to), one-off and recurring,
+ *          ordered by start time.
+ *
+ *  @param  [in,out] store   [\b EventStore*]                      Open store.
+ *  @param  [in]     from    [\b int64_t]                          Inclusive lower bound.
+ *  @param  [in]     to      [\b int64_t]                          Exclusive upper bound.
+ *  @param  [out]    results [\b std::vector<EventOccurrence>*]    Receives the occurrences (appended).
+ *
+ *  @retval [\b size_t] Number of occurrences appended.
+ *
+ *  @details
+ *  One-off events stream out of the time index as in findEventsInRange().
+ *  The interval tree of series spans yields only the recurring events
+ *  whose first-to-last start overlaps the window, so series that ended
+ *  before it or start after it are never visited. Each of those gets an
+ *  OccurrenceIterator, seeked there in O(1) from the start cached in its
+ *  EventRecurrence. A min-heap of 16-byte (start, id, cursor) keys merges
+ *  the iterators with the one-off stream. Only the iterators and the heap
+ *  are held besides the results; no occurrence list is built. Ties are
+ *  broken by event id.
+ *
+ *  @complexity O(log n + log r + a + k log a) for a of the r recurring
+ *              events active in the window and k results.
+ */
+size_t findOccurrencesInRange(EventStore* store, int64_t from, int64_t to, std::vector<EventOccurrence>* results)
+{
+	if (!store || !results || to <= from)
+	{
+		return 0;
+	}
+
+	std::vector<ScheduleConflict> active;
+	ScheduleInterval window = { from, to, 0 };
+	findScheduleOverlaps(&store->seriesSpans, &window, &active);
+
+	std::vector<SeriesCursor> series;
+	std::vector<SeriesHeapEntry> heap;
+	for (size_t i = 0; i < active.size(); i++)
+	{
+		const EventRecurrence* recurrence = store->recurrences.find(active[i].otherID);
+		SeriesCursor cursor;
+		if (recurrence
+			&& beginOccurrences(&cursor.it, recurrence, recurrence->firstStart, from, to)
+			&& (cursor.event = store->events.find(recurrence->eventID)) != NULL)
+		{
+			SeriesHeapEntry top = { cursor.it.startTime, recurrence->eventID, (unsigned int)series.size() };
+			series.push_back(cursor);
+			heap.push_back(top);
+		}
+	}
+	std::make_heap(heap.begin(), heap.end(), seriesEntryAfter);
+
+	TimeIndexCursor cursor;
+	openTimeIndexCursor(store, from, to, &cursor);
+	const EventTimeEntry* entry = nextOneOffEntry(store, &cursor);
+	size_t first = results->size();
+
+	while (entry || !heap.empty())
+	{
+		if (!heap.empty() && (!entry || heap.front().startTime < entry->startTime
+			|| (heap.front().startTime == entry->startTime && heap.front().id < entry->id)))
+		{
+			std::pop_heap(heap.begin(), heap.end(), seriesEntryAfter);
+			SeriesCursor& next = series[heap.back().cursor];
+			pushOccurrence(results, next.event, next.it.startTime);
+			if (advanceOccurrence(&next.it))
+			{
+				heap.back().startTime = next.it.startTime;
+				std::push_heap(heap.begin(), heap.end(), seriesEntryAfter);
+			}
+			else
+			{
+				heap.pop_back();
+			}
+			continue;
+		}
+
+		const Event* event = store->events.find(entry->id);
+		if (event)
+		{
+			pushOccurrence(results, event, event->startTime);
+		}
+		entry = nextOneOffEntry(store, &cursor);
+	}
+	return results->size() - first;
+}
+
+/**
+ *  @name   findEventsNear
+ *
+ *  @brief  Collects the events within a radius that start in [from, to).
+ *
+ *  @param  [in,out] store     [\b EventStore*]                  Open store.
+ *  @param  [in]     latitude  [\b double]                       Centre latitude in degrees.
+ *  @param  [in]     longitude [\b double]                       Centre longitude in degrees.
+ *  @param  [in]     radiusKm  [\b double]                       Search radius in kilometres.
+ *  @param  [in]     from      [\b int64_t]                      Inclusive start-time bound.
+ *  @param  [in]     to        [\b int64_t]                      Exclusive start-time bound.
+ *  @param  [out]    results   [\b std::vector<const Event*>*]   Receives the matches, nearest first (appended).
+ *
+ *  @retval [\b size_t] Number of events appended.
+ *
+ *  @details
+ *  The grid is searched over the circle's bounding box and each candidate
+ *  is checked by great-circle distance. Pass INT64_MIN and INT64_MAX to
+ *  ignore dates.
+ */
+size_t findEventsNear(EventStore* store, double latitude, double longitude, double radiusKm, int64_t from, int64_t to, std::vector<const Event*>* results)
+{
+	SpatialBox box;
+	if (!store || !results || !spatialBoxAroundPoint(latitude, longitude, radiusKm, &box))
+	{
+		return 0;
+	}
+
+	std::vector<SpatialEntry> candidates;
+	querySpatialBox(&store->places, &box, from, to, &candidates);
+
+	int32_t latitudeE6 = degreesToE6(latitude);
+	int32_t longitudeE6 = degreesToE6(longitude);
+	std::vector<std::pair<double, const Event*> > matches;
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		double distance = distanceKm(latitudeE6, longitudeE6, candidates[i].latitudeE6, candidates[i].longitudeE6);
+		const Event* event = distance <= radiusKm ? store->events.find(candidates[i].id) : NULL;
+		if (event)
+		{
+			matches.push_back(std::make_pair(distance, event));
+		}
+	}
+
+	std::sort(matches.begin(), matches.end(), placeDistanceLess);
+	for (size_t i = 0; i < matches.size(); i++)
+	{
+		results->push_back(matches[i].second);
+	}
+	return matches.size();
+}
+
+/**
+ *  @name   findEventsInBox
+ *
+ *  @brief  Collects the events inside a latitude/longitude box that start in [from, to).
+ *
+ *  @param  [in,out] store        [\b EventStore*]                  Open store.
+ *  @param  [in]     minLatitude  [\b double]                       Southern edge in degrees.
+ *  @param  [in]     minLongitude [\b double]                       Western edge in degrees.
+ *  @param  [in]     maxLatitude  [\b double]                       Northern edge in degrees.
+ *  @param  [in]     maxLongitude [\b double]                       Eastern edge; less than @p minLongitude
+ *                                                                  for a box crossing 180 degrees.
+ *  @param  [in]     from         [\b int64_t]                      Inclusive start-time bound.
+ *  @param  [in]     to           [\b int64_t]                      Exclusive start-time bound.
+ *  @param  [out]    results      [\b std::vector<const Event*>*]   Receives the matches by start time (appended).
+ *
+ *  @retval [\b size_t] Number of events appended.
+ */
+size_t findEventsInBox(EventStore* store, double minLatitude, double minLongitude, double maxLatitude, double maxLongitude, int64_t from, int64_t to, std::vector<const Event*>* results)
+{
+	if (!store || !results || !(minLatitude >= -90.0 && maxLatitude <= 90.0 && minLatitude <= maxLatitude)
+		|| !(minLongitude >= -180.0 && minLongitude <= 180.0 && maxLongitude >= -180.0 && maxLongitude <= 180.0))
+	{
+		return 0;
+	}
+
+	SpatialBox box = { degreesToE6(minLatitude), degreesToE6(maxLatitude), degreesToE6(minLongitude), degreesToE6(maxLongitude) };
+	std::vector<SpatialEntry> candidates;
+	querySpatialBox(&store->places, &box, from, to, &candidates);
+
+	size_t first = results->size();
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		const Event* event = store->events.find(candidates[i].id);
+		if (event)
+		{
+			results->push_back(event);
+		}
+	}
+	std::sort(results->begin() + first, results->end(), startTimeLess);
+	return results->size() - first;
+}
+
+/**
+ *  @name   searchEvents
+ *
+ *  @brief  Finds events by title/location keywords.
+ *
+ *  @param  [in,out] store   [\b EventStore*]                  Open store.
+ *  @param  [in]     query   [\b const char*]                  Keywords, e.g. "jazz kids".
+ *  @param  [in]     mode    [\b int]                          TEXT_QUERY_ALL or TEXT_QUERY_ANY.
+ *  @param  [out]    results [\b std::vector<const Event*>*]   Receives the matches in id order (appended).
+ *
+ *  @retval [\b size_t] Number of events appended.
+ */
+size_t searchEvents(EventStore* store, const char* query, int mode, std::vector<const Event*>* results)
+{
+	if (!store || !results)
+	{
+		return 0;
+	}
+
+	std::vector<uint32_t> ids;
+	searchTextIndex(&store->text, query, mode, &ids);
+	size_t found = 0;
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		const Event* event = store->events.find((int)ids[i]);
+		if (event)
+		{
+			results->push_back(event);
+			found++;
+		}
+	}
+	return found;
+}
+
+/**
+ *  @name   countEvents
+ *
+ *  @brief  Number of events in the store.
+ */
+size_t countEvents(const EventStore* store)
+{
+	return store ? store->events.size() : 0;
+}
+
+/**
+ *  @name   readRecurrenceSection
+ *
+ *  @brief  Reads the records of a recurrence section.
+ *
+ *  @retval [\b int] 1 on success; 0 if the section is damaged.
+ *
+ *  @details Rules whose event is missing or that fail validation are skipped.
+ */
+static int readRecurrenceSection(EventStore* store, FILE* file, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		RecurrenceFileRecord record;
+		if (fread(&record, sizeof(record), 1, file) != 1 || record.exceptionCount > RECURRENCE_MAX_EXCEPTIONS)
+		{
+			return 0;
+		}
+
+		std::vector<int64_t> exceptions((size_t)record.exceptionCount);
+		if (!exceptions.empty() && fread(exceptions.data(), sizeof(int64_t), exceptions.size(), file) != exceptions.size())
+		{
+			return 0;
+		}
+
+		RecurrenceRule rule = { record.frequency, record.interval, record.count, record.until };
+		if (!setEventRecurrence(store, record.eventID, &rule))
+		{
+			continue;
+		}
+		std::sort(exceptions.begin(), exceptions.end());
+		store->recurrences.find(record.eventID)->exceptions.swap(exceptions);
+	}
+	return 1;
+}
+
+/**
+ *  @name   writeRecurrenceSection
+ *
+ *  @brief  Writes every recurrence rule after the event records.
+ *
+ *  @retval [\b int] 1 on success; 0 on I/O failure.
+ */
+static int writeRecurrenceSection(const EventStore* store, FILE* file)
+{
+	EventSectionHeader section;
+	memcpy(section.magic, EVENT_RECURRENCE_MAGIC, sizeof(section.magic));
+	section.count = store->recurrences.size();
+	if (fwrite(&section, sizeof(section), 1, file) != 1)
+	{
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < store->recurrences.size(); i++)
+	{
+		const EventRecurrence* recurrence = store->recurrences.at(i);
+		RecurrenceFileRecord record;
+		memset(&record, 0, sizeof(record));
+		record.eventID = recurrence->eventID;
+		record.frequency = recurrence->rule.frequency;
+		record.interval = recurrence->rule.interval;
+		record.count = recurrence->rule.count;
+		record.until = recurrence->rule.until;
+		record.exceptionCount = recurrence->exceptions.size();
+		if (fwrite(&record, sizeof(record), 1, file) != 1
+			|| (!recurrence->exceptions.empty()
+				&& fwrite(recurrence->exceptions.data(), sizeof(int64_t), recurrence->exceptions.size(), file) != recurrence->exceptions.size()))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   readAttendeeSection
+ *
+ *  @brief  Reads the records of an attendee section.
+ *
+ *  @retval [\b int] 1 on success; 0 if the section is damaged.
+ *
+ *  @details Sets of events that no longer exist are skipped.
+ */
+static int readAttendeeSection(EventStore* store, FILE* file, uint32_t count)
+{
+	std::vector<uint8_t> bytes;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		AttendeeFileRecord record;
+		if (fread(&record, sizeof(record), 1, file) != 1 || record.byteCount > EVENT_MAX_ATTENDEE_BYTES)
+		{
+			return 0;
+		}
+
+		bytes.resize(record.byteCount);
+		IdSet users;
+		if ((!bytes.empty() && fread(bytes.data(), 1, bytes.size(), file) != bytes.size())
+			|| !idSetDeserialize(bytes.data(), bytes.size(), &users))
+		{
+			return 0;
+		}
+
+		std::vector<uint32_t> ids;
+		idSetToVector(&users, &ids);
+		for (size_t j = 0; j < ids.size(); j++)
+		{
+			addAttendee(store, record.eventID, (int)ids[j]);
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   writeAttendeeSection
+ *
+ *  @brief  Writes every non-empty attendee set after the event records.
+ *
+ *  @retval [\b int] 1 on success; 0 on I/O failure.
+ */
+static int writeAttendeeSection(const EventStore* store, FILE* file)
+{
+	EventSectionHeader section;
+	memcpy(section.magic, EVENT_ATTENDEE_MAGIC, sizeof(section.magic));
+	section.count = store->attendees.size();
+	if (fwrite(&section, sizeof(section), 1, file) != 1)
+	{
+		return 0;
+	}
+
+	std::vector<uint8_t> bytes;
+	for (unsigned int i = 0; i < store->attendees.size(); i++)
+	{
+		const EventAttendees* attendees = store->attendees.at(i);
+		bytes.clear();
+		idSetSerialize(&attendees->users, &bytes);
+
+		AttendeeFileRecord record = { attendees->eventID, (uint32_t)bytes.size() };
+		if (fwrite(&record, sizeof(record), 1, file) != 1 || fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   readEventSections
+ *
+ *  @brief  Reads the optional sections that follow the event records.
+ *
+ *  @retval [\b int] 1 if there are none or all were read; 0 on an unknown or damaged section.
+ */
+static int readEventSections(EventStore* store, FILE* file)
+{
+	EventSectionHeader section;
+	while (fread(&section, sizeof(section), 1, file) == 1)
+	{
+		int ok = 0;
+		if (memcmp(section.magic, EVENT_RECURRENCE_MAGIC, sizeof(section.magic)) == 0)
+		{
+			ok = readRecurrenceSection(store, file, section.count);
+		}
+		else if (memcmp(section.magic, EVENT_ATTENDEE_MAGIC, sizeof(section.magic)) == 0)
+		{
+			ok = readAttendeeSection(store, file, section.count);
+		}
+		if (!ok)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   loadEventsFromBinaryFile
+ *
+ *  @brief  Bulk-loads an events file written by saveEventsToBinaryFile().
+ *
+ *  @param  [in,out] store    [\b EventStore*]  Initialized store.
+ *  @param  [in]     filename [\b const char*]  Events file (e.g. "events.dat").
+ *
+ *  @retval [\b int] 1 on success (a missing file counts as empty); 0 if the
+ *          header is missing or damaged, the file holds fewer records than
+ *          the header counts, or allocation fails.
+ *
+ *  @details
+ *  Same layout as users.dat: a RecordFileHeader followed by fixed-width
+ *  records. The table is sized once from the header, records are read
+ *  EVENT_LOAD_BLOCK_RECORDS at a time into BrentTable::insertBulk()
+ *  (repeated ids are dropped, first one wins), and the time index is
+ *  rebuilt with one sort instead of n delta insertions. The keyword index
+ *  is rebuilt in id order and the spatial grid from scratch. Recurrence
+ *  rules and attendee sets come from optional sections after the
+ *  records, which older files simply lack.
+ */
+int loadEventsFromBinaryFile(EventStore* store, const char* filename)
+{
+	if (!store || !filename)
+	{
+		return 0;
+	}
+
+	FILE* file = fopen(filename, "rb");
+	if (!file)
+	{
+		return 1;
+	}
+
+	RecordFileHeader header;
+	if (readRecordFileHeader(file, sizeof(Event), &header) != RECORD_FILE_CURRENT
+		|| header.version != RECORD_FILE_VERSION
+		|| header.recordCount > UINT_MAX
+		|| !store->events.reserve(store->events.size() + (unsigned int)header.recordCount))
+	{
+		fclose(file);
+		return 0;
+	}
+
+	std::vector<Event> block(EVENT_LOAD_BLOCK_RECORDS);
+	uint64_t remaining = header.recordCount;
+	size_t read = 0;
+	int ok = 1;
+
+	while (remaining > 0 && (read = fread(block.data(), sizeof(Event), remaining < EVENT_LOAD_BLOCK_RECORDS ? (size_t)remaining : EVENT_LOAD_BLOCK_RECORDS, file)) > 0)
+	{
+		for (size_t i = 0; i < read; i++)
+		{
+			block[i].title[sizeof(block[i].title) - 1] = '\0';
+			block[i].location[sizeof(block[i].location) - 1] = '\0';
+		}
+
+		unsigned int consumed = 0;
+		store->events.insertBulk(block.data(), (unsigned int)read, &consumed);
+		if (consumed < read)
+		{
+			ok = 0;
+			break;
+		}
+		remaining -= read;
+	}
+	if (remaining != 0)
+	{
+		ok = 0;
+	}
+	if (ok)
+	{
+		ok = readEventSections(store, file);
+	}
+	fclose(file);
+
+	if (header.nextID > store->nextID)
+	{
+		store->nextID = header.nextID;
+	}
+	rebuildTimeIndex(store);
+	ok &= rebuildSpatialIndex(store);
+	return rebuildTextIndex(store) && ok;
+}
+
+/**
+ *  @name   saveEventsToBinaryFile
+ *
+ *  @brief  Writes every event to a record file.
+ *
+ *  @param  [in] store    [\b const EventStore*]  Store to persist.
+ *  @param  [in] filename [\b const char*]        Destination file.
+ *
+ *  @retval [\b int] 1 on success; 0 on I/O failure (the old file is kept).
+ *
+ *  @details
+ *  Writes a RecordFileHeader and the records to "<filename>.tmp", one
+ *  fwrite() per slab chunk, followed by the recurrence and attendee
+ *  sections when they have entries, then swaps it in with
+ *  replaceFileAtomically().
+ */
+int saveEventsToBinaryFile(const EventStore* store, const char* filename)
+{
+	if (!store || !filename)
+	{
+		return 0;
+	}
+
+	std::string tempName = std::string(filename) + ".tmp";
+	FILE* file = fopen(tempName.c_str(), "wb");
+	if (!file)
+	{
+		return 0;
+	}
+
+	unsigned int count = store->events.size();
+	RecordFileHeader header;
+	initRecordFileHeader(&header, RECORD_FILE_VERSION, sizeof(Event), count, store->nextID);
+	int ok = writeRecordFileHeader(file, &header);
+
+	for (unsigned int i = 0; ok && i < count; i += BRENT_RECORDS_PER_CHUNK)
+	{
+		size_t run = count - i < BRENT_RECORDS_PER_CHUNK ? count - i : BRENT_RECORDS_PER_CHUNK;
+		ok = fwrite(store->events.at(i), sizeof(Event), run, file) == run;
+	}
+	if (ok && store->recurrences.size() > 0)
+	{
+		ok = writeRecurrenceSection(store, file);
+	}
+	if (ok && store->attendees.size() > 0)
+	{
+		ok = writeAttendeeSection(store, file);
+	}
+
+	if (fclose(file) != 0)
+	{
+		ok = 0;
+	}
+	if (!ok)
+	{
+		remove(tempName.c_str());
+		return 0;
+	}
+	return replaceFileAtomically(tempName.c_str(), filename);
+}
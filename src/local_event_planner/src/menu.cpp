@@ -1,5 +1,8 @@
 #include "../header/menu.h"
+#include "../header/terminal.h"
+#include "../header/local_event_planner.h"
 #include <user_authentication.h>
+#include <algorithm>
 
 /**
  *  @name   isTestEnvironmentMenu
@@ -97,8 +100,10 @@ int getInput()
  *  @retval [\b int] 1 on successful print.
  *
  *  @details
- *  Clears the console screen, prints all menu items, and prefixes the selected
- *  one with a “>” marker. Also shows navigation instructions.
+ *  Draws one full frame with renderMenuFrame(): the screen is cleared with
+ *  an escape sequence rather than a "clear" process, the selected item is
+ *  prefixed with a “>” marker and navigation instructions are shown.
+ *  runMenu() keeps its own view and redraws only what changes.
  *
  *  @note   If `isTestEnvironmentMenu` is true, skips rendering and returns 1.
  */
@@ -107,13 +112,13 @@ int printMenu(const char menuItems[][30], int menuSize, int selectedIndex)
 	if (isTestEnvironmentMenu) 
 		return 1;
 
-	CLEAR_SCREEN();
-	std::printf("=== MENU ===\n");
-	for (int i = 0; i < menuSize; ++i) 
-	{
-		std::printf("%s %s\n", (i == selectedIndex ? ">" : " "), menuItems[i]);
-	}
-	std::printf("\nYön tuşlarıyla gez, ENTER ile seç.\n");
+	int rows, columns;
+	MenuView view;
+	std::string frame;
+	getTerminalSize(&rows, &columns);
+	initMenuView(&view);
+	renderMenuFrame(menuItems, menuSize, selectedIndex, rows, columns, &view, &frame);
+	writeTerminal(frame);
 	return 1;
 }
 
@@ -128,26 +133,38 @@ int printMenu(const char menuItems[][30], int menuSize, int selectedIndex)
  *  @retval [\b int] Index of the selected menu item when Enter is pressed.
  *
  *  @details
- *  Continuously displays the menu and processes user key input using
- *  `getInput()`. Updates the highlighted index according to arrow key input.
- *  When Enter is pressed, clears the screen and returns the current selection.
+ *  Opens one TerminalSession for the whole menu, so raw mode is set once
+ *  instead of around every key. Each key updates the selection and the
+ *  screen is brought up to date with a single write of the lines that
+ *  changed (see renderMenuFrame()). Page Up/Down move by a screenful in
+ *  lists taller than the terminal, and a resize redraws the frame at the
+ *  new size. When Enter is pressed the screen is cleared, the terminal
+ *  restored and the current selection returned.
  *
  *  @note
  *  - If `isTestEnvironmentMenu` is true, returns 0 immediately.
  *  - Uses circular navigation (wraps from first to last item and vice versa).
  *
- *  @complexity  O(menuSize) per full redraw cycle.
+ *  @complexity  O(1) lines written per arrow key after the first frame.
  */
 int runMenu(const char menuItems[][30], int menuSize) 
 {
 	if (isTestEnvironmentMenu) 
 		return 0;
 
+	TerminalSession terminal;
+	MenuView view;
+	std::string frame;
+	beginTerminalSession(&terminal);
+	initMenuView(&view);
+
 	int selectedIndex = 0;
 	while (true) 
 	{
-		printMenu(menuItems, menuSize, selectedIndex);
-		int input = getInput();
+		refreshTerminalSize(&terminal);
+		renderMenuFrame(menuItems, menuSize, selectedIndex, terminal.rows, terminal.columns, &view, &frame);
+		writeTerminal(frame);
+		int input = readTerminalKey(&terminal);
 
 		switch (input) 
 		{
@@ -157,8 +174,15 @@ int runMenu(const char menuItems[][30], int menuSize)
 		case DOWN_ARROW:
 			selectedIndex = (selectedIndex + 1) % menuSize;
 			break;
+		case PAGE_UP:
+			selectedIndex = std::max(selectedIndex - view.visibleRows, 0);
+			break;
+		case PAGE_DOWN:
+			selectedIndex = std::min(selectedIndex + view.visibleRows, menuSize - 1);
+			break;
 		case ENTER:
-			CLEAR_SCREEN();
+			writeTerminal("\x1b[H\x1b[2J");
+			endTerminalSession(&terminal);
 			return selectedIndex;
 		default:
 			break;
@@ -171,12 +195,17 @@ int runMenu(const char menuItems[][30], int menuSize)
  *
  *  @brief  Displays the initial user interaction menu (Register/Login/Guest/Exit).
  *
+ *  @param  [in,out] store     [\b UserStore*]   User store opened once by the application,
+ *                                              or NULL in read-only mode.
+ *  @param  [in]     usersFile [\b const char*]  Users file, for read-only logins.
+ *
  *  @retval [\b int] 0 on exit or test termination.
  *
  *  @details
  *  Presents four main options:
- *  - Register → Calls `initiateUserRegistration()`
- *  - Login → Calls `initiateUserLogin()`
+ *  - Register → Calls `initiateUserRegistration(store)`; unavailable without a store
+ *  - Login → Calls `initiateUserLogin(store, usersFile)`, which looks the
+ *    user up through the persistent index when there is no store
  *  - Guest Mode → Placeholder for guest functionality
  *  - Exit → Terminates the program
  *
@@ -189,7 +218,7 @@ int runMenu(const char menuItems[][30], int menuSize)
  *  @warning
  *  Future implementations should define `guestMenu()` before activation.
  */
-int firstMenu()
+int firstMenu(UserStore* store, const char* usersFile)
 {
 	const char mainMenuItems[][30] = 
 	{
@@ -207,11 +236,17 @@ int firstMenu()
 		{
 		case 0:
 			if (isTestEnvironmentMenu) return 0;
-			initiateUserRegistration();
+			if (!store)
+			{
+				printf("Registration is not available in read-only mode.\n");
+				WAIT(3);
+				break;
+			}
+			initiateUserRegistration(store);
 			break;
 		case 1:
 			if (isTestEnvironmentMenu) return 0;
-			initiateUserLogin();
+			initiateUserLogin(store, usersFile);
 			break;
 		case 2:
 			if (isTestEnvironmentMenu) return 0;
@@ -227,6 +262,183 @@ int firstMenu()
 	}
 }
 
+/**
+ *  @name   readMenuLine
+ *
+ *  @brief  Prompts for one non-empty line of text.
+ *
+ *  @param  [in]  prompt [\b const char*]  Text shown before the input.
+ *  @param  [out] buffer [\b char*]        Receives the line without its newline.
+ *  @param  [in]  size   [\b size_t]       Capacity of @p buffer in bytes.
+ *
+ *  @retval [\b int] 1 on success; 0 at end of input.
+ *
+ *  @details Blank lines are skipped, which also drops the newline an
+ *           earlier scanf() left behind.
+ */
+static int readMenuLine(const char* prompt, char* buffer, size_t size)
+{
+	printf("%s", prompt);
+	while (fgets(buffer, (int)size, stdin))
+	{
+		buffer[strcspn(buffer, "\r\n")] = '\0';
+		if (buffer[0] != '\0')
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ *  @name   readMenuTime
+ *
+ *  @brief  Prompts until a "YYYY-MM-DD HH:MM" time is entered.
+ *
+ *  @param  [in]  prompt [\b const char*]  Text shown before the input.
+ *  @param  [out] result [\b int64_t*]     Receives seconds since the epoch.
+ *
+ *  @retval [\b int] 1 on success; 0 at end of input.
+ */
+static int readMenuTime(const char* prompt, int64_t* result)
+{
+	char line[64];
+	DateTime dateTime;
+	while (readMenuLine(prompt, line, sizeof(line)))
+	{
+		if (parseDateTime(line, &dateTime))
+		{
+			*result = dateTimeToEpochSeconds(dateTime);
+			return 1;
+		}
+		printf("Invalid time! Use YYYY-MM-DD HH:MM.\n");
+	}
+	return 0;
+}
+
+/**
+ *  @name   createEventFromMenu
+ *
+ *  @brief  Asks for an event's details, adds it and saves the events file.
+ *
+ *  @param  [in,out] store  [\b EventStore*]  Events loaded by eventMenu().
+ *  @param  [in]     userID [\b int]          Owner of the new event.
+ *
+ *  @retval [\b int] 1 if the event was created and saved; 0 otherwise.
+ */
+static int createEventFromMenu(EventStore* store, int userID)
+{
+	char title[EVENT_TITLE_SIZE];
+	char location[EVENT_LOCATION_SIZE];
+	int64_t startTime, endTime;
+	Event* event = NULL;
+
+	if (!readMenuLine("Title: ", title, sizeof(title))
+		|| !readMenuLine("Location (- for none): ", location, sizeof(location))
+		|| !readMenuTime("Start (YYYY-MM-DD HH:MM): ", &startTime)
+		|| !readMenuTime("End (YYYY-MM-DD HH:MM): ", &endTime))
+	{
+		return 0;
+	}
+
+	if (!addEvent(store, userID, startTime, endTime, title, strcmp(location, "-") == 0 ? "" : location, &event))
+	{
+		printf("The event could not be created. Does it end before it starts?\n");
+		WAIT(3);
+		return 0;
+	}
+	int id = event->id;
+	if (!saveEventsToBinaryFile(store, EVENTS_FILE))
+	{
+		printf("Event %d was created but could not be saved.\n", id);
+		WAIT(3);
+		return 0;
+	}
+	printf("Event %d created.\n", id);
+	WAIT(3);
+	return 1;
+}
+
+/**
+ *  @name   manageEventsFromMenu
+ *
+ *  @brief  Lists a user's events by start time and deletes one on request.
+ *
+ *  @param  [in,out] store  [\b EventStore*]  Events loaded by eventMenu().
+ *  @param  [in]     userID [\b int]          User whose events to list.
+ *
+ *  @retval [\b int] 1 if an event was deleted and the file saved; 0 otherwise.
+ *
+ *  @details Only the owner of an event may delete it.
+ */
+static int manageEventsFromMenu(EventStore* store, int userID)
+{
+	std::vector<const Event*> events;
+	findEventsInRange(store, INT64_MIN, INT64_MAX, &events);
+
+	size_t owned = 0;
+	char start[32], end[32];
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		if (events[i]->ownerID != userID)
+		{
+			continue;
+		}
+		formatDateTime(dateTimeFromEpochSeconds(events[i]->startTime), start, sizeof(start));
+		formatDateTime(dateTimeFromEpochSeconds(events[i]->endTime), end, sizeof(end));
+		printf("%5d  %s - %s  %s%s%s\n", events[i]->id, start, end, events[i]->title,
+			events[i]->location[0] ? " @ " : "", events[i]->location);
+		owned++;
+	}
+	if (owned == 0)
+	{
+		printf("You have no events.\n");
+		WAIT(3);
+		return 0;
+	}
+
+	int id = 0;
+	Event* event = NULL;
+	printf("Enter an event id to delete (or 0 to return): ");
+	if (scanf("%d", &id) != 1 || id == 0)
+	{
+		return 0;
+	}
+	if (!findEventById(store, id, &event) || event->ownerID != userID)
+	{
+		printf("You have no event %d.\n", id);
+		WAIT(3);
+		return 0;
+	}
+
+	deleteEvent(store, id);
+	if (!saveEventsToBinaryFile(store, EVENTS_FILE))
+	{
+		printf("Event %d was deleted but the change could not be saved.\n", id);
+		WAIT(3);
+		return 0;
+	}
+	printf("Event %d deleted.\n", id);
+	WAIT(3);
+	return 1;
+}
+
+/**
+ *  @name   eventMenu
+ *
+ *  @brief  Create/Manage Events menu of a logged-in user.
+ *
+ *  @param  [in] userID   [\b const int]    Identifier of the logged-in user.
+ *  @param  [in] userName [\b const char*]  Username of the logged-in user.
+ *
+ *  @retval [\b int] 0 when the user returns; 1 if the events file cannot be loaded.
+ *
+ *  @details
+ *  Loads EVENTS_FILE once, and every change is saved before the menu is
+ *  shown again, so nothing is lost if the program is closed.
+ *
+ *  @note   When in test mode, the menu returns immediately.
+ */
 int eventMenu(const int userID, const char* userName)
 {
 	const char mainMenuItems[][30] = 
@@ -235,7 +447,20 @@ int eventMenu(const int userID, const char* userName)
 		"Manage Events",
 		"Return"
 	};
-	return 1;
+	if (isTestEnvironmentMenu) return 0;
+
+	EventStore store;
+	if (!initEventStore(&store))
+	{
+		return 1;
+	}
+	if (!loadEventsFromBinaryFile(&store, EVENTS_FILE))
+	{
+		printf("The events file %s could not be loaded.\n", EVENTS_FILE);
+		destroyEventStore(&store);
+		WAIT(3);
+		return 1;
+	}
 
 	while (true)
 	{
@@ -244,20 +469,37 @@ int eventMenu(const int userID, const char* userName)
 		switch (selection)
 		{
 		case 0:
-			if (isTestEnvironmentMenu) return 0;
-			//create event
+			printf("New event for %s\n", userName);
+			createEventFromMenu(&store, userID);
 			break;
 		case 1:
-			if (isTestEnvironmentMenu) return 0;
-			//Manage events
+			printf("Events of %s\n", userName);
+			manageEventsFromMenu(&store, userID);
 			break;
 		case 2:
-			if (isTestEnvironmentMenu) return 0;
-			//return
-			break;
+			destroyEventStore(&store);
+			return 0;
 		default:
 			printf("Invalid selection!\n");
 			break;
 		}
 	}
-}
\ No newline at end of file
+}
+
+/**
+ *  @name   mainMenu
+ *
+ *  @brief  Entry point for a logged-in user's session.
+ *
+ *  @param  [in] userID   [\b const int]    Identifier of the logged-in user.
+ *  @param  [in] userName [\b const char*]  Username of the logged-in user.
+ *
+ *  @retval [\b int] Result of the event menu.
+ *
+ *  @details
+ *  Forwards to `eventMenu()`, which hosts the event management actions.
+ */
+int mainMenu(const int userID, const char* userName)
+{
+	return eventMenu(userID, userName);
+}
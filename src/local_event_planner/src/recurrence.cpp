@@ -0,0 +1,192 @@
+#include "../header/recurrence.h"
+#include <algorithm>
+
+/**
+ *  @name   recurrenceStepSeconds
+ *
+ *  @brief  Fixed distance between occurrences of daily and weekly rules.
+ */
+static int64_t recurrenceStepSeconds(const RecurrenceRule* rule)
+{
+	return (int64_t)rule->interval * (rule->frequency == RECURRENCE_WEEKLY ? 7 : 1) * SECONDS_PER_DAY;
+}
+
+/**
+ *  @name   isValidRecurrenceRule
+ *
+ *  @brief  Checks a rule before it is attached to an event.
+ *
+ *  @retval [\b int] 1 if the frequency is known, the interval positive and
+ *          the count not negative; 0 otherwise.
+ */
+int isValidRecurrenceRule(const RecurrenceRule* rule)
+{
+	return rule && rule->frequency >= RECURRENCE_DAILY && rule->frequency <= RECURRENCE_MONTHLY
+		&& rule->interval >= 1 && rule->count >= 0;
+}
+
+/**
+ *  @name   occurrenceStart
+ *
+ *  @brief  Start time of occurrence @p index of a series.
+ *
+ *  @param  [in] rule       [\b const RecurrenceRule*]  Valid rule.
+ *  @param  [in] firstStart [\b int64_t]                Start of occurrence 0, seconds since the epoch.
+ *  @param  [in] index      [\b int64_t]                Occurrence number (>= 0).
+ *
+ *  @retval [\b int64_t] Start of the occurrence, ignoring count, until and exceptions.
+ *
+ *  @details
+ *  Daily and weekly rules add a fixed number of seconds. Monthly rules
+ *  keep the first occurrence's time of day and day of month; a day the
+ *  month does not have (the 31st in April) falls on its last day, so
+ *  every month of the series has exactly one occurrence and the index
+ *  maps to a month without counting skipped ones.
+ *
+ *  @complexity O(1)
+ */
+int64_t occurrenceStart(const RecurrenceRule* rule, int64_t firstStart, int64_t index)
+{
+	if (rule->frequency != RECURRENCE_MONTHLY)
+	{
+		return firstStart + index * recurrenceStepSeconds(rule);
+	}
+
+	DateTime first = dateTimeFromEpochSeconds(firstStart);
+	CivilDate civil = dateToCivil(dateOf(first));
+	int64_t month = (int64_t)civil.year * 12 + (civil.month - 1) + index * rule->interval;
+	int64_t year = floorDivide(month, 12);
+	uint32_t monthOfYear = (uint32_t)(month - year * 12 + 1);
+	uint32_t day = std::min(civil.day, daysInMonth(year, monthOfYear));
+	return daysFromCivil(year, monthOfYear, day) * SECONDS_PER_DAY + first.seconds;
+}
+
+/**
+ *  @name   firstIndexFrom
+ *
+ *  @brief  Smallest occurrence number whose start is not before @p from.
+ *
+ *  @complexity O(1): a division, plus at most two monthly corrections.
+ */
+static int64_t firstIndexFrom(const RecurrenceRule* rule, int64_t firstStart, int64_t from)
+{
+	if (from <= firstStart)
+	{
+		return 0;
+	}
+
+	if (rule->frequency != RECURRENCE_MONTHLY)
+	{
+		int64_t step = recurrenceStepSeconds(rule);
+		return (from - firstStart + step - 1) / step;
+	}
+
+	CivilDate first = dateToCivil(dateOf(dateTimeFromEpochSeconds(firstStart)));
+	CivilDate target = dateToCivil(dateOf(dateTimeFromEpochSeconds(from)));
+	int64_t months = ((int64_t)target.year * 12 + target.month) - ((int64_t)first.year * 12 + first.month);
+	int64_t index = months / rule->interval > 0 ? months / rule->interval - 1 : 0;
+	while (occurrenceStart(rule, firstStart, index) < from)
+	{
+		index++;
+	}
+	return index;
+}
+
+/**
+ *  @name   settleOccurrence
+ *
+ *  @brief  Moves the iterator past cancelled occurrences and ends it at the limits.
+ */
+static int settleOccurrence(OccurrenceIterator* it)
+{
+	while (it->valid)
+	{
+		const EventRecurrence* recurrence = it->recurrence;
+		if (!recurrence)
+		{
+			it->valid = it->index == 0 && it->startTime < it->to;
+			break;
+		}
+
+		it->startTime = occurrenceStart(&recurrence->rule, it->firstStart, it->index);
+		if ((recurrence->rule.count > 0 && it->index >= recurrence->rule.count)
+			|| it->startTime > recurrence->rule.until || it->startTime >= it->to)
+		{
+			it->valid = false;
+			break;
+		}
+
+		while (it->nextException < recurrence->exceptions.size() && recurrence->exceptions[it->nextException] < it->startTime)
+		{
+			it->nextException++;
+		}
+		if (it->nextException == recurrence->exceptions.size() || recurrence->exceptions[it->nextException] != it->startTime)
+		{
+			break;
+		}
+		it->index++;
+	}
+	return it->valid;
+}
+
+/**
+ *  @name   beginOccurrences
+ *
+ *  @brief  Positions an iterator on the first occurrence starting in [from, to).
+ *
+ *  @param  [out] it         [\b OccurrenceIterator*]       Iterator to set up.
+ *  @param  [in]  recurrence [\b const EventRecurrence*]    Series, or NULL for a one-off event.
+ *  @param  [in]  firstStart [\b int64_t]                   The event's own start time.
+ *  @param  [in]  from       [\b int64_t]                   Inclusive window start.
+ *  @param  [in]  to         [\b int64_t]                   Exclusive window end.
+ *
+ *  @retval [\b int] 1 if an occurrence exists in the window; 0 otherwise.
+ *
+ *  @details
+ *  Jumps straight to the window with firstIndexFrom() instead of
+ *  stepping through earlier occurrences. Occurrences are produced on
+ *  demand by advanceOccurrence(); nothing is materialized. The count
+ *  limit includes cancelled occurrences, so exceptions never shift it.
+ *
+ *  @warning The iterator refers to @p recurrence, which must outlive it.
+ */
+int beginOccurrences(OccurrenceIterator* it, const EventRecurrence* recurrence, int64_t firstStart, int64_t from, int64_t to)
+{
+	if (!it)
+	{
+		return 0;
+	}
+
+	it->recurrence = recurrence;
+	it->firstStart = firstStart;
+	it->to = to;
+	it->startTime = firstStart;
+	it->nextException = 0;
+	it->valid = from < to;
+	if (!recurrence)
+	{
+		it->index = firstStart >= from ? 0 : 1;
+		return settleOccurrence(it);
+	}
+
+	it->index = firstIndexFrom(&recurrence->rule, firstStart, from);
+	it->nextException = std::lower_bound(recurrence->exceptions.begin(), recurrence->exceptions.end(), from) - recurrence->exceptions.begin();
+	return settleOccurrence(it);
+}
+
+/**
+ *  @name   advanceOccurrence
+ *
+ *  @brief  Moves to the next occurrence in the window.
+ *
+ *  @retval [\b int] 1 if the iterator is on an occurrence; 0 once it is exhausted.
+ */
+int advanceOccurrence(OccurrenceIterator* it)
+{
+	if (!it || !it->valid)
+	{
+		return 0;
+	}
+	it->index++;
+	return settleOccurrence(it);
+}
@@ -0,0 +1,438 @@
+#include "../header/schedule_conflict.h"
+#include <algorithm>
+
+/**
+ *  @name   intervalLess
+ *
+ *  @brief  Tree order: by start time, then id.
+ */
+static bool intervalLess(const ScheduleInterval& left, const ScheduleInterval& right)
+{
+	return left.startTime < right.startTime || (left.startTime == right.startTime && left.id < right.id);
+}
+
+/**
+ *  @name   sweepLess
+ *
+ *  @brief  Sweep order: by start time, then end time, then id.
+ */
+static bool sweepLess(const ScheduleInterval& left, const ScheduleInterval& right)
+{
+	if (left.startTime != right.startTime)
+	{
+		return left.startTime < right.startTime;
+	}
+	return left.endTime < right.endTime || (left.endTime == right.endTime && left.id < right.id);
+}
+
+/**
+ *  @name   endsAfter
+ *
+ *  @brief  Heap predicate that keeps the earliest-ending interval on top.
+ */
+static bool endsAfter(const ScheduleInterval& left, const ScheduleInterval& right)
+{
+	return left.endTime > right.endTime;
+}
+
+static int64_t subtreeMaxEnd(const ScheduleTree* tree, int32_t node)
+{
+	return node == SCHEDULE_NO_NODE ? INT64_MIN : tree->nodes[node].maxEnd;
+}
+
+static void updateNode(ScheduleTree* tree, int32_t node)
+{
+	ScheduleNode* n = &tree->nodes[node];
+	n->maxEnd = std::max(n->interval.endTime, std::max(subtreeMaxEnd(tree, n->left), subtreeMaxEnd(tree, n->right)));
+}
+
+static int32_t rotateRight(ScheduleTree* tree, int32_t node)
+{
+	int32_t child = tree->nodes[node].left;
+	tree->nodes[node].left = tree->nodes[child].right;
+	tree->nodes[child].right = node;
+	updateNode(tree, node);
+	updateNode(tree, child);
+	return child;
+}
+
+static int32_t rotateLeft(ScheduleTree* tree, int32_t node)
+{
+	int32_t child = tree->nodes[node].right;
+	tree->nodes[node].right = tree->nodes[child].left;
+	tree->nodes[child].left = node;
+	updateNode(tree, node);
+	updateNode(tree, child);
+	return child;
+}
+
+/**
+ *  @name   nextPriority
+ *
+ *  @brief  xorshift32 step; random priorities keep the treap's expected depth O(log n).
+ */
+static uint32_t nextPriority(ScheduleTree* tree)
+{
+	uint32_t x = tree->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	tree->seed = x;
+	return x;
+}
+
+static int32_t insertNode(ScheduleTree* tree, int32_t node, int32_t created)
+{
+	if (node == SCHEDULE_NO_NODE)
+	{
+		return created;
+	}
+
+	if (intervalLess(tree->nodes[created].interval, tree->nodes[node].interval))
+	{
+		tree->nodes[node].left = insertNode(tree, tree->nodes[node].left, created);
+		if (tree->nodes[tree->nodes[node].left].priority > tree->nodes[node].priority)
+		{
+			return rotateRight(tree, node);
+		}
+	}
+	else
+	{
+		tree->nodes[node].right = insertNode(tree, tree->nodes[node].right, created);
+		if (tree->nodes[tree->nodes[node].right].priority > tree->nodes[node].priority)
+		{
+			return rotateLeft(tree, node);
+		}
+	}
+	updateNode(tree, node);
+	return node;
+}
+
+static int32_t removeNode(ScheduleTree* tree, int32_t node, const ScheduleInterval* interval, int* removed)
+{
+	if (node == SCHEDULE_NO_NODE)
+	{
+		return node;
+	}
+
+	ScheduleNode* n = &tree->nodes[node];
+	if (intervalLess(*interval, n->interval))
+	{
+		n->left = removeNode(tree, n->left, interval, removed);
+	}
+	else if (intervalLess(n->interval, *interval))
+	{
+		n->right = removeNode(tree, n->right, interval, removed);
+	}
+	else if (n->left == SCHEDULE_NO_NODE || n->right == SCHEDULE_NO_NODE)
+	{
+		int32_t child = n->left == SCHEDULE_NO_NODE ? n->right : n->left;
+		tree->freeNodes.push_back(node);
+		*removed = 1;
+		return child;
+	}
+	else if (tree->nodes[n->left].priority > tree->nodes[n->right].priority)
+	{
+		node = rotateRight(tree, node);
+		tree->nodes[node].right = removeNode(tree, tree->nodes[node].right, interval, removed);
+	}
+	else
+	{
+		node = rotateLeft(tree, node);
+		tree->nodes[node].left = removeNode(tree, tree->nodes[node].left, interval, removed);
+	}
+	updateNode(tree, node);
+	return node;
+}
+
+/**
+ *  @name   initScheduleTree
+ *
+ *  @brief  Prepares an empty interval tree.
+ *
+ *  @param  [out] tree [\b ScheduleTree*]  Tree to initialize.
+ */
+void initScheduleTree(ScheduleTree* tree)
+{
+	tree->nodes.clear();
+	tree->freeNodes.clear();
+	tree->root = SCHEDULE_NO_NODE;
+	tree->count = 0;
+	tree->seed = 0x9E3779B9u;
+}
+
+/**
+ *  @name   containsInterval
+ *
+ *  @brief  Whether an interval with the same start time and id is stored.
+ */
+static bool containsInterval(const ScheduleTree* tree, const ScheduleInterval* interval)
+{
+	int32_t node = tree->root;
+	while (node != SCHEDULE_NO_NODE)
+	{
+		const ScheduleNode* n = &tree->nodes[node];
+		if (intervalLess(*interval, n->interval))
+		{
+			node = n->left;
+		}
+		else if (intervalLess(n->interval, *interval))
+		{
+			node = n->right;
+		}
+		else
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *  @name   addScheduleInterval
+ *
+ *  @brief  Adds a commitment to an interval tree.
+ *
+ *  @param  [in,out] tree     [\b ScheduleTree*]            Tree from initScheduleTree().
+ *  @param  [in]     interval [\b const ScheduleInterval*]  Interval with endTime >= startTime.
+ *
+ *  @retval [\b int] 1 if added; 0 if the interval is invalid or one with the
+ *          same start time and id is already stored.
+ *
+ *  @details
+ *  The tree is a treap ordered by (startTime, id) whose nodes also keep the
+ *  largest end time of their subtree; that is what lets an overlap query
+ *  skip whole subtrees. Nodes live in a pooled vector and are reused after
+ *  removal.
+ *
+ *  @complexity O(log n) expected
+ */
+int addScheduleInterval(ScheduleTree* tree, const ScheduleInterval* interval)
+{
+	if (!tree || !interval || interval->endTime < interval->startTime || containsInterval(tree, interval))
+	{
+		return 0;
+	}
+
+	int32_t created;
+	if (!tree->freeNodes.empty())
+	{
+		created = tree->freeNodes.back();
+		tree->freeNodes.pop_back();
+	}
+	else
+	{
+		created = (int32_t)tree->nodes.size();
+		tree->nodes.push_back(ScheduleNode());
+	}
+
+	ScheduleNode* node = &tree->nodes[created];
+	node->interval = *interval;
+	node->maxEnd = interval->endTime;
+	node->priority = nextPriority(tree);
+	node->left = SCHEDULE_NO_NODE;
+	node->right = SCHEDULE_NO_NODE;
+	tree->root = insertNode(tree, tree->root, created);
+	tree->count++;
+	return 1;
+}
+
+/**
+ *  @name   removeScheduleInterval
+ *
+ *  @brief  Removes the interval with the given start time and id.
+ *
+ *  @retval [\b int] 1 if removed; 0 if it was not stored.
+ *
+ *  @complexity O(log n) expected
+ */
+int removeScheduleInterval(ScheduleTree* tree, const ScheduleInterval* interval)
+{
+	if (!tree || !interval)
+	{
+		return 0;
+	}
+
+	int removed = 0;
+	tree->root = removeNode(tree, tree->root, interval, &removed);
+	tree->count -= removed;
+	return removed;
+}
+
+/**
+ *  @name   hasScheduleOverlap
+ *
+ *  @brief  Whether any stored interval overlaps [startTime, endTime).
+ *
+ *  @retval [\b int] 1 if there is an overlap; 0 otherwise.
+ *
+ *  @details
+ *  Follows a single root-to-leaf path: when the left subtree ends after
+ *  @p startTime it either holds an overlap or its latest-ending interval
+ *  starts at or after @p endTime, and then so does everything to the right.
+ *
+ *  @complexity O(log n) expected
+ */
+int hasScheduleOverlap(const ScheduleTree* tree, int64_t startTime, int64_t endTime)
+{
+	int32_t node = tree ? tree->root : SCHEDULE_NO_NODE;
+	while (node != SCHEDULE_NO_NODE)
+	{
+		const ScheduleNode* n = &tree->nodes[node];
+		if (n->interval.startTime < endTime && startTime < n->interval.endTime)
+		{
+			return 1;
+		}
+		node = subtreeMaxEnd(tree, n->left) > startTime ? n->left : n->right;
+	}
+	return 0;
+}
+
+static void collectOverlaps(const ScheduleTree* tree, int32_t node, const ScheduleInterval* candidate, std::vector<ScheduleConflict>* conflicts)
+{
+	while (node != SCHEDULE_NO_NODE && tree->nodes[node].maxEnd > candidate->startTime)
+	{
+		const ScheduleNode* n = &tree->nodes[node];
+		collectOverlaps(tree, n->left, candidate, conflicts);
+		if (n->interval.startTime >= candidate->endTime)
+		{
+			return;
+		}
+		if (candidate->startTime < n->interval.endTime && n->interval.id != candidate->id)
+		{
+			ScheduleConflict conflict;
+			conflict.id = candidate->id;
+			conflict.otherID = n->interval.id;
+			conflict.overlapStart = std::max(candidate->startTime, n->interval.startTime);
+			conflict.overlapEnd = std::min(candidate->endTime, n->interval.endTime);
+			conflicts->push_back(conflict);
+		}
+		node = n->right;
+	}
+}
+
+/**
+ *  @name   findScheduleOverlaps
+ *
+ *  @brief  Lists the stored intervals that overlap a candidate.
+ *
+ *  @param  [in]  tree      [\b const ScheduleTree*]                 Tree to search.
+ *  @param  [in]  candidate [\b const ScheduleInterval*]             Prospective interval; a stored interval
+ *                                                                    with the same id is not reported.
+ *  @param  [out] conflicts [\b std::vector<ScheduleConflict>*]      Receives the overlaps by start time (appended).
+ *
+ *  @retval [\b size_t] Number of conflicts appended.
+ *
+ *  @details Subtrees that end before the candidate starts are skipped and
+ *           the walk stops at the first interval starting after it ends.
+ */
+size_t findScheduleOverlaps(const ScheduleTree* tree, const ScheduleInterval* candidate, std::vector<ScheduleConflict>* conflicts)
+{
+	if (!tree || !candidate || !conflicts || candidate->endTime < candidate->startTime)
+	{
+		return 0;
+	}
+
+	size_t before = conflicts->size();
+	collectOverlaps(tree, tree->root, candidate, conflicts);
+	return conflicts->size() - before;
+}
+
+/**
+ *  @name   scheduleIntervals
+ *
+ *  @brief  Copies the stored intervals in (startTime, id) order.
+ *
+ *  @retval [\b size_t] Number of intervals appended.
+ */
+size_t scheduleIntervals(const ScheduleTree* tree, std::vector<ScheduleInterval>* intervals)
+{
+	if (!tree || !intervals)
+	{
+		return 0;
+	}
+
+	size_t before = intervals->size();
+	std::vector<int32_t> path;
+	int32_t node = tree->root;
+	while (node != SCHEDULE_NO_NODE || !path.empty())
+	{
+		while (node != SCHEDULE_NO_NODE)
+		{
+			path.push_back(node);
+			node = tree->nodes[node].left;
+		}
+		node = path.back();
+		path.pop_back();
+		intervals->push_back(tree->nodes[node].interval);
+		node = tree->nodes[node].right;
+	}
+	return intervals->size() - before;
+}
+
+/**
+ *  @name   sweepScheduleConflicts
+ *
+ *  @brief  Reports every overlapping pair in a set of intervals.
+ *
+ *  @param  [in,out] intervals [\b std::vector<ScheduleInterval>*]  Intervals; sorted in place.
+ *  @param  [in]     sorted    [\b bool]                            Whether they are already ordered by start time.
+ *  @param  [out]    conflicts [\b std::vector<ScheduleConflict>*]  Receives one entry per overlapping pair (appended).
+ *
+ *  @retval [\b size_t] Number of conflicts appended.
+ *
+ *  @details
+ *  Sweeps the intervals by start time while a min-heap on end time holds
+ *  the ones still running. Finished intervals are popped before each new
+ *  one; everything left on the heap then overlaps it, so each heap entry
+ *  visited is a reported pair. Empty intervals overlap nothing after them
+ *  and are never pushed.
+ *
+ *  @complexity O(n log n + k) for k conflicts; O(n log n) without the sort
+ *              when @p sorted holds, because of the heap.
+ */
+size_t sweepScheduleConflicts(std::vector<ScheduleInterval>* intervals, bool sorted, std::vector<ScheduleConflict>* conflicts)
+{
+	if (!intervals || !conflicts)
+	{
+		return 0;
+	}
+
+	if (!sorted)
+	{
+		std::sort(intervals->begin(), intervals->end(), sweepLess);
+	}
+
+	size_t before = conflicts->size();
+	std::vector<ScheduleInterval> running;
+	for (size_t i = 0; i < intervals->size(); i++)
+	{
+		const ScheduleInterval& current = (*intervals)[i];
+		while (!running.empty() && running.front().endTime <= current.startTime)
+		{
+			std::pop_heap(running.begin(), running.end(), endsAfter);
+			running.pop_back();
+		}
+
+		for (size_t j = 0; j < running.size(); j++)
+		{
+			if (running[j].startTime >= current.endTime)
+			{
+				continue;  // only possible for an empty interval sharing a start time
+			}
+			ScheduleConflict conflict;
+			conflict.id = running[j].id;
+			conflict.otherID = current.id;
+			conflict.overlapStart = current.startTime;
+			conflict.overlapEnd = std::min(current.endTime, running[j].endTime);
+			conflicts->push_back(conflict);
+		}
+
+		if (current.endTime > current.startTime)
+		{
+			running.push_back(current);
+			std::push_heap(running.begin(), running.end(), endsAfter);
+		}
+	}
+	return conflicts->size() - before;
+}
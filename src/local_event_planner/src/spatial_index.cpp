@@ -0,0 +1,363 @@
+#include "../header/spatial_index.h"
+#include <algorithm>
+#include <cmath>
+
+#define SPATIAL_LONGITUDE_CELLS (360000000 / SPATIAL_CELL_E6)
+
+/**
+ *  @name   cellCoordinate
+ *
+ *  @brief  Grid row/column of a coordinate (floor division, also for negatives).
+ */
+static int32_t cellCoordinate(int32_t valueE6)
+{
+	return valueE6 >= 0 ? valueE6 / SPATIAL_CELL_E6 : -((-(int64_t)valueE6 + SPATIAL_CELL_E6 - 1) / SPATIAL_CELL_E6);
+}
+
+/**
+ *  @name   packCellKey
+ *
+ *  @brief  Packs a (row, column) cell into the table key.
+ */
+static uint64_t packCellKey(int32_t latitudeCell, int32_t longitudeCell)
+{
+	return ((uint64_t)(uint32_t)latitudeCell << 32) | (uint32_t)longitudeCell;
+}
+
+/**
+ *  @name   entryStartsBefore
+ *
+ *  @brief  lower_bound() predicate over a cell's start times.
+ */
+static bool entryStartsBefore(const SpatialEntry& entry, int64_t startTime)
+{
+	return entry.startTime < startTime;
+}
+
+static bool entryStartLess(const SpatialEntry& left, const SpatialEntry& right)
+{
+	return left.startTime < right.startTime;
+}
+
+/**
+ *  @name   degreesToE6
+ *
+ *  @brief  Converts degrees to the fixed-point micro-degrees stored in events.
+ */
+int32_t degreesToE6(double degrees)
+{
+	return (int32_t)std::llround(degrees * 1e6);
+}
+
+/**
+ *  @name   distanceKm
+ *
+ *  @brief  Great-circle distance between two points (haversine).
+ *
+ *  @retval [\b double] Distance in kilometres.
+ */
+double distanceKm(int32_t latitudeE6, int32_t longitudeE6, int32_t otherLatitudeE6, int32_t otherLongitudeE6)
+{
+	const double toRadians = 3.14159265358979323846 / 180e6;
+	double lat1 = latitudeE6 * toRadians;
+	double lat2 = otherLatitudeE6 * toRadians;
+	double dLat = lat2 - lat1;
+	double dLon = ((int64_t)otherLongitudeE6 - longitudeE6) * toRadians;
+
+	double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+		+ std::cos(lat1) * std::cos(lat2) * std::sin(dLon / 2) * std::sin(dLon / 2);
+	return 2.0 * SPATIAL_EARTH_RADIUS_KM * std::asin(std::sqrt(a < 1.0 ? a : 1.0));
+}
+
+/**
+ *  @name   spatialBoxAroundPoint
+ *
+ *  @brief  Smallest latitude/longitude box containing a circle.
+ *
+ *  @param  [in]  latitude  [\b double]       Centre latitude in degrees.
+ *  @param  [in]  longitude [\b double]       Centre longitude in degrees.
+ *  @param  [in]  radiusKm  [\b double]       Radius in kilometres (>= 0).
+ *  @param  [out] box       [\b SpatialBox*]  Receives the bounding box.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments.
+ *
+ *  @details
+ *  Longitude degrees shrink with cos(latitude). When the circle reaches
+ *  a pole every longitude is included; a box that crosses 180 degrees
+ *  has minLongitudeE6 > maxLongitudeE6.
+ */
+int spatialBoxAroundPoint(double latitude, double longitude, double radiusKm, SpatialBox* box)
+{
+	if (!box || radiusKm < 0.0 || latitude < -90.0 || latitude > 90.0 || longitude < -180.0 || longitude > 180.0)
+	{
+		return 0;
+	}
+
+	double deltaLatitude = radiusKm / SPATIAL_EARTH_RADIUS_KM * 180.0 / 3.14159265358979323846;
+	double minLatitude = latitude - deltaLatitude;
+	double maxLatitude = latitude + deltaLatitude;
+	box->minLatitudeE6 = degreesToE6(minLatitude < -90.0 ? -90.0 : minLatitude);
+	box->maxLatitudeE6 = degreesToE6(maxLatitude > 90.0 ? 90.0 : maxLatitude);
+
+	double cosine = std::cos(latitude * 3.14159265358979323846 / 180.0);
+	if (minLatitude <= -90.0 || maxLatitude >= 90.0 || cosine <= 0.0 || deltaLatitude / cosine >= 180.0)
+	{
+		box->minLongitudeE6 = -180000000;
+		box->maxLongitudeE6 = 180000000;
+		return 1;
+	}
+
+	double deltaLongitude = deltaLatitude / cosine;
+	double minLongitude = longitude - deltaLongitude;
+	double maxLongitude = longitude + deltaLongitude;
+	box->minLongitudeE6 = degreesToE6(minLongitude < -180.0 ? minLongitude + 360.0 : minLongitude);
+	box->maxLongitudeE6 = degreesToE6(maxLongitude > 180.0 ? maxLongitude - 360.0 : maxLongitude);
+	return 1;
+}
+
+/**
+ *  @name   boxContains
+ *
+ *  @brief  Whether a point lies in a box, honouring boxes that cross 180 degrees.
+ */
+static bool boxContains(const SpatialBox* box, int32_t latitudeE6, int32_t longitudeE6)
+{
+	if (latitudeE6 < box->minLatitudeE6 || latitudeE6 > box->maxLatitudeE6)
+	{
+		return false;
+	}
+	if (box->minLongitudeE6 <= box->maxLongitudeE6)
+	{
+		return longitudeE6 >= box->minLongitudeE6 && longitudeE6 <= box->maxLongitudeE6;
+	}
+	return longitudeE6 >= box->minLongitudeE6 || longitudeE6 <= box->maxLongitudeE6;
+}
+
+/**
+ *  @name   initSpatialIndex
+ *
+ *  @brief  Prepares an empty grid index.
+ *
+ *  @param  [out] index [\b SpatialIndex*]  Index to initialize.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid argument or allocation failure.
+ *
+ *  @details
+ *  Points are bucketed into SPATIAL_CELL_E6-sized cells. Only non-empty
+ *  cells exist, as entries of a BrentTable keyed by packed cell
+ *  coordinates, so a city-clustered data set costs memory in proportion
+ *  to the occupied area, not to the whole globe.
+ *
+ *  @warning The index must be released with destroySpatialIndex().
+ */
+int initSpatialIndex(SpatialIndex* index)
+{
+	if (!index || !index->cells.init())
+	{
+		return 0;
+	}
+	index->pointCount = 0;
+	return 1;
+}
+
+/**
+ *  @name   destroySpatialIndex
+ *
+ *  @brief  Frees every cell.
+ */
+void destroySpatialIndex(SpatialIndex* index)
+{
+	if (!index)
+	{
+		return;
+	}
+	index->cells.destroy();
+	index->pointCount = 0;
+}
+
+/**
+ *  @name   addSpatialPoint
+ *
+ *  @brief  Adds a point to its grid cell.
+ *
+ *  @param  [in,out] index [\b SpatialIndex*]        Open index.
+ *  @param  [in]     entry [\b const SpatialEntry*]  Point with id and start time.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid coordinates or allocation failure.
+ *
+ *  @details
+ *  Appends to the cell and only clears its @c sorted flag when the new
+ *  start time breaks the order; the next query re-sorts that cell.
+ */
+int addSpatialPoint(SpatialIndex* index, const SpatialEntry* entry)
+{
+	if (!index || !entry || entry->latitudeE6 < -90000000 || entry->latitudeE6 > 90000000
+		|| entry->longitudeE6 < -180000000 || entry->longitudeE6 > 180000000)
+	{
+		return 0;
+	}
+
+	uint64_t key = packCellKey(cellCoordinate(entry->latitudeE6), cellCoordinate(entry->longitudeE6));
+	SpatialCell* cell = index->cells.find(key);
+	if (!cell)
+	{
+		SpatialCell created;
+		created.key = key;
+		created.sorted = true;
+		cell = index->cells.insert(created);
+		if (!cell)
+		{
+			return 0;
+		}
+	}
+
+	if (!cell->entries.empty() && entry->startTime < cell->entries.back().startTime)
+	{
+		cell->sorted = false;
+	}
+	cell->entries.push_back(*entry);
+	index->pointCount++;
+	return 1;
+}
+
+/**
+ *  @name   removeSpatialPoint
+ *
+ *  @brief  Removes a point added with the same id, coordinates and start time.
+ *
+ *  @retval [\b int] 1 if removed; 0 if not found.
+ *
+ *  @details
+ *  Sorted cells are searched by start time; a cell left empty is dropped.
+ */
+int removeSpatialPoint(SpatialIndex* index, const SpatialEntry* entry)
+{
+	if (!index || !entry)
+	{
+		return 0;
+	}
+
+	uint64_t key = packCellKey(cellCoordinate(entry->latitudeE6), cellCoordinate(entry->longitudeE6));
+	SpatialCell* cell = index->cells.find(key);
+	if (!cell)
+	{
+		return 0;
+	}
+
+	std::vector<SpatialEntry>::iterator it = cell->sorted
+		? std::lower_bound(cell->entries.begin(), cell->entries.end(), entry->startTime, entryStartsBefore)
+		: cell->entries.begin();
+	for (; it != cell->entries.end() && (!cell->sorted || it->startTime == entry->startTime); ++it)
+	{
+		if (it->id == entry->id && it->startTime == entry->startTime)
+		{
+			cell->entries.erase(it);
+			index->pointCount--;
+			if (cell->entries.empty())
+			{
+				index->cells.erase(key);
+			}
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ *  @name   collectCell
+ *
+ *  @brief  Appends a cell's points that fall in the box and time range.
+ */
+static size_t collectCell(SpatialCell* cell, const SpatialBox* box, int64_t from, int64_t to, std::vector<SpatialEntry>* results)
+{
+	if (!cell->sorted)
+	{
+		std::stable_sort(cell->entries.begin(), cell->entries.end(), entryStartLess);
+		cell->sorted = true;
+	}
+
+	size_t found = 0;
+	std::vector<SpatialEntry>::const_iterator it = std::lower_bound(cell->entries.begin(), cell->entries.end(), from, entryStartsBefore);
+	for (; it != cell->entries.end() && it->startTime < to; ++it)
+	{
+		if (boxContains(box, it->latitudeE6, it->longitudeE6))
+		{
+			results->push_back(*it);
+			found++;
+		}
+	}
+	return found;
+}
+
+/**
+ *  @name   querySpatialBox
+ *
+ *  @brief  Collects the points inside a box that start in [from, to).
+ *
+ *  @param  [in,out] index   [\b SpatialIndex*]               Open index.
+ *  @param  [in]     box     [\b const SpatialBox*]           Area to search.
+ *  @param  [in]     from    [\b int64_t]                     Inclusive start-time bound.
+ *  @param  [in]     to      [\b int64_t]                     Exclusive start-time bound.
+ *  @param  [out]    results [\b std::vector<SpatialEntry>*]  Receives matching points (appended).
+ *
+ *  @retval [\b size_t] Number of points appended.
+ *
+ *  @details
+ *  Visits only the grid cells overlapping the box; inside each cell a
+ *  binary search skips to @p from, so a crowded city cell is not read
+ *  in full for a short date range. If the box spans more cells than
+ *  exist, the occupied cells are walked instead.
+ *
+ *  @complexity O(cells * log m + k) for cells overlapping the box.
+ */
+size_t querySpatialBox(SpatialIndex* index, const SpatialBox* box, int64_t from, int64_t to, std::vector<SpatialEntry>* results)
+{
+	if (!index || !box || !results || to <= from || box->minLatitudeE6 > box->maxLatitudeE6)
+	{
+		return 0;
+	}
+
+	int32_t firstRow = cellCoordinate(box->minLatitudeE6);
+	int32_t lastRow = cellCoordinate(box->maxLatitudeE6);
+	int32_t firstColumn = cellCoordinate(box->minLongitudeE6);
+	int32_t lastColumn = cellCoordinate(box->maxLongitudeE6);
+	int64_t columns = box->minLongitudeE6 <= box->maxLongitudeE6
+		? (int64_t)lastColumn - firstColumn + 1
+		: (int64_t)lastColumn - firstColumn + 1 + SPATIAL_LONGITUDE_CELLS + 1;
+	int64_t gridCells = ((int64_t)lastRow - firstRow + 1) * columns;
+
+	size_t found = 0;
+	if (gridCells > (int64_t)index->cells.size())
+	{
+		for (unsigned int i = 0; i < index->cells.size(); i++)
+		{
+			SpatialCell* cell = index->cells.at(i);
+			int32_t row = (int32_t)(cell->key >> 32);
+			if (row >= firstRow && row <= lastRow)
+			{
+				found += collectCell(cell, box, from, to, results);
+			}
+		}
+		return found;
+	}
+
+	for (int32_t row = firstRow; row <= lastRow; row++)
+	{
+		for (int64_t offset = 0; offset < columns; offset++)
+		{
+			int32_t column = (int32_t)(firstColumn + offset);
+			if (column > cellCoordinate(180000000))
+			{
+				// Box crosses 180 degrees: continue from the -180 column.
+				column = (int32_t)(column - (cellCoordinate(180000000) - cellCoordinate(-180000000) + 1));
+			}
+
+			SpatialCell* cell = index->cells.find(packCellKey(row, column));
+			if (cell)
+			{
+				found += collectCell(cell, box, from, to, results);
+			}
+		}
+	}
+	return found;
+}
@@ -0,0 +1,563 @@
+#include "../header/terminal.h"
+#include "../header/menu.h"
+#include <algorithm>
+#if !defined(_WIN32)
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#endif
+
+#if defined(_WIN32) && !defined(ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+
+#define TERMINAL_ESCAPE_TIMEOUT_MS 50   // a lone ESC is not followed by the rest of a sequence
+
+static const char* const menuTitle = "=== MENU ===";
+static const char* const menuHint = "Yön tuşlarıyla gez, ENTER ile seç.";
+
+#if !defined(_WIN32)
+static volatile sig_atomic_t terminalResized = 0;
+
+static void onTerminalResize(int)
+{
+	terminalResized = 1;
+}
+#endif
+
+// Copy of the open session's saved mode, for when the program ends inside it.
+static volatile sig_atomic_t terminalRestorePending = 0;
+static bool terminalExitHookInstalled = false;
+#if defined(_WIN32)
+static HANDLE restoreOutput;
+static DWORD restoreOutputMode;
+static bool restoreModeSaved = false;
+#else
+static struct termios restoreMode;
+static bool restoreModeSaved = false;
+static struct sigaction previousInterruptAction;
+static struct sigaction previousTerminateAction;
+#endif
+
+/**
+ *  @name   restoreTerminalNow
+ *
+ *  @brief  Shows the cursor and puts back the mode of a session that was not ended.
+ *
+ *  @details Only async-signal-safe calls are used, so the SIGINT/SIGTERM
+ *           handler can call it. Does nothing outside a session.
+ */
+static void restoreTerminalNow()
+{
+	if (!terminalRestorePending)
+	{
+		return;
+	}
+	terminalRestorePending = 0;
+	static const char showCursor[] = "\x1b[?25h";
+#if defined(_WIN32)
+	DWORD written;
+	if (restoreModeSaved)
+	{
+		SetConsoleMode(restoreOutput, restoreOutputMode);
+	}
+	WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), showCursor, sizeof(showCursor) - 1, &written, NULL);
+#else
+	ssize_t written = write(STDOUT_FILENO, showCursor, sizeof(showCursor) - 1);
+	(void)written;
+	if (restoreModeSaved)
+	{
+		tcsetattr(STDIN_FILENO, TCSANOW, &restoreMode);
+	}
+#endif
+}
+
+static void restoreTerminalAtExit()
+{
+	restoreTerminalNow();
+}
+
+#if defined(_WIN32)
+static BOOL WINAPI onConsoleControl(DWORD)
+{
+	restoreTerminalNow();
+	return FALSE; // let the default handler end the process
+}
+#else
+/**
+ *  @name   onTerminalSignal
+ *
+ *  @brief  Restores the terminal, then lets SIGINT/SIGTERM do what it did before the session.
+ */
+static void onTerminalSignal(int signal)
+{
+	restoreTerminalNow();
+	sigaction(signal, signal == SIGINT ? &previousInterruptAction : &previousTerminateAction, NULL);
+	raise(signal);
+}
+
+/**
+ *  @name   catchTerminalSignal
+ *
+ *  @brief  Routes a signal through onTerminalSignal() unless it is ignored.
+ */
+static void catchTerminalSignal(int signal, struct sigaction* previous)
+{
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onTerminalSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(signal, &action, previous);
+	if (previous->sa_handler == SIG_IGN)
+	{
+		sigaction(signal, previous, NULL);
+	}
+}
+#endif
+
+/**
+ *  @name   getTerminalSize
+ *
+ *  @brief  Current size of the terminal window.
+ *
+ *  @param  [out] rows    [\b int*]  Receives the number of rows.
+ *  @param  [out] columns [\b int*]  Receives the number of columns.
+ *
+ *  @details Falls back to TERMINAL_DEFAULT_ROWS x TERMINAL_DEFAULT_COLUMNS
+ *           when the output is not a terminal.
+ */
+void getTerminalSize(int* rows, int* columns)
+{
+	*rows = TERMINAL_DEFAULT_ROWS;
+	*columns = TERMINAL_DEFAULT_COLUMNS;
+#if defined(_WIN32)
+	CONSOLE_SCREEN_BUFFER_INFO info;
+	if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+	{
+		*rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+		*columns = info.srWindow.Right - info.srWindow.Left + 1;
+	}
+#else
+	struct winsize size;
+	if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0)
+	{
+		*rows = size.ws_row;
+		*columns = size.ws_col;
+	}
+#endif
+}
+
+/**
+ *  @name   writeTerminal
+ *
+ *  @brief  Sends a rendered frame to the terminal in one write.
+ *
+ *  @retval [\b int] 1 if every byte was written; 0 otherwise.
+ *
+ *  @details Pending stdio output is flushed first so it stays in order.
+ */
+int writeTerminal(const std::string& bytes)
+{
+	fflush(stdout);
+#if defined(_WIN32)
+	size_t written = fwrite(bytes.data(), 1, bytes.size(), stdout);
+	fflush(stdout);
+	return written == bytes.size();
+#else
+	size_t written = 0;
+	while (written < bytes.size())
+	{
+		ssize_t result = write(STDOUT_FILENO, bytes.data() + written, bytes.size() - written);
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (result <= 0)
+		{
+			return 0;
+		}
+		written += (size_t)result;
+	}
+	return 1;
+#endif
+}
+
+/**
+ *  @name   beginTerminalSession
+ *
+ *  @brief  Switches the terminal to key-at-a-time input for a whole menu session.
+ *
+ *  @param  [out] terminal [\b TerminalSession*]  Session state to fill.
+ *
+ *  @retval [\b int] 1 if raw mode is on; 0 if input is not a terminal (keys are
+ *          then read as they come).
+ *
+ *  @details
+ *  The old getInput() switched modes twice for every key; here
+ *  tcsetattr() runs once when the menu opens and once when it closes.
+ *  Echo and line buffering are turned off, the cursor is hidden and a
+ *  SIGWINCH handler (installed without SA_RESTART) lets a blocked key read
+ *  return when the window is resized. On Windows the console's ANSI
+ *  processing is enabled instead; a resize is noticed at the next key.
+ *
+ *  If the program ends inside the session, the mode and cursor are still
+ *  put back: a SIGINT/SIGTERM handler (a console control handler on
+ *  Windows) restores them and re-raises the signal with the action it
+ *  had before, and an atexit() hook covers exit() calls. Signals that
+ *  were ignored stay ignored.
+ *
+ *  @warning Every successful call must be paired with endTerminalSession().
+ */
+int beginTerminalSession(TerminalSession* terminal)
+{
+	terminal->active = false;
+	getTerminalSize(&terminal->rows, &terminal->columns);
+#if defined(_WIN32)
+	terminal->output = GetStdHandle(STD_OUTPUT_HANDLE);
+	if (GetConsoleMode(terminal->output, &terminal->savedOutputMode))
+	{
+		SetConsoleMode(terminal->output, terminal->savedOutputMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+		terminal->active = true;
+	}
+	restoreOutput = terminal->output;
+	restoreOutputMode = terminal->savedOutputMode;
+	restoreModeSaved = terminal->active;
+	SetConsoleCtrlHandler(onConsoleControl, TRUE);
+#else
+	if (tcgetattr(STDIN_FILENO, &terminal->savedMode) == 0)
+	{
+		struct termios raw = terminal->savedMode;
+		raw.c_lflag &= static_cast<unsigned>(~(ICANON | ECHO));
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		terminal->active = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onTerminalResize;
+	sigemptyset(&action.sa_mask);
+	terminalResized = 0;
+	sigaction(SIGWINCH, &action, &terminal->savedResizeAction);
+
+	restoreMode = terminal->savedMode;
+	restoreModeSaved = terminal->active;
+	catchTerminalSignal(SIGINT, &previousInterruptAction);
+	catchTerminalSignal(SIGTERM, &previousTerminateAction);
+#endif
+	if (!terminalExitHookInstalled)
+	{
+		atexit(restoreTerminalAtExit);
+		terminalExitHookInstalled = true;
+	}
+	terminalRestorePending = 1;
+	writeTerminal("\x1b[?25l");
+	return terminal->active;
+}
+
+/**
+ *  @name   endTerminalSession
+ *
+ *  @brief  Restores the terminal mode and cursor saved by beginTerminalSession().
+ */
+void endTerminalSession(TerminalSession* terminal)
+{
+	terminalRestorePending = 0;
+	writeTerminal("\x1b[?25h");
+#if defined(_WIN32)
+	if (terminal->active)
+	{
+		SetConsoleMode(terminal->output, terminal->savedOutputMode);
+	}
+	SetConsoleCtrlHandler(onConsoleControl, FALSE);
+#else
+	if (terminal->active)
+	{
+		tcsetattr(STDIN_FILENO, TCSANOW, &terminal->savedMode);
+	}
+	sigaction(SIGWINCH, &terminal->savedResizeAction, NULL);
+	sigaction(SIGINT, &previousInterruptAction, NULL);
+	sigaction(SIGTERM, &previousTerminateAction, NULL);
+#endif
+	terminal->active = false;
+}
+
+/**
+ *  @name   refreshTerminalSize
+ *
+ *  @brief  Re-reads the window size.
+ *
+ *  @retval [\b int] 1 if it changed since the last call; 0 otherwise.
+ */
+int refreshTerminalSize(TerminalSession* terminal)
+{
+	int rows, columns;
+#if !defined(_WIN32)
+	terminalResized = 0;
+#endif
+	getTerminalSize(&rows, &columns);
+	if (rows == terminal->rows && columns == terminal->columns)
+	{
+		return 0;
+	}
+	terminal->rows = rows;
+	terminal->columns = columns;
+	return 1;
+}
+
+#if !defined(_WIN32)
+/**
+ *  @name   readSequenceByte
+ *
+ *  @brief  Reads the next byte of an escape sequence, giving up after a short pause.
+ */
+static int readSequenceByte()
+{
+	struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+	unsigned char ch;
+	if (poll(&input, 1, TERMINAL_ESCAPE_TIMEOUT_MS) <= 0 || read(STDIN_FILENO, &ch, 1) != 1)
+	{
+		return -1;
+	}
+	return ch;
+}
+#endif
+
+/**
+ *  @name   readTerminalKey
+ *
+ *  @brief  Waits for a key and maps it to a menu Key.
+ *
+ *  @param  [in,out] terminal [\b TerminalSession*]  Session from beginTerminalSession().
+ *
+ *  @retval [\b int] UP_ARROW, DOWN_ARROW, PAGE_UP, PAGE_DOWN or ENTER; RESIZE if
+ *          the window changed size while waiting; NONE for any other key.
+ *
+ *  @details Arrow and page keys are accepted in both the CSI ("ESC [") and
+ *           SS3 ("ESC O") forms terminals send.
+ */
+int readTerminalKey(TerminalSession* terminal)
+{
+#if defined(_WIN32)
+	(void)terminal;
+	int ch = _getch();
+	if (ch == 0 || ch == 224)
+	{
+		switch (_getch())
+		{
+		case 72: return UP_ARROW;
+		case 80: return DOWN_ARROW;
+		case 73: return PAGE_UP;
+		case 81: return PAGE_DOWN;
+		default: return NONE;
+		}
+	}
+	return ch == 13 ? ENTER : NONE;
+#else
+	(void)terminal;
+	unsigned char ch;
+	ssize_t result = read(STDIN_FILENO, &ch, 1);
+	if (result < 0 && errno == EINTR)
+	{
+		return terminalResized ? RESIZE : NONE;
+	}
+	if (result != 1)
+	{
+		return NONE;
+	}
+	if (ch == '\n' || ch == '\r')
+	{
+		return ENTER;
+	}
+	if (ch != 27)
+	{
+		return NONE;
+	}
+
+	int introducer = readSequenceByte();
+	if (introducer != '[' && introducer != 'O')
+	{
+		return NONE;
+	}
+	switch (readSequenceByte())
+	{
+	case 'A': return UP_ARROW;
+	case 'B': return DOWN_ARROW;
+	case '5': return readSequenceByte() == '~' ? PAGE_UP : NONE;
+	case '6': return readSequenceByte() == '~' ? PAGE_DOWN : NONE;
+	default:  return NONE;
+	}
+#endif
+}
+
+/**
+ *  @name   initMenuView
+ *
+ *  @brief  Resets a view so the next frame is drawn in full.
+ */
+void initMenuView(MenuView* view)
+{
+	memset(view, 0, sizeof(*view));
+}
+
+/**
+ *  @name   appendLine
+ *
+ *  @brief  Appends "move to row, write text, clear the rest of the line".
+ *
+ *  @details The text is cut one column short of the width so the terminal
+ *           never wraps, without splitting a UTF-8 character.
+ */
+static void appendLine(std::string* frame, int row, const char* text, int columns)
+{
+	char position[24];
+	snprintf(position, sizeof(position), "\x1b[%d;1H", row);
+	frame->append(position);
+
+	size_t length = strlen(text);
+	size_t width = (size_t)std::max(columns - 1, 1);
+	if (length > width)
+	{
+		length = width;
+		while (length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80)
+		{
+			length--;
+		}
+	}
+	frame->append(text, length);
+	frame->append("\x1b[K");
+}
+
+static void appendItem(std::string* frame, const char menuItems[][30], int index, int selectedIndex, const MenuView* view)
+{
+	char text[40];
+	snprintf(text, sizeof(text), "%s %s", index == selectedIndex ? ">" : " ", menuItems[index]);
+	appendLine(frame, MENU_HEADER_ROWS + 1 + index - view->top, text, view->columns);
+}
+
+static void appendFooter(std::string* frame, int menuSize, int selectedIndex, const MenuView* view)
+{
+	char text[96];
+	if (menuSize > view->visibleRows)
+	{
+		snprintf(text, sizeof(text), "%s (%d/%d)", menuHint, selectedIndex + 1, menuSize);
+	}
+	else
+	{
+		snprintf(text, sizeof(text), "%s", menuHint);
+	}
+	appendLine(frame, MENU_HEADER_ROWS + view->visibleRows + MENU_FOOTER_ROWS, text, view->columns);
+}
+
+/**
+ *  @name   renderMenuFrame
+ *
+ *  @brief  Builds the escape sequences that bring the screen to a new menu state.
+ *
+ *  @param  [in]     menuItems     [\b const char[][30]]  Menu labels.
+ *  @param  [in]     menuSize      [\b int]               Number of labels.
+ *  @param  [in]     selectedIndex [\b int]               Highlighted label.
+ *  @param  [in]     rows          [\b int]               Terminal height.
+ *  @param  [in]     columns       [\b int]               Terminal width.
+ *  @param  [in,out] view          [\b MenuView*]         What is on screen; updated.
+ *  @param  [out]    frame         [\b std::string*]      Receives the bytes for writeTerminal().
+ *
+ *  @retval [\b size_t] Number of screen lines written.
+ *
+ *  @details
+ *  The first frame, and any frame after a resize or a change of menu,
+ *  clears the screen with an escape sequence (no "clear" process) and
+ *  draws everything. After that only the lines that differ are written:
+ *  moving the highlight rewrites the old and the new item. When the
+ *  selection leaves a list taller than the screen, the item rows are set
+ *  as the scrolling region and scrolled by the offset, so only the rows
+ *  that scrolled in are drawn. The item counter in the footer is shown
+ *  only for lists that scroll.
+ */
+size_t renderMenuFrame(const char menuItems[][30], int menuSize, int selectedIndex, int rows, int columns, MenuView* view, std::string* frame)
+{
+	frame->clear();
+	if (menuSize <= 0 || !view)
+	{
+		return 0;
+	}
+
+	selectedIndex = std::min(std::max(selectedIndex, 0), menuSize - 1);
+	int visibleRows = std::max(1, std::min(menuSize, rows - MENU_HEADER_ROWS - MENU_FOOTER_ROWS));
+	bool full = view->rows != rows || view->columns != columns || view->itemCount != menuSize;
+	int previousTop = full ? 0 : view->top;
+	int top = view->rows && view->itemCount == menuSize ? view->top : 0;
+	if (selectedIndex < top)
+	{
+		top = selectedIndex;
+	}
+	else if (selectedIndex >= top + visibleRows)
+	{
+		top = selectedIndex - visibleRows + 1;
+	}
+	top = std::max(0, std::min(top, menuSize - visibleRows));
+
+	int previousSelected = view->selected;
+	view->rows = rows;
+	view->columns = columns;
+	view->itemCount = menuSize;
+	view->visibleRows = visibleRows;
+	view->top = top;
+	view->selected = selectedIndex;
+
+	size_t lines = 0;
+	if (full)
+	{
+		frame->append("\x1b[H\x1b[2J");
+		appendLine(frame, 1, menuTitle, columns);
+		for (int i = top; i < top + visibleRows; i++)
+		{
+			appendItem(frame, menuItems, i, selectedIndex, view);
+		}
+		appendFooter(frame, menuSize, selectedIndex, view);
+		return (size_t)visibleRows + 2;
+	}
+
+	// Items [exposedFirst, exposedLast) come into view and are drawn in full.
+	int delta = top - previousTop;
+	int exposedFirst = 0, exposedLast = 0;
+	if (delta != 0 && std::abs(delta) < visibleRows)
+	{
+		char scroll[48];
+		snprintf(scroll, sizeof(scroll), "\x1b[%d;%dr\x1b[%d%c\x1b[r", MENU_HEADER_ROWS + 1, MENU_HEADER_ROWS + visibleRows,
+			std::abs(delta), delta > 0 ? 'S' : 'T');
+		frame->append(scroll);
+		exposedFirst = delta > 0 ? top + visibleRows - delta : top;
+		exposedLast = exposedFirst + std::abs(delta);
+	}
+	else if (delta != 0)
+	{
+		exposedFirst = top;
+		exposedLast = top + visibleRows;
+	}
+	for (int i = exposedFirst; i < exposedLast; i++)
+	{
+		appendItem(frame, menuItems, i, selectedIndex, view);
+		lines++;
+	}
+
+	if (previousSelected != selectedIndex)
+	{
+		int changed[2] = { previousSelected, selectedIndex };
+		for (int k = 0; k < 2; k++)
+		{
+			int i = changed[k];
+			if (i >= top && i < top + visibleRows && (i < exposedFirst || i >= exposedLast))
+			{
+				appendItem(frame, menuItems, i, selectedIndex, view);
+				lines++;
+			}
+		}
+		if (menuSize > visibleRows)
+		{
+			appendFooter(frame, menuSize, selectedIndex, view);
+			lines++;
+		}
+	}
+	return lines;
+}
@@ -0,0 +1,641 @@
+#include "../header/text_index.h"
+#include <algorithm>
+
+/**
+ *  @name   isTokenByte
+ *
+ *  @brief  Whether a byte belongs to a token.
+ *
+ *  @details
+ *  ASCII letters and digits, plus every byte >= 0x80 so UTF-8 letters
+ *  (e.g. Turkish ç, ş, ğ) stay inside their word.
+ */
+static bool isTokenByte(unsigned char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+/**
+ *  @name   tokenizeText
+ *
+ *  @brief  Splits text into lowercase search terms.
+ *
+ *  @param  [in]  text   [\b const char*]                Null-terminated text; NULL counts as empty.
+ *  @param  [out] tokens [\b std::vector<std::string>*]  Receives the distinct terms, sorted (replaced).
+ *
+ *  @retval [\b size_t] Number of distinct terms.
+ *
+ *  @details
+ *  Runs of token bytes form a term; ASCII is lowercased. Terms shorter
+ *  than TEXT_MIN_TOKEN_LENGTH are dropped and longer ones truncated to
+ *  TEXT_MAX_TOKEN_LENGTH bytes, so documents and queries agree.
+ */
+size_t tokenizeText(const char* text, std::vector<std::string>* tokens)
+{
+	tokens->clear();
+	if (!text)
+	{
+		return 0;
+	}
+
+	const unsigned char* cursor = (const unsigned char*)text;
+	while (*cursor)
+	{
+		while (*cursor && !isTokenByte(*cursor))
+		{
+			cursor++;
+		}
+
+		char token[TEXT_MAX_TOKEN_LENGTH];
+		size_t length = 0;
+		while (*cursor && isTokenByte(*cursor))
+		{
+			if (length < sizeof(token))
+			{
+				unsigned char c = *cursor;
+				token[length++] = (char)(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+			}
+			cursor++;
+		}
+
+		if (length >= TEXT_MIN_TOKEN_LENGTH)
+		{
+			tokens->push_back(std::string(token, length));
+		}
+	}
+
+	std::sort(tokens->begin(), tokens->end());
+	tokens->erase(std::unique(tokens->begin(), tokens->end()), tokens->end());
+	return tokens->size();
+}
+
+/**
+ *  @name   appendVarint
+ *
+ *  @brief  Appends @p value as a little-endian base-128 varint.
+ */
+static void appendVarint(std::vector<uint8_t>* bytes, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes->push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	bytes->push_back((uint8_t)value);
+}
+
+/**
+ *  @name   readVarint
+ *
+ *  @brief  Decodes one varint and advances @p cursor past it.
+ */
+static uint32_t readVarint(const uint8_t** cursor)
+{
+	uint32_t value = 0;
+	int shift = 0;
+	uint8_t byte;
+	do
+	{
+		byte = *(*cursor)++;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	return value;
+}
+
+/**
+ *  @name   appendPosting
+ *
+ *  @brief  Appends an id larger than every id already in the list.
+ *
+ *  @details
+ *  Every TEXT_POSTING_BLOCK-th id opens a block whose first id goes into
+ *  the skip table; the rest of the block is stored as varint gaps.
+ *
+ *  @complexity O(1) amortized.
+ */
+static void appendPosting(PostingList* list, uint32_t id)
+{
+	if (list->count % TEXT_POSTING_BLOCK == 0)
+	{
+		PostingSkip skip = { id, (uint32_t)list->bytes.size() };
+		list->skips.push_back(skip);
+	}
+	else
+	{
+		appendVarint(&list->bytes, id - list->lastID);
+	}
+	list->lastID = id;
+	list->count++;
+}
+
+/**
+ *  @name   encodePostingList
+ *
+ *  @brief  Replaces the list with the given ascending ids.
+ */
+static void encodePostingList(PostingList* list, const std::vector<uint32_t>& ids)
+{
+	list->bytes.clear();
+	list->skips.clear();
+	list->count = 0;
+	list->lastID = 0;
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		appendPosting(list, ids[i]);
+	}
+}
+
+/**
+ *  @name   decodePostingBlock
+ *
+ *  @brief  Decodes one block of a posting list into @p ids.
+ *
+ *  @retval [\b size_t] Number of ids in the block.
+ */
+static size_t decodePostingBlock(const PostingList* list, size_t block, uint32_t* ids)
+{
+	size_t size = block + 1 < list->skips.size() ? TEXT_POSTING_BLOCK : list->count - block * TEXT_POSTING_BLOCK;
+	const uint8_t* cursor = list->bytes.data() + list->skips[block].offset;
+
+	ids[0] = list->skips[block].firstID;
+	for (size_t i = 1; i < size; i++)
+	{
+		ids[i] = ids[i - 1] + readVarint(&cursor);
+	}
+	return size;
+}
+
+/**
+ *  @name   decodePostingList
+ *
+ *  @brief  Decodes a whole posting list.
+ *
+ *  @param  [in]  list [\b const PostingList*]       List to decode.
+ *  @param  [out] ids  [\b std::vector<uint32_t>*]   Receives the ids in ascending order (appended).
+ *
+ *  @retval [\b size_t] Number of ids appended.
+ */
+size_t decodePostingList(const PostingList* list, std::vector<uint32_t>* ids)
+{
+	size_t start = ids->size();
+	ids->resize(start + list->count);
+	for (size_t block = 0; block < list->skips.size(); block++)
+	{
+		decodePostingBlock(list, block, ids->data() + start + block * TEXT_POSTING_BLOCK);
+	}
+	return list->count;
+}
+
+/**
+ *  @name   PostingCursor
+ *
+ *  @brief  Forward iterator over a posting list with galloping seek().
+ *
+ *  @details
+ *  seek() first gallops over the skip table (1, 2, 4, ... blocks ahead)
+ *  and binary-searches the bracket, then decodes only the target block.
+ *  Skipping k blocks therefore costs O(log k) skip reads plus one block
+ *  decode, which keeps intersections with long lists cheap.
+ */
+struct PostingCursor {
+	const PostingList* list;
+	size_t block;
+	size_t position;
+	size_t blockSize;
+	uint32_t ids[TEXT_POSTING_BLOCK];
+
+	explicit PostingCursor(const PostingList* postings) : list(postings), block(0), position(0), blockSize(0)
+	{
+		if (list->count > 0)
+		{
+			blockSize = decodePostingBlock(list, 0, ids);
+		}
+	}
+
+	bool done() const
+	{
+		return position >= blockSize;
+	}
+
+	uint32_t value() const
+	{
+		return ids[position];
+	}
+
+	// Moves to the first id >= target; returns false once the list is exhausted.
+	bool seek(uint32_t target)
+	{
+		if (done())
+		{
+			return false;
+		}
+		if (ids[blockSize - 1] < target)
+		{
+			size_t low = block, step = 1;
+			size_t count = list->skips.size();
+			while (low + step < count && list->skips[low + step].firstID <= target)
+			{
+				low += step;
+				step <<= 1;
+			}
+			size_t high = low + step < count ? low + step : count;
+			while (high - low > 1)
+			{
+				size_t middle = low + (high - low) / 2;
+				if (list->skips[middle].firstID <= target)
+				{
+					low = middle;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+
+			if (low == block)
+			{
+				// Target lies past this block but before the next one starts.
+				low++;
+			}
+			if (low >= count)
+			{
+				position = blockSize;
+				return false;
+			}
+			block = low;
+			blockSize = decodePostingBlock(list, block, ids);
+			position = 0;
+		}
+
+		position = std::lower_bound(ids + position, ids + blockSize, target) - ids;
+		if (position == blockSize)
+		{
+			// Every id of the block is smaller; the next block starts above target.
+			if (++block >= list->skips.size())
+			{
+				return false;
+			}
+			blockSize = decodePostingBlock(list, block, ids);
+			position = 0;
+		}
+		return true;
+	}
+};
+
+/**
+ *  @name   initTextIndex
+ *
+ *  @brief  Prepares an empty inverted index.
+ *
+ *  @param  [out] index [\b TextIndex*]  Index to initialize.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid argument or allocation failure.
+ *
+ *  @warning The index must be released with destroyTextIndex().
+ */
+int initTextIndex(TextIndex* index)
+{
+	if (!index || !index->terms.init())
+	{
+		return 0;
+	}
+	index->postingCount = 0;
+	return 1;
+}
+
+/**
+ *  @name   destroyTextIndex
+ *
+ *  @brief  Frees every term and posting list.
+ */
+void destroyTextIndex(TextIndex* index)
+{
+	if (!index)
+	{
+		return;
+	}
+	index->terms.destroy();
+	index->postingCount = 0;
+}
+
+/**
+ *  @name   addTermPosting
+ *
+ *  @brief  Adds one id to one term's list, creating the term if needed.
+ *
+ *  @retval [\b int] 1 if added; 0 if already present or allocation failed.
+ *
+ *  @details
+ *  New events get the highest id so far, which makes this an O(1)
+ *  append. An id below the list's last one (replayed or reloaded
+ *  records) re-encodes only this term's list.
+ */
+static int addTermPosting(TextIndex* index, const std::string& token, uint32_t id)
+{
+	TextTerm* term = index->terms.find(token);
+	if (!term)
+	{
+		TextTerm created;
+		created.term = token;
+		created.postings.count = 0;
+		created.postings.lastID = 0;
+		term = index->terms.insert(created);
+		if (!term)
+		{
+			return 0;
+		}
+	}
+
+	PostingList* list = &term->postings;
+	if (list->count == 0 || id > list->lastID)
+	{
+		appendPosting(list, id);
+	}
+	else
+	{
+		std::vector<uint32_t> ids;
+		decodePostingList(list, &ids);
+		std::vector<uint32_t>::iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+		if (it != ids.end() && *it == id)
+		{
+			return 0;
+		}
+		ids.insert(it, id);
+		encodePostingList(list, ids);
+	}
+	index->postingCount++;
+	return 1;
+}
+
+/**
+ *  @name   removeTermPosting
+ *
+ *  @brief  Removes one id from one term's list; drops the term once empty.
+ */
+static void removeTermPosting(TextIndex* index, const std::string& token, uint32_t id)
+{
+	TextTerm* term = index->terms.find(token);
+	if (!term)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> ids;
+	decodePostingList(&term->postings, &ids);
+	std::vector<uint32_t>::iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+	if (it == ids.end() || *it != id)
+	{
+		return;
+	}
+	ids.erase(it);
+	index->postingCount--;
+
+	if (ids.empty())
+	{
+		index->terms.erase(token);
+	}
+	else
+	{
+		encodePostingList(&term->postings, ids);
+	}
+}
+
+/**
+ *  @name   addDocumentToTextIndex
+ *
+ *  @brief  Indexes the terms of a document.
+ *
+ *  @param  [in,out] index [\b TextIndex*]    Open index.
+ *  @param  [in]     id    [\b uint32_t]      Document (event) id, non-zero.
+ *  @param  [in]     text  [\b const char*]   Text to index.
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments or allocation failure.
+ */
+int addDocumentToTextIndex(TextIndex* index, uint32_t id, const char* text)
+{
+	if (!index || id == 0)
+	{
+		return 0;
+	}
+
+	std::vector<std::string> tokens;
+	tokenizeText(text, &tokens);
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		if (!addTermPosting(index, tokens[i], id) && !index->terms.find(tokens[i]))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   removeDocumentFromTextIndex
+ *
+ *  @brief  Removes a document indexed with the same @p text.
+ *
+ *  @complexity O(sum of the touched posting list lengths)
+ */
+int removeDocumentFromTextIndex(TextIndex* index, uint32_t id, const char* text)
+{
+	if (!index || id == 0)
+	{
+		return 0;
+	}
+
+	std::vector<std::string> tokens;
+	tokenizeText(text, &tokens);
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		removeTermPosting(index, tokens[i], id);
+	}
+	return 1;
+}
+
+/**
+ *  @name   updateDocumentInTextIndex
+ *
+ *  @brief  Re-indexes an edited document.
+ *
+ *  @param  [in,out] index   [\b TextIndex*]   Open index.
+ *  @param  [in]     id      [\b uint32_t]     Document id.
+ *  @param  [in]     oldText [\b const char*]  Text the document was indexed with.
+ *  @param  [in]     newText [\b const char*]  Replacement text.
+ *
+ *  @retval [\b int] 1 on success; 0 on failure.
+ *
+ *  @details
+ *  Only terms that appear in exactly one of the two texts are touched;
+ *  terms kept by the edit cost nothing.
+ */
+int updateDocumentInTextIndex(TextIndex* index, uint32_t id, const char* oldText, const char* newText)
+{
+	if (!index || id == 0)
+	{
+		return 0;
+	}
+
+	std::vector<std::string> oldTokens, newTokens, changed;
+	tokenizeText(oldText, &oldTokens);
+	tokenizeText(newText, &newTokens);
+
+	std::set_difference(oldTokens.begin(), oldTokens.end(), newTokens.begin(), newTokens.end(), std::back_inserter(changed));
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		removeTermPosting(index, changed[i], id);
+	}
+
+	changed.clear();
+	std::set_difference(newTokens.begin(), newTokens.end(), oldTokens.begin(), oldTokens.end(), std::back_inserter(changed));
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		if (!addTermPosting(index, changed[i], id) && !index->terms.find(changed[i]))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ *  @name   postingCountLess
+ *
+ *  @brief  Orders posting lists shortest first.
+ */
+static bool postingCountLess(const PostingList* left, const PostingList* right)
+{
+	return left->count < right->count;
+}
+
+/**
+ *  @name   searchTextIndex
+ *
+ *  @brief  Evaluates a keyword query.
+ *
+ *  @param  [in]  index   [\b const TextIndex*]          Open index.
+ *  @param  [in]  query   [\b const char*]               Keywords, tokenized like documents.
+ *  @param  [in]  mode    [\b int]                       TEXT_QUERY_ALL or TEXT_QUERY_ANY.
+ *  @param  [out] results [\b std::vector<uint32_t>*]    Receives matching ids, ascending (replaced).
+ *
+ *  @retval [\b size_t] Number of matches.
+ *
+ *  @details
+ *  AND runs a leapfrog join: lists are ordered shortest first and the
+ *  current candidate is sought in every other list with PostingCursor's
+ *  galloping seek(), so the cost follows the shortest list rather than
+ *  the longest. A missing term ends an AND query at once. OR decodes
+ *  each list and merges them.
+ */
+size_t searchTextIndex(const TextIndex* index, const char* query, int mode, std::vector<uint32_t>* results)
+{
+	if (!results)
+	{
+		return 0;
+	}
+	results->clear();
+	if (!index)
+	{
+		return 0;
+	}
+
+	std::vector<std::string> tokens;
+	tokenizeText(query, &tokens);
+
+	std::vector<const PostingList*> lists;
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		const TextTerm* term = index->terms.find(tokens[i]);
+		if (term)
+		{
+			lists.push_back(&term->postings);
+		}
+		else if (mode == TEXT_QUERY_ALL)
+		{
+			return 0;
+		}
+	}
+	if (lists.empty())
+	{
+		return 0;
+	}
+
+	if (mode == TEXT_QUERY_ANY)
+	{
+		for (size_t i = 0; i < lists.size(); i++)
+		{
+			size_t middle = results->size();
+			decodePostingList(lists[i], results);
+			std::inplace_merge(results->begin(), results->begin() + middle, results->end());
+		}
+		results->erase(std::unique(results->begin(), results->end()), results->end());
+		return results->size();
+	}
+
+	std::sort(lists.begin(), lists.end(), postingCountLess);
+	std::vector<PostingCursor> cursors;
+	cursors.reserve(lists.size());
+	for (size_t i = 0; i < lists.size(); i++)
+	{
+		cursors.push_back(PostingCursor(lists[i]));
+	}
+
+	uint32_t candidate = cursors[0].value();
+	size_t agreeing = 1;
+	size_t current = 1 % cursors.size();
+	while (true)
+	{
+		if (agreeing == cursors.size())
+		{
+			results->push_back(candidate);
+			if (candidate == UINT32_MAX || !cursors[0].seek(candidate + 1))
+			{
+				break;
+			}
+			candidate = cursors[0].value();
+			agreeing = 1;
+			current = 1 % cursors.size();
+			continue;
+		}
+
+		if (!cursors[current].seek(candidate))
+		{
+			break;
+		}
+		if (cursors[current].value() == candidate)
+		{
+			agreeing++;
+		}
+		else
+		{
+			candidate = cursors[current].value();
+			agreeing = 1;
+		}
+		current = (current + 1) % cursors.size();
+	}
+	return results->size();
+}
+
+/**
+ *  @name   memoryUsageTextIndex
+ *
+ *  @brief  Approximate heap bytes held by the index.
+ *
+ *  @retval [\b size_t] Dictionary table plus posting bytes and skip tables.
+ */
+size_t memoryUsageTextIndex(const TextIndex* index)
+{
+	if (!index)
+	{
+		return 0;
+	}
+
+	size_t bytes = index->terms.memoryUsage();
+	for (unsigned int i = 0; i < index->terms.size(); i++)
+	{
+		const TextTerm* term = index->terms.at(i);
+		bytes += term->postings.bytes.capacity() + term->postings.skips.capacity() * sizeof(PostingSkip);
+	}
+	return bytes;
+}
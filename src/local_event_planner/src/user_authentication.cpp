@@ -1,21 +1,11 @@
 ﻿#include "user_authentication.h"
+#include "hot_path_stats.h"
 
 bool isTestEnvironment = false;
 
-int performUserLogin(HashTable* ht) 
+static int promptPasswordAndLogin(const User* user)
 {
-    char username[50], password[50];
-    User* user = NULL;
-
-    printf("Enter your username: ");
-    scanf("%49s", username);
-
-    if (!findUserBrent(ht, username, &user) || user == NULL) 
-    {
-        printf("User not found! Returning to the main menu...\n");
-        WAIT(3);
-        return 1;
-    }
+    char password[50];
 
     while (1) 
     {
@@ -31,6 +21,7 @@ int performUserLogin(HashTable* ht)
 
         if (strcmp(user->password, password) == 0) 
         {
+            HOT_PATH_COUNT(HOT_PATH_LOGINS, 1);
             printf("Login successful! Welcome, %s.\n", user->username);
             WAIT(3);
             if (!isTestEnvironment) 
@@ -45,6 +36,7 @@ int performUserLogin(HashTable* ht)
         }
         else
         {
+            HOT_PATH_COUNT(HOT_PATH_LOGIN_FAILURES, 1);
             printf("Incorrect password. Please try again.\n");
             WAIT(3);
             return 1;
@@ -52,10 +44,60 @@ int performUserLogin(HashTable* ht)
     }
 }
 
-int performUserRegistration(HashTable* ht) 
+int performUserLogin(HashTable* ht) 
 {
-    char username[50], password[50];
+    char username[50];
+    User* user = NULL;
+
+    printf("Enter your username: ");
+    scanf("%49s", username);
+
+    if (!findUserBrent(ht, username, &user) || user == NULL) 
+    {
+        HOT_PATH_COUNT(HOT_PATH_LOGIN_FAILURES, 1);
+        printf("User not found! Returning to the main menu...\n");
+        WAIT(3);
+        return 1;
+    }
+
+    return promptPasswordAndLogin(user);
+}
+
+static int loginFoundOrJournalUser(const User* user, const char* username, const char* journalFile)
+{
+    User journalUser;
+
+    // Günlükteki kayıt daha yenidir (ör. şifre değişikliği ya da silme), önce ona bak
+    int journaled = journalFile ? findUserInJournal(journalFile, username, &journalUser) : 0;
+    if (journaled != 0)
+    {
+        user = journaled > 0 ? &journalUser : NULL;
+    }
+    if (user == NULL) 
+    {
+        HOT_PATH_COUNT(HOT_PATH_LOGIN_FAILURES, 1);
+        printf("User not found! Returning to the main menu...\n");
+        WAIT(3);
+        return 1;
+    }
+
+    return promptPasswordAndLogin(user);
+}
+
+int performUserLoginFromIndex(const UserIndexView* view, const char* journalFile)
+{
+    char username[50];
+    User found;
+
+    printf("Enter your username: ");
+    scanf("%49s", username);
+
+    const User* user = findUserInIndex(view, username, &found) ? &found : NULL;
+    return loginFoundOrJournalUser(user, username, journalFile);
+}
 
+static void promptNewCredentials(HashTable* ht, char* username, char* password)
+{
     while (1) 
     {
         printf("Enter a username: ");
@@ -85,10 +127,17 @@ int performUserRegistration(HashTable* ht)
             break;
         }
     }
+}
 
-    if (insertUserBrent(ht, currentID++, username, password)) 
+int performUserRegistration(HashTable* ht) 
+{
+    char username[50], password[50];
+    promptNewCredentials(ht, username, password);
+
+    int id = allocateUserID();
+    if (insertUserBrent(ht, id, username, password)) 
     {
-        printf("User registered successfully with ID: %d\n", currentID - 1);
+        printf("User registered successfully with ID: %d\n", id);
         WAIT(3);
         return 0;
     }
@@ -99,20 +148,45 @@ int performUserRegistration(HashTable* ht)
     }
 }
 
-int initiateUserRegistration() 
+int initiateUserRegistration(UserStore* store) 
 {
-    HashTable ht;
-    initBrentHashTable(&ht);
-    loadUsersFromBinaryFile(&ht, "users.dat");
-    int result = performUserRegistration(&ht);
-    saveUsersToBinaryFile(&ht, "users.dat");
-    return result;
+    char username[50], password[50];
+    User* user = NULL;
+
+    promptNewCredentials(&store->table, username, password);
+
+    if (registerUserInStore(store, username, password, &user)) 
+    {
+        printf("User registered successfully with ID: %d\n", user->id);
+        WAIT(3);
+        return 0;
+    }
+    else 
+    {
+        printf("User registration failed.\n");
+        return 1;
+    }
 }
 
-int initiateUserLogin()
+int initiateUserLogin(UserStore* store, const char* filename)
 {
-    HashTable ht;
-    initBrentHashTable(&ht);
-    loadUsersFromBinaryFile(&ht, "users.dat");
-    return performUserLogin(&ht);
+    // Uzun ömürlü depo açıksa doğrudan bellekteki tablodan giriş
+    if (store)
+    {
+        return performUserLogin(&store->table);
+    }
+
+    // Salt okunur giriş: tablo yüklenmez, kalıcı indeksle O(1) arama yapılır
+    char journalFile[FILENAME_MAX];
+    UserIndexView index;
+    if (!filename || !buildUserJournalPath(journalFile, sizeof(journalFile), filename)
+        || !openUserIndex(&index, filename))
+    {
+        printf("User database could not be opened.\n");
+        WAIT(3);
+        return 1;
+    }
+    int result = performUserLoginFromIndex(&index, journalFile);
+    closeUserIndex(&index);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,286 @@
+﻿#include "../header/user_store.h"
+#include "../header/hot_path_stats.h"
+
+/**
+ *  @name   openUserStore
+ *
+ *  @brief  Loads the user database once for the lifetime of the application.
+ *
+ *  @param  [out] store    [\b UserStore*]   Store to initialize.
+ *  @param  [in]  filename [\b const char*]  Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments, allocation failure
+ *          or a damaged snapshot (which is then left untouched on disk).
+ *
+ *  @details
+ *  Bulk-loads the snapshot and replays its journal via loadUserDatabase().
+ *  Menu actions then work on the in-memory table instead of reloading the
+ *  file for every Register/Login selection.
+ *
+ *  @warning The store must be released with closeUserStore().
+ */
+int openUserStore(UserStore* store, const char* filename)
+{
+	if (!store || !filename || strlen(filename) >= sizeof(store->filename))
+	{
+		return 0;
+	}
+
+	strcpy(store->filename, filename);
+	if (!initBrentHashTable(&store->table))
+	{
+		return 0;
+	}
+	if (!loadUserDatabase(&store->table, filename))
+	{
+		destroyBrentHashTable(&store->table);
+		return 0;
+	}
+
+	char journalFile[FILENAME_MAX];
+	buildUserJournalPath(journalFile, sizeof(journalFile), filename);
+	store->pendingJournalRecords = countUserJournalRecords(journalFile);
+	return 1;
+}
+
+/**
+ *  @name   findUserInStore
+ *
+ *  @brief  Looks up a user in the store's in-memory table.
+ *
+ *  @param  [in]  store    [\b UserStore*]   Open store.
+ *  @param  [in]  username [\b const char*]  Null-terminated username key.
+ *  @param  [out] result   [\b User**]       If non-NULL, receives the record or NULL.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ */
+int findUserInStore(UserStore* store, const char* username, User** result)
+{
+	if (!store)
+	{
+		if (result)
+		{
+			*result = NULL;
+		}
+		return 0;
+	}
+	return findUserBrent(&store->table, username, result);
+}
+
+/**
+ *  @name   authenticateUserInStore
+ *
+ *  @brief  Checks a username/password pair against the store.
+ *
+ *  @param  [in]  store    [\b UserStore*]   Open store.
+ *  @param  [in]  username [\b const char*]  Null-terminated username key.
+ *  @param  [in]  password [\b const char*]  Password to verify.
+ *  @param  [out] result   [\b User**]       If non-NULL, receives the record on success, NULL otherwise.
+ *
+ *  @retval [\b int] 1 if the user exists and the password matches; 0 otherwise.
+ *
+ *  @details
+ *  The lookup and comparison are what a login costs once the credentials
+ *  are typed in, so with ENABLE_HOT_PATH_STATS this is where login counts
+ *  and latency are recorded.
+ */
+int authenticateUserInStore(UserStore* store, const char* username, const char* password, User** result)
+{
+	HOT_PATH_TIMER_START(startNanos);
+	User* user = NULL;
+	int ok = password && findUserInStore(store, username, &user) && strcmp(user->password, password) == 0;
+	HOT_PATH_COUNT(ok ? HOT_PATH_LOGINS : HOT_PATH_LOGIN_FAILURES, 1);
+	HOT_PATH_TIMER_STOP(startNanos, HOT_PATH_LOGIN_NANOS);
+
+	if (result)
+	{
+		*result = ok ? user : NULL;
+	}
+	return ok;
+}
+
+/**
+ *  @name   registerUserInStore
+ *
+ *  @brief  Adds a user to the store and persists it incrementally.
+ *
+ *  @param  [in,out] store    [\b UserStore*]   Open store.
+ *  @param  [in]     username [\b const char*]  New username (must not exist).
+ *  @param  [in]     password [\b const char*]  Password value.
+ *  @param  [out]    created  [\b User**]       If non-NULL, receives the stored record.
+ *
+ *  @retval [\b int] 1 on success; 0 if the name is taken, the insert fails
+ *          or the journal append fails.
+ *
+ *  @details
+ *  Takes an ID from allocateUserID(), inserts into the table and appends the record to
+ *  the journal with commitUserRegistration(), which compacts the journal
+ *  into the snapshot once it reaches USER_JOURNAL_COMPACT_THRESHOLD.
+ *  If the append fails the user is taken out of the table again, so the
+ *  store never holds a user that is not durable and a retry can succeed.
+ *  The allocated ID is not reused.
+ */
+int registerUserInStore(UserStore* store, const char* username, const char* password, User** created)
+{
+	if (created)
+	{
+		*created = NULL;
+	}
+	if (!store || !username || !password || findUserBrent(&store->table, username, NULL))
+	{
+		return 0;
+	}
+
+	if (!insertUserBrent(&store->table, allocateUserID(), username, password))
+	{
+		return 0;
+	}
+
+	User* user = getUserAtBrent(&store->table, store->table.count - 1);
+	if (!commitUserRegistration(&store->table, user, store->filename))
+	{
+		deleteUserBrent(&store->table, username);
+		return 0;
+	}
+
+	char journalFile[FILENAME_MAX];
+	buildUserJournalPath(journalFile, sizeof(journalFile), store->filename);
+	store->pendingJournalRecords = countUserJournalRecords(journalFile);
+
+	if (created)
+	{
+		*created = user;
+	}
+	return 1;
+}
+
+/**
+ *  @name   updateUserPasswordInStore
+ *
+ *  @brief  Changes a password and persists it incrementally.
+ *
+ *  @param  [in,out] store       [\b UserStore*]   Open store.
+ *  @param  [in]     username    [\b const char*]  Existing username.
+ *  @param  [in]     newPassword [\b const char*]  New password value.
+ *
+ *  @retval [\b int] 1 on success; 0 if the user is unknown or the journal append fails.
+ *
+ *  @details
+ *  Updates the record in place with updateUserBrent() and appends the
+ *  updated record to the journal; replay treats a repeated username as
+ *  an update, so the snapshot does not have to be rewritten. If the
+ *  append fails the old password is restored.
+ */
+int updateUserPasswordInStore(UserStore* store, const char* username, const char* newPassword)
+{
+	User* user = NULL;
+	if (!store || !newPassword || !findUserBrent(&store->table, username, &user))
+	{
+		return 0;
+	}
+
+	char oldPassword[sizeof(user->password)];
+	memcpy(oldPassword, user->password, sizeof(oldPassword));
+	updateUserBrent(&store->table, username, newPassword);
+	if (!commitUserRegistration(&store->table, user, store->filename))
+	{
+		memcpy(user->password, oldPassword, sizeof(oldPassword));
+		return 0;
+	}
+
+	char journalFile[FILENAME_MAX];
+	buildUserJournalPath(journalFile, sizeof(journalFile), store->filename);
+	store->pendingJournalRecords = countUserJournalRecords(journalFile);
+	return 1;
+}
+
+/**
+ *  @name   deleteUserFromStore
+ *
+ *  @brief  Removes a user and persists the removal incrementally.
+ *
+ *  @param  [in,out] store    [\b UserStore*]   Open store.
+ *  @param  [in]     username [\b const char*]  Username to remove.
+ *
+ *  @retval [\b int] 1 on success; 0 if the user is unknown or the journal append fails.
+ *
+ *  @details
+ *  Deletes the record with deleteUserBrent() and appends a deletion record
+ *  with commitUserDeletion(), so replay removes the user again even if an
+ *  older journal record for it survives an interrupted compaction. If the
+ *  append fails the user is inserted again with its old ID and password.
+ */
+int deleteUserFromStore(UserStore* store, const char* username)
+{
+	User* user = NULL;
+	if (!store || !findUserBrent(&store->table, username, &user))
+	{
+		return 0;
+	}
+
+	User removed = *user;
+	if (!deleteUserBrent(&store->table, username))
+	{
+		return 0;
+	}
+	if (!commitUserDeletion(&store->table, &removed, store->filename))
+	{
+		insertUserBrent(&store->table, removed.id, removed.username, removed.password);
+		return 0;
+	}
+
+	char journalFile[FILENAME_MAX];
+	buildUserJournalPath(journalFile, sizeof(journalFile), store->filename);
+	store->pendingJournalRecords = countUserJournalRecords(journalFile);
+	return 1;
+}
+
+/**
+ *  @name   flushUserStore
+ *
+ *  @brief  Folds pending journal records into the snapshot.
+ *
+ *  @param  [in,out] store [\b UserStore*]  Open store.
+ *
+ *  @retval [\b int] 1 on success or when nothing is pending; 0 on I/O failure.
+ */
+int flushUserStore(UserStore* store)
+{
+	if (!store)
+	{
+		return 0;
+	}
+	if (store->pendingJournalRecords == 0)
+	{
+		return 1;
+	}
+	if (!compactUserJournal(&store->table, store->filename))
+	{
+		// Leave it pending so closeUserStore() tries again
+		store->pendingJournalRecords++;
+		return 0;
+	}
+	store->pendingJournalRecords = 0;
+	return 1;
+}
+
+/**
+ *  @name   closeUserStore
+ *
+ *  @brief  Flushes pending changes and frees the table.
+ *
+ *  @param  [in,out] store [\b UserStore*]  Store to close.
+ *
+ *  @details
+ *  A failed flush loses nothing: the journal stays on disk and is replayed
+ *  by the next openUserStore().
+ */
+void closeUserStore(UserStore* store)
+{
+	if (!store)
+	{
+		return;
+	}
+	flushUserStore(store);
+	destroyBrentHashTable(&store->table);
+}
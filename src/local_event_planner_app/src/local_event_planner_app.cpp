@@ -1,8 +1,137 @@
 #include "../../local_event_planner/header/menu.h"  // Adjust this include path based on your project structure
+#include "../../local_event_planner/header/user_store.h"
+#include "../../local_event_planner/header/batch_driver.h"
+#include "../../local_event_planner/header/hot_path_stats.h"
 
+/**
+ *  @name   runBatchMode
+ *
+ *  @brief  Runs a command script without menus, prompts or WAIT() pauses.
+ *
+ *  @param  [in,out] store      [\b UserStore*]   Open user store.
+ *  @param  [in]     scriptFile [\b const char*]  Script path, or NULL / "-" for stdin.
+ *  @param  [in]     trace      [\b bool]         Print one line per command.
+ *
+ *  @retval [\b int] Process exit code: 0 if every command succeeded, 1 otherwise.
+ */
+static int runBatchMode(UserStore* store, const char* scriptFile, bool trace)
+{
+	FILE* input = stdin;
+	if (scriptFile && strcmp(scriptFile, "-") != 0)
+	{
+		input = fopen(scriptFile, "r");
+		if (!input)
+		{
+			printf("Script %s could not be opened.\n", scriptFile);
+			return 1;
+		}
+	}
 
-int main() {
-	firstMenu();
+	BatchSession session;
+	if (!openBatchSession(&session, store, trace ? stdout : NULL))
+	{
+		printf("Batch session could not be started.\n");
+		return 1;
+	}
+	runBatchScript(&session, input);
+	printBatchReport(&session, stdout);
+
+	int failed = session.unknownCommands != 0;
+	for (int i = 0; i < BATCH_COMMAND_COUNT; i++)
+	{
+		failed |= session.stats[i].failures != 0;
+	}
+	closeBatchSession(&session);
+	if (input != stdin)
+	{
+		fclose(input);
+	}
+	return failed;
+}
+
+/**
+ *  @name   dumpHotPathStats
+ *
+ *  @brief  Writes the hot-path statistics and table gauges as JSON.
+ *
+ *  @param  [in] store     [\b const UserStore*]  Open user store, or NULL in read-only mode.
+ *  @param  [in] statsFile [\b const char*]       Output path, or "-" for stdout.
+ *
+ *  @retval [\b int] 1 on success; 0 if the file cannot be written.
+ */
+static int dumpHotPathStats(const UserStore* store, const char* statsFile)
+{
+	FILE* out = strcmp(statsFile, "-") == 0 ? stdout : fopen(statsFile, "w");
+	if (!out)
+	{
+		printf("Statistics file %s could not be opened.\n", statsFile);
+		return 0;
+	}
+
+	HotPathStats stats;
+	snapshotHotPathStats(&stats);
+	int ok = writeHotPathStatsJson(out, &stats, store ? &store->table : NULL);
+	if (out != stdout)
+	{
+		ok = fclose(out) == 0 && ok;
+	}
+	return ok;
+}
+
+int main(int argc, char* argv[]) {
+	const char* usersFile = "users.dat";
+	const char* scriptFile = NULL;
+	const char* statsFile = NULL;
+	bool batch = false, trace = false, readOnly = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--batch") == 0) {
+			batch = true;
+			if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+				scriptFile = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--trace") == 0) {
+			trace = true;
+		}
+		else if (strcmp(argv[i], "--users") == 0 && i + 1 < argc) {
+			usersFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--read-only") == 0) {
+			// Login only: users are looked up through the index, the table is never loaded
+			readOnly = true;
+		}
+		else if (strcmp(argv[i], "--stats") == 0) {
+			// Undocumented admin switch: dump hot-path statistics on exit
+			statsFile = i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0 ? argv[++i] : "-";
+		}
+		else {
+			printf("Usage: %s [--batch [script|-]] [--trace] [--users file] [--read-only]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (batch && readOnly) {
+		printf("--batch cannot be combined with --read-only.\n");
+		return 1;
+	}
+
+	if (readOnly) {
+		int result = firstMenu(NULL, usersFile);
+		if (statsFile && !dumpHotPathStats(NULL, statsFile)) {
+			result = 1;
+		}
+		return result;
+	}
+
+	UserStore store;
+	if (!openUserStore(&store, usersFile)) {
+		printf("User database could not be opened.\n");
+		return 1;
+	}
+	int result = batch ? runBatchMode(&store, scriptFile, trace) : firstMenu(&store, usersFile);
 	//mainMenu(1, "mami");
-	return 0;
-}
\ No newline at end of file
+	if (statsFile && !dumpHotPathStats(&store, statsFile)) {
+		result = 1;
+	}
+	closeUserStore(&store);
+	return result;
+}
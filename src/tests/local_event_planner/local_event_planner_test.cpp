@@ -2,9 +2,37 @@
 
 #include "gtest/gtest.h"
 #include "../../local_event_planner/header/local_event_planner.h"  // Adjust this include path based on your project structure
+#include "../../local_event_planner/header/brent_hashing.h"
+#include "../../local_event_planner/header/user_store.h"
+#include "../../local_event_planner/header/concurrent_brent_hashing.h"
+#include "../../local_event_planner/header/brent_table.h"
+#include "../../local_event_planner/header/batch_driver.h"
+#include "../../local_event_planner/header/terminal.h"
+#include "../../local_event_planner/header/hot_path_stats.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#endif
 
 //using namespace local_event_planner;
 
+// Shift/add hash used by the table before hashUsername(); kept only as a benchmark baseline.
+static unsigned int legacyShiftAddHash(const char *key) {
+  unsigned int hash = 0;
+
+  while (*key) {
+    hash = (hash << 5) + *key++;
+  }
+
+  return hash;
+}
+
 class local_event_planner_Test : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -31,6 +59,1852 @@ TEST_F(local_event_planner_Test, TestDivide) {
 TEST_F(local_event_planner_Test, TestDivideByZero) {
 }
 
+TEST_F(local_event_planner_Test, TestBrentTableCapacityIsPowerOfTwo) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 100, 0.5f), 1);
+  EXPECT_EQ(ht.capacity, 128u);
+  EXPECT_EQ(ht.count, 0u);
+  destroyBrentHashTable(&ht);
+  EXPECT_EQ(ht.table, nullptr);
+  EXPECT_EQ(ht.capacity, 0u);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableRejectsInvalidLoadFactor) {
+  HashTable ht;
+  EXPECT_EQ(initBrentHashTableWithCapacity(&ht, 16, 0.0f), 0);
+  EXPECT_EQ(initBrentHashTableWithCapacity(&ht, 16, 1.5f), 0);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableGrowsPastInitialCapacity) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 16, 0.75f), 1);
+  char name[50];
+
+  for (int i = 0; i < 5000; i++) {
+    snprintf(name, sizeof(name), "user%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+
+  EXPECT_EQ(ht.count, 5000u);
+  EXPECT_EQ(ht.capacity & (ht.capacity - 1), 0u);
+  EXPECT_LE((double)ht.count, ht.capacity * 0.75);
+
+  for (int i = 0; i < 5000; i++) {
+    User *user = NULL;
+    snprintf(name, sizeof(name), "user%d", i);
+    ASSERT_EQ(findUserBrent(&ht, name, &user), 1);
+    ASSERT_NE(user, nullptr);
+    EXPECT_EQ(user->id, i + 1);
+    EXPECT_STREQ(user->username, name);
+  }
+
+  User *missing = NULL;
+  EXPECT_EQ(findUserBrent(&ht, "nobody", &missing), 0);
+  EXPECT_EQ(missing, nullptr);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableResizeKeepsUserPointers) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 7, "alice", "pass"), 1);
+  User *before = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "alice", &before), 1);
+  ASSERT_EQ(resizeBrentHashTable(&ht, 1024), 1);
+  User *after = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "alice", &after), 1);
+  EXPECT_EQ(before, after);
+  EXPECT_EQ(ht.capacity, 1024u);
+  ASSERT_EQ(insertUserBrent(&ht, 8, "bob", "pass"), 1);
+  EXPECT_EQ(resizeBrentHashTable(&ht, 1), 0);
+  EXPECT_EQ(ht.capacity, 1024u);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentAverageProbeLengthAtHighLoad) {
+  const float loads[] = { 0.5f, 0.75f, 0.9f, 0.95f, 0.99f };
+  char name[50];
+
+  for (float load : loads) {
+    HashTable ht;
+    ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 8192, 1.0f), 1);
+    const int users = (int)(ht.capacity * load);
+
+    for (int i = 0; i < users; i++) {
+      snprintf(name, sizeof(name), "member_%d", i);
+      ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+    }
+
+    for (int i = 0; i < users; i++) {
+      snprintf(name, sizeof(name), "member_%d", i);
+      ASSERT_EQ(findUserBrent(&ht, name, NULL), 1);
+    }
+
+    double average = averageProbeLengthBrent(&ht);
+    printf("[ BENCH    ] load %.2f: average successful probes %.3f\n", load, average);
+    RecordProperty(("avg_probes_load_" + std::to_string((int)(load * 100))).c_str(), std::to_string(average));
+    EXPECT_GE(average, 1.0);
+    EXPECT_LT(average, 2.5);
+    destroyBrentHashTable(&ht);
+  }
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableFillsCompletelyBeforeGrowing) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 64, 1.0f), 1);
+  char name[50];
+
+  for (int i = 0; i < 64; i++) {
+    snprintf(name, sizeof(name), "full%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+
+  EXPECT_EQ(ht.capacity, 64u);
+  EXPECT_EQ(findUserBrent(&ht, "overflow", NULL), 0);
+
+  for (int i = 0; i < 64; i++) {
+    snprintf(name, sizeof(name), "full%d", i);
+    EXPECT_EQ(findUserBrent(&ht, name, NULL), 1);
+  }
+
+  ASSERT_EQ(insertUserBrent(&ht, 65, "overflow", "secret"), 1);
+  EXPECT_EQ(ht.capacity, 128u);
+  EXPECT_EQ(findUserBrent(&ht, "overflow", NULL), 1);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestHashUsernameIsStableAndSpreadsSuffixes) {
+  EXPECT_EQ(hashUsername("alice"), hashUsername("alice"));
+  EXPECT_NE(hashUsername("user1"), hashUsername("user2"));
+  EXPECT_NE(hashUsername(""), hashUsername("a"));
+}
+
+TEST_F(local_event_planner_Test, TestHashUsernameSpreadsSequentialNames) {
+  const int keys = 20000;
+  const unsigned int buckets = 1u << 15;
+  std::vector<unsigned int> legacyLoad(buckets, 0), fnvLoad(buckets, 0);
+  unsigned int legacyUsed = 0, fnvUsed = 0, legacyMax = 0, fnvMax = 0;
+  char name[50];
+
+  for (int i = 0; i < keys; i++) {
+    snprintf(name, sizeof(name), "istanbul_user_%06d", i);
+    unsigned int &legacy = legacyLoad[legacyShiftAddHash(name) & (buckets - 1)];
+    unsigned int &fnv = fnvLoad[(unsigned int)hashUsername(name) & (buckets - 1)];
+    legacyUsed += legacy == 0;
+    fnvUsed += fnv == 0;
+    legacyMax = std::max(legacyMax, ++legacy);
+    fnvMax = std::max(fnvMax, ++fnv);
+  }
+
+  // 20k keys into 32k buckets: a uniform hash fills about 1 - e^(-0.61) = 46% of them.
+  EXPECT_GT(fnvUsed, buckets * 44 / 100);
+  EXPECT_GT(fnvUsed, legacyUsed);
+  EXPECT_LT(fnvMax, legacyMax);
+}
+
+TEST_F(local_event_planner_Test, TestBrentSlabKeepsInsertionOrder) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 16, 0.9f), 1);
+  char name[50];
+  const int users = BRENT_USERS_PER_CHUNK * 2 + 5;
+
+  for (int i = 0; i < users; i++) {
+    snprintf(name, sizeof(name), "slab%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+
+  EXPECT_EQ(ht.chunkCount, 3u);
+
+  for (int i = 0; i < users; i++) {
+    User *user = getUserAtBrent(&ht, i);
+    ASSERT_NE(user, nullptr);
+    EXPECT_EQ(user->id, i + 1);
+  }
+
+  EXPECT_EQ(getUserAtBrent(&ht, users), nullptr);
+  destroyBrentHashTable(&ht);
+  EXPECT_EQ(ht.chunks, nullptr);
+  EXPECT_EQ(ht.chunkCount, 0u);
+}
+
+TEST_F(local_event_planner_Test, TestBrentClearKeepsStorageForReuse) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 1, "carol", "pass"), 1);
+  size_t before = memoryUsageBrent(&ht);
+  clearBrentHashTable(&ht);
+  EXPECT_EQ(ht.count, 0u);
+  EXPECT_EQ(findUserBrent(&ht, "carol", NULL), 0);
+  EXPECT_EQ(memoryUsageBrent(&ht), before);
+  ASSERT_EQ(insertUserBrent(&ht, 2, "dave", "pass"), 1);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "dave", &user), 1);
+  EXPECT_EQ(user->id, 2);
+  EXPECT_EQ(user, getUserAtBrent(&ht, 0));
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentBulkInsertDropsDuplicates) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 1, "existing", "old"), 1);
+  std::vector<User> users(1000);
+
+  for (int i = 0; i < 1000; i++) {
+    memset(&users[i], 0, sizeof(User));
+    users[i].id = i + 2;
+    // every name appears twice inside the block, plus one clash with the table
+    snprintf(users[i].username, sizeof(users[i].username), i == 999 ? "existing" : "bulk%d", i / 2);
+    snprintf(users[i].password, sizeof(users[i].password), "pw%d", i);
+  }
+
+  unsigned int consumed = 0;
+  EXPECT_EQ(insertUsersBulkBrent(&ht, users.data(), (unsigned int)users.size(), &consumed), 500u);
+  EXPECT_EQ(consumed, 1000u);
+  EXPECT_EQ(ht.count, 501u);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "bulk7", &user), 1);
+  EXPECT_STREQ(user->password, "pw14");
+  ASSERT_EQ(findUserBrent(&ht, "existing", &user), 1);
+  EXPECT_STREQ(user->password, "old");
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentReserveSizesOnce) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(reserveBrentHashTable(&ht, 10000), 1);
+  unsigned int reserved = ht.capacity;
+  EXPECT_GE(reserved * ht.maxLoadFactor, 10000.0f);
+  char name[50];
+
+  for (int i = 0; i < 10000; i++) {
+    snprintf(name, sizeof(name), "reserved%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+
+  EXPECT_EQ(ht.capacity, reserved);
+  EXPECT_EQ(reserveBrentHashTable(&ht, 10), 1);
+  EXPECT_EQ(ht.capacity, reserved);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableForcedFailure) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  forceFailure = true;
+  EXPECT_EQ(insertUserBrent(&ht, 1, "bob", "pass"), 0);
+  forceFailure = false;
+  EXPECT_EQ(ht.count, 0u);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestUserStoreKeepsRegistrationsAcrossReopen) {
+  const char* file = "store_test_users.dat";
+  char journal[FILENAME_MAX];
+  char index[FILENAME_MAX];
+  buildUserJournalPath(journal, sizeof(journal), file);
+  snprintf(index, sizeof(index), "%s.idx", file);
+  remove(file);
+  remove(journal);
+  remove(index);
+
+  UserStore store;
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  User* created = NULL;
+  EXPECT_EQ(registerUserInStore(&store, "alice", "pass1", &created), 1);
+  ASSERT_NE(created, nullptr);
+  EXPECT_EQ(registerUserInStore(&store, "bob", "pass2", NULL), 1);
+  EXPECT_EQ(registerUserInStore(&store, "alice", "other", NULL), 0);
+  EXPECT_EQ(store.pendingJournalRecords, 2);
+
+  User* found = NULL;
+  EXPECT_EQ(findUserInStore(&store, "alice", &found), 1);
+  EXPECT_EQ(found, created);
+  closeUserStore(&store);
+  EXPECT_EQ(countUserJournalRecords(journal), 0);
+
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  EXPECT_EQ(store.table.count, 2u);
+  EXPECT_EQ(findUserInStore(&store, "bob", &found), 1);
+  EXPECT_STREQ(found->password, "pass2");
+  EXPECT_EQ(updateUserPasswordInStore(&store, "bob", "pass3"), 1);
+  EXPECT_EQ(store.pendingJournalRecords, 1);
+  closeUserStore(&store);
+
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  EXPECT_EQ(findUserInStore(&store, "bob", &found), 1);
+  EXPECT_STREQ(found->password, "pass3");
+  EXPECT_EQ(deleteUserFromStore(&store, "alice"), 1);
+  EXPECT_EQ(deleteUserFromStore(&store, "alice"), 0);
+  closeUserStore(&store);
+
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  EXPECT_EQ(store.table.count, 1u);
+  EXPECT_EQ(findUserInStore(&store, "alice", NULL), 0);
+  closeUserStore(&store);
+
+  remove(file);
+  remove(journal);
+  remove(index);
+}
+
+TEST_F(local_event_planner_Test, TestUserStoreRollsBackWhenJournalAppendFails) {
+  // The journal lives in a directory that does not exist, so every append fails
+  UserStore store;
+  ASSERT_EQ(openUserStore(&store, "no_such_store_dir/users.dat"), 1);
+  EXPECT_EQ(registerUserInStore(&store, "carol", "pass1", NULL), 0);
+  EXPECT_EQ(findUserInStore(&store, "carol", NULL), 0);
+  EXPECT_EQ(store.table.count, 0u);
+  EXPECT_EQ(registerUserInStore(&store, "carol", "pass1", NULL), 0);  // fails again, not as "taken"
+  EXPECT_EQ(store.table.count, 0u);
+
+  ASSERT_EQ(insertUserBrent(&store.table, 7, "dave", "old"), 1);
+  EXPECT_EQ(updateUserPasswordInStore(&store, "dave", "new"), 0);
+  User *dave = NULL;
+  ASSERT_EQ(findUserInStore(&store, "dave", &dave), 1);
+  EXPECT_STREQ(dave->password, "old");
+  EXPECT_EQ(deleteUserFromStore(&store, "dave"), 0);
+  ASSERT_EQ(findUserInStore(&store, "dave", &dave), 1);
+  EXPECT_EQ(dave->id, 7);
+  EXPECT_STREQ(dave->password, "old");
+  EXPECT_EQ(store.pendingJournalRecords, 0);
+  destroyBrentHashTable(&store.table);
+}
+
+TEST_F(local_event_planner_Test, TestDeletedUserStaysDeletedAfterInterruptedCompaction) {
+  const char* file = "store_delete_users.dat";
+  char journal[FILENAME_MAX];
+  char index[FILENAME_MAX];
+  buildUserJournalPath(journal, sizeof(journal), file);
+  snprintf(index, sizeof(index), "%s.idx", file);
+  remove(file);
+  remove(journal);
+  remove(index);
+
+  UserStore store;
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  ASSERT_EQ(registerUserInStore(&store, "alice", "pass1", NULL), 1);
+  ASSERT_EQ(registerUserInStore(&store, "bob", "pass2", NULL), 1);
+  ASSERT_EQ(deleteUserFromStore(&store, "alice"), 1);
+  EXPECT_EQ(store.pendingJournalRecords, 3);
+  User copy;
+  EXPECT_EQ(findUserInJournal(journal, "alice", &copy), -1);
+  EXPECT_EQ(findUserInJournal(journal, "bob", &copy), 1);
+
+  // Crash after the snapshot is written but before the journal is removed.
+  ASSERT_EQ(saveUsersToBinaryFile(&store.table, file), 1);
+  destroyBrentHashTable(&store.table);
+
+  ASSERT_EQ(openUserStore(&store, file), 1);
+  EXPECT_EQ(store.table.count, 1u);
+  EXPECT_EQ(findUserInStore(&store, "alice", NULL), 0);
+  EXPECT_EQ(findUserInStore(&store, "bob", NULL), 1);
+  closeUserStore(&store);
+
+  remove(file);
+  remove(journal);
+  remove(index);
+}
+
+TEST_F(local_event_planner_Test, TestAllocateUserIDNeverRewinds) {
+  currentID = 40;
+  EXPECT_EQ(allocateUserID(), 40);
+  advanceUserID(10);
+  EXPECT_EQ(currentID, 41);
+  advanceUserID(50);
+  EXPECT_EQ(allocateUserID(), 51);
+}
+
+TEST_F(local_event_planner_Test, TestConcurrentTableInsertAndFind) {
+  ConcurrentHashTable ct;
+  ASSERT_EQ(initConcurrentHashTable(&ct, 0.0f), 0);
+  ASSERT_EQ(initConcurrentHashTable(&ct, 0.9f), 1);
+  currentID = 1;
+
+  int id = 0;
+  EXPECT_EQ(insertUserConcurrent(&ct, "alice", "pass1", &id), 1);
+  EXPECT_EQ(id, 1);
+  EXPECT_EQ(insertUserConcurrent(&ct, "alice", "other", NULL), 0);
+  EXPECT_EQ(currentID, 2);
+
+  User found;
+  EXPECT_EQ(findUserConcurrent(&ct, "alice", &found), 1);
+  EXPECT_STREQ(found.password, "pass1");
+  EXPECT_EQ(findUserConcurrent(&ct, "bob", &found), 0);
+  EXPECT_EQ(countUsersConcurrent(&ct), 1u);
+  destroyConcurrentHashTable(&ct);
+}
+
+TEST_F(local_event_planner_Test, TestConcurrentTableStress) {
+  const int writers = 8, readers = 4, perWriter = 20000;
+  ConcurrentHashTable ct;
+  ASSERT_EQ(initConcurrentHashTable(&ct, 0.9f), 1);
+  currentID = 1;
+
+  std::vector<std::vector<int> > ids(writers);
+  std::atomic<bool> done(false);
+  std::atomic<int> badReads(0);
+  std::vector<std::thread> threads;
+
+  for (int w = 0; w < writers; w++) {
+    threads.push_back(std::thread([&, w]() {
+      char name[50], password[50];
+      for (int i = 0; i < perWriter; i++) {
+        snprintf(name, sizeof(name), "writer%d_user%d", w, i);
+        snprintf(password, sizeof(password), "pw%d_%d", w, i);
+        int id = 0;
+        if (insertUserConcurrent(&ct, name, password, &id)) {
+          ids[w].push_back(id);
+        }
+      }
+    }));
+  }
+
+  for (int r = 0; r < readers; r++) {
+    threads.push_back(std::thread([&, r]() {
+      char name[50], password[50];
+      User user;
+      int i = 0;
+      while (!done.load()) {
+        int w = (i + r) % writers, n = i % perWriter;
+        snprintf(name, sizeof(name), "writer%d_user%d", w, n);
+        if (findUserConcurrent(&ct, name, &user)) {
+          snprintf(password, sizeof(password), "pw%d_%d", w, n);
+          if (strcmp(user.password, password) != 0 || strcmp(user.username, name) != 0) {
+            badReads++;
+          }
+        }
+        i++;
+      }
+    }));
+  }
+
+  for (int w = 0; w < writers; w++) {
+    threads[w].join();
+  }
+  done = true;
+  for (size_t t = writers; t < threads.size(); t++) {
+    threads[t].join();
+  }
+
+  EXPECT_EQ(badReads.load(), 0);
+  EXPECT_EQ(countUsersConcurrent(&ct), (unsigned int)(writers * perWriter));
+
+  std::vector<int> all;
+  for (int w = 0; w < writers; w++) {
+    EXPECT_EQ(ids[w].size(), (size_t)perWriter);
+    all.insert(all.end(), ids[w].begin(), ids[w].end());
+  }
+  std::sort(all.begin(), all.end());
+  EXPECT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+  char name[50];
+  int missing = 0;
+  for (int w = 0; w < writers; w++) {
+    for (int i = 0; i < perWriter; i++) {
+      snprintf(name, sizeof(name), "writer%d_user%d", w, i);
+      missing += !findUserConcurrent(&ct, name, NULL);
+    }
+  }
+  EXPECT_EQ(missing, 0);
+  destroyConcurrentHashTable(&ct);
+}
+
+TEST_F(local_event_planner_Test, TestBrentDeleteKeepsSlabDense) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 1, "ada", "p1"), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 2, "ben", "p2"), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 3, "cem", "p3"), 1);
+
+  EXPECT_EQ(deleteUserBrent(&ht, "ada"), 1);
+  EXPECT_EQ(deleteUserBrent(&ht, "ada"), 0);
+  EXPECT_EQ(deleteUserBrent(&ht, "nobody"), 0);
+  EXPECT_EQ(ht.count, 2u);
+  EXPECT_EQ(ht.tombstones, 1u);
+  EXPECT_EQ(findUserBrent(&ht, "ada", NULL), 0);
+  EXPECT_STREQ(getUserAtBrent(&ht, 0)->username, "cem");
+  EXPECT_STREQ(getUserAtBrent(&ht, 1)->username, "ben");
+
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "cem", &user), 1);
+  EXPECT_EQ(user, getUserAtBrent(&ht, 0));
+  EXPECT_EQ(insertUserBrent(&ht, 4, "ada", "again"), 1);
+  ASSERT_EQ(findUserBrent(&ht, "ada", &user), 1);
+  EXPECT_STREQ(user->password, "again");
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentDeleteKeepsLongChainsReachable) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 64, 1.0f), 1);
+  char name[50];
+
+  for (int i = 0; i < 60; i++) {
+    snprintf(name, sizeof(name), "chain%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+  for (int i = 0; i < 60; i += 3) {
+    snprintf(name, sizeof(name), "chain%d", i);
+    ASSERT_EQ(deleteUserBrent(&ht, name), 1);
+  }
+
+  EXPECT_EQ(ht.capacity, 64u);
+  for (int i = 0; i < 60; i++) {
+    snprintf(name, sizeof(name), "chain%d", i);
+    EXPECT_EQ(findUserBrent(&ht, name, NULL), i % 3 != 0) << name;
+  }
+  EXPECT_LE(ht.tombstones, 64u >> BRENT_TOMBSTONE_CLEANUP_SHIFT);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentUpdateChangesPasswordInPlace) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 1, "deniz", "old"), 1);
+  User *before = NULL, *after = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "deniz", &before), 1);
+
+  EXPECT_EQ(updateUserBrent(&ht, "deniz", "a-much-longer-password-than-the-field-can-hold-xyz"), 1);
+  EXPECT_EQ(updateUserBrent(&ht, "nobody", "x"), 0);
+  ASSERT_EQ(findUserBrent(&ht, "deniz", &after), 1);
+  EXPECT_EQ(before, after);
+  EXPECT_EQ(strlen(after->password), sizeof(after->password) - 1);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentChurnKeepsCapacityAndProbes) {
+  const int live = 2000, cycles = 20000;
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(reserveBrentHashTable(&ht, live), 1);
+  unsigned int capacity = ht.capacity;
+  char name[50];
+
+  for (int i = 0; i < live; i++) {
+    snprintf(name, sizeof(name), "churn_%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+  }
+
+  // The live users are always [oldest, oldest + live).
+  for (int oldest = 0; oldest < cycles; oldest++) {
+    snprintf(name, sizeof(name), "churn_%d", oldest);
+    ASSERT_EQ(deleteUserBrent(&ht, name), 1);
+    snprintf(name, sizeof(name), "churn_%d", oldest + live);
+    ASSERT_EQ(insertUserBrent(&ht, oldest + live + 1, name, "secret"), 1);
+  }
+
+  for (int i = 0; i < live; i++) {
+    snprintf(name, sizeof(name), "churn_%d", cycles + i);
+    EXPECT_EQ(findUserBrent(&ht, name, NULL), 1) << name;
+  }
+  snprintf(name, sizeof(name), "churn_%d", cycles - 1);
+  EXPECT_EQ(findUserBrent(&ht, name, NULL), 0);
+  EXPECT_EQ(ht.count, (unsigned int)live);
+  EXPECT_EQ(ht.capacity, capacity);
+  EXPECT_LT(averageProbeLengthBrent(&ht), 2.5);
+  EXPECT_LE(ht.tombstones, capacity >> BRENT_TOMBSTONE_CLEANUP_SHIFT);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableHeterogeneousStringLookup) {
+  BrentTable<std::string, std::pair<std::string, int> > table;
+  ASSERT_TRUE(table.init(16, 0.9f));
+  char name[32];
+
+  for (int i = 0; i < 500; i++) {
+    snprintf(name, sizeof(name), "event_%d", i);
+    ASSERT_NE(table.insert(std::make_pair(std::string(name), i)), nullptr);
+  }
+  EXPECT_EQ(table.size(), 500u);
+
+  // const char* and BrentKeyView probe without building a std::string
+  std::pair<std::string, int> *found = table.find("event_321");
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->second, 321);
+  const char text[] = "event_7xyz";
+  found = table.find(BrentKeyView(text, 7));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->second, 7);
+  EXPECT_EQ(table.find("event_500"), nullptr);
+  EXPECT_EQ(table.hashOf("abc"), hashUsername("abc"));
+
+  EXPECT_TRUE(table.erase("event_0"));
+  EXPECT_FALSE(table.erase(std::string("event_0")));
+  EXPECT_EQ(table.size(), 499u);
+  EXPECT_EQ(table.at(0)->first, "event_499");
+  for (int i = 1; i < 500; i++) {
+    snprintf(name, sizeof(name), "event_%d", i);
+    ASSERT_NE(table.find(name), nullptr) << name;
+  }
+  EXPECT_LT(table.averageProbeLength(), 2.5);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableFixedSizeKeys) {
+  BrentTable<int64_t, std::pair<int64_t, int> > byId;
+  ASSERT_TRUE(byId.init());
+  for (int64_t id = 0; id < 5000; id++) {
+    ASSERT_NE(byId.insert(std::make_pair(id * 1000003, (int)id)), nullptr);
+  }
+  for (int64_t id = 0; id < 5000; id++) {
+    std::pair<int64_t, int> *found = byId.find(id * 1000003);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->second, (int)id);
+  }
+  EXPECT_EQ(byId.find((int64_t)7), nullptr);
+
+  typedef std::array<char, 8> Code;
+  BrentTable<Code, std::pair<Code, int> > byCode;
+  ASSERT_TRUE(byCode.init(8, 0.5f));
+  Code a = {{ 'C', 'E', 'N', '2', '0', '7', 0, 0 }};
+  Code b = {{ 'C', 'E', 'N', '2', '0', '8', 0, 0 }};
+  ASSERT_NE(byCode.insert(std::make_pair(a, 1)), nullptr);
+  ASSERT_NE(byCode.insert(std::make_pair(b, 2)), nullptr);
+  EXPECT_EQ(byCode.find(b)->second, 2);
+  EXPECT_TRUE(byCode.erase(a));
+  EXPECT_EQ(byCode.find(a), nullptr);
+}
+
+TEST_F(local_event_planner_Test, TestBrentTableBulkInsertSkipsDuplicates) {
+  BrentTable<std::string, std::pair<std::string, int> > table;
+  ASSERT_TRUE(table.init());
+  std::vector<std::pair<std::string, int> > values;
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(std::make_pair("k" + std::to_string(i % 600), i));
+  }
+
+  unsigned int consumed = 0;
+  EXPECT_EQ(table.insertBulk(values.data(), (unsigned int)values.size(), &consumed), 600u);
+  EXPECT_EQ(consumed, 1000u);
+  EXPECT_EQ(table.find("k5")->second, 5);
+  table.clear();
+  EXPECT_EQ(table.size(), 0u);
+  EXPECT_EQ(table.find("k5"), nullptr);
+}
+
+TEST_F(local_event_planner_Test, TestEventStoreRangeQueryIsOrderedByStart) {
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  Event *created = NULL;
+  ASSERT_EQ(addEvent(&store, 1, 500, 600, "Jazz night", "Old town", &created), 1);
+  EXPECT_EQ(created->id, 1);
+  ASSERT_EQ(addEvent(&store, 2, 100, 200, "Market", "Square", NULL), 1);
+  ASSERT_EQ(addEvent(&store, 1, 300, 300, "Kids workshop", "Library", NULL), 1);
+  ASSERT_EQ(addEvent(&store, 3, 900, 950, "Late show", "Cinema", NULL), 1);
+  EXPECT_EQ(addEvent(&store, 3, 900, 800, "Ends before it starts", "", NULL), 0);
+
+  std::vector<const Event *> found;
+  EXPECT_EQ(findEventsInRange(&store, 100, 900, &found), 3u);
+  ASSERT_EQ(found.size(), 3u);
+  EXPECT_STREQ(found[0]->title, "Market");
+  EXPECT_STREQ(found[1]->title, "Kids workshop");
+  EXPECT_STREQ(found[2]->title, "Jazz night");
+
+  found.clear();
+  EXPECT_EQ(findEventsInRange(&store, 901, 10000, &found), 0u);
+  EXPECT_EQ(countEvents(&store), 4u);
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestEventStoreUpdateAndDeleteKeepIndexExact) {
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  const int events = 20000;
+  for (int i = 0; i < events; i++) {
+    ASSERT_EQ(addEvent(&store, i % 7, (int64_t)i * 60, (int64_t)i * 60 + 30, "event", "here", NULL), 1);
+  }
+
+  // Move every even event one day later and back again; delete every tenth one.
+  for (int id = 2; id <= events; id += 2) {
+    ASSERT_EQ(updateEventTime(&store, id, (int64_t)(id - 1) * 60 + 86400, (int64_t)(id - 1) * 60 + 86430), 1);
+  }
+  for (int id = 2; id <= events; id += 2) {
+    ASSERT_EQ(updateEventTime(&store, id, (int64_t)(id - 1) * 60, (int64_t)(id - 1) * 60 + 30), 1);
+  }
+  for (int id = 10; id <= events; id += 10) {
+    ASSERT_EQ(deleteEvent(&store, id), 1);
+  }
+  EXPECT_EQ(deleteEvent(&store, 10), 0);
+  EXPECT_EQ(updateEventTime(&store, 10, 0, 1), 0);
+
+  std::vector<const Event *> found;
+  EXPECT_EQ(findEventsInRange(&store, 0, (int64_t)events * 60, &found), (size_t)(events - events / 10));
+  for (size_t i = 1; i < found.size(); i++) {
+    ASSERT_LT(found[i - 1]->startTime, found[i]->startTime);
+  }
+  EXPECT_EQ(countEvents(&store), (size_t)(events - events / 10));
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestEventStoreSaveAndLoadRoundTrip) {
+  const char *eventsFile = "local_event_planner_test_events.dat";
+  std::remove(eventsFile);
+
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  EXPECT_EQ(loadEventsFromBinaryFile(&store, eventsFile), 1);
+  for (int i = 0; i < 5000; i++) {
+    ASSERT_EQ(addEvent(&store, i, 1000 - i, 2000, "concert", "park", NULL), 1);
+  }
+  ASSERT_EQ(deleteEvent(&store, 5000), 1);
+  ASSERT_EQ(setEventPosition(&store, 42, 41.0082, 28.9784), 1);
+  ASSERT_EQ(saveEventsToBinaryFile(&store, eventsFile), 1);
+
+  EventStore loaded;
+  ASSERT_EQ(initEventStore(&loaded), 1);
+  ASSERT_EQ(loadEventsFromBinaryFile(&loaded, eventsFile), 1);
+  EXPECT_EQ(countEvents(&loaded), 4999u);
+  EXPECT_EQ(loaded.nextID, 5001);
+
+  std::vector<const Event *> before, after;
+  findEventsInRange(&store, -10000, 10000, &before);
+  findEventsInRange(&loaded, -10000, 10000, &after);
+  ASSERT_EQ(before.size(), after.size());
+  for (size_t i = 0; i < before.size(); i++) {
+    EXPECT_EQ(before[i]->id, after[i]->id);
+  }
+
+  Event *event = NULL;
+  ASSERT_EQ(findEventById(&loaded, 42, &event), 1);
+  EXPECT_STREQ(event->location, "park");
+  std::vector<const Event *> near;
+  EXPECT_EQ(findEventsNear(&loaded, 41.01, 28.98, 1.0, INT64_MIN, INT64_MAX, &near), 1u);
+  ASSERT_EQ(near.size(), 1u);
+  EXPECT_EQ(near[0]->id, 42);
+  destroyEventStore(&store);
+  destroyEventStore(&loaded);
+  std::remove(eventsFile);
+}
+
+TEST_F(local_event_planner_Test, TestTokenizeTextLowercasesAndDeduplicates) {
+  std::vector<std::string> tokens;
+  EXPECT_EQ(tokenizeText("Jazz & Blues: JAZZ night, a kids-friendly show!", &tokens), 6u);
+  const char *expected[] = { "blues", "friendly", "jazz", "kids", "night", "show" };
+  for (size_t i = 0; i < tokens.size(); i++) {
+    EXPECT_EQ(tokens[i], expected[i]);
+  }
+  EXPECT_EQ(tokenizeText(NULL, &tokens), 0u);
+  EXPECT_EQ(tokenizeText("Çarşı pazarı", &tokens), 2u);
+}
+
+TEST_F(local_event_planner_Test, TestTextIndexQueriesMatchBruteForce) {
+  const char *words[] = { "jazz", "market", "kids", "food", "art", "night", "free", "run" };
+  const int documents = 5000;
+  TextIndex index;
+  ASSERT_EQ(initTextIndex(&index), 1);
+  std::vector<unsigned> masks(documents + 1, 0);
+  uint64_t seed = 99;
+
+  for (int id = 1; id <= documents; id++) {
+    std::string text;
+    for (int w = 0; w < 8; w++) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      if ((seed >> 33) % (w + 2) == 0) {
+        masks[id] |= 1u << w;
+        text += std::string(words[w]) + " ";
+      }
+    }
+    ASSERT_EQ(addDocumentToTextIndex(&index, id, text.c_str()), 1);
+  }
+  // Edit every third document: drop "jazz", add "art".
+  for (int id = 3; id <= documents; id += 3) {
+    std::string oldText, newText;
+    for (int w = 0; w < 8; w++) {
+      if (masks[id] & (1u << w)) {
+        oldText += std::string(words[w]) + " ";
+      }
+    }
+    masks[id] = (masks[id] & ~1u) | (1u << 4);
+    for (int w = 0; w < 8; w++) {
+      if (masks[id] & (1u << w)) {
+        newText += std::string(words[w]) + " ";
+      }
+    }
+    ASSERT_EQ(updateDocumentInTextIndex(&index, id, oldText.c_str(), newText.c_str()), 1);
+  }
+
+  const char *queries[] = { "jazz", "jazz kids", "market food night", "art free", "jazz run kids night" };
+  const unsigned queryMasks[] = { 1u, 1u | 4u, 2u | 8u | 32u, 16u | 64u, 1u | 128u | 4u | 32u };
+  std::vector<uint32_t> results;
+  for (int q = 0; q < 5; q++) {
+    std::vector<uint32_t> all, any;
+    for (int id = 1; id <= documents; id++) {
+      if ((masks[id] & queryMasks[q]) == queryMasks[q]) {
+        all.push_back(id);
+      }
+      if (masks[id] & queryMasks[q]) {
+        any.push_back(id);
+      }
+    }
+    searchTextIndex(&index, queries[q], TEXT_QUERY_ALL, &results);
+    EXPECT_EQ(results, all) << queries[q];
+    searchTextIndex(&index, queries[q], TEXT_QUERY_ANY, &results);
+    EXPECT_EQ(results, any) << queries[q];
+  }
+  EXPECT_EQ(searchTextIndex(&index, "jazz unknownword", TEXT_QUERY_ALL, &results), 0u);
+  destroyTextIndex(&index);
+}
+
+TEST_F(local_event_planner_Test, TestEventStoreKeywordSearchFollowsEdits) {
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  ASSERT_EQ(addEvent(&store, 1, 100, 200, "Jazz in the park", "Central Park", NULL), 1);
+  ASSERT_EQ(addEvent(&store, 1, 300, 400, "Farmers market", "Old town", NULL), 1);
+  ASSERT_EQ(addEvent(&store, 2, 500, 600, "Kids jazz workshop", "Library", NULL), 1);
+
+  std::vector<const Event *> found;
+  EXPECT_EQ(searchEvents(&store, "jazz", TEXT_QUERY_ALL, &found), 2u);
+  found.clear();
+  EXPECT_EQ(searchEvents(&store, "park", TEXT_QUERY_ALL, &found), 1u);
+
+  ASSERT_EQ(updateEventText(&store, 1, "Blues in the park", "Central Park"), 1);
+  found.clear();
+  EXPECT_EQ(searchEvents(&store, "jazz", TEXT_QUERY_ALL, &found), 1u);
+  EXPECT_EQ(found[0]->id, 3);
+
+  ASSERT_EQ(deleteEvent(&store, 3), 1);
+  found.clear();
+  EXPECT_EQ(searchEvents(&store, "jazz market blues", TEXT_QUERY_ANY, &found), 2u);
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestSpatialBoxAroundPointHandlesPolesAndDateLine) {
+  SpatialBox box;
+  ASSERT_EQ(spatialBoxAroundPoint(41.0, 29.0, 10.0, &box), 1);
+  EXPECT_LT(box.minLatitudeE6, 41000000);
+  EXPECT_GT(box.maxLatitudeE6, 41000000);
+  EXPECT_LT(box.minLongitudeE6, box.maxLongitudeE6);
+
+  ASSERT_EQ(spatialBoxAroundPoint(-17.7, 179.95, 20.0, &box), 1);
+  EXPECT_GT(box.minLongitudeE6, box.maxLongitudeE6);
+
+  ASSERT_EQ(spatialBoxAroundPoint(89.99, 0.0, 5.0, &box), 1);
+  EXPECT_EQ(box.minLongitudeE6, -180000000);
+  EXPECT_EQ(box.maxLongitudeE6, 180000000);
+  EXPECT_EQ(box.maxLatitudeE6, 90000000);
+
+  EXPECT_EQ(spatialBoxAroundPoint(91.0, 0.0, 5.0, &box), 0);
+  EXPECT_EQ(spatialBoxAroundPoint(0.0, 0.0, -1.0, &box), 0);
+  EXPECT_NEAR(distanceKm(41008200, 28978400, 39925000, 32837000), 350.0, 5.0);
+}
+
+TEST_F(local_event_planner_Test, TestEventStoreNearbyQueriesMatchBruteForce) {
+  const double cities[][2] = { { 41.0082, 28.9784 }, { 39.9250, 32.8370 }, { -17.7134, 179.99 }, { 64.1466, -21.9426 } };
+  const int events = 6000;
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+
+  uint64_t seed = 777;
+  for (int i = 0; i < events; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    const double *city = cities[(seed >> 33) % 4];
+    double latitude = city[0] + (double)((int)((seed >> 12) % 20001) - 10000) / 100000.0;
+    double longitude = city[1] + (double)((int)((seed >> 40) % 20001) - 10000) / 100000.0;
+    if (longitude > 180.0) {
+      longitude -= 360.0;
+    }
+    int64_t begin = (int64_t)((seed >> 24) % 1000) * 3600;
+    ASSERT_EQ(addEvent(&store, 1, begin, begin + 3600, "event", "city", NULL), 1);
+    if (i % 10 != 0) {
+      ASSERT_EQ(setEventPosition(&store, i + 1, latitude, longitude), 1);
+    }
+  }
+  EXPECT_EQ(setEventPosition(&store, 1, 95.0, 0.0), 0);
+  EXPECT_EQ(setEventPosition(&store, events + 1, 0.0, 0.0), 0);
+
+  // Move, re-place and delete some events so the grid has to follow.
+  for (int id = 3; id <= events; id += 7) {
+    ASSERT_EQ(updateEventTime(&store, id, 500 * 3600, 501 * 3600), 1);
+  }
+  for (int id = 5; id <= events; id += 11) {
+    ASSERT_EQ(setEventPosition(&store, id, cities[id % 4][0], cities[id % 4][1]), 1);
+  }
+  for (int id = 4; id <= events; id += 13) {
+    ASSERT_EQ(deleteEvent(&store, id), 1);
+  }
+
+  for (int q = 0; q < 40; q++) {
+    const double *city = cities[q % 4];
+    double radius = 0.5 + q % 5 * 3.0;
+    int64_t from = (int64_t)(q * 23 % 900) * 3600, to = from + (q % 3 + 1) * 100 * 3600;
+
+    std::vector<const Event *> near;
+    findEventsNear(&store, city[0], city[1], radius, from, to, &near);
+    std::vector<int> expected, actual;
+    for (unsigned int i = 0; i < store.events.size(); i++) {
+      const Event *event = store.events.at(i);
+      if (event->latitudeE6 != SPATIAL_NO_POSITION && event->startTime >= from && event->startTime < to
+          && distanceKm(degreesToE6(city[0]), degreesToE6(city[1]), event->latitudeE6, event->longitudeE6) <= radius) {
+        expected.push_back(event->id);
+      }
+    }
+    double previous = 0.0;
+    for (size_t i = 0; i < near.size(); i++) {
+      double distance = distanceKm(degreesToE6(city[0]), degreesToE6(city[1]), near[i]->latitudeE6, near[i]->longitudeE6);
+      EXPECT_GE(distance, previous);
+      previous = distance;
+      actual.push_back(near[i]->id);
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected) << "query " << q;
+  }
+
+  // A box across the date line around Fiji.
+  std::vector<const Event *> boxed;
+  findEventsInBox(&store, -17.9, 179.9, -17.5, -179.9, INT64_MIN, INT64_MAX, &boxed);
+  size_t expectedBoxed = 0;
+  for (unsigned int i = 0; i < store.events.size(); i++) {
+    const Event *event = store.events.at(i);
+    expectedBoxed += event->latitudeE6 != SPATIAL_NO_POSITION && event->latitudeE6 >= -17900000 && event->latitudeE6 <= -17500000
+                     && (event->longitudeE6 >= 179900000 || event->longitudeE6 <= -179900000);
+  }
+  EXPECT_GT(expectedBoxed, 0u);
+  EXPECT_EQ(boxed.size(), expectedBoxed);
+  for (size_t i = 1; i < boxed.size(); i++) {
+    EXPECT_LE(boxed[i - 1]->startTime, boxed[i]->startTime);
+  }
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestRecurrenceIteratorSeeksLikeStepping) {
+  const int64_t firstStart = dateTimeToEpochSeconds(makeDateTime(makeDate(2024, 1, 31), 18, 30, 0));
+  const RecurrenceRule rules[] = {
+    { RECURRENCE_DAILY, 3, 0, RECURRENCE_NO_END },
+    { RECURRENCE_WEEKLY, 1, 40, RECURRENCE_NO_END },
+    { RECURRENCE_WEEKLY, 2, 0, firstStart + 200LL * 86400 },
+    { RECURRENCE_MONTHLY, 1, 0, RECURRENCE_NO_END },
+    { RECURRENCE_MONTHLY, 5, 12, RECURRENCE_NO_END },
+  };
+
+  for (size_t r = 0; r < sizeof(rules) / sizeof(rules[0]); r++) {
+    EventRecurrence recurrence;
+    recurrence.eventID = 1;
+    recurrence.rule = rules[r];
+    for (int64_t i = 2; i < 60; i += 7) {
+      recurrence.exceptions.push_back(occurrenceStart(&rules[r], firstStart, i));
+    }
+
+    // Every occurrence in order, stepping from the first one.
+    std::vector<int64_t> all;
+    OccurrenceIterator it;
+    for (int ok = beginOccurrences(&it, &recurrence, firstStart, INT64_MIN, firstStart + 3000LL * 86400); ok; ok = advanceOccurrence(&it)) {
+      all.push_back(it.startTime);
+    }
+    ASSERT_FALSE(all.empty());
+    EXPECT_EQ(all[0], firstStart);
+
+    for (int64_t from = firstStart - 86400; from < firstStart + 800LL * 86400; from += 86400 * 13 + 3600) {
+      int64_t to = from + 45LL * 86400;
+      std::vector<int64_t> expected, actual;
+      for (size_t i = 0; i < all.size(); i++) {
+        if (all[i] >= from && all[i] < to) {
+          expected.push_back(all[i]);
+        }
+      }
+      for (int ok = beginOccurrences(&it, &recurrence, firstStart, from, to); ok; ok = advanceOccurrence(&it)) {
+        actual.push_back(it.startTime);
+      }
+      ASSERT_EQ(actual, expected) << "rule " << r << " from " << from;
+    }
+  }
+
+  // Monthly on the 31st falls on the last day of shorter months.
+  RecurrenceRule monthly = { RECURRENCE_MONTHLY, 1, 0, RECURRENCE_NO_END };
+  char text[DATE_TIME_STRING_SIZE];
+  formatDateTime(dateTimeFromEpochSeconds(occurrenceStart(&monthly, firstStart, 1)), text, sizeof(text));
+  EXPECT_STREQ(text, "2024-02-29 18:30:00");
+  formatDateTime(dateTimeFromEpochSeconds(occurrenceStart(&monthly, firstStart, 2)), text, sizeof(text));
+  EXPECT_STREQ(text, "2024-03-31 18:30:00");
+}
+
+TEST_F(local_event_planner_Test, TestOccurrencesMergeOneOffAndRecurringEvents) {
+  const char *eventsFile = "local_event_planner_test_events.dat";
+  std::remove(eventsFile);
+  const int64_t day = 86400, monday = dateTimeToEpochSeconds(makeDateTime(makeDate(2025, 3, 3), 9, 0, 0));
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+
+  Event *market = NULL, *meetup = NULL, *concert = NULL;
+  ASSERT_EQ(addEvent(&store, 1, monday, monday + 4 * 3600, "Farmers market", "Square", &market), 1);
+  ASSERT_EQ(addEvent(&store, 2, monday + 2 * day, monday + 2 * day + 3600, "Meetup", "Hub", &meetup), 1);
+  ASSERT_EQ(addEvent(&store, 3, monday + 9 * day, monday + 9 * day + 7200, "Concert", "Arena", &concert), 1);
+  int marketID = market->id, meetupID = meetup->id, concertID = concert->id;
+
+  RecurrenceRule weekly = { RECURRENCE_WEEKLY, 1, 0, RECURRENCE_NO_END };
+  RecurrenceRule monthly = { RECURRENCE_MONTHLY, 1, 6, RECURRENCE_NO_END };
+  RecurrenceRule invalid = { RECURRENCE_WEEKLY, 0, 0, RECURRENCE_NO_END };
+  ASSERT_EQ(setEventRecurrence(&store, marketID, &weekly), 1);
+  ASSERT_EQ(setEventRecurrence(&store, meetupID, &monthly), 1);
+  EXPECT_EQ(setEventRecurrence(&store, concertID, &invalid), 0);
+  EXPECT_EQ(setEventRecurrence(&store, 999, &weekly), 0);
+  ASSERT_EQ(addRecurrenceException(&store, marketID, monday + 14 * day), 1);
+  EXPECT_EQ(addRecurrenceException(&store, marketID, monday + 14 * day), 1);
+  EXPECT_EQ(addRecurrenceException(&store, marketID, monday + 15 * day), 0);
+  EXPECT_EQ(addRecurrenceException(&store, concertID, monday + 9 * day), 0);
+
+  // Four weeks from the second Monday: markets on weeks 1 and 3 (week 2 is cancelled),
+  // the concert, and no meetup (monthly, next one in April).
+  std::vector<EventOccurrence> found;
+  EXPECT_EQ(findOccurrencesInRange(&store, monday + 7 * day, monday + 28 * day, &found), 3u);
+  ASSERT_EQ(found.size(), 3u);
+  EXPECT_EQ(found[0].event->id, marketID);
+  EXPECT_EQ(found[0].startTime, monday + 7 * day);
+  EXPECT_EQ(found[0].endTime, monday + 7 * day + 4 * 3600);
+  EXPECT_EQ(found[1].event->id, concertID);
+  EXPECT_EQ(found[2].startTime, monday + 21 * day);
+
+  // A year of listings: 52 markets minus one exception, 6 meetups, the concert.
+  found.clear();
+  EXPECT_EQ(findOccurrencesInRange(&store, monday, monday + 364 * day, &found), 51u + 6u + 1u);
+  for (size_t i = 1; i < found.size(); i++) {
+    ASSERT_LE(found[i - 1].startTime, found[i].startTime);
+  }
+
+  ASSERT_EQ(saveEventsToBinaryFile(&store, eventsFile), 1);
+  EventStore loaded;
+  ASSERT_EQ(initEventStore(&loaded), 1);
+  ASSERT_EQ(loadEventsFromBinaryFile(&loaded, eventsFile), 1);
+  const EventRecurrence *recurrence = findEventRecurrence(&loaded, marketID);
+  ASSERT_NE(recurrence, nullptr);
+  EXPECT_EQ(recurrence->rule.frequency, RECURRENCE_WEEKLY);
+  ASSERT_EQ(recurrence->exceptions.size(), 1u);
+  std::vector<EventOccurrence> reloaded;
+  findOccurrencesInRange(&loaded, monday, monday + 364 * day, &reloaded);
+  ASSERT_EQ(reloaded.size(), found.size());
+  for (size_t i = 0; i < found.size(); i++) {
+    EXPECT_EQ(reloaded[i].event->id, found[i].event->id);
+    EXPECT_EQ(reloaded[i].startTime, found[i].startTime);
+  }
+
+  // Moving the series drops its exceptions; deleting or clearing the rule removes it.
+  ASSERT_EQ(updateEventTime(&store, marketID, monday + day, monday + day + 3600), 1);
+  EXPECT_TRUE(findEventRecurrence(&store, marketID)->exceptions.empty());
+  ASSERT_EQ(setEventRecurrence(&store, meetupID, NULL), 1);
+  EXPECT_EQ(findEventRecurrence(&store, meetupID), nullptr);
+  ASSERT_EQ(deleteEvent(&store, marketID), 1);
+  EXPECT_EQ(findEventRecurrence(&store, marketID), nullptr);
+  found.clear();
+  EXPECT_EQ(findOccurrencesInRange(&store, monday, monday + 364 * day, &found), 2u);
+
+  destroyEventStore(&store);
+  destroyEventStore(&loaded);
+  std::remove(eventsFile);
+}
+
+TEST_F(local_event_planner_Test, TestOccurrenceQueriesMatchMaterializedOccurrences) {
+  const int oneOff = 2000, recurring = 200;
+  const int64_t day = 86400, year = 365 * day;
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+
+  uint64_t seed = 99;
+  for (int i = 0; i < oneOff + recurring; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    int64_t begin = (int64_t)((seed >> 20) % (uint64_t)year);
+    Event *created = NULL;
+    ASSERT_EQ(addEvent(&store, i % 1000, begin, begin + 7200, "event", "city", &created), 1);
+    if (i >= oneOff) {
+      RecurrenceRule rule = { (seed >> 50) % 3 ? RECURRENCE_WEEKLY : RECURRENCE_MONTHLY, 1, 0, RECURRENCE_NO_END };
+      ASSERT_EQ(setEventRecurrence(&store, created->id, &rule), 1);
+    }
+  }
+
+  // Every occurrence of the first three years, stepped one by one.
+  std::vector<std::pair<int64_t, int>> materialized;
+  for (unsigned int i = 0; i < store.events.size(); i++) {
+    const Event *event = store.events.at(i);
+    const EventRecurrence *recurrence = findEventRecurrence(&store, event->id);
+    for (int64_t n = 0; recurrence || n == 0; n++) {
+      int64_t begin = recurrence ? occurrenceStart(&recurrence->rule, event->startTime, n) : event->startTime;
+      if (begin >= 3 * year) {
+        break;
+      }
+      materialized.push_back(std::make_pair(begin, event->id));
+    }
+  }
+  std::sort(materialized.begin(), materialized.end());
+
+  std::vector<EventOccurrence> found;
+  for (int q = 0; q < 50; q++) {
+    int64_t from = year + (int64_t)q * (year / 50);
+    std::vector<std::pair<int64_t, int>> expected, actual;
+    for (size_t i = 0; i < materialized.size(); i++) {
+      if (materialized[i].first >= from && materialized[i].first < from + 7 * day) {
+        expected.push_back(materialized[i]);
+      }
+    }
+    found.clear();
+    findOccurrencesInRange(&store, from, from + 7 * day, &found);
+    for (size_t i = 0; i < found.size(); i++) {
+      actual.push_back(std::make_pair(found[i].startTime, found[i].event->id));
+    }
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected) << "week " << q;
+  }
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestIdSetMatchesStdSet) {
+  IdSet left, right;
+  std::set<uint32_t> leftRef, rightRef;
+  uint64_t seed = 2024;
+  for (int i = 0; i < 60000; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    // Dense ids in the first two containers (bitmaps), sparse ones further out (arrays).
+    uint32_t id = (seed >> 60) < 12 ? (uint32_t)((seed >> 20) % 131072) : (uint32_t)((seed >> 20) % 50000000);
+    if ((seed >> 33) & 1) {
+      EXPECT_EQ(idSetAdd(&left, id), leftRef.insert(id).second ? 1 : 0);
+    } else {
+      EXPECT_EQ(idSetAdd(&right, id), rightRef.insert(id).second ? 1 : 0);
+    }
+  }
+  for (int i = 0; i < 20000; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint32_t id = (uint32_t)((seed >> 20) % 131072);
+    EXPECT_EQ(idSetRemove(&left, id), (int)leftRef.erase(id));
+  }
+  EXPECT_EQ(idSetCardinality(&left), leftRef.size());
+  EXPECT_EQ(idSetContains(&left, *leftRef.begin()), 1);
+  EXPECT_EQ(idSetContains(&left, 4000000000u), 0);
+
+  std::vector<uint32_t> ids, expected(leftRef.begin(), leftRef.end());
+  idSetToVector(&left, &ids);
+  EXPECT_EQ(ids, expected);
+
+  std::vector<uint32_t> common, all;
+  std::set_intersection(leftRef.begin(), leftRef.end(), rightRef.begin(), rightRef.end(), std::back_inserter(common));
+  std::set_union(leftRef.begin(), leftRef.end(), rightRef.begin(), rightRef.end(), std::back_inserter(all));
+  IdSet result;
+  idSetIntersection(&left, &right, &result);
+  ids.clear();
+  idSetToVector(&result, &ids);
+  EXPECT_EQ(ids, common);
+  EXPECT_EQ(idSetIntersectionCardinality(&left, &right), common.size());
+  idSetUnion(&left, &right, &result);
+  ids.clear();
+  idSetToVector(&result, &ids);
+  EXPECT_EQ(ids, all);
+
+  std::vector<uint8_t> bytes;
+  idSetSerialize(&result, &bytes);
+  IdSet copy;
+  ASSERT_EQ(idSetDeserialize(bytes.data(), bytes.size(), &copy), 1);
+  EXPECT_EQ(idSetIntersectionCardinality(&copy, &result), all.size());
+  EXPECT_EQ(idSetCardinality(&copy), all.size());
+  EXPECT_EQ(idSetDeserialize(bytes.data(), bytes.size() - 1, &copy), 0);
+  EXPECT_EQ(idSetCardinality(&copy), 0u);
+  bytes[6] ^= 1; // first container's type
+  EXPECT_EQ(idSetDeserialize(bytes.data(), bytes.size(), &copy), 0);
+}
+
+TEST_F(local_event_planner_Test, TestEventAttendeesFollowRsvpsAndPersist) {
+  const char *eventsFile = "local_event_planner_test_events.dat";
+  std::remove(eventsFile);
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(addEvent(&store, 1, 1000 * i, 1000 * i + 500, "event", "here", NULL), 1);
+  }
+
+  // Event 1 is popular: every user 1..20000 attends. Event 2 gets every third user.
+  for (int user = 1; user <= 20000; user++) {
+    ASSERT_EQ(addAttendee(&store, 1, user), 1);
+    if (user % 3 == 0) {
+      ASSERT_EQ(addAttendee(&store, 2, user), 1);
+    }
+  }
+  ASSERT_EQ(addAttendee(&store, 3, 7), 1);
+  EXPECT_EQ(addAttendee(&store, 3, 7), 0);
+  EXPECT_EQ(addAttendee(&store, 99, 7), 0);
+  EXPECT_EQ(addAttendee(&store, 3, 0), 0);
+  EXPECT_EQ(countAttendees(&store, 1), 20000u);
+  EXPECT_EQ(isAttending(&store, 2, 9), 1);
+  EXPECT_EQ(isAttending(&store, 2, 10), 0);
+
+  IdSet mutual, friends, going;
+  EXPECT_EQ(findMutualAttendees(&store, 1, 2, &mutual), 6666u);
+  EXPECT_EQ(findMutualAttendees(&store, 1, 4, &mutual), 0u);
+  idSetAdd(&friends, 7);
+  idSetAdd(&friends, 8);
+  idSetAdd(&friends, 50000);
+  EXPECT_EQ(countAttendeesAmong(&store, 1, &friends), 2u);
+  EXPECT_EQ(findEventsAttendedBy(&store, &friends, &going), 2u);
+  EXPECT_EQ(idSetContains(&going, 3), 1);
+  EXPECT_EQ(idSetContains(&going, 2), 0);
+
+  EXPECT_EQ(removeAttendee(&store, 3, 7), 1);
+  EXPECT_EQ(removeAttendee(&store, 3, 7), 0);
+  EXPECT_EQ(findEventAttendees(&store, 3), nullptr);
+
+  ASSERT_EQ(saveEventsToBinaryFile(&store, eventsFile), 1);
+  EventStore loaded;
+  ASSERT_EQ(initEventStore(&loaded), 1);
+  ASSERT_EQ(loadEventsFromBinaryFile(&loaded, eventsFile), 1);
+  EXPECT_EQ(countAttendees(&loaded, 1), 20000u);
+  EXPECT_EQ(countAttendees(&loaded, 2), 6666u);
+  EXPECT_EQ(findEventsAttendedBy(&loaded, &friends, &going), 1u);
+
+  // Deleting an event drops it from every attendee's attendance set.
+  ASSERT_EQ(deleteEvent(&loaded, 1), 1);
+  EXPECT_EQ(findEventsAttendedBy(&loaded, &friends, &going), 0u);
+  EXPECT_EQ(loaded.attendance.size(), 6666u);
+
+  destroyEventStore(&store);
+  destroyEventStore(&loaded);
+  std::remove(eventsFile);
+}
+
+static bool conflictPairLess(const ScheduleConflict &left, const ScheduleConflict &right) {
+  int leftLow = std::min(left.id, left.otherID), rightLow = std::min(right.id, right.otherID);
+  int leftHigh = std::max(left.id, left.otherID), rightHigh = std::max(right.id, right.otherID);
+  return leftLow < rightLow || (leftLow == rightLow && leftHigh < rightHigh);
+}
+
+static std::vector<std::pair<int, int>> conflictPairs(std::vector<ScheduleConflict> conflicts) {
+  std::sort(conflicts.begin(), conflicts.end(), conflictPairLess);
+  std::vector<std::pair<int, int>> pairs;
+  for (size_t i = 0; i < conflicts.size(); i++) {
+    pairs.push_back(std::make_pair(std::min(conflicts[i].id, conflicts[i].otherID), std::max(conflicts[i].id, conflicts[i].otherID)));
+  }
+  return pairs;
+}
+
+TEST_F(local_event_planner_Test, TestScheduleTreeMatchesBruteForce) {
+  ScheduleTree tree;
+  initScheduleTree(&tree);
+  std::vector<ScheduleInterval> stored;
+  uint64_t seed = 77;
+  for (int i = 1; i <= 3000; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    ScheduleInterval interval;
+    interval.startTime = (int64_t)((seed >> 20) % 100000);
+    interval.endTime = interval.startTime + (int64_t)((seed >> 44) % 400);  // some are empty
+    interval.id = i;
+    ASSERT_EQ(addScheduleInterval(&tree, &interval), 1);
+    stored.push_back(interval);
+    if (i % 4 == 0) {
+      ASSERT_EQ(removeScheduleInterval(&tree, &stored[i / 2]), 1);
+      EXPECT_EQ(removeScheduleInterval(&tree, &stored[i / 2]), 0);
+      stored[i / 2].id = -stored[i / 2].id;  // mark as removed
+    }
+  }
+  EXPECT_EQ(addScheduleInterval(&tree, &stored.back()), 0);
+
+  std::vector<ScheduleInterval> live;
+  for (size_t i = 0; i < stored.size(); i++) {
+    if (stored[i].id > 0) {
+      live.push_back(stored[i]);
+    }
+  }
+  EXPECT_EQ(tree.count, live.size());
+  std::vector<ScheduleInterval> ordered;
+  scheduleIntervals(&tree, &ordered);
+  ASSERT_EQ(ordered.size(), live.size());
+  for (size_t i = 1; i < ordered.size(); i++) {
+    EXPECT_LE(ordered[i - 1].startTime, ordered[i].startTime);
+  }
+
+  for (int q = 0; q < 500; q++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    ScheduleInterval candidate = { (int64_t)((seed >> 20) % 100000), 0, 0 };
+    candidate.endTime = candidate.startTime + (int64_t)((seed >> 44) % 300);
+    std::vector<ScheduleConflict> found;
+    findScheduleOverlaps(&tree, &candidate, &found);
+    std::vector<int> expected, actual;
+    for (size_t i = 0; i < live.size(); i++) {
+      if (live[i].startTime < candidate.endTime && candidate.startTime < live[i].endTime) {
+        expected.push_back(live[i].id);
+      }
+    }
+    for (size_t i = 0; i < found.size(); i++) {
+      actual.push_back(found[i].otherID);
+      EXPECT_LE(found[i].overlapStart, found[i].overlapEnd);
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected);
+    EXPECT_EQ(hasScheduleOverlap(&tree, candidate.startTime, candidate.endTime), expected.empty() ? 0 : 1);
+  }
+
+  // All pairs, both from the tree's order and from an unsorted copy.
+  std::vector<ScheduleConflict> fromTree, fromSort;
+  std::vector<std::pair<int, int>> expectedPairs;
+  for (size_t i = 0; i < live.size(); i++) {
+    for (size_t j = i + 1; j < live.size(); j++) {
+      if (live[i].startTime < live[j].endTime && live[j].startTime < live[i].endTime) {
+        expectedPairs.push_back(std::make_pair(std::min(live[i].id, live[j].id), std::max(live[i].id, live[j].id)));
+      }
+    }
+  }
+  std::sort(expectedPairs.begin(), expectedPairs.end());
+  sweepScheduleConflicts(&ordered, true, &fromTree);
+  sweepScheduleConflicts(&live, false, &fromSort);
+  EXPECT_EQ(conflictPairs(fromTree), expectedPairs);
+  EXPECT_EQ(conflictPairs(fromSort), expectedPairs);
+}
+
+TEST_F(local_event_planner_Test, TestScheduleConflictsFollowRsvpsAndVenues) {
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  Event *event = NULL;
+  ASSERT_EQ(addEvent(&store, 1, 1000, 2000, "standup", "Room A", &event), 1);   // id 1
+  ASSERT_EQ(addEvent(&store, 1, 1500, 2500, "review", "Room A", &event), 1);    // id 2
+  ASSERT_EQ(addEvent(&store, 1, 2500, 3000, "lunch", "Room A", &event), 1);     // id 3, back to back with 2
+  ASSERT_EQ(addEvent(&store, 1, 1200, 1300, "call", "Room B", &event), 1);      // id 4
+  ASSERT_EQ(addEvent(&store, 1, 1200, 1800, "call", "", &event), 1);            // id 5, no venue
+
+  std::vector<ScheduleConflict> conflicts;
+  EXPECT_EQ(findVenueConflicts(&store, 0, 10000, &conflicts), 1u);
+  ASSERT_EQ(conflicts.size(), 1u);
+  EXPECT_EQ(conflicts[0].id, 1);
+  EXPECT_EQ(conflicts[0].otherID, 2);
+  EXPECT_EQ(conflicts[0].overlapStart, 1500);
+  EXPECT_EQ(conflicts[0].overlapEnd, 2000);
+
+  ASSERT_EQ(addAttendee(&store, 1, 9), 1);
+  ASSERT_EQ(addAttendee(&store, 3, 9), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 2000, 2500, NULL), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 1500, 2600, NULL), 1u);
+  conflicts.clear();
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 1500, 2600, &conflicts), 2u);
+  EXPECT_EQ(conflicts[0].otherID, 1);
+  EXPECT_EQ(conflicts[1].otherID, 3);
+  EXPECT_EQ(checkScheduleConflicts(&store, 8, 0, 10000, NULL), 0u);
+
+  ASSERT_EQ(addAttendee(&store, 2, 9), 1);
+  conflicts.clear();
+  EXPECT_EQ(findUserConflicts(&store, 9, 0, 10000, &conflicts), 1u);
+
+  // Moving an event moves it in the attendee's schedule.
+  ASSERT_EQ(updateEventTime(&store, 2, 5000, 6000), 1);
+  conflicts.clear();
+  EXPECT_EQ(findUserConflicts(&store, 9, 0, 10000, &conflicts), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 5500, 5600, NULL), 1u);
+
+  ASSERT_EQ(removeAttendee(&store, 2, 9), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 5500, 5600, NULL), 0u);
+  ASSERT_EQ(deleteEvent(&store, 1), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 1500, 1600, NULL), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, 2600, 2700, NULL), 1u);
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestBatchScriptRunsCommandsWithoutPrompts) {
+  const char *usersFile = "batch_test_users.dat";
+  const char *eventsFile = "batch_test_events.dat";
+  const char *scriptFile = "batch_test_script.txt";
+  char journal[FILENAME_MAX], index[FILENAME_MAX];
+  buildUserJournalPath(journal, sizeof(journal), usersFile);
+  snprintf(index, sizeof(index), "%s.idx", usersFile);
+  remove(usersFile);
+  remove(journal);
+  remove(index);
+
+  FILE *script = fopen(scriptFile, "w");
+  ASSERT_NE(script, nullptr);
+  fputs("# comment lines and blank lines are skipped\n"
+        "\n"
+        "create-event 2025-03-01T10:00 2025-03-01T12:00 early\n"
+        "register alice secret\n"
+        "register alice again1\n"
+        "register bob abc\n"
+        "login alice wrong\n"
+        "login alice secret\n"
+        "create-event 2025-03-01T10:00 2025-03-01T12:00 \"Jazz night\" \"Blue Room\"  # quoted tokens\n"
+        "create-event 1740830400 1740834000 Brunch\n"
+        "rsvp 1\n"
+        "rsvp 1\n"
+        "query 2025-03-01T00:00 2025-03-02T00:00\n"
+        "search jazz\n"
+        "save batch_test_events.dat\n"
+        "logout\n"
+        "rsvp 2\n"
+        "explode now\n",
+        script);
+  fclose(script);
+
+  UserStore users;
+  ASSERT_EQ(openUserStore(&users, usersFile), 1);
+  BatchSession session;
+  ASSERT_EQ(openBatchSession(&session, &users, NULL), 1);
+  script = fopen(scriptFile, "r");
+  ASSERT_NE(script, nullptr);
+  EXPECT_EQ(runBatchScript(&session, script), 16u);
+  fclose(script);
+
+  EXPECT_EQ(session.stats[BATCH_REGISTER].count, 3u);
+  EXPECT_EQ(session.stats[BATCH_REGISTER].failures, 2u);  // taken, too short
+  EXPECT_EQ(session.stats[BATCH_LOGIN].failures, 1u);
+  EXPECT_EQ(session.stats[BATCH_CREATE_EVENT].count, 3u);
+  EXPECT_EQ(session.stats[BATCH_CREATE_EVENT].failures, 1u);  // before login
+  EXPECT_EQ(session.stats[BATCH_RSVP].failures, 2u);          // repeated, after logout
+  EXPECT_EQ(session.unknownCommands, 1u);
+  EXPECT_EQ(session.userID, 0);
+  EXPECT_GT(session.elapsedMicros, 0.0);
+  EXPECT_EQ(countEvents(&session.events), 2u);
+
+  Event *event = NULL;
+  ASSERT_EQ(findEventById(&session.events, 1, &event), 1);
+  EXPECT_STREQ(event->title, "Jazz night");
+  EXPECT_STREQ(event->location, "Blue Room");
+  EXPECT_EQ(event->startTime, 1740823200);
+  User *alice = NULL;
+  ASSERT_EQ(findUserInStore(&users, "alice", &alice), 1);
+  EXPECT_EQ(event->ownerID, alice->id);
+  EXPECT_EQ(isAttending(&session.events, 1, alice->id), 1);
+
+  char report[4096] = "";
+  FILE *output = tmpfile();
+  ASSERT_NE(output, nullptr);
+  printBatchReport(&session, output);
+  rewind(output);
+  size_t length = fread(report, 1, sizeof(report) - 1, output);
+  report[length] = '\0';
+  fclose(output);
+  EXPECT_NE(strstr(report, "create-event"), nullptr);
+  EXPECT_NE(strstr(report, "16 commands in"), nullptr);
+
+  EXPECT_EQ(runBatchCommand(&session, "load batch_test_events.dat"), 1);
+  EXPECT_EQ(countEvents(&session.events), 2u);
+  EXPECT_EQ(runBatchCommand(&session, "   # nothing"), -1);
+
+  closeBatchSession(&session);
+  closeUserStore(&users);
+  remove(usersFile);
+  remove(journal);
+  remove(index);
+  remove(eventsFile);
+  remove(scriptFile);
+}
+
+TEST_F(local_event_planner_Test, TestMenuFrameRedrawsOnlyChangedLines) {
+  const char items[][30] = { "Register", "Login", "Guest Mode", "Exit" };
+  MenuView view;
+  std::string frame;
+  initMenuView(&view);
+
+  EXPECT_EQ(renderMenuFrame(items, 4, 0, 24, 80, &view, &frame), 6u);  // title, 4 items, hint
+  EXPECT_NE(frame.find("\x1b[2J"), std::string::npos);
+  EXPECT_NE(frame.find("\x1b[2;1H> Register\x1b[K"), std::string::npos);
+  EXPECT_NE(frame.find("\x1b[5;1H  Exit\x1b[K"), std::string::npos);
+
+  EXPECT_EQ(renderMenuFrame(items, 4, 1, 24, 80, &view, &frame), 2u);
+  EXPECT_EQ(frame, "\x1b[2;1H  Register\x1b[K\x1b[3;1H> Login\x1b[K");
+  EXPECT_EQ(renderMenuFrame(items, 4, 1, 24, 80, &view, &frame), 0u);
+  EXPECT_TRUE(frame.empty());
+
+  // A resize redraws everything at the new size; a narrow screen never wraps.
+  EXPECT_EQ(renderMenuFrame(items, 4, 1, 24, 5, &view, &frame), 6u);
+  EXPECT_NE(frame.find("\x1b[2J"), std::string::npos);
+  EXPECT_NE(frame.find("\x1b[3;1H> Lo\x1b[K"), std::string::npos);
+}
+
+TEST_F(local_event_planner_Test, TestMenuFrameScrollsLongLists) {
+  char items[100][30];
+  for (int i = 0; i < 100; i++) {
+    snprintf(items[i], sizeof(items[i]), "Event %d", i);
+  }
+  MenuView view;
+  std::string frame;
+  initMenuView(&view);
+
+  // 10 rows leave 7 for items (title above, blank line and hint below).
+  EXPECT_EQ(renderMenuFrame(items, 100, 6, 10, 80, &view, &frame), 9u);
+  EXPECT_EQ(view.visibleRows, 7);
+  EXPECT_EQ(view.top, 0);
+  EXPECT_NE(frame.find("(7/100)"), std::string::npos);
+
+  // One step past the bottom scrolls the item rows by one and draws the new row.
+  EXPECT_EQ(renderMenuFrame(items, 100, 7, 10, 80, &view, &frame), 3u);
+  EXPECT_EQ(view.top, 1);
+  EXPECT_EQ(frame.find("\x1b[2J"), std::string::npos);
+  EXPECT_EQ(frame.find("\x1b[2;8r\x1b[1S\x1b[r"), 0u);
+  EXPECT_NE(frame.find("\x1b[8;1H> Event 7\x1b[K"), std::string::npos);
+  EXPECT_NE(frame.find("\x1b[7;1H  Event 6\x1b[K"), std::string::npos);
+  EXPECT_NE(frame.find("(8/100)"), std::string::npos);
+
+  // A jump of a screenful or more rewrites the item rows but does not clear the screen.
+  EXPECT_EQ(renderMenuFrame(items, 100, 50, 10, 80, &view, &frame), 8u);
+  EXPECT_EQ(view.top, 44);
+  EXPECT_EQ(frame.find("\x1b[2J"), std::string::npos);
+
+  // Moving up inside the window, then past its top, scrolls the other way.
+  EXPECT_EQ(renderMenuFrame(items, 100, 44, 10, 80, &view, &frame), 3u);
+  EXPECT_EQ(renderMenuFrame(items, 100, 42, 10, 80, &view, &frame), 4u);
+  EXPECT_EQ(frame.find("\x1b[2;8r\x1b[2T\x1b[r"), 0u);
+  EXPECT_NE(frame.find("\x1b[2;1H> Event 42\x1b[K"), std::string::npos);
+  EXPECT_NE(frame.find("\x1b[4;1H  Event 44\x1b[K"), std::string::npos);
+}
+
+TEST_F(local_event_planner_Test, TestHotPathStatsCountTableFileAndLoginActivity) {
+  const char *usersFile = "hot_path_test_users.dat";
+  char journal[FILENAME_MAX];
+  buildUserJournalPath(journal, sizeof(journal), usersFile);
+  remove(usersFile);
+  remove(journal);
+  resetHotPathStats();
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTableWithCapacity(&ht, 64, 0.5f), 1);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, ("hot" + std::to_string(i)).c_str(), "pw"), 1);
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(findUserBrent(&ht, ("hot" + std::to_string(i)).c_str(), NULL), 1);
+  }
+  for (int i = 0; i < 20; i++) {
+    EXPECT_EQ(findUserBrent(&ht, ("cold" + std::to_string(i)).c_str(), NULL), 0);
+  }
+  EXPECT_EQ(deleteUserBrent(&ht, "hot0"), 1);
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+
+  HashTable loaded;
+  ASSERT_EQ(initBrentHashTable(&loaded), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&loaded, usersFile), 1);
+  EXPECT_EQ(loaded.count, 99u);
+  destroyBrentHashTable(&loaded);
+
+  // Counters of a finished thread are kept
+  std::thread worker([&ht]() {
+    for (int i = 1; i < 11; i++) {
+      findUserBrent(&ht, ("hot" + std::to_string(i)).c_str(), NULL);
+    }
+  });
+  worker.join();
+
+  UserStore store;
+  ASSERT_EQ(openUserStore(&store, usersFile), 1);
+  User *user = NULL;
+  EXPECT_EQ(authenticateUserInStore(&store, "hot5", "pw", &user), 1);
+  ASSERT_NE(user, nullptr);
+  EXPECT_EQ(user->id, 6);
+  EXPECT_EQ(authenticateUserInStore(&store, "hot5", "wrong", &user), 0);
+  EXPECT_EQ(user, nullptr);
+  EXPECT_EQ(authenticateUserInStore(&store, "nobody", "pw", NULL), 0);
+
+  HotPathStats stats;
+  snapshotHotPathStats(&stats);
+#if defined(ENABLE_HOT_PATH_STATS)
+  long fileBytes = 0;
+  FILE *file = fopen(usersFile, "rb");
+  ASSERT_NE(file, nullptr);
+  fseek(file, 0, SEEK_END);
+  fileBytes = ftell(file);
+  fclose(file);
+
+  EXPECT_TRUE(stats.enabled);
+  EXPECT_EQ(stats.counters[HOT_PATH_LOOKUPS], 100u + 20u + 10u + 3u);
+  EXPECT_EQ(stats.counters[HOT_PATH_LOOKUP_HITS], 100u + 10u + 2u);
+  EXPECT_GE(stats.counters[HOT_PATH_LOOKUP_PROBES], stats.counters[HOT_PATH_LOOKUPS]);
+  EXPECT_EQ(hotPathHistogramCount(&stats, HOT_PATH_PROBE_LENGTH), stats.counters[HOT_PATH_LOOKUPS]);
+  EXPECT_EQ(stats.sums[HOT_PATH_PROBE_LENGTH], stats.counters[HOT_PATH_LOOKUP_PROBES]);
+  EXPECT_GE(stats.counters[HOT_PATH_INSERTS], 100u + 99u + 99u);  // inserts, two bulk loads
+  EXPECT_GT(stats.counters[HOT_PATH_INSERT_COLLISIONS], 0u);
+  EXPECT_GE(stats.counters[HOT_PATH_RESIZES], 2u);                // 64 -> 128 -> 256 at load 0.5
+  EXPECT_EQ(stats.counters[HOT_PATH_DELETES], 1u);
+  EXPECT_EQ(stats.counters[HOT_PATH_FILE_SAVES], 1u);
+  EXPECT_EQ(stats.counters[HOT_PATH_FILE_LOADS], 2u);
+  EXPECT_EQ(stats.counters[HOT_PATH_BYTES_WRITTEN], (uint64_t)fileBytes);
+  EXPECT_EQ(stats.counters[HOT_PATH_BYTES_READ], 2u * (uint64_t)fileBytes);
+  EXPECT_EQ(stats.counters[HOT_PATH_LOGINS], 1u);
+  EXPECT_EQ(stats.counters[HOT_PATH_LOGIN_FAILURES], 2u);
+  EXPECT_EQ(hotPathHistogramCount(&stats, HOT_PATH_LOGIN_NANOS), 3u);
+  EXPECT_EQ(hotPathHistogramCount(&stats, HOT_PATH_SAVE_NANOS), 1u);
+  EXPECT_GE(hotPathHistogramPercentile(&stats, HOT_PATH_PROBE_LENGTH, 0.99), 1u);
+#else
+  EXPECT_FALSE(stats.enabled);
+  EXPECT_EQ(stats.counters[HOT_PATH_LOOKUPS], 0u);
+#endif
+
+  FILE *json = tmpfile();
+  ASSERT_NE(json, nullptr);
+  ASSERT_EQ(writeHotPathStatsJson(json, &stats, &store.table), 1);
+  rewind(json);
+  char text[4096] = { 0 };
+  size_t length = fread(text, 1, sizeof(text) - 1, json);
+  fclose(json);
+  ASSERT_GT(length, 0u);
+  EXPECT_EQ(text[0], '{');
+  EXPECT_EQ(text[length - 2], '}');
+  EXPECT_NE(strstr(text, "\"counters\":{\"lookups\":"), nullptr);
+  EXPECT_NE(strstr(text, "\"probe_length\":{\"count\":"), nullptr);
+  EXPECT_NE(strstr(text, "\"table\":{\"capacity\":"), nullptr);
+  EXPECT_NE(strstr(text, "\"load_factor\":"), nullptr);
+
+  closeUserStore(&store);
+  destroyBrentHashTable(&ht);
+  remove(usersFile);
+  remove(journal);
+}
+
+TEST_F(local_event_planner_Test, TestHotPathHistogramUsesLogBuckets) {
+  EXPECT_EQ(hotPathBucket(0), 0u);
+  EXPECT_EQ(hotPathBucket(1), 1u);
+  EXPECT_EQ(hotPathBucket(2), 2u);
+  EXPECT_EQ(hotPathBucket(3), 2u);
+  EXPECT_EQ(hotPathBucket(4), 3u);
+  EXPECT_EQ(hotPathBucket(1023), 10u);
+  EXPECT_EQ(hotPathBucket(1024), 11u);
+  EXPECT_EQ(hotPathBucket(UINT64_MAX), (unsigned int)HOT_PATH_HISTOGRAM_BUCKETS - 1);
+
+  HotPathStats stats;
+  memset(&stats, 0, sizeof(stats));
+  for (uint64_t value = 1; value <= 100; value++) {
+    stats.buckets[HOT_PATH_LOGIN_NANOS][hotPathBucket(value)]++;
+  }
+  EXPECT_EQ(hotPathHistogramCount(&stats, HOT_PATH_LOGIN_NANOS), 100u);
+  EXPECT_EQ(hotPathHistogramPercentile(&stats, HOT_PATH_LOGIN_NANOS, 0.5), 63u);    // 50 lies in [32, 63]
+  EXPECT_EQ(hotPathHistogramPercentile(&stats, HOT_PATH_LOGIN_NANOS, 0.99), 127u);  // 99 lies in [64, 127]
+  EXPECT_EQ(hotPathHistogramPercentile(&stats, HOT_PATH_SAVE_NANOS, 0.5), 0u);
+  EXPECT_STREQ(hotPathCounterName(HOT_PATH_BYTES_READ), "bytes_read");
+  EXPECT_STREQ(hotPathHistogramName(HOT_PATH_LOGIN_NANOS), "login_ns");
+}
+
+TEST_F(local_event_planner_Test, TestScheduleConflictsExpandRecurringEvents) {
+  const char *eventsFile = "local_event_planner_test_events.dat";
+  std::remove(eventsFile);
+  const int64_t day = 86400, monday = dateTimeToEpochSeconds(makeDateTime(makeDate(2025, 3, 3), 9, 0, 0));
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  Event *event = NULL;
+  ASSERT_EQ(addEvent(&store, 1, monday, monday + 3600, "Standup", "Room A", &event), 1);
+  int standupID = event->id;
+  ASSERT_EQ(addEvent(&store, 1, monday + 14 * day + 1800, monday + 14 * day + 5400, "Review", "Room B", &event), 1);
+  int reviewID = event->id;
+  ASSERT_EQ(addAttendee(&store, standupID, 9), 1);
+  ASSERT_EQ(addAttendee(&store, reviewID, 9), 1);
+
+  // One-off: only the first Monday is taken.
+  std::vector<ScheduleConflict> conflicts;
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 7 * day, monday + 7 * day + 600, NULL), 0u);
+  EXPECT_EQ(findUserConflicts(&store, 9, monday, monday + 28 * day, &conflicts), 0u);
+
+  // Weekly: every Monday clashes, including the one with the review.
+  RecurrenceRule weekly = { RECURRENCE_WEEKLY, 1, 0, RECURRENCE_NO_END };
+  ASSERT_EQ(setEventRecurrence(&store, standupID, &weekly), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 7 * day, monday + 7 * day + 600, NULL), 1u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 7 * day + 3600, monday + 7 * day + 7200, NULL), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 70 * day - 600, monday + 70 * day + 1, &conflicts), 1u);
+  ASSERT_EQ(conflicts.size(), 1u);
+  EXPECT_EQ(conflicts[0].id, 0);
+  EXPECT_EQ(conflicts[0].otherID, standupID);
+  EXPECT_EQ(conflicts[0].overlapStart, monday + 70 * day);
+  EXPECT_EQ(conflicts[0].overlapEnd, monday + 70 * day + 1);
+
+  // A slot spanning two Mondays and the review lists all three, by overlap start.
+  conflicts.clear();
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 7 * day, monday + 14 * day + 3600, &conflicts), 3u);
+  ASSERT_EQ(conflicts.size(), 3u);
+  EXPECT_EQ(conflicts[0].otherID, standupID);
+  EXPECT_EQ(conflicts[1].otherID, standupID);
+  EXPECT_EQ(conflicts[1].overlapStart, monday + 14 * day);
+  EXPECT_EQ(conflicts[2].otherID, reviewID);
+
+  conflicts.clear();
+  EXPECT_EQ(findUserConflicts(&store, 9, monday, monday + 28 * day, &conflicts), 1u);
+  ASSERT_EQ(conflicts.size(), 1u);
+  EXPECT_EQ(conflicts[0].id, standupID);
+  EXPECT_EQ(conflicts[0].otherID, reviewID);
+  EXPECT_EQ(conflicts[0].overlapStart, monday + 14 * day + 1800);
+  EXPECT_EQ(conflicts[0].overlapEnd, monday + 14 * day + 3600);
+
+  // Cancelled occurrences do not clash.
+  ASSERT_EQ(addRecurrenceException(&store, standupID, monday + 14 * day), 1);
+  conflicts.clear();
+  EXPECT_EQ(findUserConflicts(&store, 9, monday, monday + 28 * day, &conflicts), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 14 * day, monday + 14 * day + 600, NULL), 0u);
+
+  // The series survives a reload and is dropped with the RSVP.
+  ASSERT_EQ(saveEventsToBinaryFile(&store, eventsFile), 1);
+  destroyEventStore(&store);
+  ASSERT_EQ(initEventStore(&store), 1);
+  ASSERT_EQ(loadEventsFromBinaryFile(&store, eventsFile), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 21 * day, monday + 21 * day + 600, NULL), 1u);
+  ASSERT_EQ(removeAttendee(&store, standupID, 9), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 21 * day, monday + 21 * day + 600, NULL), 0u);
+
+  // Back to one-off: the first Monday is a slot in the tree again.
+  ASSERT_EQ(addAttendee(&store, standupID, 9), 1);
+  ASSERT_EQ(setEventRecurrence(&store, standupID, NULL), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday + 21 * day, monday + 21 * day + 600, NULL), 0u);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday, monday + 600, NULL), 1u);
+  ASSERT_EQ(deleteEvent(&store, standupID), 1);
+  EXPECT_EQ(checkScheduleConflicts(&store, 9, monday, monday + 600, NULL), 0u);
+  destroyEventStore(&store);
+  std::remove(eventsFile);
+}
+
+TEST_F(local_event_planner_Test, TestOccurrenceQueriesSkipSeriesOutsideTheWindow) {
+  const int64_t day = 86400, start = dateTimeToEpochSeconds(makeDateTime(makeDate(2020, 1, 6), 18, 0, 0));
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+
+  // Ten-week courses starting one week apart over four years, plus one open-ended series.
+  std::vector<int> ids;
+  for (int i = 0; i < 200; i++) {
+    Event *event = NULL;
+    int64_t first = start + i * 7 * day;
+    ASSERT_EQ(addEvent(&store, 1, first, first + 3600, "Course", "Hall", &event), 1);
+    RecurrenceRule rule = { RECURRENCE_WEEKLY, 1, i % 2 == 0 ? 10 : 0, i % 2 == 0 ? RECURRENCE_NO_END : first + 63 * day };
+    ASSERT_EQ(setEventRecurrence(&store, event->id, &rule), 1);
+    ids.push_back(event->id);
+  }
+  Event *open = NULL;
+  ASSERT_EQ(addEvent(&store, 2, start + 3 * 3600, start + 4 * 3600, "Club", "Bar", &open), 1);
+  RecurrenceRule monthly = { RECURRENCE_MONTHLY, 1, 0, RECURRENCE_NO_END };
+  ASSERT_EQ(setEventRecurrence(&store, open->id, &monthly), 1);
+  EXPECT_EQ(store.seriesSpans.count, 201u);
+
+  // Moving, replacing and clearing rules keeps the spans in step with the series.
+  ASSERT_EQ(updateEventTime(&store, ids[10], start + 300 * day, start + 300 * day + 3600), 1);
+  RecurrenceRule daily = { RECURRENCE_DAILY, 1, 5, RECURRENCE_NO_END };
+  ASSERT_EQ(setEventRecurrence(&store, ids[20], &daily), 1);
+  ASSERT_EQ(setEventRecurrence(&store, ids[30], NULL), 1);
+  ASSERT_EQ(deleteEvent(&store, ids[40]), 1);
+  EXPECT_EQ(store.seriesSpans.count, 199u);
+
+  for (int64_t from = start - 30 * day; from < start + 1500 * day; from += 37 * day) {
+    int64_t to = from + 45 * day;
+    std::vector<EventOccurrence> found;
+    findOccurrencesInRange(&store, from, to, &found);
+
+    std::vector<std::pair<int64_t, int> > expected;
+    for (unsigned int i = 0; i < store.events.size(); i++) {
+      const Event *event = store.events.at(i);
+      OccurrenceIterator it;
+      for (int more = beginOccurrences(&it, findEventRecurrence(&store, event->id), event->startTime, from, to); more; more = advanceOccurrence(&it)) {
+        expected.push_back(std::make_pair(it.startTime, event->id));
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    ASSERT_EQ(found.size(), expected.size()) << "window starting " << from;
+    for (size_t i = 0; i < found.size(); i++) {
+      EXPECT_EQ(found[i].startTime, expected[i].first);
+      EXPECT_EQ(found[i].event->id, expected[i].second);
+    }
+  }
+  destroyEventStore(&store);
+}
+
+TEST_F(local_event_planner_Test, TestTruncatedEventsFileFailsToLoad) {
+  const char *eventsFile = "local_event_planner_test_events.dat";
+  std::remove(eventsFile);
+  EventStore store;
+  ASSERT_EQ(initEventStore(&store), 1);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(addEvent(&store, 1, 1000 * i, 1000 * i + 500, "talk", "hall", NULL), 1);
+  }
+  ASSERT_EQ(saveEventsToBinaryFile(&store, eventsFile), 1);
+  destroyEventStore(&store);
+
+  // Keep the header and all but the last record.
+  std::vector<char> bytes;
+  FILE *file = fopen(eventsFile, "rb");
+  ASSERT_NE(file, nullptr);
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + read);
+  }
+  fclose(file);
+  ASSERT_GE(bytes.size(), sizeof(RecordFileHeader) + 10 * sizeof(Event));
+  file = fopen(eventsFile, "wb");
+  ASSERT_NE(file, nullptr);
+  fwrite(bytes.data(), 1, sizeof(RecordFileHeader) + 9 * sizeof(Event), file);
+  fclose(file);
+
+  ASSERT_EQ(initEventStore(&store), 1);
+  EXPECT_EQ(loadEventsFromBinaryFile(&store, eventsFile), 0);
+  destroyEventStore(&store);
+  std::remove(eventsFile);
+}
+
+TEST_F(local_event_planner_Test, TestTruncatedUsersFileFailsToLoad) {
+  const char *usersFile = "local_event_planner_test_users.dat";
+  std::vector<User> users(5);
+  for (int i = 0; i < 5; i++) {
+    memset(&users[i], 0, sizeof(User));
+    users[i].id = i + 1;
+    snprintf(users[i].username, sizeof(users[i].username), "fixed%d", i);
+    snprintf(users[i].password, sizeof(users[i].password), "pw%d", i);
+  }
+
+  // A fixed-width file whose header counts one record more than it holds.
+  RecordFileHeader header;
+  initRecordFileHeader(&header, RECORD_FILE_VERSION, sizeof(User), 5, 6);
+  FILE *file = fopen(usersFile, "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(writeRecordFileHeader(file, &header), 1);
+  fwrite(users.data(), sizeof(User), 4, file);
+  fclose(file);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 0);
+  destroyBrentHashTable(&ht);
+
+  // Complete file, but the inserts fail.
+  file = fopen(usersFile, "ab");
+  ASSERT_NE(file, nullptr);
+  fwrite(&users[4], sizeof(User), 1, file);
+  fclose(file);
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  forceFailure = true;
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 0);
+  forceFailure = false;
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 5u);
+  destroyBrentHashTable(&ht);
+  std::remove(usersFile);
+}
+
+#if !defined(_WIN32)
+TEST_F(local_event_planner_Test, TestTerminalSessionRestoredWhenKilled) {
+  int output[2];
+  ASSERT_EQ(pipe(output), 0);
+  fflush(stdout);
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    dup2(output[1], STDOUT_FILENO);
+    close(output[0]);
+    TerminalSession terminal;
+    beginTerminalSession(&terminal);
+    raise(SIGTERM);
+    _exit(0);  // not reached: SIGTERM keeps its default action
+  }
+  close(output[1]);
+  std::string written;
+  char buffer[64];
+  ssize_t got;
+  while ((got = read(output[0], buffer, sizeof(buffer))) > 0) {
+    written.append(buffer, (size_t)got);
+  }
+  close(output[0]);
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  EXPECT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGTERM);
+  EXPECT_EQ(written, std::string("\x1b[?25l\x1b[?25h"));
+}
+
+TEST_F(local_event_planner_Test, TestTerminalSessionPutsBackSignalActions) {
+  struct sigaction before, during, after;
+  sigaction(SIGINT, NULL, &before);
+  TerminalSession terminal;
+  beginTerminalSession(&terminal);
+  sigaction(SIGINT, NULL, &during);
+  endTerminalSession(&terminal);
+  sigaction(SIGINT, NULL, &after);
+  EXPECT_NE(during.sa_handler, before.sa_handler);
+  EXPECT_EQ(after.sa_handler, before.sa_handler);
+}
+#endif
+
+
 /**
  * @brief The main function of the test program.
  *
@@ -0,0 +1,744 @@
+//#define ENABLE_UTILITY_TEST  // Uncomment this line to enable the Utility tests
+
+#include "gtest/gtest.h"
+#include "../../utility/header/file_utility.h"
+#include "../../utility/header/compact_user_file.h"
+#include "../../utility/header/user_index.h"
+#include "../../utility/header/user_journal.h"
+#include "../../utility/header/date_time.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+class FileUtilityTest : public ::testing::Test {
+ protected:
+  const char *usersFile = "utility_test_users.dat";
+  const char *journalFile = "utility_test_users.dat.journal";
+  const char *indexFile = "utility_test_users.dat.idx";
+
+  void SetUp() override {
+    std::remove(usersFile);
+    std::remove(journalFile);
+    std::remove(indexFile);
+    currentID = 1;
+  }
+
+  void TearDown() override {
+    std::remove(usersFile);
+    std::remove(journalFile);
+    std::remove(indexFile);
+  }
+
+  static User makeUser(int id, const char *username, const char *password) {
+    User user;
+    memset(&user, 0, sizeof(user));
+    user.id = id;
+    snprintf(user.username, sizeof(user.username), "%s", username);
+    snprintf(user.password, sizeof(user.password), "%s", password);
+    return user;
+  }
+
+  // Writes bare records with no RecordFileHeader, as older builds did.
+  void writeHeaderlessUsers(const User *users, size_t count) {
+    FILE *file = fopen(usersFile, "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(users, sizeof(User), count, file);
+    fclose(file);
+  }
+
+  static long fileSize(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+      return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+  }
+
+  // Writes `count` users named <prefix><i> through saveUsersToBinaryFile.
+  void writeUsers(const char *prefix, int count) {
+    HashTable ht;
+    ASSERT_EQ(initBrentHashTable(&ht), 1);
+    char name[50];
+
+    for (int i = 0; i < count; i++) {
+      snprintf(name, sizeof(name), "%s%d", prefix, i);
+      ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+    }
+
+    ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+    destroyBrentHashTable(&ht);
+  }
+};
+
+TEST_F(FileUtilityTest, TestUserFileViewFindsSavedUsers) {
+  writeUsers("viewer", 100);
+  UserFileView view;
+  ASSERT_EQ(openUserFileView(&view, usersFile), 1);
+  EXPECT_EQ(view.count, 100u);
+  User user;
+  ASSERT_EQ(findUserInFileView(&view, "viewer42", &user), 1);
+  EXPECT_EQ(user.id, 43);
+  EXPECT_STREQ(user.password, "secret");
+  EXPECT_EQ(findUserInFileView(&view, "viewer4", NULL), 1);
+  EXPECT_EQ(findUserInFileView(&view, "viewer", &user), 0);
+  closeUserFileView(&view);
+  closeUserFileView(&view);
+  EXPECT_EQ(view.records, nullptr);
+  EXPECT_EQ(view.blockOffsets, nullptr);
+}
+
+TEST_F(FileUtilityTest, TestUserFileViewMissingFileIsEmpty) {
+  UserFileView view;
+  ASSERT_EQ(openUserFileView(&view, usersFile), 1);
+  EXPECT_EQ(view.count, 0u);
+  EXPECT_EQ(findUserInFileView(&view, "anyone", NULL), 0);
+  closeUserFileView(&view);
+}
+
+TEST_F(FileUtilityTest, TestCrc32MatchesReferenceValue) {
+  EXPECT_EQ(computeCrc32("123456789", 9), 0xCBF43926u);
+  EXPECT_EQ(computeCrc32("", 0), 0u);
+}
+
+TEST_F(FileUtilityTest, TestReplaceFileAtomicallySyncsOrKeepsTarget) {
+  const char *tempFile = "utility_test_users.dat.tmp";
+  writeUsers("keep", 2);
+  long size = fileSize(usersFile);
+  EXPECT_EQ(replaceFileAtomically(tempFile, usersFile), 0);  // nothing to sync: target untouched
+  EXPECT_EQ(fileSize(usersFile), size);
+
+  FILE *file = fopen(tempFile, "wb");
+  ASSERT_NE(file, nullptr);
+  fputs("new contents", file);
+  fclose(file);
+  EXPECT_EQ(replaceFileAtomically(tempFile, usersFile), 1);
+  EXPECT_EQ(fileSize(usersFile), 12);
+  EXPECT_EQ(fileSize(tempFile), -1);
+  EXPECT_EQ(syncParentDirectory(usersFile), 1);
+  EXPECT_EQ(syncParentDirectory("./utility_test_users.dat"), 1);
+}
+
+TEST_F(FileUtilityTest, TestJournalReplayRestoresRegistrations) {
+  writeUsers("snap", 3);
+  char path[FILENAME_MAX];
+  ASSERT_EQ(buildUserJournalPath(path, sizeof(path), usersFile), 1);
+  EXPECT_STREQ(path, journalFile);
+  User erin = makeUser(10, "erin", "pass1");
+  User frank = makeUser(11, "frank", "pass2");
+  ASSERT_EQ(appendUserToJournal(journalFile, &erin), 1);
+  ASSERT_EQ(appendUserToJournal(journalFile, &frank), 1);
+  EXPECT_EQ(countUserJournalRecords(journalFile), 2);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 5u);
+  EXPECT_EQ(currentID, 12);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "frank", &user), 1);
+  EXPECT_STREQ(user->password, "pass2");
+  User copy;
+  ASSERT_EQ(findUserInJournal(journalFile, "erin", &copy), 1);
+  EXPECT_EQ(copy.id, 10);
+  EXPECT_EQ(findUserInJournal(journalFile, "snap0", &copy), 0);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestJournalReplayStopsAtTornRecord) {
+  User good = makeUser(1, "good", "pass");
+  User bad = makeUser(2, "bad", "pass");
+  ASSERT_EQ(appendUserToJournal(journalFile, &good), 1);
+  ASSERT_EQ(appendUserToJournal(journalFile, &bad), 1);
+  // Simulate a crash that flipped a byte in the second record and left half a third record.
+  FILE *file = fopen(journalFile, "r+b");
+  ASSERT_NE(file, nullptr);
+  fseek(file, (long)sizeof(UserJournalRecord) + 10, SEEK_SET);
+  fputc('X', file);
+  fseek(file, 0, SEEK_END);
+  fwrite(&good, sizeof(User) / 2, 1, file);
+  fclose(file);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  long validLength = -1;
+  EXPECT_EQ(replayUserJournal(&ht, journalFile, &validLength), 1);
+  EXPECT_EQ(validLength, (long)sizeof(UserJournalRecord));
+  EXPECT_EQ(findUserBrent(&ht, "good", NULL), 1);
+  EXPECT_EQ(findUserBrent(&ht, "bad", NULL), 0);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestTornJournalTailIsTruncatedBeforeAppending) {
+  User first = makeUser(1, "first", "pass");
+  ASSERT_EQ(appendUserToJournal(journalFile, &first), 1);
+  // Half a record, as a crash during the next append would leave.
+  FILE *file = fopen(journalFile, "ab");
+  ASSERT_NE(file, nullptr);
+  fwrite(&first, sizeof(User) / 2, 1, file);
+  fclose(file);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(fileSize(journalFile), (long)sizeof(UserJournalRecord));
+  ASSERT_EQ(insertUserBrent(&ht, allocateUserID(), "second", "pass"), 1);
+  ASSERT_EQ(commitUserRegistration(&ht, getUserAtBrent(&ht, ht.count - 1), usersFile), 1);
+  destroyBrentHashTable(&ht);
+
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  EXPECT_EQ(findUserBrent(&ht, "second", NULL), 1);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestRegistrationCompactsAtThreshold) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  char name[50];
+
+  for (int i = 0; i < USER_JOURNAL_COMPACT_THRESHOLD; i++) {
+    snprintf(name, sizeof(name), "member%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, i + 1, name, "secret"), 1);
+    ASSERT_EQ(commitUserRegistration(&ht, getUserAtBrent(&ht, ht.count - 1), usersFile), 1);
+
+    if (i + 1 < USER_JOURNAL_COMPACT_THRESHOLD) {
+      ASSERT_EQ(countUserJournalRecords(journalFile), i + 1);
+    }
+  }
+
+  EXPECT_EQ(countUserJournalRecords(journalFile), 0);
+  destroyBrentHashTable(&ht);
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, (unsigned int)USER_JOURNAL_COMPACT_THRESHOLD);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestReplayAfterInterruptedCompactionSkipsDuplicates) {
+  writeUsers("dup", 2);
+  User again = makeUser(1, "dup0", "secret");
+  ASSERT_EQ(appendUserToJournal(journalFile, &again), 1);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestUserIndexIsBuiltOnFirstOpen) {
+  writeUsers("indexed", 1000);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 0);
+  UserIndexView view;
+  ASSERT_EQ(openUserIndex(&view, usersFile), 1);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 1);
+  EXPECT_EQ(view.header->count, 1000u);
+  EXPECT_EQ(view.header->version, USER_INDEX_VERSION);
+  EXPECT_EQ(view.header->capacity & (view.header->capacity - 1), 0u);
+  User user;
+  ASSERT_EQ(findUserInIndex(&view, "indexed777", &user), 1);
+  EXPECT_EQ(user.id, 778);
+  EXPECT_EQ(findUserInIndex(&view, "indexed1000", &user), 0);
+  closeUserIndex(&view);
+  closeUserIndex(&view);
+}
+
+TEST_F(FileUtilityTest, TestUserIndexRebuildsWhenStale) {
+  writeUsers("first", 10);
+  ASSERT_EQ(writeUserIndex(usersFile), 1);
+  ASSERT_EQ(isUserIndexCurrent(usersFile), 1);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 99, "latecomer", "pass"), 1);
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+  destroyBrentHashTable(&ht);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 0);
+  UserIndexView view;
+  ASSERT_EQ(openUserIndex(&view, usersFile), 1);
+  EXPECT_EQ(findUserInIndex(&view, "latecomer", NULL), 1);
+  EXPECT_EQ(view.header->count, 11u);
+  closeUserIndex(&view);
+}
+
+TEST_F(FileUtilityTest, TestUserIndexRebuildsOnVersionMismatch) {
+  writeUsers("versioned", 5);
+  ASSERT_EQ(writeUserIndex(usersFile), 1);
+  FILE *file = fopen(indexFile, "r+b");
+  ASSERT_NE(file, nullptr);
+  uint32_t oldVersion = USER_INDEX_VERSION + 1;
+  fseek(file, offsetof(UserIndexHeader, version), SEEK_SET);
+  fwrite(&oldVersion, sizeof(oldVersion), 1, file);
+  fclose(file);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 0);
+  UserIndexView view;
+  ASSERT_EQ(openUserIndex(&view, usersFile), 1);
+  EXPECT_EQ(view.header->version, USER_INDEX_VERSION);
+  EXPECT_EQ(findUserInIndex(&view, "versioned3", NULL), 1);
+  closeUserIndex(&view);
+}
+
+TEST_F(FileUtilityTest, TestUserIndexKeepsFirstDuplicate) {
+  User first = makeUser(1, "twin", "first");
+  User second = makeUser(2, "twin", "second");
+  FILE *file = fopen(usersFile, "wb");
+  ASSERT_NE(file, nullptr);
+  fwrite(&first, sizeof(first), 1, file);
+  fwrite(&second, sizeof(second), 1, file);
+  fclose(file);
+  UserIndexView view;
+  ASSERT_EQ(openUserIndex(&view, usersFile), 1);
+  User user;
+  ASSERT_EQ(findUserInIndex(&view, "twin", &user), 1);
+  EXPECT_STREQ(user.password, "first");
+  EXPECT_EQ(view.header->count, 1u);
+  closeUserIndex(&view);
+}
+
+TEST_F(FileUtilityTest, TestCompactionWritesCurrentIndex) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 1, "gina", "pass"), 1);
+  ASSERT_EQ(compactUserJournal(&ht, usersFile), 1);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 1);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestBulkLoadKeepsFirstDuplicateAndMaxID) {
+  User records[3] = { makeUser(5, "hank", "first"), makeUser(9, "ivy", "pass"), makeUser(7, "hank", "second") };
+  FILE *file = fopen(usersFile, "wb");
+  ASSERT_NE(file, nullptr);
+  fwrite(records, sizeof(User), 3, file);
+  fclose(file);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  EXPECT_EQ(currentID, 10);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "hank", &user), 1);
+  EXPECT_STREQ(user->password, "first");
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestLoadNeverRewindsCurrentID) {
+  writeUsers("rewind", 3);
+  currentID = 50;
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(currentID, 50);
+  destroyBrentHashTable(&ht);
+
+  User records[2] = { makeUser(7, "old1", "a"), makeUser(9, "old2", "b") };
+  writeHeaderlessUsers(records, 2);
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(currentID, 50);
+  destroyBrentHashTable(&ht);
+
+  std::remove(usersFile);
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(currentID, 50);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestSavedFileCarriesRecordHeader) {
+  writeUsers("header", 5);
+
+  FILE *file = fopen(usersFile, "rb");
+  ASSERT_NE(file, nullptr);
+  RecordFileHeader header;
+  EXPECT_EQ(readRecordFileHeader(file, sizeof(User), &header), RECORD_FILE_CURRENT);
+  EXPECT_EQ(header.version, RECORD_FILE_COMPACT_VERSION);
+  EXPECT_EQ(header.recordCount, 5u);
+  EXPECT_EQ(header.nextID, 6);
+  EXPECT_EQ(readRecordFileHeader(file, sizeof(User) + 1, &header), RECORD_FILE_CORRUPT);
+  fclose(file);
+
+  EXPECT_EQ(getNextID(usersFile, sizeof(User)), 6);
+  UserFileView view;
+  ASSERT_EQ(openUserFileView(&view, usersFile), 1);
+  EXPECT_EQ(view.count, 5u);
+  User user;
+  ASSERT_EQ(readUserFromFileView(&view, 0, &user), 1);
+  EXPECT_STREQ(user.username, "header0");
+  EXPECT_EQ(readUserFromFileView(&view, 5, &user), 0);
+  closeUserFileView(&view);
+}
+
+TEST_F(FileUtilityTest, TestSaveKeepsAllocatedIDsInHeader) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 3, "jane", "pass"), 1);
+  currentID = 20;
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+  destroyBrentHashTable(&ht);
+  EXPECT_EQ(getNextID(usersFile, sizeof(User)), 20);
+}
+
+TEST_F(FileUtilityTest, TestGetNextIDReadsHeaderlessFileWithoutRewritingIt) {
+  User records[3] = { makeUser(4, "kate", "a"), makeUser(9, "liam", "b"), makeUser(2, "mia", "c") };
+  writeHeaderlessUsers(records, 3);
+
+  EXPECT_EQ(getNextID(usersFile, sizeof(User)), 10);
+  EXPECT_EQ(fileSize(usersFile), (long)(3 * sizeof(User)));
+  EXPECT_EQ(migrateRecordFile(usersFile, sizeof(User)), 1);
+  EXPECT_EQ(fileSize(usersFile), (long)(sizeof(RecordFileHeader) + 3 * sizeof(User)));
+  EXPECT_EQ(getNextID(usersFile, sizeof(User)), 10);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 3u);
+  EXPECT_EQ(getUserAtBrent(&ht, 0)->id, 4);
+  EXPECT_EQ(currentID, 10);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestLoadUserDatabaseMigratesSnapshot) {
+  User records[2] = { makeUser(1, "nina", "a"), makeUser(2, "omar", "b") };
+  writeHeaderlessUsers(records, 2);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  destroyBrentHashTable(&ht);
+
+  FILE *file = fopen(usersFile, "rb");
+  ASSERT_NE(file, nullptr);
+  RecordFileHeader header;
+  EXPECT_EQ(readRecordFileHeader(file, sizeof(User), &header), RECORD_FILE_CURRENT);
+  fclose(file);
+}
+
+TEST_F(FileUtilityTest, TestDamagedRecordHeaderIsRejected) {
+  User records[4] = { makeUser(1, "d0", "a"), makeUser(2, "d1", "b"), makeUser(4, "d2", "c"), makeUser(3, "d3", "d") };
+  writeHeaderlessUsers(records, 4);
+  ASSERT_EQ(migrateRecordFile(usersFile, sizeof(User)), 1);
+  FILE *file = fopen(usersFile, "r+b");
+  ASSERT_NE(file, nullptr);
+  fseek(file, (long)offsetof(RecordFileHeader, recordCount), SEEK_SET);
+  fputc(0x7f, file);
+  fclose(file);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 0);
+  EXPECT_EQ(ht.count, 0u);
+  destroyBrentHashTable(&ht);
+  UserFileView view;
+  EXPECT_EQ(openUserFileView(&view, usersFile), 0);
+  EXPECT_EQ(migrateRecordFile(usersFile, sizeof(User)), 0);
+  EXPECT_EQ(getNextID(usersFile, sizeof(User)), 0);
+}
+
+TEST_F(FileUtilityTest, TestCompactFileRoundTripsEdgeValues) {
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  std::string longest(49, 'x');
+  ASSERT_EQ(insertUserBrent(&ht, 7, longest.c_str(), longest.c_str()), 1);
+  ASSERT_EQ(insertUserBrent(&ht, 8, "nopassword", ""), 1);
+  char name[50];
+  for (int i = 0; i < 2 * (int)COMPACT_USER_BLOCK_RECORDS + 3; i++) {
+    snprintf(name, sizeof(name), "block_user_%d", i);
+    ASSERT_EQ(insertUserBrent(&ht, 100 + i, name, "pw"), 1);
+  }
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+
+  HashTable loaded;
+  ASSERT_EQ(initBrentHashTable(&loaded), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&loaded, usersFile), 1);
+  ASSERT_EQ(loaded.count, ht.count);
+  for (unsigned int i = 0; i < ht.count; i++) {
+    EXPECT_EQ(memcmp(getUserAtBrent(&ht, i), getUserAtBrent(&loaded, i), sizeof(User)), 0);
+  }
+  destroyBrentHashTable(&loaded);
+
+  UserFileView view;
+  ASSERT_EQ(openUserFileView(&view, usersFile), 1);
+  EXPECT_EQ(view.blockCount, 3u);
+  User user;
+  ASSERT_EQ(findUserInFileView(&view, longest.c_str(), &user), 1);
+  EXPECT_EQ(user.id, 7);
+  ASSERT_EQ(findUserInFileView(&view, "block_user_2050", &user), 1);
+  EXPECT_EQ(user.id, 2150);
+  ASSERT_EQ(readUserFromFileView(&view, 1, &user), 1);
+  EXPECT_STREQ(user.password, "");
+  closeUserFileView(&view);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestFixedWidthFilesStayReadable) {
+  User records[2] = { makeUser(3, "pat", "one"), makeUser(6, "quinn", "two") };
+  writeHeaderlessUsers(records, 2);
+  ASSERT_EQ(migrateRecordFile(usersFile, sizeof(User)), 1);
+
+  FILE *file = fopen(usersFile, "rb");
+  ASSERT_NE(file, nullptr);
+  RecordFileHeader header;
+  ASSERT_EQ(readRecordFileHeader(file, sizeof(User), &header), RECORD_FILE_CURRENT);
+  EXPECT_EQ(header.version, RECORD_FILE_VERSION);
+  fclose(file);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  EXPECT_EQ(currentID, 7);
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+  destroyBrentHashTable(&ht);
+
+  UserFileView view;
+  ASSERT_EQ(openUserFileView(&view, usersFile), 1);
+  EXPECT_EQ(view.records, nullptr);
+  User user;
+  ASSERT_EQ(findUserInFileView(&view, "quinn", &user), 1);
+  EXPECT_STREQ(user.password, "two");
+  closeUserFileView(&view);
+}
+
+TEST_F(FileUtilityTest, TestCompactFileIsUnderHalfTheFixedWidthSize) {
+  const int users = 2000;
+  std::vector<User> records(users);
+  for (int i = 0; i < users; i++) {
+    char name[50];
+    snprintf(name, sizeof(name), "compact_user_%07d", i);
+    records[i] = makeUser(i + 1, name, "hunter2!");
+  }
+  writeHeaderlessUsers(records.data(), records.size());
+  ASSERT_EQ(migrateRecordFile(usersFile, sizeof(User)), 1);
+  long fixedSize = fileSize(usersFile);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+  destroyBrentHashTable(&ht);
+  EXPECT_LT(fileSize(usersFile) * 2, fixedSize);
+
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, (unsigned int)users);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "compact_user_0001999", &user), 1);
+  EXPECT_EQ(user->id, users);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestCompactLoadFailsWhenInsertsFail) {
+  writeUsers("compact", 10);
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  forceFailure = true;
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 0);
+  forceFailure = false;
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 10u);
+  destroyBrentHashTable(&ht);
+}
+
+TEST_F(FileUtilityTest, TestCompactBlockChecksumDetectsCorruption) {
+  writeUsers("crc", 10);
+  long size = fileSize(usersFile);
+  FILE *file = fopen(usersFile, "r+b");
+  ASSERT_NE(file, nullptr);
+  fseek(file, size - 6, SEEK_SET);
+  int byte = fgetc(file);
+  fseek(file, size - 6, SEEK_SET);
+  fputc(byte ^ 0x20, file);
+  fclose(file);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  EXPECT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 0);
+  destroyBrentHashTable(&ht);
+
+  // The database refuses to open, so nothing compacts over the damaged snapshot
+  User late = makeUser(50, "late", "pw");
+  ASSERT_EQ(appendUserToJournal(journalFile, &late), 1);
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  EXPECT_EQ(loadUserDatabase(&ht, usersFile), 0);
+  destroyBrentHashTable(&ht);
+  EXPECT_EQ(fileSize(usersFile), size);
+  EXPECT_EQ(countUserJournalRecords(journalFile), 1);
+}
+
+TEST_F(FileUtilityTest, TestJournalReplayAppliesLaterRecordsAsUpdates) {
+  writeUsers("upd", 2);
+  User changed = makeUser(1, "upd0", "changed1");
+  User changedAgain = makeUser(1, "upd0", "changed2");
+  ASSERT_EQ(appendUserToJournal(journalFile, &changed), 1);
+  ASSERT_EQ(appendUserToJournal(journalFile, &changedAgain), 1);
+
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUserDatabase(&ht, usersFile), 1);
+  EXPECT_EQ(ht.count, 2u);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "upd0", &user), 1);
+  EXPECT_STREQ(user->password, "changed2");
+  destroyBrentHashTable(&ht);
+
+  User copy;
+  ASSERT_EQ(findUserInJournal(journalFile, "upd0", &copy), 1);
+  EXPECT_STREQ(copy.password, "changed2");
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch is day 0");
+static_assert(makeDate(2000, 3, 1).days == 11017, "2000-03-01");
+static_assert(civilFromDays(-1).year == 1969 && civilFromDays(-1).month == 12 && civilFromDays(-1).day == 31, "day before the epoch");
+static_assert(dayOfWeek(makeDate(2025, 1, 1)) == 3, "2025-01-01 was a Wednesday");
+static_assert(dateTimeFromEpochSeconds(-1).days == -1 && dateTimeFromEpochSeconds(-1).seconds == SECONDS_PER_DAY - 1, "floor split");
+
+TEST_F(FileUtilityTest, TestCivilConversionRoundTripsEveryDay) {
+  CivilDate expected = civilFromDays(-800000);
+  for (int64_t days = -800000; days <= 800000; days++) {
+    CivilDate civil = civilFromDays(days);
+    ASSERT_EQ(civil.year, expected.year);
+    ASSERT_EQ(civil.month, expected.month);
+    ASSERT_EQ(civil.day, expected.day);
+    ASSERT_EQ(daysFromCivil(civil.year, civil.month, civil.day), days);
+
+    // Step the expected date forward by one calendar day.
+    if (++expected.day > daysInMonth(expected.year, expected.month)) {
+      expected.day = 1;
+      if (++expected.month > 12) {
+        expected.month = 1;
+        expected.year++;
+      }
+    }
+  }
+}
+
+TEST_F(FileUtilityTest, TestDateFormattingAndParsing) {
+  char text[DATE_TIME_STRING_SIZE];
+  EXPECT_EQ(formatDate(makeDate(2024, 2, 29), text, sizeof(text)), 10);
+  EXPECT_STREQ(text, "2024-02-29");
+  EXPECT_EQ(formatDate(makeDate(2024, 2, 29), text, DATE_STRING_SIZE - 1), 0);
+  EXPECT_EQ(formatDate(makeDate(10000, 1, 1), text, sizeof(text)), 0);
+
+  DateTime start = makeDateTime(makeDate(1999, 12, 31), 23, 59, 7);
+  EXPECT_EQ(formatDateTime(start, text, sizeof(text)), 19);
+  EXPECT_STREQ(text, "1999-12-31 23:59:07");
+  EXPECT_EQ(dateTimeToEpochSeconds(start), 946684747);
+
+  Date date;
+  DateTime dateTime;
+  EXPECT_EQ(parseDate("2023-10-29", &date), 1);
+  EXPECT_EQ(date.days, makeDate(2023, 10, 29).days);
+  EXPECT_EQ(parseDate("2023-02-29", &date), 0);
+  EXPECT_EQ(parseDate("2023-1-29", &date), 0);
+  EXPECT_EQ(parseDate("2023-10-29x", &date), 0);
+  EXPECT_EQ(parseDate(NULL, &date), 0);
+  EXPECT_EQ(parseDateTime("2023-10-29T08:30", &dateTime), 1);
+  EXPECT_EQ(dateTimeToEpochSeconds(dateTime), 1698568200);
+  EXPECT_EQ(parseDateTime("2023-10-29 08:30:15", &dateTime), 1);
+  EXPECT_EQ(dateTime.seconds, 8 * 3600 + 30 * 60 + 15);
+  EXPECT_EQ(parseDateTime("2023-10-29 24:00", &dateTime), 0);
+  EXPECT_EQ(parseDateTime("2023-10-29 08:30:", &dateTime), 0);
+}
+
+TEST_F(FileUtilityTest, TestBatchFormattingMatchesSingleValues) {
+  std::vector<DateTime> values;
+  for (int i = 0; i < 5000; i++) {
+    values.push_back(dateTimeFromEpochSeconds(1700000000LL + (int64_t)i * 7919 - (i % 3) * 86400 * 40));
+  }
+  std::vector<char> table(values.size() * DATE_TIME_STRING_SIZE);
+  ASSERT_EQ(formatDateTimes(values.data(), values.size(), table.data(), DATE_TIME_STRING_SIZE), values.size());
+
+  std::vector<Date> dates;
+  for (size_t i = 0; i < values.size(); i++) {
+    dates.push_back(dateOf(values[i]));
+  }
+  std::vector<char> dateTable(dates.size() * 16);
+  ASSERT_EQ(formatDates(dates.data(), dates.size(), dateTable.data(), 16), dates.size());
+
+  char single[DATE_TIME_STRING_SIZE];
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(formatDateTime(values[i], single, sizeof(single)), 19);
+    ASSERT_STREQ(&table[i * DATE_TIME_STRING_SIZE], single);
+    single[10] = '\0';
+    ASSERT_STREQ(&dateTable[i * 16], single);
+  }
+
+  dates.push_back(makeDate(12000, 1, 1));
+  EXPECT_EQ(formatDates(dates.data(), dates.size(), dateTable.data(), DATE_STRING_SIZE), dates.size() - 1);
+}
+
+TEST_F(FileUtilityTest, TestGetFormattedDateMatchesDateType) {
+  Date today;
+  ASSERT_EQ(currentLocalDate(&today), 1);
+  char expected[DATE_STRING_SIZE];
+  ASSERT_EQ(formatDate(addDays(today, 45), expected, sizeof(expected)), 10);
+
+  char *formatted = getFormattedDate(45);
+  ASSERT_NE(formatted, nullptr);
+  EXPECT_STREQ(formatted, expected);
+  free(formatted);
+
+  char buffer[DATE_STRING_SIZE];
+  EXPECT_EQ(getFormattedDate(45, buffer, sizeof(buffer)), 10);
+  EXPECT_STREQ(buffer, expected);
+  EXPECT_EQ(getFormattedDate(45, buffer, DATE_STRING_SIZE - 1), 0);
+  EXPECT_STREQ(buffer, "");
+}
+
+TEST_F(FileUtilityTest, TestUserIndexNoticesSameSizeRewrite) {
+  writeUsers("same", 10);
+  ASSERT_EQ(writeUserIndex(usersFile), 1);
+  ASSERT_EQ(isUserIndexCurrent(usersFile), 1);
+  auto fileSize = [](const char *name) {
+    FILE *file = fopen(name, "rb");
+    long size = -1;
+    if (file) {
+      fseek(file, 0, SEEK_END);
+      size = ftell(file);
+      fclose(file);
+    }
+    return size;
+  };
+  long sizeBefore = fileSize(usersFile);
+
+  // Same record count, same length password: only the contents differ.
+  HashTable ht;
+  ASSERT_EQ(initBrentHashTable(&ht), 1);
+  ASSERT_EQ(loadUsersFromBinaryFile(&ht, usersFile), 1);
+  User *user = NULL;
+  ASSERT_EQ(findUserBrent(&ht, "same3", &user), 1);
+  user->password[0] = user->password[0] == 'x' ? 'y' : 'x';
+  ASSERT_EQ(saveUsersToBinaryFile(&ht, usersFile), 1);
+  destroyBrentHashTable(&ht);
+  ASSERT_EQ(fileSize(usersFile), sizeBefore);
+
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 0);
+  UserIndexView view;
+  ASSERT_EQ(openUserIndex(&view, usersFile), 1);
+  EXPECT_EQ(isUserIndexCurrent(usersFile), 1);
+  User found;
+  ASSERT_EQ(findUserInIndex(&view, "same3", &found), 1);
+  EXPECT_TRUE(found.password[0] == 'x' || found.password[0] == 'y');
+  closeUserIndex(&view);
+}
+
+/**
+ * @brief The main function of the test program.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of command-line argument strings.
+ * @return int The exit status of the program.
+ */
+int main(int argc, char **argv) {
+#ifdef ENABLE_UTILITY_TEST
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef COMPACT_USER_FILE_H
+#define COMPACT_USER_FILE_H
+
+#include "file_utility.h"
+
+#define COMPACT_USER_BLOCK_RECORDS 1024u
+
+typedef struct CompactUserBlockHeader {
+	uint32_t recordCount;
+	uint32_t poolSize;   // bytes of string pool, padded to a multiple of 4
+	uint32_t checksum;   // CRC-32 of the entries and the pool
+} CompactUserBlockHeader;
+
+typedef struct CompactUserEntry {
+	int32_t id;
+	uint32_t poolOffset; // username as [u8 length][bytes], password right after it
+} CompactUserEntry;
+
+int writeCompactUsers(FILE* file, const HashTable* ht, int* maxID);
+int loadCompactUsers(FILE* file, const RecordFileHeader* header, HashTable* ht);
+int openCompactUserView(UserFileView* view, const RecordFileHeader* header);
+int readCompactUserFields(const UserFileView* view, size_t index, int* id,
+	const char** username, size_t* usernameLength, const char** password, size_t* passwordLength);
+
+#endif // COMPACT_USER_FILE_H
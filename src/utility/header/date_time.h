@@ -0,0 +1,185 @@
+#ifndef DATE_TIME_H
+#define DATE_TIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DATE_STRING_SIZE 11       // "YYYY-MM-DD" + '\0'
+#define DATE_TIME_STRING_SIZE 20  // "YYYY-MM-DD HH:MM:SS" + '\0'
+#define SECONDS_PER_DAY 86400
+#define CIVIL_DAYS_BEFORE_EPOCH 719468  // days from 0000-03-01 to 1970-01-01
+
+typedef struct Date {
+	int32_t days;     // days since 1970-01-01
+} Date;
+
+typedef struct DateTime {
+	int32_t days;     // days since 1970-01-01
+	int32_t seconds;  // seconds into the day, [0, SECONDS_PER_DAY)
+} DateTime;
+
+typedef struct CivilDate {
+	int32_t year;
+	uint32_t month;   // 1..12
+	uint32_t day;     // 1..31
+} CivilDate;
+
+/*
+ * Proleptic Gregorian conversions after H. Hinnant's days_from_civil /
+ * civil_from_days. Years start in March so the leap day is the last day
+ * of a year, and 400-year eras make the arithmetic branch-free. Written
+ * as single-expression helpers so they stay constexpr under C++11.
+ */
+
+constexpr int64_t floorDivide(int64_t value, int64_t divisor)
+{
+	return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+constexpr int64_t civilEra(int64_t marchYear)
+{
+	return (marchYear >= 0 ? marchYear : marchYear - 399) / 400;
+}
+
+constexpr int64_t civilDayOfMarchYear(uint32_t month, uint32_t day)
+{
+	return (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+
+constexpr int64_t civilDayOfEra(int64_t yearOfEra, uint32_t month, uint32_t day)
+{
+	return yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + civilDayOfMarchYear(month, day);
+}
+
+constexpr int64_t civilDaysFromMarchYear(int64_t marchYear, uint32_t month, uint32_t day)
+{
+	return civilEra(marchYear) * 146097 + civilDayOfEra(marchYear - civilEra(marchYear) * 400, month, day) - CIVIL_DAYS_BEFORE_EPOCH;
+}
+
+/**
+ *  @name   daysFromCivil
+ *
+ *  @brief  Days since 1970-01-01 of a calendar date (negative before it).
+ */
+constexpr int64_t daysFromCivil(int64_t year, uint32_t month, uint32_t day)
+{
+	return civilDaysFromMarchYear(year - (month <= 2 ? 1 : 0), month, day);
+}
+
+constexpr CivilDate civilFromMonthIndex(int64_t marchYear, int64_t dayOfYear, int64_t monthIndex)
+{
+	return CivilDate{ (int32_t)(marchYear + (monthIndex >= 10 ? 1 : 0)),
+		(uint32_t)(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9),
+		(uint32_t)(dayOfYear - (153 * monthIndex + 2) / 5 + 1) };
+}
+
+constexpr CivilDate civilFromDayOfYear(int64_t marchYear, int64_t dayOfYear)
+{
+	return civilFromMonthIndex(marchYear, dayOfYear, (5 * dayOfYear + 2) / 153);
+}
+
+constexpr CivilDate civilFromYearOfEra(int64_t era, int64_t dayOfEra, int64_t yearOfEra)
+{
+	return civilFromDayOfYear(yearOfEra + era * 400, dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100));
+}
+
+constexpr CivilDate civilFromDayOfEra(int64_t era, int64_t dayOfEra)
+{
+	return civilFromYearOfEra(era, dayOfEra, (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365);
+}
+
+constexpr CivilDate civilFromShiftedDays(int64_t shiftedDays)
+{
+	return civilFromDayOfEra(floorDivide(shiftedDays, 146097), shiftedDays - floorDivide(shiftedDays, 146097) * 146097);
+}
+
+/**
+ *  @name   civilFromDays
+ *
+ *  @brief  Calendar date of a day count since 1970-01-01.
+ */
+constexpr CivilDate civilFromDays(int64_t days)
+{
+	return civilFromShiftedDays(days + CIVIL_DAYS_BEFORE_EPOCH);
+}
+
+constexpr bool isLeapYear(int64_t year)
+{
+	return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+constexpr uint32_t daysInMonth(int64_t year, uint32_t month)
+{
+	return month == 2 ? (isLeapYear(year) ? 29u : 28u) : (month == 4 || month == 6 || month == 9 || month == 11 ? 30u : 31u);
+}
+
+constexpr bool isValidCivilDate(int64_t year, uint32_t month, uint32_t day)
+{
+	return month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month);
+}
+
+/**
+ *  @name   makeDate
+ *
+ *  @brief  Date of a valid calendar day, e.g. makeDate(2025, 3, 14).
+ */
+constexpr Date makeDate(int32_t year, uint32_t month, uint32_t day)
+{
+	return Date{ (int32_t)daysFromCivil(year, month, day) };
+}
+
+constexpr Date addDays(Date date, int32_t days)
+{
+	return Date{ date.days + days };
+}
+
+constexpr CivilDate dateToCivil(Date date)
+{
+	return civilFromDays(date.days);
+}
+
+/**
+ *  @name   dayOfWeek
+ *
+ *  @brief  0 = Sunday ... 6 = Saturday (1970-01-01 was a Thursday).
+ */
+constexpr uint32_t dayOfWeek(Date date)
+{
+	return (uint32_t)(date.days - floorDivide(date.days + 4, 7) * 7 + 4);
+}
+
+constexpr DateTime makeDateTime(Date date, int32_t hour, int32_t minute, int32_t second)
+{
+	return DateTime{ date.days, hour * 3600 + minute * 60 + second };
+}
+
+/**
+ *  @name   dateTimeFromEpochSeconds
+ *
+ *  @brief  Splits seconds since the Unix epoch (UTC) into day and time of day.
+ */
+constexpr DateTime dateTimeFromEpochSeconds(int64_t seconds)
+{
+	return DateTime{ (int32_t)floorDivide(seconds, SECONDS_PER_DAY),
+		(int32_t)(seconds - floorDivide(seconds, SECONDS_PER_DAY) * SECONDS_PER_DAY) };
+}
+
+constexpr int64_t dateTimeToEpochSeconds(DateTime dateTime)
+{
+	return (int64_t)dateTime.days * SECONDS_PER_DAY + dateTime.seconds;
+}
+
+constexpr Date dateOf(DateTime dateTime)
+{
+	return Date{ dateTime.days };
+}
+
+int formatDate(Date date, char* buffer, size_t size);
+int formatDateTime(DateTime dateTime, char* buffer, size_t size);
+size_t formatDates(const Date* dates, size_t count, char* buffer, size_t stride);
+size_t formatDateTimes(const DateTime* dateTimes, size_t count, char* buffer, size_t stride);
+int parseDate(const char* text, Date* result);
+int parseDateTime(const char* text, DateTime* result);
+int currentLocalDate(Date* result);
+
+#endif // DATE_TIME_H
@@ -3,10 +3,68 @@
 
 #include "../../local_event_planner/header/brent_hashing.h"
 
+#define USER_LOAD_BLOCK_RECORDS 4096
+#define RECORD_FILE_MAGIC "RECF"
+#define RECORD_FILE_VERSION 1u          // fixed-width records
+#define RECORD_FILE_COMPACT_VERSION 2u  // compact user blocks, see compact_user_file.h
+
+typedef struct RecordFileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t headerSize;   // records start at this offset
+	uint32_t recordSize;
+	uint64_t recordCount;
+	int32_t nextID;        // one past the highest ID ever written
+	uint32_t checksum;     // CRC-32 of every field above
+} RecordFileHeader;
+
+enum RecordFileFormat {
+	RECORD_FILE_CORRUPT = -1,
+	RECORD_FILE_LEGACY = 0,
+	RECORD_FILE_CURRENT = 1
+};
+
+typedef struct MappedFile {
+	void* base;
+	size_t size;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+} MappedFile;
+
+typedef struct UserFileView {
+	const User* records;          // fixed-width files; NULL for compact files
+	const uint64_t* blockOffsets; // compact files: file offset of each block
+	size_t blockCount;
+	size_t count;
+	MappedFile map;
+} UserFileView;
+
 int loadUsersFromBinaryFile(HashTable* ht, const char* filename);
 int saveUsersToBinaryFile(const HashTable* ht, const char* filename);
 int getNextID(const char* filename, size_t recordSize);
 
+void initRecordFileHeader(RecordFileHeader* header, uint32_t version, size_t recordSize, uint64_t recordCount, int nextID);
+int readRecordFileHeader(FILE* file, size_t recordSize, RecordFileHeader* header);
+int writeRecordFileHeader(FILE* file, const RecordFileHeader* header);
+int migrateRecordFile(const char* filename, size_t recordSize);
+
+uint32_t computeCrc32(const void* data, size_t length);
+int syncParentDirectory(const char* path);
+int replaceFileAtomically(const char* from, const char* to);
+
+int mapFileReadOnly(MappedFile* map, const char* filename);
+void unmapFile(MappedFile* map);
+
+int openUserFileView(UserFileView* view, const char* filename);
+int readUserFromFileView(const UserFileView* view, size_t index, User* result);
+int findUserInFileView(const UserFileView* view, const char* username, User* result);
+void closeUserFileView(UserFileView* view);
+
+int getFormattedDate(int daysToAdd, char* buffer, size_t size);
 char* getFormattedDate(int daysToAdd);
 
 #endif // FILE_UTILITY_H
\ No newline at end of file
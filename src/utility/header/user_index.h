@@ -0,0 +1,36 @@
+#ifndef USER_INDEX_H
+#define USER_INDEX_H
+
+#include "file_utility.h"
+
+#define USER_INDEX_SUFFIX ".idx"
+#define USER_INDEX_MAGIC "UIDX"
+#define USER_INDEX_VERSION 2u
+#define USER_INDEX_SEED 0ull
+
+typedef struct UserIndexHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t capacity;      // slot count, power of two
+	uint32_t count;         // indexed records
+	uint64_t seed;          // hashUsernameSeeded() seed used to build the slots
+	uint64_t snapshotSize;  // size of the users file the index was built from
+	uint32_t snapshotChecksum; // snapshotChecksum() of that users file
+	uint32_t reserved;
+} UserIndexHeader;
+
+typedef struct UserIndexView {
+	UserFileView users;
+	MappedFile map;
+	const UserIndexHeader* header;
+	const BrentSlot* slots;
+} UserIndexView;
+
+int buildUserIndexPath(char* out, size_t outSize, const char* filename);
+int writeUserIndex(const char* filename);
+int isUserIndexCurrent(const char* filename);
+int openUserIndex(UserIndexView* view, const char* filename);
+int findUserInIndex(const UserIndexView* view, const char* username, User* result);
+void closeUserIndex(UserIndexView* view);
+
+#endif // USER_INDEX_H
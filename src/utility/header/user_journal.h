@@ -0,0 +1,32 @@
+#ifndef USER_JOURNAL_H
+#define USER_JOURNAL_H
+
+#include "file_utility.h"
+
+#define USER_JOURNAL_SUFFIX ".journal"
+#define USER_JOURNAL_COMPACT_THRESHOLD 256
+
+enum UserJournalRecordType {
+	USER_JOURNAL_PUT = 0,          // registration or password change
+	USER_JOURNAL_DELETE = 1
+};
+
+typedef struct UserJournalRecord {
+	User user;
+	uint32_t checksum; // CRC-32 of user; its bitwise NOT for a USER_JOURNAL_DELETE record
+} UserJournalRecord;
+
+int buildUserJournalPath(char* out, size_t outSize, const char* filename);
+int appendUserToJournal(const char* journalFile, const User* user);
+int appendUserDeletionToJournal(const char* journalFile, const User* user);
+int replayUserJournal(HashTable* ht, const char* journalFile, long* validLength);
+int truncateUserJournal(const char* journalFile, long length);
+int findUserInJournal(const char* journalFile, const char* username, User* result);
+long countUserJournalRecords(const char* journalFile);
+int compactUserJournal(const HashTable* ht, const char* filename);
+
+int loadUserDatabase(HashTable* ht, const char* filename);
+int commitUserRegistration(const HashTable* ht, const User* user, const char* filename);
+int commitUserDeletion(const HashTable* ht, const User* user, const char* filename);
+
+#endif // USER_JOURNAL_H
@@ -0,0 +1,330 @@
+﻿#include "../header/compact_user_file.h"
+#include <cstring>
+#include <vector>
+
+// Bir blok tamponunun üst sınırı: kayıtlar + (2 uzunluk baytı + iki alan) + hizalama
+#define COMPACT_USER_MAX_POOL (COMPACT_USER_BLOCK_RECORDS * (2 + sizeof(((User*)0)->username) + sizeof(((User*)0)->password)) + 3)
+
+/**
+ *  @name   compactBlockCount
+ *
+ *  @brief  Number of blocks needed for @p recordCount users.
+ */
+static size_t compactBlockCount(uint64_t recordCount)
+{
+	return (size_t)((recordCount + COMPACT_USER_BLOCK_RECORDS - 1) / COMPACT_USER_BLOCK_RECORDS);
+}
+
+/**
+ *  @name   appendPoolString
+ *
+ *  @brief  Appends a length-prefixed string to a block's pool.
+ *
+ *  @param  [in,out] pool     [\b std::vector<unsigned char>&]  Block buffer (entries + pool).
+ *  @param  [in]     value    [\b const char*]                  Field of a User.
+ *  @param  [in]     capacity [\b size_t]                       Size of that field.
+ */
+static void appendPoolString(std::vector<unsigned char>& pool, const char* value, size_t capacity)
+{
+	size_t length = 0;
+	while (length < capacity - 1 && value[length] != '\0') {
+		++length;
+	}
+	pool.push_back((unsigned char)length);
+	pool.insert(pool.end(), value, value + length);
+}
+
+/**
+ *  @name   decodePoolString
+ *
+ *  @brief  Locates a length-prefixed string inside a pool, with bounds checks.
+ *
+ *  @param  [in]  pool     [\b const unsigned char*]  Start of the pool.
+ *  @param  [in]  poolSize [\b uint32_t]              Pool size in bytes.
+ *  @param  [in]  offset   [\b uint32_t]              Offset of the length byte.
+ *  @param  [in]  capacity [\b size_t]                Size of the destination User field.
+ *  @param  [out] value    [\b const char**]          Receives the first character.
+ *  @param  [out] length   [\b size_t*]               Receives the length.
+ *
+ *  @retval [\b uint32_t] Offset just past the string, or 0 if it is out of bounds
+ *          or too long for the field.
+ */
+static uint32_t decodePoolString(const unsigned char* pool, uint32_t poolSize, uint32_t offset, size_t capacity,
+	const char** value, size_t* length)
+{
+	if (offset >= poolSize) {
+		return 0;
+	}
+	size_t stored = pool[offset];
+	if (stored >= capacity || (size_t)offset + 1 + stored > poolSize) {
+		return 0;
+	}
+	*value = reinterpret_cast<const char*>(pool + offset + 1);
+	*length = stored;
+	return offset + 1 + (uint32_t)stored;
+}
+
+/**
+ *  @name   decodeCompactEntry
+ *
+ *  @brief  Resolves one entry of a verified or mapped block into its fields.
+ *
+ *  @retval [\b int] 1 on success; 0 if the entry points outside the pool.
+ */
+static int decodeCompactEntry(const CompactUserEntry* entry, const unsigned char* pool, uint32_t poolSize,
+	const char** username, size_t* usernameLength, const char** password, size_t* passwordLength)
+{
+	uint32_t next = decodePoolString(pool, poolSize, entry->poolOffset, sizeof(((User*)0)->username), username, usernameLength);
+	return next != 0
+		&& decodePoolString(pool, poolSize, next, sizeof(((User*)0)->password), password, passwordLength) != 0;
+}
+
+/**
+ *  @name   writeCompactUsers
+ *
+ *  @brief  Writes the body of a compact users file.
+ *
+ *  @param  [in]  file  [\b FILE*]             File positioned right after a RecordFileHeader.
+ *  @param  [in]  ht    [\b const HashTable*]  Users to write, in slab order.
+ *  @param  [out] maxID [\b int*]              Receives the highest ID written (0 if none).
+ *
+ *  @retval [\b int] 1 on success; 0 on write failure.
+ *
+ *  @details
+ *  Layout after the header: a directory of uint64 block offsets and its
+ *  CRC-32, then one block per COMPACT_USER_BLOCK_RECORDS users. A block is
+ *  a CompactUserBlockHeader, a fixed-width CompactUserEntry per user for
+ *  random access, and a string pool holding each username and password as
+ *  a length byte plus the characters. The pool is padded to 4 bytes so the
+ *  next block stays aligned for in-place reads from a mapping. A typical
+ *  user costs about 30 bytes instead of sizeof(User) = 104.
+ */
+int writeCompactUsers(FILE* file, const HashTable* ht, int* maxID)
+{
+	*maxID = 0;
+	long directoryOffset = std::ftell(file);
+	size_t blockCount = compactBlockCount(ht->count);
+	std::vector<uint64_t> offsets(blockCount, 0);
+	uint32_t directoryChecksum = 0;
+
+	if (directoryOffset < 0
+		|| (blockCount > 0 && std::fwrite(offsets.data(), sizeof(uint64_t), blockCount, file) != blockCount)
+		|| std::fwrite(&directoryChecksum, sizeof(directoryChecksum), 1, file) != 1) {
+		return 0;
+	}
+
+	uint64_t position = (uint64_t)directoryOffset + blockCount * sizeof(uint64_t) + sizeof(directoryChecksum);
+	std::vector<unsigned char> buffer;
+	buffer.reserve(COMPACT_USER_BLOCK_RECORDS * sizeof(CompactUserEntry) + COMPACT_USER_MAX_POOL);
+
+	for (size_t block = 0; block < blockCount; ++block) {
+		unsigned int first = (unsigned int)(block * COMPACT_USER_BLOCK_RECORDS);
+		unsigned int count = ht->count - first < COMPACT_USER_BLOCK_RECORDS ? ht->count - first : COMPACT_USER_BLOCK_RECORDS;
+		size_t entriesSize = count * sizeof(CompactUserEntry);
+
+		buffer.assign(entriesSize, 0);
+		for (unsigned int i = 0; i < count; ++i) {
+			const User* user = getUserAtBrent(ht, first + i);
+			CompactUserEntry entry;
+			entry.id = user->id;
+			entry.poolOffset = (uint32_t)(buffer.size() - entriesSize);
+			std::memcpy(&buffer[i * sizeof(CompactUserEntry)], &entry, sizeof(entry));
+			appendPoolString(buffer, user->username, sizeof(user->username));
+			appendPoolString(buffer, user->password, sizeof(user->password));
+			if (user->id > *maxID) {
+				*maxID = user->id;
+			}
+		}
+		while (buffer.size() % 4 != 0) {
+			buffer.push_back(0);
+		}
+
+		CompactUserBlockHeader header;
+		header.recordCount = count;
+		header.poolSize = (uint32_t)(buffer.size() - entriesSize);
+		header.checksum = computeCrc32(buffer.data(), buffer.size());
+		if (std::fwrite(&header, sizeof(header), 1, file) != 1
+			|| std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+			return 0;
+		}
+		offsets[block] = position;
+		position += sizeof(header) + buffer.size();
+	}
+
+	directoryChecksum = computeCrc32(offsets.data(), blockCount * sizeof(uint64_t));
+	return std::fseek(file, directoryOffset, SEEK_SET) == 0
+		&& (blockCount == 0 || std::fwrite(offsets.data(), sizeof(uint64_t), blockCount, file) == blockCount)
+		&& std::fwrite(&directoryChecksum, sizeof(directoryChecksum), 1, file) == 1;
+}
+
+/**
+ *  @name   loadCompactUsers
+ *
+ *  @brief  Decodes a compact users file straight into the table.
+ *
+ *  @param  [in]     file   [\b FILE*]                    File positioned after the header.
+ *  @param  [in]     header [\b const RecordFileHeader*]  Validated header (compact version).
+ *  @param  [in,out] ht     [\b HashTable*]               Initialized table to fill.
+ *
+ *  @retval [\b int] 1 on success; 0 if a checksum or bound fails, memory
+ *          runs out or a block is only partly placed in the table.
+ *
+ *  @details
+ *  The table is sized once from the header. Every block is read with one
+ *  fread(), its CRC checked, its entries expanded into a reused User batch
+ *  and handed to insertUsersBulkBrent(). Users from blocks before a
+ *  damaged one stay in the table, but the load still fails.
+ */
+int loadCompactUsers(FILE* file, const RecordFileHeader* header, HashTable* ht)
+{
+	size_t blockCount = compactBlockCount(header->recordCount);
+	if (header->recordCount > UINT_MAX
+		|| (header->recordCount > 0 && !reserveBrentHashTable(ht, ht->count + (unsigned int)header->recordCount))) {
+		return 0;
+	}
+
+	std::vector<uint64_t> offsets(blockCount);
+	uint32_t directoryChecksum = 0;
+	if ((blockCount > 0 && std::fread(offsets.data(), sizeof(uint64_t), blockCount, file) != blockCount)
+		|| std::fread(&directoryChecksum, sizeof(directoryChecksum), 1, file) != 1
+		|| computeCrc32(offsets.data(), blockCount * sizeof(uint64_t)) != directoryChecksum) {
+		return 0;
+	}
+
+	std::vector<unsigned char> buffer(COMPACT_USER_BLOCK_RECORDS * sizeof(CompactUserEntry) + COMPACT_USER_MAX_POOL);
+	std::vector<User> batch(COMPACT_USER_BLOCK_RECORDS);
+	uint64_t remaining = header->recordCount;
+	uint64_t position = (uint64_t)header->headerSize + blockCount * sizeof(uint64_t) + sizeof(directoryChecksum);
+
+	for (size_t block = 0; block < blockCount; ++block) {
+		CompactUserBlockHeader blockHeader;
+		uint32_t expected = remaining < COMPACT_USER_BLOCK_RECORDS ? (uint32_t)remaining : COMPACT_USER_BLOCK_RECORDS;
+		// Bloklar ardışık yazılır; fseek yalnızca dizin başka bir yeri gösterirse (stdio tamponunu korur)
+		if ((offsets[block] != position && std::fseek(file, (long)offsets[block], SEEK_SET) != 0)
+			|| std::fread(&blockHeader, sizeof(blockHeader), 1, file) != 1
+			|| blockHeader.recordCount != expected
+			|| blockHeader.poolSize > COMPACT_USER_MAX_POOL) {
+			return 0;
+		}
+
+		size_t entriesSize = expected * sizeof(CompactUserEntry);
+		size_t blockSize = entriesSize + blockHeader.poolSize;
+		if (std::fread(buffer.data(), 1, blockSize, file) != blockSize
+			|| computeCrc32(buffer.data(), blockSize) != blockHeader.checksum) {
+			return 0;
+		}
+		position = offsets[block] + sizeof(blockHeader) + blockSize;
+
+		const unsigned char* pool = buffer.data() + entriesSize;
+		for (uint32_t i = 0; i < expected; ++i) {
+			CompactUserEntry entry;
+			std::memcpy(&entry, &buffer[i * sizeof(CompactUserEntry)], sizeof(entry));
+
+			const char* username;
+			const char* password;
+			size_t usernameLength, passwordLength;
+			if (!decodeCompactEntry(&entry, pool, blockHeader.poolSize, &username, &usernameLength, &password, &passwordLength)) {
+				return 0;
+			}
+
+			User* user = &batch[i];
+			std::memset(user, 0, sizeof(*user));
+			user->id = entry.id;
+			std::memcpy(user->username, username, usernameLength);
+			std::memcpy(user->password, password, passwordLength);
+		}
+
+		unsigned int consumed = 0;
+		insertUsersBulkBrent(ht, batch.data(), expected, &consumed);
+		if (consumed < expected) {
+			return 0;
+		}
+		remaining -= expected;
+	}
+	return 1;
+}
+
+/**
+ *  @name   openCompactUserView
+ *
+ *  @brief  Sets up a mapped view over a compact users file.
+ *
+ *  @param  [in,out] view   [\b UserFileView*]            View whose file is already mapped.
+ *  @param  [in]     header [\b const RecordFileHeader*]  Header at the start of the mapping.
+ *
+ *  @retval [\b int] 1 on success; 0 if the block directory is damaged.
+ *
+ *  @details
+ *  Only the directory and its CRC are checked here; block CRCs are left
+ *  to loadCompactUsers() so that opening the view still touches just the
+ *  first pages. readCompactUserFields() bounds-checks every access instead.
+ */
+int openCompactUserView(UserFileView* view, const RecordFileHeader* header)
+{
+	size_t blockCount = compactBlockCount(header->recordCount);
+	size_t directoryEnd = header->headerSize + blockCount * sizeof(uint64_t) + sizeof(uint32_t);
+	if (view->map.size < directoryEnd) {
+		return 0;
+	}
+
+	const unsigned char* base = static_cast<const unsigned char*>(view->map.base);
+	const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + header->headerSize);
+	uint32_t directoryChecksum;
+	std::memcpy(&directoryChecksum, base + directoryEnd - sizeof(uint32_t), sizeof(directoryChecksum));
+	if (computeCrc32(offsets, blockCount * sizeof(uint64_t)) != directoryChecksum) {
+		return 0;
+	}
+
+	for (size_t block = 0; block < blockCount; ++block) {
+		if (offsets[block] % 4 != 0 || offsets[block] < directoryEnd
+			|| offsets[block] + sizeof(CompactUserBlockHeader) > view->map.size) {
+			return 0;
+		}
+	}
+
+	view->records = nullptr;
+	view->blockOffsets = offsets;
+	view->blockCount = blockCount;
+	view->count = (size_t)header->recordCount;
+	return 1;
+}
+
+/**
+ *  @name   readCompactUserFields
+ *
+ *  @brief  Random access to one user of a compact view, without copying.
+ *
+ *  @param  [in]  view           [\b const UserFileView*]  View set up by openCompactUserView().
+ *  @param  [in]  index          [\b size_t]               0-based record number.
+ *  @param  [out] id             [\b int*]                 Receives the ID.
+ *  @param  [out] username       [\b const char**]         Receives the name (not null-terminated).
+ *  @param  [out] usernameLength [\b size_t*]              Receives the name length.
+ *  @param  [out] password       [\b const char**]         Receives the password (not null-terminated).
+ *  @param  [out] passwordLength [\b size_t*]              Receives the password length.
+ *
+ *  @retval [\b int] 1 on success; 0 if @p index is out of range or the block is malformed.
+ *
+ *  @complexity O(1): directory lookup, then the fixed-width entry, then the pool.
+ */
+int readCompactUserFields(const UserFileView* view, size_t index, int* id,
+	const char** username, size_t* usernameLength, const char** password, size_t* passwordLength)
+{
+	if (index >= view->count) {
+		return 0;
+	}
+
+	size_t block = index / COMPACT_USER_BLOCK_RECORDS;
+	uint32_t slot = (uint32_t)(index % COMPACT_USER_BLOCK_RECORDS);
+	const unsigned char* base = static_cast<const unsigned char*>(view->map.base) + view->blockOffsets[block];
+	const CompactUserBlockHeader* header = reinterpret_cast<const CompactUserBlockHeader*>(base);
+	size_t blockEnd = (size_t)view->blockOffsets[block] + sizeof(*header)
+		+ (size_t)header->recordCount * sizeof(CompactUserEntry) + header->poolSize;
+	if (slot >= header->recordCount || blockEnd > view->map.size) {
+		return 0;
+	}
+
+	const CompactUserEntry* entries = reinterpret_cast<const CompactUserEntry*>(base + sizeof(*header));
+	const unsigned char* pool = reinterpret_cast<const unsigned char*>(entries + header->recordCount);
+	*id = entries[slot].id;
+	return decodeCompactEntry(&entries[slot], pool, header->poolSize, username, usernameLength, password, passwordLength);
+}
@@ -0,0 +1,319 @@
+#include "../header/date_time.h"
+#include <cstring>
+#include <ctime>
+
+/**
+ *  @name   writeTwoDigits
+ *
+ *  @brief  Writes 0..99 as two ASCII digits.
+ */
+static void writeTwoDigits(char* out, uint32_t value)
+{
+	out[0] = (char)('0' + value / 10);
+	out[1] = (char)('0' + value % 10);
+}
+
+/**
+ *  @name   writeCivilDate
+ *
+ *  @brief  Writes "YYYY-MM-DD" (no terminator) for a year in 0..9999.
+ */
+static void writeCivilDate(char* out, const CivilDate& civil)
+{
+	writeTwoDigits(out, (uint32_t)civil.year / 100);
+	writeTwoDigits(out + 2, (uint32_t)civil.year % 100);
+	out[4] = '-';
+	writeTwoDigits(out + 5, civil.month);
+	out[7] = '-';
+	writeTwoDigits(out + 8, civil.day);
+}
+
+/**
+ *  @name   writeTimeOfDay
+ *
+ *  @brief  Writes " HH:MM:SS" (no terminator).
+ */
+static void writeTimeOfDay(char* out, int32_t seconds)
+{
+	out[0] = ' ';
+	writeTwoDigits(out + 1, (uint32_t)seconds / 3600);
+	out[3] = ':';
+	writeTwoDigits(out + 4, (uint32_t)seconds / 60 % 60);
+	out[6] = ':';
+	writeTwoDigits(out + 7, (uint32_t)seconds % 60);
+}
+
+static bool isPrintableYear(int32_t year)
+{
+	return year >= 0 && year <= 9999;
+}
+
+/**
+ *  @name   formatDate
+ *
+ *  @brief  Formats a date as "YYYY-MM-DD" into a caller buffer.
+ *
+ *  @param  [in]  date   [\b Date]    Date to format.
+ *  @param  [out] buffer [\b char*]   Receives the terminated string.
+ *  @param  [in]  size   [\b size_t]  Capacity of @p buffer (>= DATE_STRING_SIZE).
+ *
+ *  @retval [\b int] Characters written (10); 0 if the buffer is too small
+ *          or the year is outside 0..9999.
+ *
+ *  @details No allocation, locale or time zone is involved, so it is safe
+ *           to call from any thread.
+ */
+int formatDate(Date date, char* buffer, size_t size)
+{
+	CivilDate civil = dateToCivil(date);
+	if (!buffer || size < DATE_STRING_SIZE || !isPrintableYear(civil.year)) {
+		return 0;
+	}
+
+	writeCivilDate(buffer, civil);
+	buffer[DATE_STRING_SIZE - 1] = '\0';
+	return DATE_STRING_SIZE - 1;
+}
+
+/**
+ *  @name   formatDateTime
+ *
+ *  @brief  Formats a date and time as "YYYY-MM-DD HH:MM:SS" into a caller buffer.
+ *
+ *  @retval [\b int] Characters written (19); 0 if the buffer is too small,
+ *          the year is outside 0..9999 or the time of day is out of range.
+ */
+int formatDateTime(DateTime dateTime, char* buffer, size_t size)
+{
+	CivilDate civil = dateToCivil(dateOf(dateTime));
+	if (!buffer || size < DATE_TIME_STRING_SIZE || !isPrintableYear(civil.year)
+		|| dateTime.seconds < 0 || dateTime.seconds >= SECONDS_PER_DAY) {
+		return 0;
+	}
+
+	writeCivilDate(buffer, civil);
+	writeTimeOfDay(buffer + DATE_STRING_SIZE - 1, dateTime.seconds);
+	buffer[DATE_TIME_STRING_SIZE - 1] = '\0';
+	return DATE_TIME_STRING_SIZE - 1;
+}
+
+/**
+ *  @name   MonthCache
+ *
+ *  @brief  The last formatted month: dates inside it only rewrite the day.
+ */
+typedef struct MonthCache {
+	int64_t firstDay;   // days of the 1st of the month
+	int64_t endDay;     // days of the 1st of the next month
+	char prefix[8];     // "YYYY-MM-"
+} MonthCache;
+
+/**
+ *  @name   writeCachedDate
+ *
+ *  @brief  Writes "YYYY-MM-DD", recomputing the civil date only when the month changes.
+ *
+ *  @retval [\b bool] false if the year is outside 0..9999.
+ */
+static bool writeCachedDate(char* out, int32_t days, MonthCache* cache)
+{
+	if (days < cache->firstDay || days >= cache->endDay) {
+		CivilDate civil = civilFromDays(days);
+		if (!isPrintableYear(civil.year)) {
+			return false;
+		}
+		char text[DATE_STRING_SIZE - 1];
+		writeCivilDate(text, civil);
+		std::memcpy(cache->prefix, text, sizeof(cache->prefix));
+		cache->firstDay = days - (int64_t)(civil.day - 1);
+		cache->endDay = cache->firstDay + daysInMonth(civil.year, civil.month);
+	}
+
+	std::memcpy(out, cache->prefix, sizeof(cache->prefix));
+	writeTwoDigits(out + 8, (uint32_t)(days - cache->firstDay + 1));
+	return true;
+}
+
+/**
+ *  @name   formatDates
+ *
+ *  @brief  Formats many dates into a table of fixed-width strings.
+ *
+ *  @param  [in]  dates  [\b const Date*]  Dates to format.
+ *  @param  [in]  count  [\b size_t]       Number of dates.
+ *  @param  [out] buffer [\b char*]        Receives @p count terminated strings, @p stride bytes apart.
+ *  @param  [in]  stride [\b size_t]       Distance between strings (>= DATE_STRING_SIZE).
+ *
+ *  @retval [\b size_t] Number of dates formatted; stops at the first unprintable year.
+ *
+ *  @details
+ *  Listing views show runs of dates from the same month, so the year and
+ *  month digits are produced once per month and copied for the rest.
+ */
+size_t formatDates(const Date* dates, size_t count, char* buffer, size_t stride)
+{
+	if (!dates || !buffer || stride < DATE_STRING_SIZE) {
+		return 0;
+	}
+
+	MonthCache cache = { 1, 0, { 0 } };
+	for (size_t i = 0; i < count; i++) {
+		char* out = buffer + i * stride;
+		if (!writeCachedDate(out, dates[i].days, &cache)) {
+			return i;
+		}
+		out[DATE_STRING_SIZE - 1] = '\0';
+	}
+	return count;
+}
+
+/**
+ *  @name   formatDateTimes
+ *
+ *  @brief  Formats many date-times into a table of fixed-width strings.
+ *
+ *  @param  [in]  dateTimes [\b const DateTime*]  Values to format.
+ *  @param  [in]  count     [\b size_t]           Number of values.
+ *  @param  [out] buffer    [\b char*]            Receives @p count terminated strings, @p stride bytes apart.
+ *  @param  [in]  stride    [\b size_t]           Distance between strings (>= DATE_TIME_STRING_SIZE).
+ *
+ *  @retval [\b size_t] Number of values formatted; stops at the first invalid one.
+ *
+ *  @details Shares the per-month cache described in formatDates().
+ */
+size_t formatDateTimes(const DateTime* dateTimes, size_t count, char* buffer, size_t stride)
+{
+	if (!dateTimes || !buffer || stride < DATE_TIME_STRING_SIZE) {
+		return 0;
+	}
+
+	MonthCache cache = { 1, 0, { 0 } };
+	for (size_t i = 0; i < count; i++) {
+		char* out = buffer + i * stride;
+		if (dateTimes[i].seconds < 0 || dateTimes[i].seconds >= SECONDS_PER_DAY
+			|| !writeCachedDate(out, dateTimes[i].days, &cache)) {
+			return i;
+		}
+		writeTimeOfDay(out + DATE_STRING_SIZE - 1, dateTimes[i].seconds);
+		out[DATE_TIME_STRING_SIZE - 1] = '\0';
+	}
+	return count;
+}
+
+/**
+ *  @name   readDigits
+ *
+ *  @brief  Reads exactly @p count ASCII digits.
+ */
+static bool readDigits(const char* text, int count, uint32_t* value)
+{
+	uint32_t result = 0;
+	for (int i = 0; i < count; i++) {
+		if (text[i] < '0' || text[i] > '9') {
+			return false;
+		}
+		result = result * 10 + (uint32_t)(text[i] - '0');
+	}
+	*value = result;
+	return true;
+}
+
+/**
+ *  @name   parseCivilDate
+ *
+ *  @brief  Parses the leading "YYYY-MM-DD" of @p text.
+ */
+static bool parseCivilDate(const char* text, Date* result)
+{
+	uint32_t year, month, day;
+	if (!readDigits(text, 4, &year) || text[4] != '-' || !readDigits(text + 5, 2, &month)
+		|| text[7] != '-' || !readDigits(text + 8, 2, &day) || !isValidCivilDate(year, month, day)) {
+		return false;
+	}
+	*result = makeDate((int32_t)year, month, day);
+	return true;
+}
+
+/**
+ *  @name   parseDate
+ *
+ *  @brief  Parses a strict "YYYY-MM-DD" date.
+ *
+ *  @param  [in]  text   [\b const char*]  Text to parse; nothing may follow the date.
+ *  @param  [out] result [\b Date*]        Receives the date.
+ *
+ *  @retval [\b int] 1 on success; 0 on malformed text or a day that does not
+ *          exist (e.g. 2023-02-29).
+ *
+ *  @details Unlike strptime()/mktime() this reads no global state and is
+ *           safe to call from any thread.
+ */
+int parseDate(const char* text, Date* result)
+{
+	Date date;
+	if (!text || !result || std::strlen(text) != DATE_STRING_SIZE - 1 || !parseCivilDate(text, &date)) {
+		return 0;
+	}
+	*result = date;
+	return 1;
+}
+
+/**
+ *  @name   parseDateTime
+ *
+ *  @brief  Parses "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS" ('T' may replace the space).
+ *
+ *  @param  [in]  text   [\b const char*]  Text to parse; nothing may follow the time.
+ *  @param  [out] result [\b DateTime*]    Receives the value.
+ *
+ *  @retval [\b int] 1 on success; 0 on malformed text or an impossible date or time.
+ */
+int parseDateTime(const char* text, DateTime* result)
+{
+	size_t length = text ? std::strlen(text) : 0;
+	Date date;
+	uint32_t hour, minute, second = 0;
+	if (!result || (length != 16 && length != 19) || !parseCivilDate(text, &date)
+		|| (text[10] != ' ' && text[10] != 'T') || !readDigits(text + 11, 2, &hour)
+		|| text[13] != ':' || !readDigits(text + 14, 2, &minute)
+		|| (length == 19 && (text[16] != ':' || !readDigits(text + 17, 2, &second)))
+		|| hour > 23 || minute > 59 || second > 59) {
+		return 0;
+	}
+	*result = makeDateTime(date, (int32_t)hour, (int32_t)minute, (int32_t)second);
+	return 1;
+}
+
+/**
+ *  @name   currentLocalDate
+ *
+ *  @brief  Today's date in the local time zone.
+ *
+ *  @param  [out] result [\b Date*]  Receives today's date.
+ *
+ *  @retval [\b int] 1 on success; 0 if the local time is unavailable.
+ *
+ *  @details Uses the reentrant localtime_r()/localtime_s() and then plain
+ *           day arithmetic, so no shared struct tm is touched.
+ */
+int currentLocalDate(Date* result)
+{
+	if (!result) {
+		return 0;
+	}
+
+	std::time_t now = std::time(nullptr);
+	std::tm local;
+#if defined(_WIN32)
+	if (localtime_s(&local, &now) != 0) {
+		return 0;
+	}
+#else
+	if (!localtime_r(&now, &local)) {
+		return 0;
+	}
+#endif
+
+	*result = makeDate(1900 + local.tm_year, (uint32_t)(1 + local.tm_mon), (uint32_t)local.tm_mday);
+	return 1;
+}
@@ -1,51 +1,278 @@
 ﻿#include "../header/file_utility.h"
+#include "../header/compact_user_file.h"
+#include "../header/date_time.h"
+#include "../../local_event_planner/header/hot_path_stats.h"
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#endif
 
-int loadUsersFromBinaryFile(HashTable* ht, const char* filename)
+/**
+ *  @name   checkRecordFileHeader
+ *
+ *  @brief  Classifies the first bytes of a record file.
+ *
+ *  @param  [in] header     [\b const RecordFileHeader*]  Bytes read from offset 0.
+ *  @param  [in] recordSize [\b size_t]                   Record size the caller expects.
+ *
+ *  @retval [\b int] RECORD_FILE_CURRENT for a valid header, RECORD_FILE_LEGACY
+ *          when the magic is absent (a headerless file), RECORD_FILE_CORRUPT
+ *          when the magic is present but anything else does not check out.
+ */
+static int checkRecordFileHeader(const RecordFileHeader* header, size_t recordSize)
 {
-	FILE* file = std::fopen(filename, "rb");
-	if (!file) {
-		// Dosya yoksa boş başlangıç; ID'yi 1'e çek
-		currentID = 1;
-		return 1; // başarı kabul ediliyor (boş durum)
+	if (std::memcmp(header->magic, RECORD_FILE_MAGIC, sizeof(header->magic)) != 0) {
+		return RECORD_FILE_LEGACY;
+	}
+	if ((header->version != RECORD_FILE_VERSION && header->version != RECORD_FILE_COMPACT_VERSION)
+		|| header->headerSize < sizeof(RecordFileHeader)
+		|| header->recordSize != recordSize
+		|| header->checksum != computeCrc32(header, offsetof(RecordFileHeader, checksum))) {
+		return RECORD_FILE_CORRUPT;
+	}
+	return RECORD_FILE_CURRENT;
+}
+
+/**
+ *  @name   scanMaxRecordID
+ *
+ *  @brief  Highest leading int ID from the current position to end of file.
+ *
+ *  @param  [in] file       [\b FILE*]   Open file, positioned at the first record.
+ *  @param  [in] recordSize [\b size_t]  Size of one record.
+ *
+ *  @retval [\b int] Highest ID seen, 0 if there are no records.
+ *
+ *  @details Only used for headerless files; O(n) reads.
+ */
+static int scanMaxRecordID(FILE* file, size_t recordSize)
+{
+	void* record = std::malloc(recordSize);
+	if (!record) {
+		std::perror("Memory allocation failed");
+		return 0;
+	}
+
+	int maxID = 0;
+
+	// Varsayım: her kaydın ilk alanı int ID
+	while (std::fread(record, recordSize, 1, file) == 1) {
+		int recID = *reinterpret_cast<int*>(record);
+		if (recID > maxID) {
+			maxID = recID;
+		}
+	}
+
+	std::free(record);
+	return maxID;
+}
+
+/**
+ *  @name   loadUsersFromOpenFile
+ *
+ *  @brief  Body of loadUsersFromBinaryFile() once the file is open.
+ *
+ *  @details
+ *  Leaves the file open and positioned after the last byte it read, so
+ *  the caller can count the bytes consumed before closing it.
+ */
+static int loadUsersFromOpenFile(HashTable* ht, FILE* file)
+{
+	RecordFileHeader header;
+	int format = readRecordFileHeader(file, sizeof(User), &header);
+	if (format == RECORD_FILE_CORRUPT) {
+		return 0;
+	}
+
+	if (format == RECORD_FILE_CURRENT && header.version == RECORD_FILE_COMPACT_VERSION) {
+		int ok = loadCompactUsers(file, &header, ht);
+		if (ok) {
+			advanceUserID(header.nextID - 1);
+		}
+		return ok;
+	}
+
+	uint64_t expected = 0;
+	if (format == RECORD_FILE_CURRENT) {
+		expected = header.recordCount;
+	} else {
+		std::fseek(file, 0, SEEK_END);
+		expected = (uint64_t)std::ftell(file) / sizeof(User);
+		std::fseek(file, 0, SEEK_SET);
+	}
+	if (expected > 0 && (expected > UINT_MAX || !reserveBrentHashTable(ht, ht->count + (unsigned int)expected))) {
+		return 0;
+	}
+
+	User* block = static_cast<User*>(std::malloc(USER_LOAD_BLOCK_RECORDS * sizeof(User)));
+	if (!block) {
+		return 0;
 	}
 
-	User tempUser{};
 	int maxID = 0;
+	uint64_t remaining = expected;
+	size_t read = 0;
 
-	while (std::fread(&tempUser, sizeof(User), 1, file) == 1) {
-		User* existingUser = nullptr;
-		// Aynı kullanıcı yoksa tabloya ekle
-		if (!findUserBrent(ht, tempUser.username, &existingUser) || existingUser == nullptr) {
-			insertUserBrent(ht, tempUser.id, tempUser.username, tempUser.password);
+	while (remaining > 0 && (read = std::fread(block, sizeof(User), remaining < USER_LOAD_BLOCK_RECORDS ? (size_t)remaining : USER_LOAD_BLOCK_RECORDS, file)) > 0) {
+		unsigned int consumed = 0;
+		insertUsersBulkBrent(ht, block, (unsigned int)read, &consumed);
+		if (consumed < read) {
+			std::free(block);
+			return 0;
 		}
-		if (tempUser.id > maxID) {
-			maxID = tempUser.id;
+		remaining -= read;
+		if (format == RECORD_FILE_LEGACY) {
+			for (size_t i = 0; i < read; ++i) {
+				if (block[i].id > maxID) {
+					maxID = block[i].id;
+				}
+			}
 		}
 	}
 
-	std::fclose(file);
-	currentID = maxID + 1;
+	std::free(block);
+	if (remaining != 0) {
+		return 0; // the header promised more records than the file holds
+	}
+	advanceUserID(format == RECORD_FILE_CURRENT ? header.nextID - 1 : maxID);
 	return 1;
 }
 
+/**
+ *  @name   loadUsersFromBinaryFile
+ *
+ *  @brief  Bulk-loads a users file in any supported format into the table.
+ *
+ *  @param  [in,out] ht       [\b HashTable*]  Initialized table to fill.
+ *  @param  [in]     filename [\b const char*] Compact, fixed-width or headerless users file.
+ *
+ *  @retval [\b int] 1 on success (a missing file counts as empty); 0 if
+ *          the header or a block checksum is damaged, the file holds fewer
+ *          records than its header says, the table cannot be sized, a
+ *          record cannot be inserted or the buffer cannot be allocated.
+ *
+ *  @details
+ *  Compact files (the format saveUsersToBinaryFile() writes) are decoded
+ *  block by block by loadCompactUsers(). For fixed-width files, this
+ *  sizes the table once from the header's record count (or, for a
+ *  headerless file, the file length divided by sizeof(User)), then reads
+ *  USER_LOAD_BLOCK_RECORDS records per fread() and hands each block to
+ *  insertUsersBulkBrent(), which hashes a batch before placing it and
+ *  drops repeated usernames (first one wins). advanceUserID() raises
+ *  @c currentID to at least the header's next ID (one past the highest
+ *  ID for headerless files, the only ones scanned) and never lowers it,
+ *  so IDs handed out before the load are not reused. A missing file
+ *  leaves @c currentID alone. A partial load returns 0 rather than 1: a
+ *  caller that trusts it would compact the partial table over the file.
+ *  The file itself is not rewritten; see migrateRecordFile().
+ *  With ENABLE_HOT_PATH_STATS the latency and the bytes read are recorded.
+ */
+int loadUsersFromBinaryFile(HashTable* ht, const char* filename)
+{
+	HOT_PATH_TIMER_START(startNanos);
+	FILE* file = std::fopen(filename, "rb");
+	if (!file) {
+		// Dosya yoksa boş başlangıç; ID sayacına dokunma
+		return 1; // başarı kabul ediliyor (boş durum)
+	}
+
+	int ok = loadUsersFromOpenFile(ht, file);
+#if defined(ENABLE_HOT_PATH_STATS)
+	long consumed = std::ftell(file);
+	hotPathAdd(ok ? HOT_PATH_FILE_LOADS : HOT_PATH_FILE_FAILURES, 1);
+	hotPathAdd(HOT_PATH_BYTES_READ, consumed > 0 ? (uint64_t)consumed : 0);
+#endif
+	std::fclose(file);
+	HOT_PATH_TIMER_STOP(startNanos, HOT_PATH_LOAD_NANOS);
+	return ok;
+}
+
+/**
+ *  @name   saveUsersToBinaryFile
+ *
+ *  @brief  Writes every user in the table to a compact users file.
+ *
+ *  @param  [in] ht       [\b const HashTable*]  Table to persist.
+ *  @param  [in] filename [\b const char*]       Destination file.
+ *
+ *  @retval [\b int] 1 on success; 0 on I/O failure (the old file is kept).
+ *
+ *  @details
+ *  Writes a RecordFileHeader (compact version) and the blocks produced by
+ *  writeCompactUsers(), in insertion order, to "<filename>.tmp", which
+ *  then replaces @p filename with replaceFileAtomically(). The header's
+ *  next ID is the larger of @c currentID and one past the highest saved
+ *  ID, so IDs handed out but not yet saved are never reused. A crash
+ *  mid-write leaves the previous file, header included, intact; once this
+ *  returns 1 the new file has been synced to disk.
+ *  With ENABLE_HOT_PATH_STATS the latency and the bytes written are recorded.
+ */
 int saveUsersToBinaryFile(const HashTable* ht, const char* filename)
 {
-	FILE* file = std::fopen(filename, "wb");
+	HOT_PATH_TIMER_START(startNanos);
+	std::string tempName = std::string(filename) + ".tmp";
+	FILE* file = std::fopen(tempName.c_str(), "wb");
 	if (!file) {
+		HOT_PATH_COUNT(HOT_PATH_FILE_FAILURES, 1);
 		return 0;
 	}
 
-	for (int i = 0; i < TABLE_SIZE; ++i) {
-		const User* user = ht->table[i];
-		if (user) {
-			std::fwrite(user, sizeof(User), 1, file);
-		}
+	RecordFileHeader header;
+	initRecordFileHeader(&header, RECORD_FILE_COMPACT_VERSION, sizeof(User), 0, 1);
+	int maxID = 0;
+	int ok = writeRecordFileHeader(file, &header) && writeCompactUsers(file, ht, &maxID);
+
+#if defined(ENABLE_HOT_PATH_STATS)
+	long written = ok && std::fseek(file, 0, SEEK_END) == 0 ? std::ftell(file) : 0; // the block directory is written last but sits earlier
+#endif
+	int nextID = currentID.load();
+	initRecordFileHeader(&header, RECORD_FILE_COMPACT_VERSION, sizeof(User), ht->count, maxID + 1 > nextID ? maxID + 1 : nextID);
+	if (ok) {
+		ok = std::fseek(file, 0, SEEK_SET) == 0 && writeRecordFileHeader(file, &header);
 	}
 
-	std::fclose(file);
-	return 1;
+	if (std::fclose(file) != 0) {
+		ok = 0;
+	}
+	if (ok) {
+		ok = replaceFileAtomically(tempName.c_str(), filename);
+	} else {
+		std::remove(tempName.c_str());
+	}
+#if defined(ENABLE_HOT_PATH_STATS)
+	hotPathAdd(ok ? HOT_PATH_FILE_SAVES : HOT_PATH_FILE_FAILURES, 1);
+	hotPathAdd(HOT_PATH_BYTES_WRITTEN, written > 0 ? (uint64_t)written : 0);
+#endif
+	HOT_PATH_TIMER_STOP(startNanos, HOT_PATH_SAVE_NANOS);
+	return ok;
 }
 
+/**
+ *  @name   getNextID
+ *
+ *  @brief  Next free ID of a record file whose records start with an int ID.
+ *
+ *  @param  [in] filename   [\b const char*]  Record file.
+ *  @param  [in] recordSize [\b size_t]       Size of one record.
+ *
+ *  @retval [\b int] Next ID; 1 if the file does not exist; 0 if its header
+ *          is damaged.
+ *
+ *  @details
+ *  A single header read for current files. Headerless files are scanned
+ *  from offset 0, O(n) reads; loadUserDatabase() migrates them, after
+ *  which this is a header read too. The file is only read, so this is
+ *  safe next to a UserStore that holds it open. A damaged header gives no
+ *  reliable record offset, so no ID is guessed from the records.
+ */
 int getNextID(const char* filename, size_t recordSize)
 {
 	FILE* file = std::fopen(filename, "rb");
@@ -53,43 +280,675 @@ int getNextID(const char* filename, size_t recordSize)
 		return 1; // dosya yoksa ilk ID 1
 	}
 
-	void* record = std::malloc(recordSize);
-	if (!record) {
-		std::perror("Memory allocation failed");
-		std::fclose(file);
+	RecordFileHeader header;
+	int format = readRecordFileHeader(file, recordSize, &header);
+	int nextID = 0;
+	if (format == RECORD_FILE_CURRENT) {
+		nextID = header.nextID;
+	} else if (format == RECORD_FILE_LEGACY) {
+		nextID = scanMaxRecordID(file, recordSize) + 1;
+	}
+	std::fclose(file);
+	return nextID;
+}
+
+/**
+ *  @name   initRecordFileHeader
+ *
+ *  @brief  Fills in a RecordFileHeader and its checksum.
+ *
+ *  @param  [out] header      [\b RecordFileHeader*]  Header to fill.
+ *  @param  [in]  version     [\b uint32_t]          RECORD_FILE_VERSION or RECORD_FILE_COMPACT_VERSION.
+ *  @param  [in]  recordSize  [\b size_t]             Size of one record.
+ *  @param  [in]  recordCount [\b uint64_t]           Number of records that follow.
+ *  @param  [in]  nextID      [\b int]                Next free ID.
+ */
+void initRecordFileHeader(RecordFileHeader* header, uint32_t version, size_t recordSize, uint64_t recordCount, int nextID)
+{
+	std::memset(header, 0, sizeof(*header));
+	std::memcpy(header->magic, RECORD_FILE_MAGIC, sizeof(header->magic));
+	header->version = version;
+	header->headerSize = sizeof(RecordFileHeader);
+	header->recordSize = (uint32_t)recordSize;
+	header->recordCount = recordCount;
+	header->nextID = nextID;
+	header->checksum = computeCrc32(header, offsetof(RecordFileHeader, checksum));
+}
+
+/**
+ *  @name   readRecordFileHeader
+ *
+ *  @brief  Reads and validates the header at the start of a record file.
+ *
+ *  @param  [in]  file       [\b FILE*]              Open file (any position).
+ *  @param  [in]  recordSize [\b size_t]             Record size the caller expects.
+ *  @param  [out] header     [\b RecordFileHeader*]  Receives the header if current.
+ *
+ *  @retval [\b int] A RecordFileFormat value.
+ *
+ *  @details
+ *  Both layouts report RECORD_FILE_CURRENT; callers that only understand
+ *  fixed-width records must also check @c header->version. Leaves @p file
+ *  at the first record: after the header for
+ *  RECORD_FILE_CURRENT and RECORD_FILE_CORRUPT, at offset 0 for a
+ *  headerless RECORD_FILE_LEGACY file.
+ */
+int readRecordFileHeader(FILE* file, size_t recordSize, RecordFileHeader* header)
+{
+	std::fseek(file, 0, SEEK_SET);
+	if (std::fread(header, sizeof(*header), 1, file) != 1) {
+		std::fseek(file, 0, SEEK_SET);
+		return RECORD_FILE_LEGACY;
+	}
+
+	int format = checkRecordFileHeader(header, recordSize);
+	if (format == RECORD_FILE_LEGACY) {
+		std::fseek(file, 0, SEEK_SET);
+	} else if (format == RECORD_FILE_CURRENT) {
+		std::fseek(file, (long)header->headerSize, SEEK_SET);
+	}
+	return format;
+}
+
+/**
+ *  @name   writeRecordFileHeader
+ *
+ *  @brief  Writes a header prepared by initRecordFileHeader().
+ *
+ *  @param  [in] file   [\b FILE*]                   File positioned at offset 0.
+ *  @param  [in] header [\b const RecordFileHeader*] Header to write.
+ *
+ *  @retval [\b int] 1 on success; 0 on write failure.
+ */
+int writeRecordFileHeader(FILE* file, const RecordFileHeader* header)
+{
+	return std::fwrite(header, sizeof(*header), 1, file) == 1;
+}
+
+/**
+ *  @name   migrateRecordFile
+ *
+ *  @brief  Adds a RecordFileHeader to a headerless record file.
+ *
+ *  @param  [in] filename   [\b const char*]  Record file.
+ *  @param  [in] recordSize [\b size_t]       Size of one record.
+ *
+ *  @retval [\b int] 1 if the file now has a current header (or does not
+ *          exist); 0 if it is damaged or could not be rewritten.
+ *
+ *  @details
+ *  One pass copies the records to "<filename>.tmp" behind a placeholder
+ *  header while tracking the highest ID, then the real header is written
+ *  and the copy replaces the original atomically. Record bytes and order
+ *  are unchanged; a trailing partial record is dropped.
+ */
+int migrateRecordFile(const char* filename, size_t recordSize)
+{
+	FILE* source = std::fopen(filename, "rb");
+	if (!source) {
 		return 1;
 	}
 
-	int maxID = 0;
+	RecordFileHeader header;
+	int format = readRecordFileHeader(source, recordSize, &header);
+	if (format != RECORD_FILE_LEGACY) {
+		std::fclose(source);
+		return format == RECORD_FILE_CURRENT;
+	}
 
-	// Varsayım: her kaydın ilk alanı int ID
-	while (std::fread(record, recordSize, 1, file) == 1) {
+	std::string tempName = std::string(filename) + ".tmp";
+	FILE* target = std::fopen(tempName.c_str(), "wb");
+	void* record = std::malloc(recordSize);
+	if (!target || !record) {
+		std::free(record);
+		if (target) {
+			std::fclose(target);
+			std::remove(tempName.c_str());
+		}
+		std::fclose(source);
+		return 0;
+	}
+
+	initRecordFileHeader(&header, RECORD_FILE_VERSION, recordSize, 0, 1);
+	int ok = writeRecordFileHeader(target, &header);
+
+	uint64_t count = 0;
+	int maxID = 0;
+	while (ok && std::fread(record, recordSize, 1, source) == 1) {
+		ok = std::fwrite(record, recordSize, 1, target) == 1;
 		int recID = *reinterpret_cast<int*>(record);
 		if (recID > maxID) {
 			maxID = recID;
 		}
+		++count;
+	}
+
+	initRecordFileHeader(&header, RECORD_FILE_VERSION, recordSize, count, maxID + 1);
+	if (ok) {
+		ok = std::fseek(target, 0, SEEK_SET) == 0 && writeRecordFileHeader(target, &header);
 	}
 
 	std::free(record);
-	std::fclose(file);
-	return maxID + 1;
+	std::fclose(source);
+	if (std::fclose(target) != 0) {
+		ok = 0;
+	}
+	if (!ok) {
+		std::remove(tempName.c_str());
+		return 0;
+	}
+	return replaceFileAtomically(tempName.c_str(), filename);
 }
 
-char* getFormattedDate(int daysToAdd)
+/**
+ *  @name   Crc32Tables
+ *
+ *  @brief  Slicing-by-4 lookup tables for computeCrc32().
+ *
+ *  @details
+ *  table[0] is the classic byte table; table[k][i] is the CRC of byte i
+ *  followed by k zero bytes, which lets the inner loop fold four input
+ *  bytes per step.
+ */
+struct Crc32Tables {
+	uint32_t table[4][256];
+
+	Crc32Tables()
+	{
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t value = i;
+			for (int bit = 0; bit < 8; ++bit) {
+				value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+			}
+			table[0][i] = value;
+		}
+		for (uint32_t i = 0; i < 256; ++i) {
+			for (int k = 1; k < 4; ++k) {
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFFu];
+			}
+		}
+	}
+};
+
+/**
+ *  @name   computeCrc32
+ *
+ *  @brief  CRC-32 (IEEE 802.3, reflected 0xEDB88320) of a byte range.
+ *
+ *  @param  [in] data   [\b const void*]  Bytes to checksum.
+ *  @param  [in] length [\b size_t]       Number of bytes.
+ *
+ *  @retval [\b uint32_t] Checksum, compatible with zlib's crc32().
+ *
+ *  @details
+ *  Slicing-by-4: four table lookups per 32-bit word instead of one per
+ *  byte, which matters now that every compact block is checksummed on
+ *  load. Words are assembled byte by byte, so the result does not depend
+ *  on host endianness or alignment. The tables are a function-local
+ *  static, built once and safely even if several threads call first.
+ */
+uint32_t computeCrc32(const void* data, size_t length)
 {
-	char* dateStr = static_cast<char*>(std::malloc(11)); // YYYY-MM-DD + '\0'
-	if (!dateStr) {
-		std::perror("Memory allocation failed");
-		std::exit(EXIT_FAILURE);
+	static const Crc32Tables tables;
+	const uint32_t (*table)[256] = tables.table;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint32_t crc = 0xFFFFFFFFu;
+	for (; length >= 4; length -= 4, bytes += 4) {
+		crc ^= (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+		crc = table[3][crc & 0xFFu] ^ table[2][(crc >> 8) & 0xFFu] ^ table[1][(crc >> 16) & 0xFFu] ^ table[0][crc >> 24];
 	}
+	for (; length > 0; --length) {
+		crc = table[0][(crc ^ *bytes++) & 0xFFu] ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFFu;
+}
 
-	std::time_t now = std::time(nullptr);
-	std::tm* ltm = std::localtime(&now);
+/**
+ *  @name   syncFileByName
+ *
+ *  @brief  Flushes a closed file's data to disk.
+ *
+ *  @param  [in] filename [\b const char*]  File written and closed by the caller.
+ *
+ *  @retval [\b int] 1 once the data is on disk; 0 on failure.
+ *
+ *  @details
+ *  fclose() only hands the data to the OS. fsync()/_commit() on a fresh
+ *  descriptor flushes every dirty page of the file, whichever descriptor
+ *  wrote it.
+ */
+static int syncFileByName(const char* filename)
+{
+#if defined(_WIN32)
+	int fd = _open(filename, _O_RDWR | _O_BINARY);
+	if (fd < 0) {
+		return 0;
+	}
+	int ok = _commit(fd) == 0;
+	_close(fd);
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return 0;
+	}
+	int ok = fsync(fd) == 0;
+	close(fd);
+#endif
+	return ok;
+}
+
+/**
+ *  @name   syncParentDirectory
+ *
+ *  @brief  Makes a rename or a file creation inside a directory durable.
+ *
+ *  @param  [in] path [\b const char*]  File whose directory entry changed.
+ *
+ *  @retval [\b int] 1 on success; 0 if the directory cannot be synced.
+ *
+ *  @details
+ *  On POSIX a new or renamed directory entry survives a power loss only
+ *  once the directory itself is fsync()ed. Windows has no equivalent;
+ *  replaceFileAtomically() uses MOVEFILE_WRITE_THROUGH there instead, so
+ *  this is a no-op.
+ */
+int syncParentDirectory(const char* path)
+{
+#if defined(_WIN32)
+	(void)path;
+	return 1;
+#else
+	std::string directory(path);
+	size_t slash = directory.find_last_of('/');
+	directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : directory.substr(0, slash));
+
+	int fd = open(directory.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return 0;
+	}
+	int ok = fsync(fd) == 0;
+	close(fd);
+	return ok;
+#endif
+}
+
+/**
+ *  @name   replaceFileAtomically
+ *
+ *  @brief  Durably renames @p from over @p to, replacing any existing file.
+ *
+ *  @param  [in] from [\b const char*]  Fully written and closed temporary file.
+ *  @param  [in] to   [\b const char*]  Destination path.
+ *
+ *  @retval [\b int] 1 once the new contents and the rename are on disk;
+ *          0 on failure (@p from is removed, @p to is unchanged).
+ *
+ *  @details
+ *  @p from is synced before the rename. Otherwise a power loss could
+ *  persist the rename but not the data, leaving @p to empty or truncated.
+ *  The directory is synced afterwards, so callers may delete whatever
+ *  the old file was backed by (e.g. the user journal) once this returns.
+ *  rename() is atomic on POSIX; Windows needs MoveFileEx with
+ *  MOVEFILE_REPLACE_EXISTING because its rename() refuses to overwrite.
+ */
+int replaceFileAtomically(const char* from, const char* to)
+{
+	int ok = syncFileByName(from);
+#if defined(_WIN32)
+	ok = ok && MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	ok = ok && std::rename(from, to) == 0;
+#endif
+	if (!ok) {
+		std::remove(from);
+		return 0;
+	}
+	return syncParentDirectory(to);
+}
+
+/**
+ *  @name   mapFileReadOnly
+ *
+ *  @brief  Maps a whole file into memory for reading.
+ *
+ *  @param  [out] map      [\b MappedFile*]  Mapping to initialize.
+ *  @param  [in]  filename [\b const char*]  File to map.
+ *
+ *  @retval [\b int] 1 if the file was mapped or is empty (size 0, base NULL);
+ *          0 if it does not exist or cannot be mapped.
+ *
+ *  @details
+ *  Uses mmap() on POSIX and a file mapping on Windows. Pages are faulted
+ *  in only when touched, so opening a large file costs nothing up front.
+ *
+ *  @warning The mapping must be released with unmapFile().
+ */
+int mapFileReadOnly(MappedFile* map, const char* filename)
+{
+	if (!map || !filename) {
+		return 0;
+	}
+
+	map->base = nullptr;
+	map->size = 0;
+#if defined(_WIN32)
+	map->mapping = nullptr;
+	map->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (map->file == INVALID_HANDLE_VALUE) {
+		return 0;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(map->file, &size)) {
+		unmapFile(map);
+		return 0;
+	}
+	if (size.QuadPart == 0) {
+		return 1;
+	}
+
+	map->mapping = CreateFileMappingA(map->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	map->base = map->mapping ? MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!map->base) {
+		unmapFile(map);
+		return 0;
+	}
+	map->size = (size_t)size.QuadPart;
+#else
+	map->fd = open(filename, O_RDONLY);
+	if (map->fd < 0) {
+		return 0;
+	}
+
+	struct stat info;
+	if (fstat(map->fd, &info) != 0) {
+		unmapFile(map);
+		return 0;
+	}
+	if (info.st_size == 0) {
+		return 1;
+	}
+
+	void* base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, map->fd, 0);
+	if (base == MAP_FAILED) {
+		unmapFile(map);
+		return 0;
+	}
+	map->base = base;
+	map->size = (size_t)info.st_size;
+#endif
+	return 1;
+}
+
+/**
+ *  @name   unmapFile
+ *
+ *  @brief  Releases a mapping created by mapFileReadOnly().
+ *
+ *  @param  [in,out] map [\b MappedFile*]  Mapping to release; left empty.
+ *
+ *  @details Safe to call more than once.
+ */
+void unmapFile(MappedFile* map)
+{
+	if (!map) {
+		return;
+	}
+
+#if defined(_WIN32)
+	if (map->base) {
+		UnmapViewOfFile(map->base);
+	}
+	if (map->mapping) {
+		CloseHandle(map->mapping);
+	}
+	if (map->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(map->file);
+	}
+	map->mapping = nullptr;
+	map->file = INVALID_HANDLE_VALUE;
+#else
+	if (map->base) {
+		munmap(map->base, map->size);
+	}
+	if (map->fd >= 0) {
+		close(map->fd);
+	}
+	map->fd = -1;
+#endif
 
-	ltm->tm_mday += daysToAdd;
-	std::mktime(ltm); // normalize
+	map->base = nullptr;
+	map->size = 0;
+}
+
+/**
+ *  @name   openUserFileView
+ *
+ *  @brief  Maps a users file read-only so records can be searched in place.
+ *
+ *  @param  [out] view     [\b UserFileView*]  View to initialize.
+ *  @param  [in]  filename [\b const char*]    Path of the User record file.
+ *
+ *  @retval [\b int] 1 on success (including a missing or empty file, which
+ *          yields an empty view); 0 if the file exists but cannot be mapped
+ *          or its header is damaged.
+ *
+ *  @details
+ *  Nothing is copied or inserted into a HashTable. Compact files are
+ *  read through their block directory; fixed-width files expose
+ *  @c records directly, after the RecordFileHeader if there is one. A
+ *  trailing partial record is ignored.
+ *
+ *  @warning The view must be released with closeUserFileView().
+ */
+int openUserFileView(UserFileView* view, const char* filename)
+{
+	if (!view || !filename) {
+		return 0;
+	}
+
+	view->records = nullptr;
+	view->blockOffsets = nullptr;
+	view->blockCount = 0;
+	view->count = 0;
+	if (!mapFileReadOnly(&view->map, filename)) {
+		FILE* probe = std::fopen(filename, "rb");
+		if (!probe) {
+			return 1; // dosya yoksa boş görünüm
+		}
+		std::fclose(probe);
+		return 0;
+	}
+
+	const char* base = static_cast<const char*>(view->map.base);
+	size_t offset = 0;
+	size_t count = view->map.size / sizeof(User);
+	if (view->map.size >= sizeof(RecordFileHeader)) {
+		const RecordFileHeader* header = reinterpret_cast<const RecordFileHeader*>(base);
+		int format = checkRecordFileHeader(header, sizeof(User));
+		if (format == RECORD_FILE_CORRUPT) {
+			closeUserFileView(view);
+			return 0;
+		}
+		if (format == RECORD_FILE_CURRENT && header->version == RECORD_FILE_COMPACT_VERSION) {
+			if (!openCompactUserView(view, header)) {
+				closeUserFileView(view);
+				return 0;
+			}
+			return 1;
+		}
+		if (format == RECORD_FILE_CURRENT) {
+			offset = header->headerSize;
+			count = (view->map.size - offset) / sizeof(User);
+			if (header->recordCount < count) {
+				count = (size_t)header->recordCount;
+			}
+		}
+	}
 
-	std::snprintf(dateStr, 11, "%04d-%02d-%02d",
-		1900 + ltm->tm_year, 1 + ltm->tm_mon, ltm->tm_mday);
+	view->records = count > 0 ? reinterpret_cast<const User*>(base + offset) : nullptr;
+	view->count = count;
+	return 1;
+}
+
+/**
+ *  @name   readUserFromFileView
+ *
+ *  @brief  Copies one record out of a users file view.
+ *
+ *  @param  [in]  view   [\b const UserFileView*]  View opened with openUserFileView().
+ *  @param  [in]  index  [\b size_t]               0-based record number.
+ *  @param  [out] result [\b User*]                Receives the record, null-terminated.
+ *
+ *  @retval [\b int] 1 on success; 0 if @p index is out of range or the record is malformed.
+ */
+int readUserFromFileView(const UserFileView* view, size_t index, User* result)
+{
+	if (!view || !result || index >= view->count) {
+		return 0;
+	}
+
+	if (view->records) {
+		*result = view->records[index];
+		result->username[sizeof(result->username) - 1] = '\0';
+		result->password[sizeof(result->password) - 1] = '\0';
+		return 1;
+	}
+
+	const char* username;
+	const char* password;
+	size_t usernameLength, passwordLength;
+	if (!readCompactUserFields(view, index, &result->id, &username, &usernameLength, &password, &passwordLength)) {
+		return 0;
+	}
+	std::memset(result->username, 0, sizeof(result->username));
+	std::memset(result->password, 0, sizeof(result->password));
+	std::memcpy(result->username, username, usernameLength);
+	std::memcpy(result->password, password, passwordLength);
+	return 1;
+}
+
+/**
+ *  @name   findUserInFileView
+ *
+ *  @brief  Finds a user by name directly in a mapped users file.
+ *
+ *  @param  [in]  view     [\b const UserFileView*]  View opened with openUserFileView().
+ *  @param  [in]  username [\b const char*]          Null-terminated username key.
+ *  @param  [out] result   [\b User*]                If non-NULL, receives a copy of the record.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ *
+ *  @details
+ *  Names are compared in place; only the matching record is copied. The
+ *  first matching record wins, which is the record
+ *  loadUsersFromBinaryFile() would keep. Logins without a loaded table
+ *  use findUserInIndex() instead, whose cost does not grow with the file.
+ *
+ *  @complexity O(count) sequential reads of the mapping.
+ */
+int findUserInFileView(const UserFileView* view, const char* username, User* result)
+{
+	if (!view || !username) {
+		return 0;
+	}
+
+	size_t length = std::strlen(username);
+	if (length >= sizeof(result->username)) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < view->count; ++i) {
+		if (view->records) {
+			// length + 1 bayt: sondaki '\0' da eşleşmeli
+			if (std::memcmp(view->records[i].username, username, length + 1) != 0) {
+				continue;
+			}
+		} else {
+			int id;
+			const char* name;
+			const char* password;
+			size_t nameLength, passwordLength;
+			if (!readCompactUserFields(view, i, &id, &name, &nameLength, &password, &passwordLength)
+				|| nameLength != length || std::memcmp(name, username, length) != 0) {
+				continue;
+			}
+		}
+		return result ? readUserFromFileView(view, i, result) : 1;
+	}
+	return 0;
+}
+
+/**
+ *  @name   closeUserFileView
+ *
+ *  @brief  Unmaps a users file view.
+ *
+ *  @param  [in,out] view [\b UserFileView*]  View to release; left empty.
+ *
+ *  @details Safe to call more than once.
+ */
+void closeUserFileView(UserFileView* view)
+{
+	if (!view) {
+		return;
+	}
+
+	unmapFile(&view->map);
+	view->records = nullptr;
+	view->blockOffsets = nullptr;
+	view->blockCount = 0;
+	view->count = 0;
+}
+
+/**
+ *  @name   getFormattedDate
+ *
+ *  @brief  Writes the local date @p daysToAdd days from today as "YYYY-MM-DD".
+ *
+ *  @param  [in]  daysToAdd [\b int]     Offset from today; may be negative.
+ *  @param  [out] buffer    [\b char*]   Receives the date; at least DATE_STRING_SIZE bytes.
+ *  @param  [in]  size      [\b size_t]  Size of @p buffer.
+ *
+ *  @retval [\b int] Characters written (10); 0 if the buffer is too small or
+ *          the local date is unavailable, with @p buffer set to "" when it has room.
+ *
+ *  @details No allocation; the same work as currentLocalDate(), addDays()
+ *           and formatDate().
+ */
+int getFormattedDate(int daysToAdd, char* buffer, size_t size)
+{
+	Date today;
+	int written = 0;
+	if (buffer && currentLocalDate(&today)) {
+		written = formatDate(addDays(today, daysToAdd), buffer, size);
+	}
+	if (!written && buffer && size > 0) {
+		buffer[0] = '\0';
+	}
+	return written;
+}
+
+/**
+ *  @name   getFormattedDate
+ *
+ *  @brief  Local date @p daysToAdd days from today as a malloc'ed "YYYY-MM-DD".
+ *
+ *  @param  [in] daysToAdd [\b int]  Offset from today; may be negative.
+ *
+ *  @retval [\b char*] String the caller must free(); NULL on allocation failure
+ *          or when the date cannot be formatted.
+ *
+ *  @deprecated Kept for existing callers; allocates on every call. Use the
+ *              caller-buffer overload instead.
+ */
+char* getFormattedDate(int daysToAdd)
+{
+	char* dateStr = static_cast<char*>(std::malloc(DATE_STRING_SIZE));
+	if (dateStr && !getFormattedDate(daysToAdd, dateStr, DATE_STRING_SIZE)) {
+		std::free(dateStr);
+		return nullptr;
+	}
 	return dateStr;
 }
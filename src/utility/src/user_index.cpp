@@ -0,0 +1,342 @@
+﻿#include "../header/user_index.h"
+#include "../header/compact_user_file.h"
+#include <cstring>
+#include <vector>
+
+/**
+ *  @name   snapshotChecksum
+ *
+ *  @brief  Fingerprints the contents of a mapped users file.
+ *
+ *  @param  [in] users [\b const UserFileView*]  Open view of the users file.
+ *
+ *  @retval [\b uint32_t] CRC-32 that changes whenever a record changes.
+ *
+ *  @details
+ *  Compact files already checksum every block, so the CRC covers only the
+ *  file header and the block headers: one small read per 1024 users.
+ *  Fixed-width and headerless files carry no checksums and are hashed
+ *  whole. Unlike a size and mtime pair, this catches a rewrite within the
+ *  same second that keeps the size, such as a changed password.
+ *
+ *  @complexity O(blocks) for compact files, O(file size) otherwise
+ */
+static uint32_t snapshotChecksum(const UserFileView* users)
+{
+	if (!users->map.base) {
+		return 0;
+	}
+	if (!users->blockOffsets) {
+		return computeCrc32(users->map.base, users->map.size);
+	}
+
+	const unsigned char* base = static_cast<const unsigned char*>(users->map.base);
+	std::vector<unsigned char> headers(base, base + sizeof(RecordFileHeader));
+	for (size_t block = 0; block < users->blockCount; ++block) {
+		const unsigned char* blockHeader = base + users->blockOffsets[block];
+		headers.insert(headers.end(), blockHeader, blockHeader + sizeof(CompactUserBlockHeader));
+	}
+	return computeCrc32(headers.data(), headers.size());
+}
+
+/**
+ *  @name   indexMatchesSnapshot
+ *
+ *  @brief  Compares an index file's header with the users file it belongs to.
+ *
+ *  @param  [in] indexFile [\b const char*]            Index path.
+ *  @param  [in] users     [\b const UserFileView*]    Open view of the users file.
+ *
+ *  @retval [\b int] 1 if the index has the current magic/version and was
+ *          built from a users file of the same size and checksum.
+ */
+static int indexMatchesSnapshot(const char* indexFile, const UserFileView* users)
+{
+	FILE* file = std::fopen(indexFile, "rb");
+	if (!file) {
+		return 0;
+	}
+	UserIndexHeader header;
+	int ok = std::fread(&header, sizeof(header), 1, file) == 1;
+	std::fclose(file);
+
+	return ok
+		&& std::memcmp(header.magic, USER_INDEX_MAGIC, sizeof(header.magic)) == 0
+		&& header.version == USER_INDEX_VERSION
+		&& header.snapshotSize == (uint64_t)users->map.size
+		&& header.snapshotChecksum == snapshotChecksum(users);
+}
+
+/**
+ *  @name   probeIndexSlots
+ *
+ *  @brief  Follows a username's Brent probe sequence through index slots.
+ *
+ *  @param  [in] slots     [\b const BrentSlot*]  Slot array.
+ *  @param  [in] capacity  [\b uint32_t]          Slot count (power of two).
+ *  @param  [in] users     [\b const UserFileView*]  Users file the slots refer to.
+ *  @param  [in] hashValue [\b uint64_t]          hashUsernameSeeded() of @p username.
+ *  @param  [in] username  [\b const char*]       Key to find.
+ *  @param  [out] result   [\b User*]             Receives a copy of the matching record.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ *
+ *  @details
+ *  Same sequence as findUserBrent(): records are only read when the stored
+ *  fingerprint matches, so a lookup touches the header page, one or two
+ *  slot pages and the single matching record page.
+ */
+static int probeIndexSlots(const BrentSlot* slots, uint32_t capacity, const UserFileView* users,
+	uint64_t hashValue, const char* username, User* result)
+{
+	unsigned int mask = capacity - 1;
+	uint32_t fingerprint = brentFingerprint(hashValue);
+	unsigned int index = brentHomeIndex(hashValue, mask);
+	unsigned int step = brentProbeStep(fingerprint, mask);
+
+	for (uint32_t i = 0; i < capacity; ++i) {
+		const BrentSlot* slot = &slots[index];
+		if (slot->record == 0) {
+			return 0;
+		}
+		if (slot->fingerprint == fingerprint && readUserFromFileView(users, slot->record - 1, result)
+			&& std::strncmp(result->username, username, sizeof(result->username)) == 0) {
+			return 1;
+		}
+		index = (index + step) & mask;
+	}
+	return 0;
+}
+
+/**
+ *  @name   buildUserIndexPath
+ *
+ *  @brief  Derives the index path that belongs to a users file.
+ *
+ *  @param  [out] out      [\b char*]        Receives "<filename>.idx".
+ *  @param  [in]  outSize  [\b size_t]       Capacity of @p out in bytes.
+ *  @param  [in]  filename [\b const char*]  Users file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 on success; 0 if @p out is too small.
+ */
+int buildUserIndexPath(char* out, size_t outSize, const char* filename)
+{
+	int written = std::snprintf(out, outSize, "%s%s", filename, USER_INDEX_SUFFIX);
+	return written > 0 && (size_t)written < outSize;
+}
+
+/**
+ *  @name   writeUserIndex
+ *
+ *  @brief  Builds the on-disk Brent index for a users file.
+ *
+ *  @param  [in] filename [\b const char*]  Users file to index.
+ *
+ *  @retval [\b int] 1 on success; 0 on I/O failure or a missing or empty users file.
+ *
+ *  @details
+ *  Places every record number with placeRecordBrent() into a slot array
+ *  sized for BRENT_DEFAULT_MAX_LOAD, then writes a UserIndexHeader followed
+ *  by the slots to "<filename>.idx" (via a temporary file and an atomic
+ *  rename). When a username occurs more than once, only the first record is
+ *  indexed, matching loadUsersFromBinaryFile().
+ *
+ *  @complexity O(n) in the number of records.
+ */
+int writeUserIndex(const char* filename)
+{
+	char indexFile[FILENAME_MAX];
+	if (!filename || !buildUserIndexPath(indexFile, sizeof(indexFile), filename)) {
+		return 0;
+	}
+
+	UserIndexHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, USER_INDEX_MAGIC, sizeof(header.magic));
+	header.version = USER_INDEX_VERSION;
+	header.seed = USER_INDEX_SEED;
+
+	UserFileView users;
+	if (!openUserFileView(&users, filename)) {
+		return 0;
+	}
+	if (!users.map.base) {
+		closeUserFileView(&users);
+		return 0;
+	}
+	header.snapshotSize = (uint64_t)users.map.size;
+	header.snapshotChecksum = snapshotChecksum(&users);
+
+	uint32_t capacity = 1;
+	while ((double)capacity * BRENT_DEFAULT_MAX_LOAD < (double)users.count + 1) {
+		capacity <<= 1;
+	}
+
+	std::vector<BrentSlot> slots(capacity, BrentSlot{ 0, 0 });
+	User user, existing;
+	for (size_t i = 0; i < users.count; ++i) {
+		if (!readUserFromFileView(&users, i, &user)) {
+			closeUserFileView(&users);
+			return 0;
+		}
+
+		uint64_t hashValue = hashUsernameSeeded(user.username, header.seed);
+		if (probeIndexSlots(slots.data(), capacity, &users, hashValue, user.username, &existing)) {
+			continue;
+		}
+		placeRecordBrent(slots.data(), capacity, (uint32_t)(i + 1), hashValue);
+		header.count++;
+	}
+	header.capacity = capacity;
+	closeUserFileView(&users);
+
+	std::string tempName = std::string(indexFile) + ".tmp";
+	FILE* file = std::fopen(tempName.c_str(), "wb");
+	if (!file) {
+		return 0;
+	}
+
+	int ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+		&& std::fwrite(slots.data(), sizeof(BrentSlot), capacity, file) == capacity;
+	if (std::fclose(file) != 0) {
+		ok = 0;
+	}
+	if (!ok) {
+		std::remove(tempName.c_str());
+		return 0;
+	}
+	return replaceFileAtomically(tempName.c_str(), indexFile);
+}
+
+/**
+ *  @name   isUserIndexCurrent
+ *
+ *  @brief  Checks whether the index on disk matches its users file.
+ *
+ *  @param  [in] filename [\b const char*]  Users file.
+ *
+ *  @retval [\b int] 1 if the index exists, has the current magic/version
+ *          and was built from a users file of the same size and checksum.
+ */
+int isUserIndexCurrent(const char* filename)
+{
+	char indexFile[FILENAME_MAX];
+	UserFileView users;
+	if (!filename || !buildUserIndexPath(indexFile, sizeof(indexFile), filename)
+		|| !openUserFileView(&users, filename)) {
+		return 0;
+	}
+
+	int current = users.map.base && indexMatchesSnapshot(indexFile, &users);
+	closeUserFileView(&users);
+	return current;
+}
+
+/**
+ *  @name   openUserIndex
+ *
+ *  @brief  Maps a users file together with its index, rebuilding the index if needed.
+ *
+ *  @param  [out] view     [\b UserIndexView*]  View to initialize.
+ *  @param  [in]  filename [\b const char*]     Users file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 if lookups can be served (a missing users file gives an
+ *          empty view); 0 if the index cannot be built or mapped.
+ *
+ *  @details
+ *  The index is rewritten only when it is missing, from another version,
+ *  or out of date with the users file. Otherwise opening is two mmap calls
+ *  plus snapshotChecksum() over the block headers; no record is read.
+ */
+int openUserIndex(UserIndexView* view, const char* filename)
+{
+	if (!view || !filename) {
+		return 0;
+	}
+
+	view->header = nullptr;
+	view->slots = nullptr;
+	view->map.base = nullptr;
+	view->map.size = 0;
+#if defined(_WIN32)
+	view->map.file = INVALID_HANDLE_VALUE;
+	view->map.mapping = nullptr;
+#else
+	view->map.fd = -1;
+#endif
+	if (!openUserFileView(&view->users, filename)) {
+		return 0;
+	}
+	if (view->users.count == 0) {
+		return 1;
+	}
+
+	char indexFile[FILENAME_MAX];
+	if (!buildUserIndexPath(indexFile, sizeof(indexFile), filename)
+		|| (!indexMatchesSnapshot(indexFile, &view->users) && !writeUserIndex(filename))
+		|| !mapFileReadOnly(&view->map, indexFile)
+		|| view->map.size < sizeof(UserIndexHeader)) {
+		closeUserIndex(view);
+		return 0;
+	}
+
+	view->header = static_cast<const UserIndexHeader*>(view->map.base);
+	if (view->map.size < sizeof(UserIndexHeader) + (size_t)view->header->capacity * sizeof(BrentSlot)
+		|| view->header->capacity == 0 || (view->header->capacity & (view->header->capacity - 1)) != 0) {
+		closeUserIndex(view);
+		return 0;
+	}
+	view->slots = reinterpret_cast<const BrentSlot*>(view->header + 1);
+	return 1;
+}
+
+/**
+ *  @name   findUserInIndex
+ *
+ *  @brief  Looks a user up through the persistent index.
+ *
+ *  @param  [in]  view     [\b const UserIndexView*]  View opened with openUserIndex().
+ *  @param  [in]  username [\b const char*]           Null-terminated username key.
+ *  @param  [out] result   [\b User*]                 If non-NULL, receives a copy of the record.
+ *
+ *  @retval [\b int] 1 if found; 0 otherwise.
+ *
+ *  @complexity O(1) expected, independent of the number of users.
+ */
+int findUserInIndex(const UserIndexView* view, const char* username, User* result)
+{
+	if (!view || !username || !view->slots) {
+		return 0;
+	}
+
+	User found;
+	if (!probeIndexSlots(view->slots, view->header->capacity, &view->users,
+		hashUsernameSeeded(username, view->header->seed), username, &found)) {
+		return 0;
+	}
+	if (result) {
+		*result = found;
+	}
+	return 1;
+}
+
+/**
+ *  @name   closeUserIndex
+ *
+ *  @brief  Unmaps the index and its users file.
+ *
+ *  @param  [in,out] view [\b UserIndexView*]  View to release; left empty.
+ *
+ *  @details Safe to call more than once.
+ */
+void closeUserIndex(UserIndexView* view)
+{
+	if (!view) {
+		return;
+	}
+
+	unmapFile(&view->map);
+	closeUserFileView(&view->users);
+	view->header = nullptr;
+	view->slots = nullptr;
+}
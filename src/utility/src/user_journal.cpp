@@ -0,0 +1,455 @@
+﻿#include "../header/user_journal.h"
+#include "../header/user_index.h"
+#include <cstring>
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+/**
+ *  @name   buildUserJournalPath
+ *
+ *  @brief  Derives the journal path that belongs to a users snapshot file.
+ *
+ *  @param  [out] out      [\b char*]        Receives "<filename>.journal".
+ *  @param  [in]  outSize  [\b size_t]       Capacity of @p out in bytes.
+ *  @param  [in]  filename [\b const char*]  Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 on success; 0 if @p out is too small.
+ */
+int buildUserJournalPath(char* out, size_t outSize, const char* filename)
+{
+	int written = std::snprintf(out, outSize, "%s%s", filename, USER_JOURNAL_SUFFIX);
+	return written > 0 && (size_t)written < outSize;
+}
+
+/**
+ *  @name   readJournalRecord
+ *
+ *  @brief  Reads the next journal record and checks it.
+ *
+ *  @param  [in]  file   [\b FILE*]                   Journal opened for reading.
+ *  @param  [out] record [\b UserJournalRecord*]      Receives the record, strings null-terminated.
+ *  @param  [out] type   [\b UserJournalRecordType*]  Receives what the record does.
+ *
+ *  @retval [\b int] 1 for an intact record; 0 at the end of the journal or
+ *          at a short or damaged record.
+ */
+static int readJournalRecord(FILE* file, UserJournalRecord* record, UserJournalRecordType* type)
+{
+	if (std::fread(record, sizeof(*record), 1, file) != 1) {
+		return 0;
+	}
+
+	uint32_t checksum = computeCrc32(&record->user, sizeof(record->user));
+	if (record->checksum == checksum) {
+		*type = USER_JOURNAL_PUT;
+	} else if (record->checksum == ~checksum) {
+		*type = USER_JOURNAL_DELETE;
+	} else {
+		return 0;
+	}
+	record->user.username[sizeof(record->user.username) - 1] = '\0';
+	record->user.password[sizeof(record->user.password) - 1] = '\0';
+	return 1;
+}
+
+/**
+ *  @name   appendJournalRecord
+ *
+ *  @brief  Durably appends one record to the journal.
+ *
+ *  @param  [in] journalFile [\b const char*]            Journal path.
+ *  @param  [in] user        [\b const User*]            Record to append.
+ *  @param  [in] type        [\b UserJournalRecordType]  What the record does.
+ *
+ *  @retval [\b int] 1 once the record is flushed to disk; 0 on I/O failure.
+ *
+ *  @details
+ *  Writes a UserJournalRecord (the raw User followed by its CRC-32, or the
+ *  CRC's bitwise NOT for a deletion) and flushes it with fsync()/_commit().
+ *  The cost is independent of how many users already exist. The append
+ *  that creates the journal also syncs its directory, so the file itself
+ *  survives a power loss. A crash during the write leaves at most one torn
+ *  record at the tail, which replayUserJournal() detects and
+ *  loadUserDatabase() truncates.
+ */
+static int appendJournalRecord(const char* journalFile, const User* user, UserJournalRecordType type)
+{
+	FILE* file = std::fopen(journalFile, "ab");
+	if (!file) {
+		return 0;
+	}
+
+	std::fseek(file, 0, SEEK_END);
+	bool created = std::ftell(file) == 0;
+
+	UserJournalRecord record;
+	std::memset(&record, 0, sizeof(record));
+	record.user = *user;
+	record.checksum = computeCrc32(&record.user, sizeof(record.user));
+	if (type == USER_JOURNAL_DELETE) {
+		record.checksum = ~record.checksum;
+	}
+
+	int ok = std::fwrite(&record, sizeof(record), 1, file) == 1 && std::fflush(file) == 0;
+#if defined(_WIN32)
+	ok = ok && _commit(_fileno(file)) == 0;
+#else
+	ok = ok && fsync(fileno(file)) == 0;
+#endif
+
+	if (std::fclose(file) != 0) {
+		ok = 0;
+	}
+	return ok && (!created || syncParentDirectory(journalFile));
+}
+
+/**
+ *  @name   appendUserToJournal
+ *
+ *  @brief  Durably appends a registration or password change to the journal.
+ *
+ *  @param  [in] journalFile [\b const char*]  Journal path.
+ *  @param  [in] user        [\b const User*]  Record to append.
+ *
+ *  @retval [\b int] 1 once the record is flushed to disk; 0 on I/O failure.
+ */
+int appendUserToJournal(const char* journalFile, const User* user)
+{
+	return appendJournalRecord(journalFile, user, USER_JOURNAL_PUT);
+}
+
+/**
+ *  @name   appendUserDeletionToJournal
+ *
+ *  @brief  Durably appends a deletion to the journal.
+ *
+ *  @param  [in] journalFile [\b const char*]  Journal path.
+ *  @param  [in] user        [\b const User*]  The removed record; replay matches it by username.
+ *
+ *  @retval [\b int] 1 once the record is flushed to disk; 0 on I/O failure.
+ *
+ *  @details
+ *  A deletion keeps the record layout and only inverts the checksum, so a
+ *  journal written by an older build still replays, and an older build
+ *  stops at a deletion instead of reading it as a registration.
+ */
+int appendUserDeletionToJournal(const char* journalFile, const User* user)
+{
+	return appendJournalRecord(journalFile, user, USER_JOURNAL_DELETE);
+}
+
+/**
+ *  @name   replayUserJournal
+ *
+ *  @brief  Applies every intact journal record to the table.
+ *
+ *  @param  [in,out] ht          [\b HashTable*]   Table already holding the snapshot.
+ *  @param  [in]     journalFile [\b const char*]  Journal path.
+ *  @param  [out]    validLength [\b long*]        If non-NULL, receives the offset just past
+ *                                                the last intact record (0 if the journal is missing).
+ *
+ *  @retval [\b int] Number of records inserted (0 if the journal is missing).
+ *
+ *  @details
+ *  Stops at the first record that is short or whose checksum does not
+ *  match, since only the tail can be torn by a crash. Everything from
+ *  @p validLength on is that torn tail; truncateUserJournal() removes it
+ *  before the next append. A record whose
+ *  username is already present is a password change and is applied with
+ *  updateUserBrent(), and a deletion is applied with deleteUserBrent();
+ *  records are applied in order, so the last one for a name wins.
+ *  Replaying after an interrupted compaction repeats changes the snapshot
+ *  already holds and ends in the same table. Advances @c currentID past
+ *  every replayed ID.
+ */
+int replayUserJournal(HashTable* ht, const char* journalFile, long* validLength)
+{
+	if (validLength) {
+		*validLength = 0;
+	}
+	FILE* file = std::fopen(journalFile, "rb");
+	if (!file) {
+		return 0;
+	}
+
+	UserJournalRecord record;
+	UserJournalRecordType type;
+	int replayed = 0;
+	long intact = 0;
+
+	while (readJournalRecord(file, &record, &type)) {
+		if (type == USER_JOURNAL_DELETE) {
+			deleteUserBrent(ht, record.user.username);
+		} else if (findUserBrent(ht, record.user.username, NULL)) {
+			updateUserBrent(ht, record.user.username, record.user.password);
+		} else if (insertUserBrent(ht, record.user.id, record.user.username, record.user.password)) {
+			++replayed;
+		}
+		advanceUserID(record.user.id);
+		intact += (long)sizeof(record);
+	}
+
+	std::fclose(file);
+	if (validLength) {
+		*validLength = intact;
+	}
+	return replayed;
+}
+
+/**
+ *  @name   truncateUserJournal
+ *
+ *  @brief  Cuts a torn tail off the journal.
+ *
+ *  @param  [in] journalFile [\b const char*]  Journal path.
+ *  @param  [in] length      [\b long]         Bytes to keep, from replayUserJournal().
+ *
+ *  @retval [\b int] 1 if the journal is at most @p length bytes long afterwards
+ *          (a missing journal counts); 0 on I/O failure.
+ *
+ *  @details
+ *  appendUserToJournal() opens the journal with "ab", so a record appended
+ *  after a torn one would sit behind a bad checksum and never be replayed.
+ *  The truncation is flushed with fsync()/_commit() before returning. An
+ *  intact journal is left untouched, so this is cheap on every load.
+ */
+int truncateUserJournal(const char* journalFile, long length)
+{
+	FILE* file = std::fopen(journalFile, "r+b");
+	if (!file) {
+		FILE* probe = std::fopen(journalFile, "rb");
+		if (probe) {
+			std::fclose(probe);
+			return 0;
+		}
+		return 1;
+	}
+
+	std::fseek(file, 0, SEEK_END);
+	long size = std::ftell(file);
+	int ok = size >= 0;
+	if (ok && size > length) {
+		std::fflush(file);
+#if defined(_WIN32)
+		ok = _chsize_s(_fileno(file), length) == 0 && _commit(_fileno(file)) == 0;
+#else
+		ok = ftruncate(fileno(file), (off_t)length) == 0 && fsync(fileno(file)) == 0;
+#endif
+	}
+
+	if (std::fclose(file) != 0) {
+		ok = 0;
+	}
+	return ok;
+}
+
+/**
+ *  @name   findUserInJournal
+ *
+ *  @brief  Searches the journal for a user without building a table.
+ *
+ *  @param  [in]  journalFile [\b const char*]  Journal path.
+ *  @param  [in]  username    [\b const char*]  Null-terminated username key.
+ *  @param  [out] result      [\b User*]        Receives a copy of the last intact match.
+ *
+ *  @retval [\b int] 1 if the last intact record for @p username registers or
+ *          updates it; -1 if it deletes it; 0 if the journal does not name it.
+ *
+ *  @details
+ *  Complements findUserInFileView() for users registered, updated or
+ *  deleted since the last compaction; a later record for the same name
+ *  supersedes an earlier one, as in replayUserJournal(). On -1 the caller
+ *  must not fall back to the snapshot, which may still hold the user. The journal holds at most USER_JOURNAL_COMPACT_THRESHOLD
+ *  records, so the scan is bounded.
+ */
+int findUserInJournal(const char* journalFile, const char* username, User* result)
+{
+	FILE* file = std::fopen(journalFile, "rb");
+	if (!file) {
+		return 0;
+	}
+
+	UserJournalRecord record;
+	UserJournalRecordType type;
+	int found = 0;
+
+	while (readJournalRecord(file, &record, &type)) {
+		if (std::strcmp(record.user.username, username) != 0) {
+			continue;
+		}
+		if (type == USER_JOURNAL_DELETE) {
+			found = -1;
+			continue;
+		}
+		if (result) {
+			*result = record.user;
+		}
+		found = 1;
+	}
+
+	std::fclose(file);
+	return found;
+}
+
+/**
+ *  @name   countUserJournalRecords
+ *
+ *  @brief  Number of complete records in the journal, from its size.
+ *
+ *  @param  [in] journalFile [\b const char*]  Journal path.
+ *
+ *  @retval [\b long] Record count; 0 if the journal does not exist.
+ */
+long countUserJournalRecords(const char* journalFile)
+{
+	FILE* file = std::fopen(journalFile, "rb");
+	if (!file) {
+		return 0;
+	}
+
+	std::fseek(file, 0, SEEK_END);
+	long size = std::ftell(file);
+	std::fclose(file);
+	return size < 0 ? 0 : size / (long)sizeof(UserJournalRecord);
+}
+
+/**
+ *  @name   compactUserJournal
+ *
+ *  @brief  Folds the journal into a new snapshot and empties it.
+ *
+ *  @param  [in] ht       [\b const HashTable*]  Table holding snapshot + journal contents.
+ *  @param  [in] filename [\b const char*]       Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 on success; 0 if the snapshot could not be written
+ *          (the journal is then kept, so nothing is lost).
+ *
+ *  @details
+ *  The snapshot is replaced atomically by saveUsersToBinaryFile(), which
+ *  returns only once the new snapshot and its rename are on disk; only
+ *  then is the journal removed. A crash between the two steps leaves
+ *  journal records whose effect the snapshot already holds; deletions are
+ *  journaled too, so replaying them cannot bring a deleted user back.
+ *  The persistent index is rebuilt right away so the next login does not
+ *  have to; if that fails, openUserIndex() rebuilds it on demand.
+ */
+int compactUserJournal(const HashTable* ht, const char* filename)
+{
+	char journalFile[FILENAME_MAX];
+	if (!buildUserJournalPath(journalFile, sizeof(journalFile), filename)) {
+		return 0;
+	}
+
+	if (!saveUsersToBinaryFile(ht, filename)) {
+		return 0;
+	}
+
+	std::remove(journalFile);
+	writeUserIndex(filename);
+	return 1;
+}
+
+/**
+ *  @name   loadUserDatabase
+ *
+ *  @brief  Loads the snapshot and replays its journal (crash recovery).
+ *
+ *  @param  [in,out] ht       [\b HashTable*]  Initialized table to fill.
+ *  @param  [in]     filename [\b const char*] Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 on success; 0 on invalid arguments, if the snapshot
+ *          exists but cannot be loaded (damaged header or block checksum),
+ *          or if a torn journal tail cannot be truncated.
+ *
+ *  @details
+ *  A headerless snapshot from an older build is given a RecordFileHeader
+ *  first with migrateRecordFile(). If that fails (e.g. a read-only
+ *  directory) it is still loaded as is. A damaged snapshot is reported
+ *  instead of being treated as empty: the next compaction would otherwise
+ *  overwrite it with whatever part of it had been loaded. A torn journal
+ *  tail is truncated here, before anything can be appended behind it.
+ */
+int loadUserDatabase(HashTable* ht, const char* filename)
+{
+	char journalFile[FILENAME_MAX];
+	if (!ht || !filename || !buildUserJournalPath(journalFile, sizeof(journalFile), filename)) {
+		return 0;
+	}
+
+	migrateRecordFile(filename, sizeof(User));
+	if (!loadUsersFromBinaryFile(ht, filename)) {
+		return 0;
+	}
+	long validLength = 0;
+	replayUserJournal(ht, journalFile, &validLength);
+	return truncateUserJournal(journalFile, validLength);
+}
+
+/**
+ *  @name   commitJournalRecord
+ *
+ *  @brief  Appends a change to the journal and compacts it when it is full.
+ *
+ *  @param  [in] ht       [\b const HashTable*]       Table that already reflects the change.
+ *  @param  [in] user     [\b const User*]            The record to journal.
+ *  @param  [in] type     [\b UserJournalRecordType]  What the record does.
+ *  @param  [in] filename [\b const char*]            Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 once the change is durable; 0 on I/O failure.
+ *
+ *  @details
+ *  When the journal reaches USER_JOURNAL_COMPACT_THRESHOLD records it is
+ *  compacted into the snapshot. Compaction failure is not an error,
+ *  because the change is already durable in the journal.
+ */
+static int commitJournalRecord(const HashTable* ht, const User* user, UserJournalRecordType type, const char* filename)
+{
+	char journalFile[FILENAME_MAX];
+	if (!ht || !user || !filename || !buildUserJournalPath(journalFile, sizeof(journalFile), filename)) {
+		return 0;
+	}
+
+	if (!appendJournalRecord(journalFile, user, type)) {
+		return 0;
+	}
+
+	if (countUserJournalRecords(journalFile) >= USER_JOURNAL_COMPACT_THRESHOLD) {
+		compactUserJournal(ht, filename);
+	}
+	return 1;
+}
+
+/**
+ *  @name   commitUserRegistration
+ *
+ *  @brief  Persists a newly registered user or a changed password.
+ *
+ *  @param  [in] ht       [\b const HashTable*]  Table that already contains @p user.
+ *  @param  [in] user     [\b const User*]       The new record.
+ *  @param  [in] filename [\b const char*]       Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 once the user is durable; 0 on I/O failure.
+ */
+int commitUserRegistration(const HashTable* ht, const User* user, const char* filename)
+{
+	return commitJournalRecord(ht, user, USER_JOURNAL_PUT, filename);
+}
+
+/**
+ *  @name   commitUserDeletion
+ *
+ *  @brief  Persists the removal of a user.
+ *
+ *  @param  [in] ht       [\b const HashTable*]  Table the user was already deleted from.
+ *  @param  [in] user     [\b const User*]       Copy of the removed record.
+ *  @param  [in] filename [\b const char*]       Snapshot file (e.g. "users.dat").
+ *
+ *  @retval [\b int] 1 once the deletion is durable; 0 on I/O failure.
+ */
+int commitUserDeletion(const HashTable* ht, const User* user, const char* filename)
+{
+	return commitJournalRecord(ht, user, USER_JOURNAL_DELETE, filename);
+}